@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+#
+# Copyright The pyparted Project Authors
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+# Measure the per-call overhead of the small _ped methods that get called
+# in tight loops (geometry tests, alignment, flag queries).  The work done
+# inside libparted for these is a handful of comparisons, so the numbers
+# are dominated by argument passing and result conversion.  Run it against
+# two builds to compare them:
+#
+#     make bench
+#     PYTHONPATH=build/lib.<platform> python3 benchmarks/bench_calls.py
+#
+
+import argparse
+import timeit
+
+import _ped
+
+DEVICE_SIZE = 8 * 1024 * 1024
+
+
+def setup_disk():
+    device = _ped.device_new_memory(DEVICE_SIZE // 512)
+    disk = _ped.disk_new_fresh(device, _ped.disk_type_get("msdos"))
+    geom = _ped.Geometry(device, 2048, 8192)
+    part = _ped.Partition(disk, _ped.PARTITION_NORMAL, geom.start, geom.end)
+    disk.add_partition(part, device.get_constraint())
+    return (device, disk, part)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="_ped method call overhead")
+    parser.add_argument("-n", "--number", type=int, default=200000,
+                        help="calls per measurement (default: %(default)s)")
+    parser.add_argument("-r", "--repeat", type=int, default=5,
+                        help="measurements per method, the best is reported "
+                             "(default: %(default)s)")
+    args = parser.parse_args()
+
+    (device, disk, part) = setup_disk()
+
+    try:
+        geom = _ped.Geometry(device, 0, 4096)
+        other = _ped.Geometry(device, 2048, 8192)
+        align = _ped.Alignment(0, 2048)
+        constraint = device.get_constraint()
+        layout = ["512KiB", "1MiB", "20%", "rest"]
+
+        calls = [
+            ("Geometry.test_sector_inside(int)", lambda: geom.test_sector_inside(100)),
+            ("Geometry.test_overlap(Geometry)", lambda: geom.test_overlap(other)),
+            ("Geometry.map(Geometry, int)", lambda: geom.map(other, 3000)),
+            ("Geometry.set_end(int)", lambda: geom.set_end(4096)),
+            ("Geometry.sync()", lambda: geom.sync()),
+            ("Alignment.align_up(Geometry, int)", lambda: align.align_up(other, 3000)),
+            ("Alignment.is_aligned(Geometry, int)", lambda: align.is_aligned(other, 4096)),
+            ("Constraint.is_solution(Geometry)", lambda: constraint.is_solution(other)),
+            ("Disk.get_flag(int)", lambda: disk.get_flag(_ped.DISK_CYLINDER_ALIGNMENT)),
+            ("Disk.get_partition(int)", lambda: disk.get_partition(part.num)),
+            ("Disk.next_partition()", lambda: disk.next_partition()),
+            ("Disk.get_last_partition_num()", lambda: disk.get_last_partition_num()),
+            ("Partition.get_flag(int)", lambda: part.get_flag(_ped.PARTITION_BOOT)),
+            ("Partition.is_active()", lambda: part.is_active()),
+            ("plan_layout(Disk, 4 entries)", lambda: _ped.plan_layout(disk, layout, align)),
+        ]
+
+        width = max(len(name) for (name, _) in calls)
+        print("%-*s  %10s" % (width, "method", "ns/call"))
+
+        for (name, call) in calls:
+            best = min(timeit.repeat(call, number=args.number, repeat=args.repeat))
+            print("%-*s  %10.1f" % (width, name, best * 1e9 / args.number))
+    finally:
+        device.destroy()
+
+
+if __name__ == "__main__":
+    main()
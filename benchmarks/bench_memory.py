@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+#
+# Copyright The pyparted Project Authors
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+# Measure the memory cost and the garbage collector cost of keeping large
+# inventories of the small _ped leaf objects (Alignment, CHSGeometry,
+# DiskType, FileSystemType) alive.  For each type this reports the size of
+# one instance, the bytes allocated per instance and how long a full
+# gc.collect() takes while the inventory is alive.
+#
+# The parted.Geometry, parted.Partition and parted.Device wrappers are
+# measured next to the _ped objects they wrap, so the difference between
+# the two rows is what the Python layer costs per object.
+#
+
+import argparse
+import gc
+import os
+import sys
+import tempfile
+import time
+import tracemalloc
+
+import _ped
+import parted
+
+
+def make_alignment(ctx):
+    return _ped.Alignment(0, 2048)
+
+
+def make_chs_geometry(ctx):
+    return _ped.device_get(ctx["path"]).hw_geom
+
+
+def make_disk_type(ctx):
+    return _ped.disk_type_get("msdos")
+
+
+def make_file_system_type(ctx):
+    return _ped.file_system_type_get("ext2")
+
+
+def make_ped_geometry(ctx):
+    return _ped.Geometry(ctx["ped_device"], 0, 1)
+
+
+def make_geometry(ctx):
+    return parted.Geometry(ctx["device"], start=0, length=1)
+
+
+def make_ped_partition(ctx):
+    return _ped.Partition(ctx["ped_disk"], _ped.PARTITION_NORMAL, 64, 127)
+
+
+def make_partition(ctx):
+    return parted.Partition(
+        disk=ctx["disk"], type=parted.PARTITION_NORMAL, geometry=ctx["geometry"]
+    )
+
+
+def make_device(ctx):
+    return parted.Device(PedDevice=ctx["ped_device"])
+
+
+def measure(name, factory, ctx, count, repeat):
+    gc.collect()
+    tracemalloc.start()
+    before = tracemalloc.get_traced_memory()[0]
+    inventory = [factory(ctx) for _ in range(count)]
+    after = tracemalloc.get_traced_memory()[0]
+    tracemalloc.stop()
+
+    tracked = sum(1 for obj in inventory if gc.is_tracked(obj))
+
+    best = None
+    for _ in range(repeat):
+        start = time.perf_counter()
+        gc.collect()
+        elapsed = time.perf_counter() - start
+        best = elapsed if best is None else min(best, elapsed)
+
+    print("%-16s %8d %10.1f %10d %10.2f" % (
+        name,
+        sys.getsizeof(inventory[0]),
+        (after - before) / count,
+        tracked,
+        best * 1000,
+    ))
+
+    del inventory
+    gc.collect()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="_ped leaf object memory use")
+    parser.add_argument("-n", "--number", type=int, default=50000,
+                        help="objects kept alive per type (default: %(default)s)")
+    parser.add_argument("-r", "--repeat", type=int, default=5,
+                        help="gc.collect() runs, the best is reported "
+                             "(default: %(default)s)")
+    args = parser.parse_args()
+
+    (fd, path) = tempfile.mkstemp(prefix="bench-device-")
+    os.ftruncate(fd, 8 * 1024 * 1024)
+    os.close(fd)
+
+    try:
+        ctx = {"path": path}
+        ctx["ped_device"] = _ped.device_get(path)
+        ctx["device"] = parted.Device(PedDevice=ctx["ped_device"])
+        ctx["disk"] = parted.freshDisk(ctx["device"], "msdos")
+        ctx["ped_disk"] = ctx["disk"].getPedDisk()
+        ctx["geometry"] = parted.Geometry(ctx["device"], start=64, length=64)
+        print("%-16s %8s %10s %10s %10s" % (
+            "type", "sizeof", "bytes/obj", "gc-tracked", "collect ms"))
+
+        measure("Alignment", make_alignment, ctx, args.number, args.repeat)
+        measure("CHSGeometry", make_chs_geometry, ctx, args.number, args.repeat)
+        measure("DiskType", make_disk_type, ctx, args.number, args.repeat)
+        measure("FileSystemType", make_file_system_type, ctx, args.number,
+                args.repeat)
+
+        # each wrapper row includes the _ped object above it
+        measure("_ped.Geometry", make_ped_geometry, ctx, args.number, args.repeat)
+        measure("Geometry", make_geometry, ctx, args.number, args.repeat)
+        measure("_ped.Partition", make_ped_partition, ctx, args.number,
+                args.repeat)
+        measure("Partition", make_partition, ctx, args.number, args.repeat)
+        measure("Device", make_device, ctx, args.number, args.repeat)
+    finally:
+        os.unlink(path)
+
+
+if __name__ == "__main__":
+    main()
@@ -125,17 +125,36 @@ if (original_sectors - new_sectors) != 33:
 pad_block(sdcard)
 partition_insertion_point = os.path.getsize(sdcard)
 partition_insertion_point_sector = int(partition_insertion_point / 512)
-subprocess.run(
-    f"cat {new_partition_file} >> {sdcard}", shell=True, capture_output=True, check=True
+
+# Grow the image to make room for the new partition, then copy the filesystem
+# dump into place.  Between two image files copyTo() only copies the blocks
+# that hold data, so the image stays as sparse as the dump.
+with open(sdcard, "rb+") as file:
+    file.truncate(partition_insertion_point + new_partition_size)
+
+source = parted.getDevice(new_partition_file)
+target = parted.getDevice(sdcard)
+source.open()
+target.open()
+dump = parted.Geometry(source, start=0, length=new_partition_size_sectors)
+slot = parted.Geometry(
+    target, start=partition_insertion_point_sector, length=new_partition_size_sectors
 )
+copied = dump.copyTo(slot)
+target.close()
+source.close()
+print(f"Copied {copied} sectors into {sdcard}")
+
+# The image is about to change size again, don't let the stale length linger
+source.removeFromCache()
+target.removeFromCache()
 
 # pad out the block after writing our new partition
 pad_block(sdcard)
 
 # Restore the backup GPT
-subprocess.run(
-    f"cat {gpt_backup} >> {sdcard}", shell=True, capture_output=True, check=True
-)
+with open(sdcard, "ab") as file:
+    file.write(gpt_data)
 
 # Fix the backup GPT by "moving" it to end of disk (its already there but
 # contains checksums that needs recomputing as well as pointers to its position
@@ -21,6 +21,9 @@
 
 #define TP_FLAGS (Py_TPFLAGS_HAVE_GC | Py_TPFLAGS_BASETYPE)
 
+/* for types that never hold references to other Python objects */
+#define TP_FLAGS_NOGC (Py_TPFLAGS_BASETYPE)
+
 PedAlignment *_ped_Alignment2PedAlignment(PyObject *);
 _ped_Alignment *PedAlignment2_ped_Alignment(PedAlignment *);
 
@@ -28,7 +28,9 @@ PyDoc_STRVAR(device_open_doc,
 "flushing caches.\n\n"
 "This method may allocate internal resources depending on the architecture\n"
 "All allocated resources are freed when you call the close() method.\n\n"
-"Return True if the Device could be opened, False otherwise.");
+"Raises _ped.IOException while a read-only Disk holds this Device, as it\n"
+"could not be written.  Return True if the Device could be opened, False\n"
+"otherwise.");
 
 PyDoc_STRVAR(device_close_doc,
 "close(self) -> bool\n\n"
@@ -92,6 +94,47 @@ PyDoc_STRVAR(device_check_doc,
 "Architecture-dependent function that returns the number of sectors on\n"
 "this Device that are ok.");
 
+PyDoc_STRVAR(device_trace_start_doc,
+"trace_start(self) -> None\n\n"
+"Start recording every sector read, write and sync libparted does on this\n"
+"Device, from any Disk, Geometry or FileSystem using it.  Starting again\n"
+"discards what was recorded so far.  Tracing costs nothing until it is\n"
+"first started, and little for devices that are not being traced.");
+
+PyDoc_STRVAR(device_trace_stop_doc,
+"trace_stop(self) -> dict\n\n"
+"Stop tracing this Device and return what was recorded since\n"
+"trace_start().  'events' is a list of (operation, start sector, sector\n"
+"count, seconds since trace_start()) tuples, where operation is 'read',\n"
+"'write' or 'sync'.  The rest sums them up: the number of reads, writes\n"
+"and syncs and the sectors read and written in total, dropped events\n"
+"included, then how many distinct sectors the kept events touched and the\n"
+"read and write amplification over those.  'dropped' counts events that\n"
+"did not fit in the trace.");
+
+PyDoc_STRVAR(device_sector_cache_enable_doc,
+"sector_cache_enable(self, size=8MiB, block_size=64KiB) -> None\n\n"
+"Keep the sectors libparted reads from this Device in memory, so probing\n"
+"labels and file systems over and over reads each region from the\n"
+"device only once.  Reads are done in blocks of block_size bytes, which\n"
+"must be a multiple of the sector size, and at most size bytes are kept,\n"
+"dropping the least recently used blocks first.  Writes go through to\n"
+"the device and drop the blocks they touch; sync() and\n"
+"end_external_access() drop all of them.  Changes made to the device\n"
+"behind libparted's back are not noticed.  Enabling the cache again\n"
+"empties it and applies the new limits.");
+
+PyDoc_STRVAR(device_sector_cache_disable_doc,
+"sector_cache_disable(self) -> boolean\n\n"
+"Stop caching sectors of this Device and free the cache.  Returns False\n"
+"if there was no cache.");
+
+PyDoc_STRVAR(device_sector_cache_info_doc,
+"sector_cache_info(self) -> dict\n\n"
+"Return the size and block_size of the sector cache of this Device, the\n"
+"number of blocks it holds, and how many block hits, misses, device\n"
+"reads and evictions there were.  Returns None if there is no cache.");
+
 PyDoc_STRVAR(disk_clobber_doc,
 "clobber(self) -> boolean\n\n"
 "Remove all identifying information from a partition table.  If the partition\n"
@@ -109,6 +109,34 @@ PyDoc_STRVAR(disk_duplicate_doc,
 "Return a new Disk that is a copy of self.  This method raises\n"
 "_ped.DiskException if there is an error making the copy.");
 
+PyDoc_STRVAR(disk_snapshot_doc,
+"snapshot(self) -> snapshot\n\n"
+"Record the partition table of self: every partition's number, type,\n"
+"geometry, file system type, flags, name and type ID or UUID, plus the\n"
+"disk flags.  Unlike duplicate(), the PedDisk itself is not copied.  The\n"
+"returned object can only be passed to restore() on the same Disk.");
+
+PyDoc_STRVAR(disk_restore_doc,
+"restore(self, snapshot) -> None\n\n"
+"Bring the partition table of self back to the state recorded by\n"
+"snapshot().  Partitions that still match the snapshot are left alone,\n"
+"the rest are taken off the disk and the missing ones are added again, so\n"
+"the cost depends on how much changed since the snapshot.  Partitions\n"
+"that are added again get new unique IDs on labels that have them.\n"
+"Partition objects for partitions that were taken off stay valid but no\n"
+"longer belong to the disk.  Raises _ped.PartitionException if libparted\n"
+"refuses a change, in which case self may be partially restored.");
+
+PyDoc_STRVAR(disk_diff_doc,
+"diff(self, base) -> dict\n\n"
+"Compare the partition table of self against base, which is either\n"
+"another Disk, such as a duplicate() taken when the disk was opened, or a\n"
+"snapshot().  Partitions are matched up by number.  Returns a dict with\n"
+"lists of partition numbers under 'added', 'removed', 'resized' (moved or\n"
+"grown or shrunk), 'renamed' and 'modified' (type, file system type,\n"
+"flags or type ID/UUID), and 'disk', which is True if the label type or\n"
+"disk flags differ.");
+
 PyDoc_STRVAR(disk_destroy_doc,
 "destroy(self) -> None\n\n"
 "Destroy the Disk object.");
@@ -132,12 +160,45 @@ PyDoc_STRVAR(disk_commit_to_os_doc,
 "What exactly this means depends on the operating system.  On error, a\n"
 "_ped.DiskException is raised.");
 
+PyDoc_STRVAR(disk_export_layout_doc,
+"export_layout(self) -> bytes\n\n"
+"Return the partition table of self as a compact, versioned binary layout\n"
+"record: the label type, sector size, device length, partition alignment\n"
+"and disk flags, then every partition with its type, geometry, file system\n"
+"type, flags, name and type identifiers.  Records can be concatenated and\n"
+"loaded with _ped.disk_new_from_layout() or compared with\n"
+"_ped.layout_diff().");
+
+PyDoc_STRVAR(disk_label_template_doc,
+"label_template(self) -> template\n\n"
+"Render the partition table of self once, by committing a copy of it to a\n"
+"memory device of the same size, and return the sectors written as an\n"
+"opaque template for _ped.label_stamp().  self itself is not written.");
+
+PyDoc_STRVAR(disk_commit_changes_doc,
+"commit_changes(self, base) -> boolean\n\n"
+"Like commit(), but only if self differs from base, a Disk or snapshot()\n"
+"as taken by diff().  Returns False without writing anything when nothing\n"
+"changed.  Otherwise the label is written and the operating system is only\n"
+"told about the partitions that were added, removed or resized, falling\n"
+"back to a full commit_to_os() if that fails.  Returns True on success.");
+
 PyDoc_STRVAR(disk_check_doc,
 "check(self) -> boolean\n\n"
 "Perform a basic sanity check on the partition table.  This check does not\n"
 "depend on the type of disk.  If there is an error performing the check,\n"
 "_ped.DiskException is raised.");
 
+PyDoc_STRVAR(disk_probe_file_systems_doc,
+"probe_file_systems(self, workers=1) -> dict\n\n"
+"Probe every partition of self that can hold a file system, with the GIL\n"
+"released, and return a dict mapping partition numbers to the detected\n"
+"FileSystemType, None if no file system was found, or the IOException\n"
+"instance describing why probing failed.  Nothing is raised for a\n"
+"single partition.  Probes of the same device run one at a time, so\n"
+"workers only matters once other devices are involved; see\n"
+"_ped.file_system_probe_many().");
+
 PyDoc_STRVAR(disk_print_doc,
 "print(self) -> None\n\n"
 "Print a summary of the partitions on self.");
@@ -202,6 +263,17 @@ PyDoc_STRVAR(disk_add_partition_doc,
 "will likely cause this operation to fail, raising a _ped.PartitionException\n"
 "in the process.");
 
+PyDoc_STRVAR(disk_add_partitions_doc,
+"add_partitions(self, entries, Constraint=None) -> list\n\n"
+"Create and add one partition per entry in entries, a sequence of\n"
+"(type, fs_type, start, end, flags, name) tuples.  fs_type is a\n"
+"_ped.FileSystemType, a file system type name or None, flags is a sequence\n"
+"of _ped.PARTITION_* flags to set and name is a string or None.  flags and\n"
+"name may be left off.  Every partition is added subject to Constraint.\n\n"
+"Returns a list with one item per entry: the new _ped.Partition, or the\n"
+"exception that kept the entry from being added.  A failed entry leaves\n"
+"the disk unchanged and does not stop the entries after it.");
+
 PyDoc_STRVAR(disk_remove_partition_doc,
 "remove_partition(self, Partition) -> boolean\n\n"
 "Remove Partition from self.  If Partition is an extended partition, it must\n"
@@ -302,7 +374,8 @@ PyDoc_STRVAR(_ped_Disk_doc,
 "partitions in various ways.  Creating filesystems within these partitions is\n"
 "left up to the FileSystem objects.\n\n"
 "For most errors involving a Disk object, _ped.PartitionException will be\n"
-"raised.  Some operations can also raise _ped.IOException or IndexError.");
+"raised.  Some operations can also raise _ped.IOException or IndexError.\n\n"
+"_ped.Disk(Device, True) reads the label as disk_new(Device, True) does.");
 
 PyDoc_STRVAR(_ped_DiskType_doc,
 "A _ped.DiskType object is a simple object that gives a partition table a\n"
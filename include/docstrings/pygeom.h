@@ -89,6 +89,19 @@ PyDoc_STRVAR(geometry_check_doc,
 "be grouped together.\n\n"
 "This method returns the first bad sector, or 0 if there are no errors.");
 
+PyDoc_STRVAR(geometry_copy_to_doc,
+"copy_to(self, Geometry, timer=None) -> Sector\n\n"
+"Copy the contents of the region described by self to the start of the\n"
+"region described by Geometry, which must be at least as long, and return\n"
+"the number of Sectors copied.  Both devices must be open.  Data moves in\n"
+"large chunks, with the next ones read while the previous ones are\n"
+"written and the GIL released throughout.  The regions may overlap on the\n"
+"same device, as when moving a partition.  Between image files only the\n"
+"data is copied, sharing extents where the file system allows, and holes\n"
+"stay holes in the destination.  If a Timer is given, it is\n"
+"updated as the copy progresses.  Nothing is synced, call sync() on the\n"
+"destination once done.");
+
 PyDoc_STRVAR(geometry_map_doc,
 "map(self, Geometry, Sector) -> integer\n\n"
 "Given a Geometry that overlaps with self and a Sector inside Geometry,\n"
@@ -27,7 +27,8 @@ extern PyObject *TimerException;
 extern PyObject *UnknownDeviceException;
 extern PyObject *UnknownTypeException;
 
-extern unsigned int partedExnRaised;
-extern char *partedExnMessage;
+/* per-thread, libparted calls may run concurrently with the GIL released */
+extern _Thread_local unsigned int partedExnRaised;
+extern _Thread_local char *partedExnMessage;
 
 #endif /* _EXCEPTIONS_H_INCLUDED */
@@ -0,0 +1,28 @@
+/*
+ * pyargs.h
+ * Argument parsing helpers for METH_FASTCALL methods
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PYARGS_H_INCLUDED
+#define PYARGS_H_INCLUDED
+
+#include <Python.h>
+
+#include <parted/parted.h>
+
+/*
+ * The most frequently called methods take their arguments as a C array
+ * (METH_FASTCALL) instead of a tuple, which saves building the tuple and
+ * running the PyArg_ParseTuple() format parser on every call.  These
+ * helpers raise the same exceptions PyArg_ParseTuple() would and return
+ * -1 on failure, 0 on success.
+ */
+int _ped_args_count(const char *, Py_ssize_t, Py_ssize_t, Py_ssize_t);
+int _ped_args_object(const char *, Py_ssize_t, PyObject *, PyTypeObject *);
+int _ped_args_int(PyObject *, int *);
+int _ped_args_sector(PyObject *, PedSector *);
+
+#endif /* PYARGS_H_INCLUDED */
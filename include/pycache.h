@@ -0,0 +1,41 @@
+/*
+ * pycache.h
+ * Optional read-through sector cache for devices
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PYCACHE_H_INCLUDED
+#define PYCACHE_H_INCLUDED
+
+#include <Python.h>
+
+#include <parted/parted.h>
+
+/* Defaults for _ped.Device.sector_cache_enable(). */
+#define SECTOR_CACHE_SIZE (8 * 1024 * 1024)
+#define SECTOR_CACHE_BLOCK_SIZE (64 * 1024)
+
+/*
+ * Probing a device for labels and file systems reads the same handful of
+ * metadata sectors many times over, each time from the device.  With the
+ * cache enabled on a device, reads are served in fixed size blocks kept
+ * in memory, and runs of missing blocks are fetched with a single read.
+ * Writes go straight through and drop the blocks they touch; a sync or
+ * the end of external access drops everything.  Least recently used
+ * blocks are evicted to stay within the size limit.
+ *
+ * These are called from the device op wrappers in pydevops.c, with the
+ * GIL released.
+ */
+int _ped_SectorCache_read(const PedDevice *, void *, PedSector, PedSector);
+int _ped_SectorCache_write(PedDevice *, const void *, PedSector, PedSector);
+void _ped_SectorCache_invalidate(const PedDevice *);
+void _ped_SectorCache_forget(const PedDevice *);
+
+PyObject *py_ped_device_sector_cache_enable(PyObject *, PyObject *);
+PyObject *py_ped_device_sector_cache_disable(PyObject *, PyObject *);
+PyObject *py_ped_device_sector_cache_info(PyObject *, PyObject *);
+
+#endif /* PYCACHE_H_INCLUDED */
@@ -20,11 +20,23 @@ PyObject *py_ped_constraint_new_from_max(PyObject *, PyObject *);
 PyObject *py_ped_constraint_duplicate(PyObject *, PyObject *);
 PyObject *py_ped_constraint_intersect(PyObject *, PyObject *);
 PyObject *py_ped_constraint_solve_max(PyObject *, PyObject *);
-PyObject *py_ped_constraint_solve_nearest(PyObject *, PyObject *);
-PyObject *py_ped_constraint_is_solution(PyObject *, PyObject *);
+PyObject *py_ped_constraint_solve_nearest(PyObject *, PyObject *const *, Py_ssize_t);
+PyObject *py_ped_constraint_is_solution(PyObject *, PyObject *const *, Py_ssize_t);
 PyObject *py_ped_constraint_any(PyObject *, PyObject *);
 PyObject *py_ped_constraint_exact(PyObject *, PyObject *);
 
+/* the member values a compiled PedConstraint was built from */
+typedef struct {
+    long long start_align[2];           /* offset, grain_size */
+    long long end_align[2];             /* offset, grain_size */
+    PedDevice *start_dev;
+    PedDevice *end_dev;
+    PedSector start_range[2];           /* start, length */
+    PedSector end_range[2];             /* start, length */
+    long long min_size;
+    long long max_size;
+} _ped_ConstraintKey;
+
 /* _ped.Constraint type is the Python equiv of PedConstraint in libparted */
 typedef struct {
     PyObject_HEAD
@@ -36,6 +48,11 @@ typedef struct {
     PyObject *end_range;                /* _ped.Geometry  */
     long long min_size;                 /* PedSector      */
     long long max_size;                 /* PedSector      */
+
+    /* compiled PedConstraint, see _ped_Constraint_acquire() */
+    PedConstraint *ped_constraint;
+    _ped_ConstraintKey key;
+    int users;
 } _ped_Constraint;
 
 void _ped_Constraint_dealloc(_ped_Constraint *);
@@ -48,6 +65,15 @@ int _ped_Constraint_init(_ped_Constraint *, PyObject *, PyObject *);
 PyObject *_ped_Constraint_get(_ped_Constraint *, void *);
 int _ped_Constraint_set(_ped_Constraint *, PyObject *, void *);
 
+/*
+ * Return the PedConstraint for a _ped.Constraint, compiling it only when
+ * the constraint or any of its alignments and ranges changed since the
+ * last call.  The result is owned by the _ped.Constraint and must be
+ * handed back with _ped_Constraint_release() rather than destroyed.
+ */
+PedConstraint *_ped_Constraint_acquire(PyObject *);
+void _ped_Constraint_release(PyObject *, PedConstraint *);
+
 extern PyTypeObject _ped_Constraint_Type_obj;
 
 #endif /* PYCONSTRAINT_H_INCLUDED */
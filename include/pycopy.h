@@ -0,0 +1,22 @@
+/*
+ * pycopy.h
+ * Copying the contents of one Geometry to another
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PYCOPY_H_INCLUDED
+#define PYCOPY_H_INCLUDED
+
+#include <Python.h>
+
+#include <parted/parted.h>
+
+/* Size of each copy buffer in bytes, and how many of them are in flight. */
+#define COPY_CHUNK_SIZE (4 * 1024 * 1024)
+#define COPY_BUFFERS 4
+
+PyObject *py_ped_geometry_copy_to(PyObject *, PyObject *);
+
+#endif /* PYCOPY_H_INCLUDED */
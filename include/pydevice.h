@@ -23,12 +23,11 @@ typedef struct {
     int sectors;
 } _ped_CHSGeometry;
 
+PyObject *_ped_CHSGeometry_alloc(PyTypeObject *, Py_ssize_t);
 void _ped_CHSGeometry_dealloc(_ped_CHSGeometry *);
 int _ped_CHSGeometry_compare(_ped_CHSGeometry *, PyObject *);
 PyObject *_ped_CHSGeometry_richcompare(_ped_CHSGeometry *, PyObject *, int);
 PyObject *_ped_CHSGeometry_str(_ped_CHSGeometry *);
-int _ped_CHSGeometry_traverse(_ped_CHSGeometry *, visitproc, void *);
-int _ped_CHSGeometry_clear(_ped_CHSGeometry *);
 PyObject *_ped_CHSGeometry_get(_ped_CHSGeometry *, void *);
 
 extern PyTypeObject _ped_CHSGeometry_Type_obj;
@@ -54,6 +53,7 @@ typedef struct {
     PyObject *bios_geom;          /* a _ped.CHSGeometry */
     short host;
     short did;
+    unsigned long memory;         /* memory device serial, 0 if not one */
 } _ped_Device;
 
 void _ped_Device_dealloc(_ped_Device *);
@@ -63,6 +63,7 @@ PyObject *_ped_Device_str(_ped_Device *);
 int _ped_Device_traverse(_ped_Device *, visitproc, void *);
 int _ped_Device_clear(_ped_Device *);
 PyObject *_ped_Device_get(_ped_Device *, void *);
+int _ped_Device_check_writable(const PedDevice *);
 
 extern PyTypeObject _ped_Device_Type_obj;
 
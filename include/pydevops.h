@@ -0,0 +1,50 @@
+/*
+ * pydevops.h
+ * Interposition on libparted's device I/O operations
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PYDEVOPS_H_INCLUDED
+#define PYDEVOPS_H_INCLUDED
+
+#include <Python.h>
+
+#include <parted/parted.h>
+
+/*
+ * libparted sends all device I/O through the dev_ops table of its one
+ * architecture, which lives in writable data.  _ped_DevOps_install()
+ * points the I/O entries of that table at wrappers that feed pytrace.c
+ * and pycache.c before handing the call on to the real implementation,
+ * which stays reachable through _ped_DevOps_orig.  Opening a device that
+ * is already open lets pypool.c flush it if only the pool had it open.
+ * Destroying a device also drops whatever pytrace.c, pycache.c and
+ * pypool.c keep for it.
+ * Nothing is patched until a feature that needs it is first used.  The
+ * wrappers run with the GIL released and must not touch Python objects.
+ */
+extern PedDeviceArchOps _ped_DevOps_orig;
+
+void _ped_DevOps_install(void);
+int _ped_DevOps_read_raw(const PedDevice *, void *, PedSector, PedSector);
+
+/*
+ * Opening a device through libparted asks for write access and flushes the
+ * buffer cache of the device and of every one of its partitions, on open
+ * and again on close if anything was written.  While a device is held, a
+ * first open of it instead gets a read-only descriptor of our own and none
+ * of the flushing; writes to it fail and syncs do nothing until the last
+ * close, which puts dev->read_only back.  A device that is already open
+ * keeps the descriptor it has.  A read-only Disk holds its device, and
+ * keeps it open, for as long as it lives.  The descriptor is the device's,
+ * not the Disk's, so _ped_Device_check_writable() refuses new writable
+ * Disks and opens of a held device up front rather than letting their
+ * writes fail later.
+ */
+int _ped_DevOps_read_only_hold(const PedDevice *);
+void _ped_DevOps_read_only_release(const PedDevice *);
+int _ped_DevOps_is_read_only(const PedDevice *);
+
+#endif /* PYDEVOPS_H_INCLUDED */
@@ -13,6 +13,8 @@
 
 #include <parted/parted.h>
 
+#include "pylock.h"
+
 /* _ped.Partition type is the Python equivalent of PedPartition
  * in libparted */
 typedef struct {
@@ -28,8 +30,12 @@ typedef struct {
     PedPartition *ped_partition;
 
     int _owned;                    /* Belongs to a Disk or not */
+
+    /* 1 + index in the disk's live array, 0 if not tracked */
+    Py_ssize_t live;
 } _ped_Partition;
 
+PyObject *_ped_Partition_alloc(PyTypeObject *, Py_ssize_t);
 void _ped_Partition_dealloc(_ped_Partition *);
 int _ped_Partition_compare(_ped_Partition *, PyObject *);
 PyObject *_ped_Partition_richcompare(_ped_Partition *, PyObject *, int);
@@ -52,6 +58,29 @@ typedef struct {
 
     /* store the PedDisk from libparted */
     PedDisk *ped_disk;
+
+    /* serializes libparted calls on ped_disk */
+    _ped_Lock lock;
+
+    /*
+     * Partitions taken off ped_disk by restore().  _ped.Partition objects
+     * may still point at them, so each restore() only destroys the ones
+     * no object in live points at, and the rest go with the disk.
+     */
+    PedPartition **detached;
+    Py_ssize_t n_detached;
+    Py_ssize_t detached_size;
+
+    /* the _ped.Partition objects made for this disk and not yet freed */
+    _ped_Partition **live;
+    Py_ssize_t n_live;
+    Py_ssize_t live_size;
+
+    /* read through a read-only descriptor, refuses to change */
+    int read_only;
+
+    /* unique for the life of the process, snapshots record it */
+    unsigned long long serial;
 } _ped_Disk;
 
 void _ped_Disk_dealloc(_ped_Disk *);
@@ -61,6 +90,12 @@ PyObject *_ped_Disk_str(_ped_Disk *);
 int _ped_Disk_traverse(_ped_Disk *, visitproc, void *);
 int _ped_Disk_clear(_ped_Disk *);
 int _ped_Disk_init(_ped_Disk *, PyObject *, PyObject *);
+PyObject *_ped_Disk_new(PyTypeObject *, PyObject *, PyObject *);
+int _ped_Disk_detach(_ped_Disk *, PedPartition *);
+void _ped_Disk_free_detached(_ped_Disk *);
+int _ped_Disk_track_partition(_ped_Partition *);
+void _ped_Disk_untrack_partition(_ped_Partition *);
+int _ped_Disk_check_writable(PyObject *);
 
 extern PyTypeObject _ped_Disk_Type_obj;
 
@@ -77,8 +112,6 @@ void _ped_DiskType_dealloc(_ped_DiskType *);
 int _ped_DiskType_compare(_ped_DiskType *, PyObject *);
 PyObject *_ped_DiskType_richcompare(_ped_DiskType *, PyObject *, int);
 PyObject *_ped_DiskType_str(_ped_DiskType *);
-int _ped_DiskType_traverse(_ped_DiskType *, visitproc, void *);
-int _ped_DiskType_clear(_ped_DiskType *);
 PyObject *_ped_DiskType_get(_ped_DiskType *, void *);
 
 extern PyTypeObject _ped_DiskType_Type_obj;
@@ -102,17 +135,17 @@ PyObject *py_ped_disk_get_max_supported_partition_count(PyObject *, PyObject *);
 PyObject *py_ped_disk_get_partition_alignment(PyObject *, PyObject *);
 PyObject *py_ped_disk_max_partition_length(PyObject *, PyObject *);
 PyObject *py_ped_disk_max_partition_start_sector(PyObject *, PyObject *);
-PyObject *py_ped_disk_set_flag(PyObject *, PyObject *);
-PyObject *py_ped_disk_get_flag(PyObject *, PyObject *);
-PyObject *py_ped_disk_is_flag_available(PyObject *, PyObject *);
+PyObject *py_ped_disk_set_flag(PyObject *, PyObject *const *, Py_ssize_t);
+PyObject *py_ped_disk_get_flag(PyObject *, PyObject *const *, Py_ssize_t);
+PyObject *py_ped_disk_is_flag_available(PyObject *, PyObject *const *, Py_ssize_t);
 PyObject *py_ped_disk_flag_get_name(PyObject *, PyObject *);
 PyObject *py_ped_disk_flag_get_by_name(PyObject *, PyObject *);
 PyObject *py_ped_disk_flag_next(PyObject *, PyObject *);
 PyObject *py_ped_partition_destroy(_ped_Partition *, PyObject *);
 PyObject *py_ped_partition_is_active(_ped_Partition *, PyObject *);
-PyObject *py_ped_partition_set_flag(_ped_Partition *, PyObject *);
-PyObject *py_ped_partition_get_flag(_ped_Partition *, PyObject *);
-PyObject *py_ped_partition_is_flag_available(_ped_Partition *, PyObject *);
+PyObject *py_ped_partition_set_flag(_ped_Partition *, PyObject *const *, Py_ssize_t);
+PyObject *py_ped_partition_get_flag(_ped_Partition *, PyObject *const *, Py_ssize_t);
+PyObject *py_ped_partition_is_flag_available(_ped_Partition *, PyObject *const *, Py_ssize_t);
 PyObject *py_ped_partition_set_system(_ped_Partition *, PyObject *);
 PyObject *py_ped_partition_set_name(_ped_Partition *, PyObject *);
 PyObject *py_ped_partition_get_name(_ped_Partition *, PyObject *);
@@ -132,6 +165,7 @@ PyObject *py_ped_partition_flag_get_name(PyObject *, PyObject *);
 PyObject *py_ped_partition_flag_get_by_name(PyObject *, PyObject *);
 PyObject *py_ped_partition_flag_next(PyObject *, PyObject *);
 PyObject *py_ped_disk_add_partition(PyObject *, PyObject *);
+PyObject *py_ped_disk_add_partitions(PyObject *, PyObject *);
 PyObject *py_ped_disk_remove_partition(PyObject *, PyObject *);
 PyObject *py_ped_disk_delete_partition(PyObject *, PyObject *);
 PyObject *py_ped_disk_delete_all(PyObject *, PyObject *);
@@ -139,9 +173,9 @@ PyObject *py_ped_disk_set_partition_geom(PyObject *, PyObject *);
 PyObject *py_ped_disk_maximize_partition(PyObject *, PyObject *);
 PyObject *py_ped_disk_get_max_partition_geometry(PyObject *, PyObject *);
 PyObject *py_ped_disk_minimize_extended_partition(PyObject *, PyObject *);
-PyObject *py_ped_disk_next_partition(PyObject *, PyObject *);
-PyObject *py_ped_disk_get_partition(PyObject *, PyObject *);
-PyObject *py_ped_disk_get_partition_by_sector(PyObject *, PyObject *);
+PyObject *py_ped_disk_next_partition(PyObject *, PyObject *const *, Py_ssize_t);
+PyObject *py_ped_disk_get_partition(PyObject *, PyObject *const *, Py_ssize_t);
+PyObject *py_ped_disk_get_partition_by_sector(PyObject *, PyObject *const *, Py_ssize_t);
 PyObject *py_ped_disk_extended_partition(PyObject *, PyObject *);
 PyObject *py_ped_disk_new_fresh(PyObject *, PyObject *);
 PyObject *py_ped_disk_new(PyObject *, PyObject *);
@@ -21,6 +21,8 @@ PyObject *py_ped_file_system_type_get(PyObject *, PyObject *);
 PyObject *py_ped_file_system_type_get_next(PyObject *, PyObject *);
 PyObject *py_ped_file_system_probe_specific(PyObject *, PyObject *);
 PyObject *py_ped_file_system_probe(PyObject *, PyObject *);
+PyObject *py_ped_file_system_probe_many(PyObject *, PyObject *);
+PyObject *py_ped_disk_probe_file_systems(PyObject *, PyObject *);
 
 /* _ped.FileSystemType type is the Python equivalent of PedFileSystemType
  * in libparted */
@@ -36,8 +38,6 @@ int _ped_FileSystemType_compare(_ped_FileSystemType *, PyObject *);
 PyObject *_ped_FileSystemType_richcompare(_ped_FileSystemType *, PyObject *,
                                           int);
 PyObject *_ped_FileSystemType_str(_ped_FileSystemType *);
-int _ped_FileSystemType_traverse(_ped_FileSystemType *, visitproc, void *);
-int _ped_FileSystemType_clear(_ped_FileSystemType *);
 PyObject *_ped_FileSystemType_get(_ped_FileSystemType *, void *);
 
 extern PyTypeObject _ped_FileSystemType_Type_obj;
@@ -0,0 +1,36 @@
+/*
+ * pyfreelist.h
+ * Per-type free lists for small, frequently allocated _ped objects
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PYFREELIST_H_INCLUDED
+#define PYFREELIST_H_INCLUDED
+
+#include <Python.h>
+
+/* Maximum number of released objects kept around per type. */
+#define FREELIST_SIZE 128
+
+/*
+ * Walking a partition table or solving constraints creates and drops
+ * thousands of _ped.Geometry, _ped.Partition and friends.  Rather than
+ * handing each one back to the allocator, the type's dealloc parks it
+ * here and the type's tp_alloc picks it up again.  Only instances of
+ * the exact type are recycled; subclasses always use the regular
+ * allocator since their size may differ.
+ */
+typedef struct {
+    PyTypeObject *type;
+    int count;
+    PyObject *items[FREELIST_SIZE];
+} _ped_FreeList;
+
+#define FREELIST_INIT(t) { (t), 0, { NULL } }
+
+PyObject *_ped_FreeList_alloc(_ped_FreeList *, PyTypeObject *, Py_ssize_t);
+void _ped_FreeList_free(_ped_FreeList *, PyObject *);
+
+#endif /* PYFREELIST_H_INCLUDED */
@@ -16,19 +16,19 @@
 /* 1:1 function mappings for geom.h in libparted */
 PyObject *py_ped_geometry_duplicate(PyObject *, PyObject *);
 PyObject *py_ped_geometry_intersect(PyObject *, PyObject *);
-PyObject *py_ped_geometry_set(PyObject *, PyObject *);
-PyObject *py_ped_geometry_set_start(PyObject *, PyObject *);
-PyObject *py_ped_geometry_set_end(PyObject *, PyObject *);
-PyObject *py_ped_geometry_test_overlap(PyObject *, PyObject *);
-PyObject *py_ped_geometry_test_inside(PyObject *, PyObject *);
-PyObject *py_ped_geometry_test_equal(PyObject *, PyObject *);
-PyObject *py_ped_geometry_test_sector_inside(PyObject *, PyObject *);
+PyObject *py_ped_geometry_set(PyObject *, PyObject *const *, Py_ssize_t);
+PyObject *py_ped_geometry_set_start(PyObject *, PyObject *const *, Py_ssize_t);
+PyObject *py_ped_geometry_set_end(PyObject *, PyObject *const *, Py_ssize_t);
+PyObject *py_ped_geometry_test_overlap(PyObject *, PyObject *const *, Py_ssize_t);
+PyObject *py_ped_geometry_test_inside(PyObject *, PyObject *const *, Py_ssize_t);
+PyObject *py_ped_geometry_test_equal(PyObject *, PyObject *const *, Py_ssize_t);
+PyObject *py_ped_geometry_test_sector_inside(PyObject *, PyObject *const *, Py_ssize_t);
 PyObject *py_ped_geometry_read(PyObject *, PyObject *);
 PyObject *py_ped_geometry_sync(PyObject *, PyObject *);
 PyObject *py_ped_geometry_sync_fast(PyObject *, PyObject *);
 PyObject *py_ped_geometry_write(PyObject *, PyObject *);
 PyObject *py_ped_geometry_check(PyObject *, PyObject *);
-PyObject *py_ped_geometry_map(PyObject *, PyObject *);
+PyObject *py_ped_geometry_map(PyObject *, PyObject *const *, Py_ssize_t);
 
 /* _ped.Geometry type is the Python equivalent of PedGeometry in libparted */
 typedef struct {
@@ -41,6 +41,7 @@ typedef struct {
     PedGeometry *ped_geometry;
 } _ped_Geometry;
 
+PyObject *_ped_Geometry_alloc(PyTypeObject *, Py_ssize_t);
 void _ped_Geometry_dealloc(_ped_Geometry *);
 int _ped_Geometry_compare(_ped_Geometry *, PyObject *);
 PyObject *_ped_Geometry_richcompare(_ped_Geometry *, PyObject *, int);
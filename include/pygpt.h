@@ -0,0 +1,46 @@
+/*
+ * pygpt.h
+ * On-disk layout of GPT and MBR labels, for code that reads or writes
+ * them without going through libparted
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PYGPT_H_INCLUDED
+#define PYGPT_H_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* GPT header fields, all little endian */
+#define GPT_SIGNATURE "EFI PART"
+#define GPT_HEADER_SIZE 12
+#define GPT_HEADER_CRC 16
+#define GPT_MY_LBA 24
+#define GPT_ALTERNATE_LBA 32
+#define GPT_FIRST_USABLE_LBA 40
+#define GPT_LAST_USABLE_LBA 48
+#define GPT_DISK_GUID 56
+#define GPT_ENTRIES_LBA 72
+#define GPT_ENTRIES_COUNT 80
+#define GPT_ENTRY_SIZE 84
+#define GPT_ENTRIES_CRC 88
+#define GPT_HEADER_MIN_SIZE 92
+#define GPT_ENTRY_UNIQUE_GUID 16
+#define GPT_ENTRY_MIN_SIZE 128
+
+/* MBR fields */
+#define MSDOS_DISK_ID 440
+#define MSDOS_ENTRIES 446
+#define MSDOS_ENTRY_SIZE 16
+#define MSDOS_ENTRY_TYPE 4
+#define MSDOS_ENTRY_START 8
+#define MSDOS_ENTRY_LENGTH 12
+#define MSDOS_MAGIC 510
+#define MSDOS_TYPE_GPT 0xee
+
+/* The CRC32 GPT uses, the same as zlib's. */
+uint32_t _ped_crc32(const unsigned char *, size_t);
+
+#endif /* PYGPT_H_INCLUDED */
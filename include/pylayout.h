@@ -0,0 +1,39 @@
+/*
+ * pylayout.h
+ * Binary serialization of partition layouts
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PYLAYOUT_H_INCLUDED
+#define PYLAYOUT_H_INCLUDED
+
+#include <Python.h>
+
+#include <parted/parted.h>
+
+/*
+ * A layout record holds what a snapshot holds, in a fixed little endian
+ * format so it can be stored and moved between hosts:
+ *
+ *   header   "PPLY", version, header size, record size, label type name,
+ *            sector size, device length, partition alignment, disk flags
+ *            and the number of entries
+ *   entries  one per partition, each starting with its own size
+ *
+ * Records are self-delimiting, so any number of them can be concatenated
+ * into one inventory and read back one at a time.  Readers skip header
+ * and entry bytes they do not know about, so later versions may append
+ * fields without breaking older readers.
+ */
+#define LAYOUT_MAGIC "PPLY"
+#define LAYOUT_VERSION 1
+#define LAYOUT_HEADER_SIZE 72
+
+PyObject *py_ped_disk_export_layout(PyObject *, PyObject *);
+PyObject *py_ped_disk_new_from_layout(PyObject *, PyObject *);
+PyObject *py_ped_layout_header(PyObject *, PyObject *);
+PyObject *py_ped_layout_diff(PyObject *, PyObject *);
+
+#endif /* PYLAYOUT_H_INCLUDED */
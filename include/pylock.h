@@ -0,0 +1,57 @@
+/*
+ * pylock.h
+ * Reader/writer locks serializing libparted calls on Disk and Device objects
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PYLOCK_H_INCLUDED
+#define PYLOCK_H_INCLUDED
+
+#include <Python.h>
+#include <pthread.h>
+
+#include <parted/parted.h>
+
+/*
+ * libparted is not thread safe on a single PedDisk or PedDevice, but
+ * distinct objects share no state.  Every _ped.Disk carries one of these
+ * locks and every PedDevice maps to one, so calls on different disks can
+ * run in parallel with the GIL released while calls on the same disk are
+ * serialized.  Accessors take the lock shared, mutators take it exclusive.
+ */
+typedef struct {
+    pthread_rwlock_t rwlock;
+    int initialized;
+} _ped_Lock;
+
+int _ped_Lock_init(_ped_Lock *);
+void _ped_Lock_destroy(_ped_Lock *);
+void _ped_Lock_read(_ped_Lock *);
+void _ped_Lock_write(_ped_Lock *);
+void _ped_Lock_write_nogil(_ped_Lock *);
+void _ped_Lock_release(_ped_Lock *);
+
+/*
+ * The libparted exception handler calls back into Python in the middle of
+ * a libparted call, with every lock that call took still held.  Locks are
+ * not recursive, so a registered handler must not use the Disk or Device
+ * that raised, nor any other sharing its device lock stripe; it would
+ * deadlock.
+ */
+
+/*
+ * libparted caches one PedDevice per path and any number of _ped.Device
+ * objects may refer to it, and a PedDevice has no room for a lock of ours,
+ * so device locks are looked up by the PedDevice address in a fixed table
+ * of DEVICE_LOCK_COUNT stripes.  Two devices may share a stripe, in which
+ * case calls on them are serialized against each other too; that costs
+ * parallelism but never correctness.
+ */
+#define DEVICE_LOCK_COUNT 64
+
+int _ped_Device_lock_init(void);
+_ped_Lock *_ped_Device_lock(const PedDevice *);
+
+#endif /* PYLOCK_H_INCLUDED */
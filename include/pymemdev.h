@@ -0,0 +1,47 @@
+/*
+ * pymemdev.h
+ * RAM backed devices for planning and testing partition layouts
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PYMEMDEV_H_INCLUDED
+#define PYMEMDEV_H_INCLUDED
+
+#include <Python.h>
+
+#include <parted/parted.h>
+
+/*
+ * libparted only knows how to talk to devices through its architecture
+ * code, which opens a path.  A memory device is an anonymous memfd that
+ * libparted sees as an image file under /proc/self/fd, with the sector
+ * sizes and alignment it was created with laid over what the probe found.
+ * All functions here must be called with the GIL held.
+ */
+PyObject *py_ped_device_new_memory(PyObject *, PyObject *);
+
+/*
+ * Return a new PedAlignment or PedConstraint built from the alignment
+ * given to device_new_memory(), or NULL if dev is not a memory device or
+ * was created without one.  No exception is set in that case and the
+ * caller should ask libparted as usual.
+ */
+PedAlignment *_ped_MemoryDevice_alignment(const PedDevice *, int);
+PedConstraint *_ped_MemoryDevice_constraint(const PedDevice *, int);
+
+/*
+ * Every _ped.Device made for a memory device holds it.  hold() returns
+ * the serial to hand back to release(), or 0 if path is not a memory
+ * device.  When the last holder is released without destroy() having
+ * been called, the PedDevice is destroyed and the memfd closed.
+ */
+unsigned long _ped_MemoryDevice_hold(const char *);
+void _ped_MemoryDevice_release(unsigned long);
+
+/* Close the memfd behind a destroyed device, or behind all of them. */
+void _ped_MemoryDevice_forget(const char *);
+void _ped_MemoryDevice_forget_all(void);
+
+#endif /* PYMEMDEV_H_INCLUDED */
@@ -0,0 +1,24 @@
+/*
+ * pyplan.h
+ * pyparted function prototypes for pyplan.c
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PYPLAN_H_INCLUDED
+#define PYPLAN_H_INCLUDED
+
+#include <Python.h>
+
+#include <parted/parted.h>
+
+/*
+ * Layout planning works out where a list of partitions would go without
+ * touching the disk.  Nothing here maps to a libparted call, the sizes and
+ * alignment rules are applied directly so thousands of candidate layouts
+ * can be tried cheaply.
+ */
+PyObject *py_ped_plan_layout(PyObject *, PyObject *);
+
+#endif /* PYPLAN_H_INCLUDED */
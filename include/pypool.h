@@ -0,0 +1,53 @@
+/*
+ * pypool.h
+ * Keeping idle devices open for reuse
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PYPOOL_H_INCLUDED
+#define PYPOOL_H_INCLUDED
+
+#include <Python.h>
+
+#include <parted/parted.h>
+
+/* Default for _ped.device_pool_enable(), if RLIMIT_NOFILE allows it. */
+#define DEVICE_POOL_SIZE 64
+
+/*
+ * Scripts open and close a Device around every operation, and every first
+ * open and last close costs libparted a system call or two plus a flush of
+ * the buffer caches of the device and each of its partitions.  With the
+ * pool enabled, the last Device.close() on a device with nothing left to
+ * flush keeps it open and idle instead.  The next Device.open() takes it
+ * back without going to libparted at all, and libparted's own opens, such
+ * as in disk_new(), find it already open.  Either way the device's own
+ * buffer cache is flushed then, as a real open would have.  Idle devices
+ * beyond the limit are closed, least recently used first.
+ *
+ * A device idle in the pool is still open as far as the kernel and other
+ * processes can tell, however closed it looks from Python: it shows up in
+ * lsof and fuser, tools that look for openers take it as in use, and an
+ * image file unlinked meanwhile keeps its space until the pool lets go.
+ * Disable the pool around anything that needs the device really closed.
+ *
+ * The pool holds one of the device's libparted opens, which the open
+ * count seen from Python leaves out.  Everything here is called with the
+ * GIL held, except _ped_DevicePool_refresh(), _ped_DevicePool_evict()
+ * and _ped_DevicePool_forget().
+ */
+int _ped_DevicePool_take(const PedDevice *);
+int _ped_DevicePool_put(PedDevice *);
+void _ped_DevicePool_trim(void);
+int _ped_DevicePool_open_count(const PedDevice *);
+void _ped_DevicePool_forget(const PedDevice *);
+void _ped_DevicePool_refresh(const PedDevice *);
+void _ped_DevicePool_evict(PedDevice *);
+
+PyObject *py_ped_device_pool_enable(PyObject *, PyObject *);
+PyObject *py_ped_device_pool_disable(PyObject *, PyObject *);
+PyObject *py_ped_device_pool_info(PyObject *, PyObject *);
+
+#endif /* PYPOOL_H_INCLUDED */
@@ -0,0 +1,33 @@
+/*
+ * pyscan.h
+ * Checking GPT and MBR labels without building a Disk
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PYSCAN_H_INCLUDED
+#define PYSCAN_H_INCLUDED
+
+#include <Python.h>
+
+/* Problems label_scan() can report, or'ed together in each record. */
+enum {
+    SCAN_READ_ERROR = 1 << 0,
+    SCAN_PMBR_INVALID = 1 << 1,
+    SCAN_PRIMARY_HEADER_INVALID = 1 << 2,
+    SCAN_PRIMARY_ENTRIES_INVALID = 1 << 3,
+    SCAN_BACKUP_HEADER_INVALID = 1 << 4,
+    SCAN_BACKUP_ENTRIES_INVALID = 1 << 5,
+    SCAN_BACKUP_MISPLACED = 1 << 6,
+    SCAN_HEADER_MISMATCH = 1 << 7,
+    SCAN_PARTITION_OUT_OF_RANGE = 1 << 8,
+    SCAN_PARTITION_OVERLAP = 1 << 9
+};
+
+/* Entry arrays larger than this are reported invalid rather than read. */
+#define SCAN_MAX_ENTRIES_SIZE (1024 * 1024)
+
+PyObject *py_ped_label_scan(PyObject *, PyObject *);
+
+#endif /* PYSCAN_H_INCLUDED */
@@ -0,0 +1,63 @@
+/*
+ * pysnapshot.h
+ * Lightweight checkpoints of a Disk's partition table
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PYSNAPSHOT_H_INCLUDED
+#define PYSNAPSHOT_H_INCLUDED
+
+#include <Python.h>
+#include <stdint.h>
+
+#include <parted/parted.h>
+
+#include "pydisk.h"
+
+/* what is recorded for each active partition */
+typedef struct {
+    int num;
+    PedPartitionType type;
+    PedSector start;
+    PedSector end;
+    const PedFileSystemType *fs_type;
+
+    /* 1 or 0 for each flag the partition supports, -1 otherwise */
+    signed char flags[PED_PARTITION_LAST_FLAG + 1];
+
+    /* only set when the disk type supports them */
+    char *name;
+    int has_type_id;
+    uint8_t type_id;
+    int has_type_uuid;
+    uint8_t type_uuid[16];
+} _ped_SnapshotEntry;
+
+/*
+ * A snapshot is a flat copy of the values that make up a partition table,
+ * rather than a copy of the PedDisk.  Taking one costs a walk over the
+ * partition list; restoring one only touches the partitions that differ.
+ */
+typedef struct {
+    /* the serial of the _ped.Disk it was taken from, 0 if none */
+    unsigned long long disk_serial;
+    const PedDiskType *type;
+    signed char disk_flags[PED_DISK_LAST_FLAG + 1];
+    int count;
+    _ped_SnapshotEntry *entries;
+} _ped_DiskSnapshot;
+
+_ped_DiskSnapshot *_ped_DiskSnapshot_take(const PedDisk *);
+void _ped_DiskSnapshot_free(_ped_DiskSnapshot *);
+_ped_DiskSnapshot *_ped_DiskSnapshot_get(PyObject *);
+int _ped_DiskSnapshot_restore(_ped_Disk *, PedDisk *, const _ped_DiskSnapshot *);
+PyObject *_ped_DiskSnapshot_diff(const _ped_DiskSnapshot *, const _ped_DiskSnapshot *);
+
+PyObject *py_ped_disk_snapshot(PyObject *, PyObject *);
+PyObject *py_ped_disk_restore(PyObject *, PyObject *);
+PyObject *py_ped_disk_diff(PyObject *, PyObject *);
+PyObject *py_ped_disk_commit_changes(PyObject *, PyObject *);
+
+#endif /* PYSNAPSHOT_H_INCLUDED */
@@ -0,0 +1,32 @@
+/*
+ * pysniff.h
+ * File system probing narrowed down by on-disk signatures
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PYSNIFF_H_INCLUDED
+#define PYSNIFF_H_INCLUDED
+
+#include <Python.h>
+
+#include <parted/parted.h>
+
+/*
+ * ped_file_system_probe() runs the probe of every file system type it
+ * knows, and each probe does its own reads.  The same answer can be had
+ * by reading the start of the region once, checking it against the
+ * magic numbers of the well known file systems, and only running the
+ * probes of the types that match, plus those of any type we have no
+ * magic number for.  The probes still confirm the match, so nothing is
+ * detected that ped_file_system_probe() would not detect.
+ *
+ * _ped_FileSystem_probe() is a drop in replacement for
+ * ped_file_system_probe() and may be called without the GIL.
+ */
+const PedFileSystemType *_ped_FileSystem_probe(PedGeometry *);
+
+PyObject *py_ped_file_system_sniff(PyObject *, PyObject *);
+
+#endif /* PYSNIFF_H_INCLUDED */
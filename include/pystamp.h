@@ -0,0 +1,49 @@
+/*
+ * pystamp.h
+ * Writing one pre-rendered partition table to many identical devices
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PYSTAMP_H_INCLUDED
+#define PYSTAMP_H_INCLUDED
+
+#include <Python.h>
+
+#include <parted/parted.h>
+
+#include "pysnapshot.h"
+
+/*
+ * A label template holds the sectors libparted writes when it commits a
+ * Disk, recorded by committing a copy of the Disk to a memory device of
+ * the same size.  Stamping writes those sectors to another device of the
+ * same size, with the identifiers that have to be unique per disk
+ * replaced, instead of going through libparted again.
+ */
+typedef struct {
+    const PedDiskType *type;
+    long long sector_size;
+    long long phys_sector_size;
+    PedSector length;
+    PedCHSGeometry bios_geom;
+
+    /* minimum and optimum alignment of the device, a grain of 0 for none */
+    PedSector align_offset[2];
+    PedSector align_grain[2];
+
+    /* to commit through libparted when the device does not match */
+    _ped_DiskSnapshot *snap;
+
+    /* first and last sector of each written extent, and their contents */
+    size_t count;
+    PedSector *extents;
+    unsigned char *data;
+    size_t size;
+} _ped_LabelTemplate;
+
+PyObject *py_ped_disk_label_template(PyObject *, PyObject *);
+PyObject *py_ped_label_stamp(PyObject *, PyObject *);
+
+#endif /* PYSTAMP_H_INCLUDED */
@@ -0,0 +1,47 @@
+/*
+ * pystats.h
+ * Opt-in call and I/O statistics for _ped entry points
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PYSTATS_H_INCLUDED
+#define PYSTATS_H_INCLUDED
+
+#include <Python.h>
+
+#include <parted/parted.h>
+
+/*
+ * Statistics are gathered by pointing the method tables at counting
+ * trampolines while they are enabled and back at the real functions
+ * while they are not, so a disabled build pays nothing on the call path.
+ * Byte counts are bumped by the I/O entry points themselves behind a
+ * single flag test.
+ */
+extern int _ped_stats_enabled;
+extern unsigned long long _ped_stats_bytes_read;
+extern unsigned long long _ped_stats_bytes_written;
+
+/* Called with the GIL held, once the I/O has completed. */
+#define STATS_READ(dev, sectors) \
+    do { \
+        if (_ped_stats_enabled) { \
+            _ped_stats_bytes_read += (unsigned long long) (sectors) * (dev)->sector_size; \
+        } \
+    } while (0)
+
+#define STATS_WRITE(dev, sectors) \
+    do { \
+        if (_ped_stats_enabled) { \
+            _ped_stats_bytes_written += (unsigned long long) (sectors) * (dev)->sector_size; \
+        } \
+    } while (0)
+
+int _ped_Stats_register(const char *, PyMethodDef *);
+
+PyObject *py_ped_stats(PyObject *, PyObject *);
+PyObject *py_ped_stats_enable(PyObject *, PyObject *);
+
+#endif /* PYSTATS_H_INCLUDED */
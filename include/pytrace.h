@@ -0,0 +1,40 @@
+/*
+ * pytrace.h
+ * Sector level tracing of the I/O libparted does on a device
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PYTRACE_H_INCLUDED
+#define PYTRACE_H_INCLUDED
+
+#include <Python.h>
+
+#include <parted/parted.h>
+
+/* Events kept per traced device; anything past this is only counted. */
+#define TRACE_MAX_EVENTS (1 << 20)
+
+enum {
+    TRACE_READ,
+    TRACE_WRITE,
+    TRACE_SYNC,
+    TRACE_OPS
+};
+
+void _ped_Trace_record(const PedDevice *, int, PedSector, PedSector);
+
+/*
+ * For tracing from C.  _ped_Trace_stop() ends the trace and returns a
+ * malloc()ed array of count pairs of first and last sector, sorted and
+ * merged, touched by the given op.  Both set an exception on failure.
+ */
+int _ped_Trace_start(const PedDevice *);
+PedSector *_ped_Trace_stop(const PedDevice *, int, size_t *);
+void _ped_Trace_forget(const PedDevice *);
+
+PyObject *py_ped_device_trace_start(PyObject *, PyObject *);
+PyObject *py_ped_device_trace_stop(PyObject *, PyObject *);
+
+#endif /* PYTRACE_H_INCLUDED */
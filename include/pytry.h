@@ -0,0 +1,31 @@
+/*
+ * pytry.h
+ * Probing variants that report the common "nothing there" outcome as a
+ * status code instead of raising
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PYTRY_H_INCLUDED
+#define PYTRY_H_INCLUDED
+
+#include <Python.h>
+
+/*
+ * The try_ functions return a (result, status) tuple.  result is None
+ * unless status is TRY_FOUND.  TRY_FAILED covers every libparted error;
+ * the message is dropped, call the raising variant to get it.  Parted
+ * bugs and unsupported features are still raised.
+ */
+enum {
+    TRY_FOUND = 0,
+    TRY_UNRECOGNIZED = 1,
+    TRY_FAILED = 2
+};
+
+PyObject *py_ped_try_disk_probe(PyObject *, PyObject *);
+PyObject *py_ped_try_disk_new(PyObject *, PyObject *);
+PyObject *py_ped_try_file_system_probe(PyObject *, PyObject *);
+
+#endif /* PYTRY_H_INCLUDED */
@@ -0,0 +1,29 @@
+/*
+ * pywipe.h
+ * Clearing file system and RAID signatures and discarding partitions
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef PYWIPE_H_INCLUDED
+#define PYWIPE_H_INCLUDED
+
+#include <Python.h>
+
+/*
+ * How much is zeroed at each end of a region.  Every file system libparted
+ * knows keeps its superblock in the first 68KiB, md and LVM labels sit in
+ * the first few KiB or the last 128KiB, and ZFS keeps two 256KiB labels at
+ * the start, which 512KiB at both ends covers.  The two ZFS labels at the
+ * end are placed from the size rounded down to WIPE_ZFS_LABEL_SIZE, so
+ * they can start up to 768KiB from the end; the tail is widened to reach
+ * them, see wipe_add_geometry().
+ */
+#define WIPE_HEAD_SIZE (512 * 1024)
+#define WIPE_TAIL_SIZE (512 * 1024)
+#define WIPE_ZFS_LABEL_SIZE (256 * 1024)
+
+PyObject *py_ped_wipe_signatures(PyObject *, PyObject *);
+
+#endif /* PYWIPE_H_INCLUDED */
@@ -27,15 +27,15 @@ static PyMemberDef _ped_Constraint_members[] = {
 
 static PyMethodDef _ped_Constraint_methods[] = {
     {"duplicate", (PyCFunction) py_ped_constraint_duplicate,
-                  METH_VARARGS, constraint_duplicate_doc},
+                  METH_NOARGS, constraint_duplicate_doc},
     {"intersect", (PyCFunction) py_ped_constraint_intersect,
                   METH_VARARGS, constraint_intersect_doc},
     {"solve_max", (PyCFunction) py_ped_constraint_solve_max,
-                  METH_VARARGS, constraint_solve_max_doc},
+                  METH_NOARGS, constraint_solve_max_doc},
     {"solve_nearest", (PyCFunction) py_ped_constraint_solve_nearest,
-                      METH_VARARGS, constraint_solve_nearest_doc},
+                      METH_FASTCALL, constraint_solve_nearest_doc},
     {"is_solution", (PyCFunction) py_ped_constraint_is_solution,
-                    METH_VARARGS, constraint_is_solution_doc},
+                    METH_FASTCALL, constraint_is_solution_doc},
     {NULL}
 };
 
@@ -52,10 +52,10 @@ PyTypeObject _ped_CHSGeometry_Type_obj = {
     .tp_getattro = PyObject_GenericGetAttr,
     .tp_setattro = PyObject_GenericSetAttr,
  /* .tp_as_buffer = XXX */
-    .tp_flags = TP_FLAGS,
+    .tp_flags = TP_FLAGS_NOGC,
     .tp_doc = _ped_CHSGeometry_doc,
-    .tp_traverse = (traverseproc) _ped_CHSGeometry_traverse,
-    .tp_clear = (inquiry) _ped_CHSGeometry_clear,
+ /* .tp_traverse = XXX */
+ /* .tp_clear = XXX */
     .tp_richcompare = (richcmpfunc) _ped_CHSGeometry_richcompare,
  /* .tp_weaklistoffset = XXX */
  /* .tp_iter = XXX */
@@ -69,7 +69,7 @@ PyTypeObject _ped_CHSGeometry_Type_obj = {
  /* .tp_descr_set = XXX */
  /* .tp_dictoffset = XXX */
     .tp_init = NULL,
-    .tp_alloc = PyType_GenericAlloc,
+    .tp_alloc = _ped_CHSGeometry_alloc,
     .tp_new = NULL,
  /* .tp_free = XXX */
  /* .tp_is_gc = XXX */
@@ -91,36 +91,36 @@ static PyMethodDef _ped_Device_methods[] = {
      * This is a unique function as it's in pydisk.c, but is really
      * a method on _ped.Device, so it's part of this PyMethod Def
      */
-    {"disk_probe", (PyCFunction) py_ped_disk_probe, METH_VARARGS,
+    {"disk_probe", (PyCFunction) py_ped_disk_probe, METH_NOARGS,
                    disk_probe_doc},
 
     /* These functions are all in pydevice.c */
-    {"is_busy", (PyCFunction) py_ped_device_is_busy, METH_VARARGS,
+    {"is_busy", (PyCFunction) py_ped_device_is_busy, METH_NOARGS,
                 device_is_busy_doc},
-    {"open", (PyCFunction) py_ped_device_open, METH_VARARGS,
+    {"open", (PyCFunction) py_ped_device_open, METH_NOARGS,
              device_open_doc},
-    {"close", (PyCFunction) py_ped_device_close, METH_VARARGS,
+    {"close", (PyCFunction) py_ped_device_close, METH_NOARGS,
               device_close_doc},
-    {"destroy", (PyCFunction) py_ped_device_destroy, METH_VARARGS,
+    {"destroy", (PyCFunction) py_ped_device_destroy, METH_NOARGS,
                 device_destroy_doc},
     {"cache_remove", (PyCFunction) py_ped_device_cache_remove,
-                     METH_VARARGS, device_cache_remove_doc},
+                     METH_NOARGS, device_cache_remove_doc},
     {"begin_external_access", (PyCFunction) py_ped_device_begin_external_access,
-                              METH_VARARGS, device_begin_external_access_doc},
+                              METH_NOARGS, device_begin_external_access_doc},
     {"end_external_access", (PyCFunction) py_ped_device_end_external_access,
-                            METH_VARARGS, device_end_external_access_doc},
+                            METH_NOARGS, device_end_external_access_doc},
     {"read", (PyCFunction) py_ped_device_read, METH_VARARGS,
              device_read_doc},
     {"write", (PyCFunction) py_ped_device_write, METH_VARARGS,
               device_write_doc},
-    {"sync", (PyCFunction) py_ped_device_sync, METH_VARARGS,
+    {"sync", (PyCFunction) py_ped_device_sync, METH_NOARGS,
              device_sync_doc},
-    {"sync_fast", (PyCFunction) py_ped_device_sync_fast, METH_VARARGS,
+    {"sync_fast", (PyCFunction) py_ped_device_sync_fast, METH_NOARGS,
                   device_sync_fast_doc},
     {"check", (PyCFunction) py_ped_device_check, METH_VARARGS,
               device_check_doc},
     {"get_constraint", (PyCFunction) py_ped_device_get_constraint,
-                       METH_VARARGS, device_get_constraint_doc},
+                       METH_NOARGS, device_get_constraint_doc},
     {"get_minimal_aligned_constraint",
                   (PyCFunction) py_ped_device_get_minimal_aligned_constraint,
                   METH_NOARGS, device_get_minimal_aligned_constraint_doc},
@@ -134,11 +134,25 @@ static PyMethodDef _ped_Device_methods[] = {
                   (PyCFunction) py_ped_device_get_optimum_alignment,
                   METH_NOARGS, device_get_optimum_alignment_doc},
 
+    /* These functions are in pytrace.c. */
+    {"trace_start", (PyCFunction) py_ped_device_trace_start, METH_NOARGS,
+                    device_trace_start_doc},
+    {"trace_stop", (PyCFunction) py_ped_device_trace_stop, METH_NOARGS,
+                   device_trace_stop_doc},
+
+    /* These functions are in pycache.c. */
+    {"sector_cache_enable", (PyCFunction) py_ped_device_sector_cache_enable,
+                            METH_VARARGS, device_sector_cache_enable_doc},
+    {"sector_cache_disable", (PyCFunction) py_ped_device_sector_cache_disable,
+                             METH_NOARGS, device_sector_cache_disable_doc},
+    {"sector_cache_info", (PyCFunction) py_ped_device_sector_cache_info,
+                          METH_NOARGS, device_sector_cache_info_doc},
+
     /*
      * These functions are in pydisk.c, but they work best as
      * methods on a _ped.Device.
      */
-    {"clobber", (PyCFunction) py_ped_disk_clobber, METH_VARARGS,
+    {"clobber", (PyCFunction) py_ped_disk_clobber, METH_NOARGS,
                 disk_clobber_doc},
 
     /*
@@ -26,39 +26,39 @@ static PyMemberDef _ped_Partition_members[] = {
 };
 
 static PyMethodDef _ped_Partition_methods[] = {
-    {"destroy", (PyCFunction) py_ped_partition_destroy, METH_VARARGS,
+    {"destroy", (PyCFunction) py_ped_partition_destroy, METH_NOARGS,
                 partition_destroy_doc},
-    {"is_active", (PyCFunction) py_ped_partition_is_active, METH_VARARGS,
+    {"is_active", (PyCFunction) py_ped_partition_is_active, METH_NOARGS,
                   partition_is_active_doc},
-    {"set_flag", (PyCFunction) py_ped_partition_set_flag, METH_VARARGS,
+    {"set_flag", (PyCFunction) py_ped_partition_set_flag, METH_FASTCALL,
                  partition_set_flag_doc},
-    {"get_flag", (PyCFunction) py_ped_partition_get_flag, METH_VARARGS,
+    {"get_flag", (PyCFunction) py_ped_partition_get_flag, METH_FASTCALL,
                  partition_get_flag_doc},
     {"is_flag_available", (PyCFunction) py_ped_partition_is_flag_available,
-                          METH_VARARGS, partition_is_flag_available_doc},
+                          METH_FASTCALL, partition_is_flag_available_doc},
     {"set_system", (PyCFunction) py_ped_partition_set_system,
                    METH_VARARGS, partition_set_system_doc},
     {"set_name", (PyCFunction) py_ped_partition_set_name, METH_VARARGS,
                  partition_set_name_doc},
-    {"get_name", (PyCFunction) py_ped_partition_get_name, METH_VARARGS,
+    {"get_name", (PyCFunction) py_ped_partition_get_name, METH_NOARGS,
                  partition_get_name_doc},
 #if PED_DISK_TYPE_LAST_FEATURE > 2
     {"set_type_id", (PyCFunction) py_ped_partition_set_type_id, METH_VARARGS,
                  partition_set_type_id_doc},
-    {"get_type_id", (PyCFunction) py_ped_partition_get_type_id, METH_VARARGS,
+    {"get_type_id", (PyCFunction) py_ped_partition_get_type_id, METH_NOARGS,
                  partition_get_type_id_doc},
 #endif /* PED_DISK_TYPE_LAST_FEATURE > 2 */
 #if PED_DISK_TYPE_LAST_FEATURE > 4
     {"set_type_uuid", (PyCFunction) py_ped_partition_set_type_uuid, METH_VARARGS,
                  partition_set_type_uuid_doc},
-    {"get_type_uuid", (PyCFunction) py_ped_partition_get_type_uuid, METH_VARARGS,
+    {"get_type_uuid", (PyCFunction) py_ped_partition_get_type_uuid, METH_NOARGS,
                  partition_get_type_uuid_doc},
 #endif /* PED_DISK_TYPE_LAST_FEATURE > 4 */
-    {"is_busy", (PyCFunction) py_ped_partition_is_busy, METH_VARARGS,
+    {"is_busy", (PyCFunction) py_ped_partition_is_busy, METH_NOARGS,
                 partition_is_busy_doc},
-    {"get_path", (PyCFunction) py_ped_partition_get_path, METH_VARARGS,
+    {"get_path", (PyCFunction) py_ped_partition_get_path, METH_NOARGS,
                  partition_get_path_doc},
-    {"reset_num", (PyCFunction) py_ped_partition_reset_num, METH_VARARGS,
+    {"reset_num", (PyCFunction) py_ped_partition_reset_num, METH_NOARGS,
                   partition_reset_num_doc},
     {NULL}
 };
@@ -107,7 +107,7 @@ PyTypeObject _ped_Partition_Type_obj = {
  /* .tp_descr_set = XXX */
  /* .tp_dictoffset = XXX */
     .tp_init = (initproc) _ped_Partition_init,
-    .tp_alloc = PyType_GenericAlloc,
+    .tp_alloc = _ped_Partition_alloc,
     .tp_new = PyType_GenericNew,
  /* .tp_free = XXX */
  /* .tp_is_gc = XXX */
@@ -121,39 +121,55 @@ static PyMemberDef _ped_Disk_members[] = {
             "A _ped.Device object holding self's partition table."},
     {"type", T_OBJECT, offsetof(_ped_Disk, type), READONLY,
              "The type of the disk label as a _ped.DiskType."},
+    {"read_only", T_INT, offsetof(_ped_Disk, read_only), READONLY,
+                  "Whether self was opened read-only and refuses changes."},
     {NULL}
 };
 
 static PyMethodDef _ped_Disk_methods[] = {
-    {"duplicate", (PyCFunction) py_ped_disk_duplicate, METH_VARARGS,
+    {"duplicate", (PyCFunction) py_ped_disk_duplicate, METH_NOARGS,
                   disk_duplicate_doc},
-    {"destroy", (PyCFunction) py_ped_disk_destroy, METH_VARARGS,
+    {"snapshot", (PyCFunction) py_ped_disk_snapshot, METH_NOARGS,
+                 disk_snapshot_doc},
+    {"restore", (PyCFunction) py_ped_disk_restore, METH_VARARGS,
+                disk_restore_doc},
+    {"diff", (PyCFunction) py_ped_disk_diff, METH_VARARGS,
+             disk_diff_doc},
+    {"export_layout", (PyCFunction) py_ped_disk_export_layout,
+                      METH_NOARGS, disk_export_layout_doc},
+    {"label_template", (PyCFunction) py_ped_disk_label_template,
+                       METH_NOARGS, disk_label_template_doc},
+    {"destroy", (PyCFunction) py_ped_disk_destroy, METH_NOARGS,
                 disk_destroy_doc},
-    {"commit", (PyCFunction) py_ped_disk_commit, METH_VARARGS,
+    {"commit", (PyCFunction) py_ped_disk_commit, METH_NOARGS,
                disk_commit_doc},
     {"commit_to_dev", (PyCFunction) py_ped_disk_commit_to_dev,
-                      METH_VARARGS, disk_commit_to_dev_doc},
+                      METH_NOARGS, disk_commit_to_dev_doc},
     {"commit_to_os", (PyCFunction) py_ped_disk_commit_to_os,
-                     METH_VARARGS, disk_commit_to_os_doc},
-    {"check", (PyCFunction) py_ped_disk_check, METH_VARARGS,
+                     METH_NOARGS, disk_commit_to_os_doc},
+    {"commit_changes", (PyCFunction) py_ped_disk_commit_changes,
+                       METH_VARARGS, disk_commit_changes_doc},
+    {"check", (PyCFunction) py_ped_disk_check, METH_NOARGS,
               disk_check_doc},
-    {"print", (PyCFunction) py_ped_disk_print, METH_VARARGS,
+    {"probe_file_systems", (PyCFunction) py_ped_disk_probe_file_systems,
+                           METH_VARARGS, disk_probe_file_systems_doc},
+    {"print", (PyCFunction) py_ped_disk_print, METH_NOARGS,
               disk_print_doc},
     {"get_primary_partition_count", (PyCFunction)
                                     py_ped_disk_get_primary_partition_count,
-                                    METH_VARARGS,
+                                    METH_NOARGS,
                                     disk_get_primary_partition_count_doc},
     {"get_last_partition_num", (PyCFunction)
                                py_ped_disk_get_last_partition_num,
-                               METH_VARARGS,
+                               METH_NOARGS,
                                disk_get_last_partition_num_doc},
     {"get_max_primary_partition_count", (PyCFunction)
                                    py_ped_disk_get_max_primary_partition_count,
-                                   METH_VARARGS,
+                                   METH_NOARGS,
                                    disk_get_max_primary_partition_count_doc},
     {"get_max_supported_partition_count", (PyCFunction)
                                  py_ped_disk_get_max_supported_partition_count,
-                                 METH_VARARGS,
+                                 METH_NOARGS,
                                  disk_get_max_supported_partition_count_doc},
     {"get_partition_alignment", (PyCFunction)
                                  py_ped_disk_get_partition_alignment,
@@ -167,19 +183,21 @@ static PyMethodDef _ped_Disk_methods[] = {
                              py_ped_disk_max_partition_start_sector,
                              METH_NOARGS,
                              disk_max_partition_start_sector_doc},
-    {"set_flag", (PyCFunction) py_ped_disk_set_flag, METH_VARARGS,
+    {"set_flag", (PyCFunction) py_ped_disk_set_flag, METH_FASTCALL,
                  disk_set_flag_doc},
-    {"get_flag", (PyCFunction) py_ped_disk_get_flag, METH_VARARGS,
+    {"get_flag", (PyCFunction) py_ped_disk_get_flag, METH_FASTCALL,
                  disk_get_flag_doc},
     {"is_flag_available", (PyCFunction) py_ped_disk_is_flag_available,
-                          METH_VARARGS, disk_is_flag_available_doc},
+                          METH_FASTCALL, disk_is_flag_available_doc},
     {"add_partition", (PyCFunction) py_ped_disk_add_partition,
                       METH_VARARGS, disk_add_partition_doc},
+    {"add_partitions", (PyCFunction) py_ped_disk_add_partitions,
+                       METH_VARARGS, disk_add_partitions_doc},
     {"remove_partition", (PyCFunction) py_ped_disk_remove_partition,
                          METH_VARARGS, disk_remove_partition_doc},
     {"delete_partition", (PyCFunction) py_ped_disk_delete_partition,
                          METH_VARARGS, disk_delete_partition_doc},
-    {"delete_all", (PyCFunction) py_ped_disk_delete_all, METH_VARARGS,
+    {"delete_all", (PyCFunction) py_ped_disk_delete_all, METH_NOARGS,
                    disk_delete_all_doc},
     {"set_partition_geom", (PyCFunction) py_ped_disk_set_partition_geom,
                            METH_VARARGS, disk_set_partition_geom_doc},
@@ -191,17 +209,17 @@ static PyMethodDef _ped_Disk_methods[] = {
                                    disk_get_max_partition_geometry_doc},
     {"minimize_extended_partition", (PyCFunction)
                                     py_ped_disk_minimize_extended_partition,
-                                    METH_VARARGS,
+                                    METH_NOARGS,
                                     disk_minimize_extended_partition_doc},
     {"next_partition", (PyCFunction) py_ped_disk_next_partition,
-                       METH_VARARGS, disk_next_partition_doc},
+                       METH_FASTCALL, disk_next_partition_doc},
     {"get_partition", (PyCFunction) py_ped_disk_get_partition,
-                      METH_VARARGS, disk_get_partition_doc},
+                      METH_FASTCALL, disk_get_partition_doc},
     {"get_partition_by_sector", (PyCFunction)
                                 py_ped_disk_get_partition_by_sector,
-                                METH_VARARGS, disk_get_partition_by_sector_doc},
+                                METH_FASTCALL, disk_get_partition_by_sector_doc},
     {"extended_partition", (PyCFunction) py_ped_disk_extended_partition,
-                           METH_VARARGS, disk_extended_partition_doc},
+                           METH_NOARGS, disk_extended_partition_doc},
     {NULL}
 };
 
@@ -246,7 +264,7 @@ PyTypeObject _ped_Disk_Type_obj = {
  /* .tp_dictoffset = XXX */
     .tp_init = (initproc) _ped_Disk_init,
     .tp_alloc = PyType_GenericAlloc,
-    .tp_new = PyType_GenericNew,
+    .tp_new = _ped_Disk_new,
  /* .tp_free = XXX */
  /* .tp_is_gc = XXX */
     .tp_bases = NULL,
@@ -292,10 +310,10 @@ PyTypeObject _ped_DiskType_Type_obj = {
     .tp_getattro = PyObject_GenericGetAttr,
     .tp_setattro = PyObject_GenericSetAttr,
  /* .tp_as_buffer = XXX */
-    .tp_flags = TP_FLAGS,
+    .tp_flags = TP_FLAGS_NOGC,
     .tp_doc = _ped_DiskType_doc,
-    .tp_traverse = (traverseproc) _ped_DiskType_traverse,
-    .tp_clear = (inquiry) _ped_DiskType_clear,
+ /* .tp_traverse = XXX */
+ /* .tp_clear = XXX */
     .tp_richcompare = (richcmpfunc) _ped_DiskType_richcompare,
  /* .tp_weaklistoffset = XXX */
  /* .tp_iter = XXX */
@@ -45,10 +45,10 @@ PyTypeObject _ped_FileSystemType_Type_obj = {
     .tp_getattro = PyObject_GenericGetAttr,
     .tp_setattro = PyObject_GenericSetAttr,
  /* .tp_as_buffer = XXX */
-    .tp_flags = TP_FLAGS,
+    .tp_flags = TP_FLAGS_NOGC,
     .tp_doc = _ped_FileSystemType_doc,
-    .tp_traverse = (traverseproc) _ped_FileSystemType_traverse,
-    .tp_clear = (inquiry) _ped_FileSystemType_clear,
+ /* .tp_traverse = XXX */
+ /* .tp_clear = XXX */
     .tp_richcompare = (richcmpfunc) _ped_FileSystemType_richcompare,
  /* .tp_weaklistoffset = XXX */
  /* .tp_iter = XXX */
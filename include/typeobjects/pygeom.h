@@ -20,36 +20,38 @@ static PyMemberDef _ped_Geometry_members[] = {
 };
 
 static PyMethodDef _ped_Geometry_methods[] = {
-    {"duplicate", (PyCFunction) py_ped_geometry_duplicate, METH_VARARGS,
+    {"duplicate", (PyCFunction) py_ped_geometry_duplicate, METH_NOARGS,
                   geometry_duplicate_doc},
     {"intersect", (PyCFunction) py_ped_geometry_intersect, METH_VARARGS,
                   geometry_intersect_doc},
-    {"set", (PyCFunction) py_ped_geometry_set, METH_VARARGS,
+    {"set", (PyCFunction) py_ped_geometry_set, METH_FASTCALL,
             geometry_set_doc},
-    {"set_start", (PyCFunction) py_ped_geometry_set_start, METH_VARARGS,
+    {"set_start", (PyCFunction) py_ped_geometry_set_start, METH_FASTCALL,
                   geometry_set_start_doc},
-    {"set_end", (PyCFunction) py_ped_geometry_set_end, METH_VARARGS,
+    {"set_end", (PyCFunction) py_ped_geometry_set_end, METH_FASTCALL,
                 geometry_set_end_doc},
     {"test_overlap", (PyCFunction) py_ped_geometry_test_overlap,
-                     METH_VARARGS, geometry_test_overlap_doc},
+                     METH_FASTCALL, geometry_test_overlap_doc},
     {"test_inside", (PyCFunction) py_ped_geometry_test_inside,
-                    METH_VARARGS, geometry_test_inside_doc},
+                    METH_FASTCALL, geometry_test_inside_doc},
     {"test_equal", (PyCFunction) py_ped_geometry_test_equal,
-                   METH_VARARGS, geometry_test_equal_doc},
+                   METH_FASTCALL, geometry_test_equal_doc},
     {"test_sector_inside", (PyCFunction) py_ped_geometry_test_sector_inside,
-                           METH_VARARGS, geometry_test_sector_inside_doc},
+                           METH_FASTCALL, geometry_test_sector_inside_doc},
     {"read", (PyCFunction) py_ped_geometry_read, METH_VARARGS,
              geometry_read_doc},
-    {"sync", (PyCFunction) py_ped_geometry_sync, METH_VARARGS,
+    {"sync", (PyCFunction) py_ped_geometry_sync, METH_NOARGS,
              geometry_sync_doc},
-    {"sync_fast", (PyCFunction) py_ped_geometry_sync_fast, METH_VARARGS,
+    {"sync_fast", (PyCFunction) py_ped_geometry_sync_fast, METH_NOARGS,
                   geometry_sync_fast_doc},
     {"write", (PyCFunction) py_ped_geometry_write, METH_VARARGS,
               geometry_write_doc},
     {"check", (PyCFunction) py_ped_geometry_check, METH_VARARGS,
               geometry_check_doc},
-    {"map", (PyCFunction) py_ped_geometry_map, METH_VARARGS,
+    {"map", (PyCFunction) py_ped_geometry_map, METH_FASTCALL,
             geometry_map_doc},
+    {"copy_to", (PyCFunction) py_ped_geometry_copy_to, METH_VARARGS,
+                geometry_copy_to_doc},
     {NULL}
 };
 
@@ -102,7 +104,7 @@ PyTypeObject _ped_Geometry_Type_obj = {
  /* .tp_descr_set = XXX */
  /* .tp_dictoffset = XXX */
     .tp_init = (initproc) _ped_Geometry_init,
-    .tp_alloc = PyType_GenericAlloc,
+    .tp_alloc = _ped_Geometry_alloc,
     .tp_new = PyType_GenericNew,
  /* .tp_free = XXX */
  /* .tp_is_gc = XXX */
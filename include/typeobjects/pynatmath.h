@@ -18,18 +18,18 @@ static PyMemberDef _ped_Alignment_members[] = {
 };
 
 static PyMethodDef _ped_Alignment_methods[] = {
-    {"duplicate", (PyCFunction) py_ped_alignment_duplicate, METH_VARARGS,
+    {"duplicate", (PyCFunction) py_ped_alignment_duplicate, METH_NOARGS,
                   alignment_duplicate_doc},
     {"intersect", (PyCFunction) py_ped_alignment_intersect, METH_VARARGS,
                   alignment_intersect_doc},
-    {"align_up", (PyCFunction) py_ped_alignment_align_up, METH_VARARGS,
+    {"align_up", (PyCFunction) py_ped_alignment_align_up, METH_FASTCALL,
                  alignment_align_up_doc},
     {"align_down", (PyCFunction) py_ped_alignment_align_down,
-                   METH_VARARGS, alignment_align_down_doc},
+                   METH_FASTCALL, alignment_align_down_doc},
     {"align_nearest", (PyCFunction) py_ped_alignment_align_nearest,
-                      METH_VARARGS, alignment_align_nearest_doc},
+                      METH_FASTCALL, alignment_align_nearest_doc},
     {"is_aligned", (PyCFunction) py_ped_alignment_is_aligned,
-                   METH_VARARGS, alignment_is_aligned_doc},
+                   METH_FASTCALL, alignment_is_aligned_doc},
     {NULL}
 };
 
@@ -61,10 +61,10 @@ PyTypeObject _ped_Alignment_Type_obj = {
     .tp_getattro = PyObject_GenericGetAttr,
     .tp_setattro = PyObject_GenericSetAttr,
  /* .tp_as_buffer = XXX */
-    .tp_flags = TP_FLAGS,
+    .tp_flags = TP_FLAGS_NOGC,
     .tp_doc = _ped_Alignment_doc,
-    .tp_traverse = (traverseproc) _ped_Alignment_traverse,
-    .tp_clear = (inquiry) _ped_Alignment_clear,
+ /* .tp_traverse = XXX */
+ /* .tp_clear = XXX */
     .tp_richcompare = (richcmpfunc) _ped_Alignment_richcompare,
  /* .tp_weaklistoffset = XXX */
  /* .tp_iter = XXX */
@@ -78,7 +78,7 @@ PyTypeObject _ped_Alignment_Type_obj = {
  /* .tp_descr_set = XXX */
  /* .tp_dictoffset = XXX */
     .tp_init = (initproc) _ped_Alignment_init,
-    .tp_alloc = PyType_GenericAlloc,
+    .tp_alloc = _ped_Alignment_alloc,
     .tp_new = PyType_GenericNew,
  /* .tp_free = XXX */
  /* .tp_is_gc = XXX */
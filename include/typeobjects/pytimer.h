@@ -18,12 +18,12 @@ static PyMemberDef _ped_Timer_members[] = {
 };
 
 static PyMethodDef _ped_Timer_methods[] = {
-    {"destroy", (PyCFunction) py_ped_timer_destroy, METH_VARARGS, NULL},
+    {"destroy", (PyCFunction) py_ped_timer_destroy, METH_NOARGS, NULL},
     {"new_nested", (PyCFunction) py_ped_timer_new_nested, METH_VARARGS, NULL},
     {"destroy_nested", (PyCFunction) py_ped_timer_destroy_nested,
-                       METH_VARARGS, NULL},
-    {"touch", (PyCFunction) py_ped_timer_touch, METH_VARARGS, NULL},
-    {"reset", (PyCFunction) py_ped_timer_reset, METH_VARARGS, NULL},
+                       METH_NOARGS, NULL},
+    {"touch", (PyCFunction) py_ped_timer_touch, METH_NOARGS, NULL},
+    {"reset", (PyCFunction) py_ped_timer_reset, METH_NOARGS, NULL},
     {"update", (PyCFunction) py_ped_timer_update, METH_VARARGS, NULL},
     {"set_state_name", (PyCFunction) py_ped_timer_set_state_name,
                        METH_VARARGS, NULL},
@@ -31,7 +31,7 @@ pyparted_version = '3.13.0'
 python_version = sys.version_info
 
 need_libparted_version = '3.4'
-need_python_version = (3, 5)
+need_python_version = (3, 7)
 
 if python_version < need_python_version:
     raise RuntimeError("pyparted requires Python version %d.%d or higher"
@@ -21,12 +21,23 @@
 #include "pydisk.h"
 #include "pyfilesys.h"
 #include "pygeom.h"
+#include "pylayout.h"
+#include "pylock.h"
+#include "pymemdev.h"
 #include "pynatmath.h"
+#include "pyplan.h"
+#include "pypool.h"
+#include "pyscan.h"
+#include "pysniff.h"
+#include "pystamp.h"
+#include "pystats.h"
 #include "pytimer.h"
+#include "pytry.h"
 #include "pyunit.h"
+#include "pywipe.h"
 
-char *partedExnMessage = NULL;
-unsigned int partedExnRaised = 0;
+_Thread_local char *partedExnMessage = NULL;
+_Thread_local unsigned int partedExnRaised = 0;
 
 PyObject *exn_handler = NULL;
 
@@ -98,6 +109,16 @@ PyDoc_STRVAR(device_free_all_doc,
 "device_free_all()\n\n"
 "Close and free all devices.");
 
+PyDoc_STRVAR(device_new_memory_doc,
+"device_new_memory(length, sector_size=512, phys_sector_size=sector_size,\n"
+"                  minimum_alignment=None, optimum_alignment=None) -> Device\n\n"
+"Create a Device of length sectors that lives in memory.  It can be read,\n"
+"written, labeled and committed like any other device, but nothing ever\n"
+"reaches a disk or file system and its contents are gone once it is\n"
+"destroyed.  The Alignment arguments are returned by the device's\n"
+"get_minimum_alignment() and get_optimum_alignment() and used by the\n"
+"aligned constraints, in place of what would be probed from hardware.");
+
 PyDoc_STRVAR(file_system_probe_doc,
 "file_system_probe(Geometry) -> FileSystemType\n\n"
 "Attempt to detect a file system in the region described by Geometry.\n"
@@ -105,6 +126,24 @@ PyDoc_STRVAR(file_system_probe_doc,
 "situations, such as when one file system was not completely erased\n"
 "before a new file system was created on top of it.");
 
+PyDoc_STRVAR(file_system_sniff_doc,
+"file_system_sniff(Geometry) -> list\n\n"
+"Read the start of the region described by Geometry once and return the\n"
+"names of the file system types whose magic numbers are found there, along\n"
+"with those of any type that has no known magic number.  These are the\n"
+"only types file_system_probe() goes on to probe.  Raises IOException if\n"
+"the region could not be read.");
+
+PyDoc_STRVAR(file_system_probe_many_doc,
+"file_system_probe_many(geometries, workers=1) -> list\n\n"
+"Run file_system_probe() on every Geometry in geometries, using up to\n"
+"workers threads with the GIL released.  libparted can only do one thing\n"
+"at a time on a device, so geometries on the same device are probed one\n"
+"after the other while different devices are probed in parallel.\n"
+"Returns a list with, for each Geometry, the FileSystemType found, None\n"
+"if there was none, or the IOException instance describing why probing\n"
+"failed; failures are not raised.");
+
 PyDoc_STRVAR(file_system_probe_specific_doc,
 "file_system_probe_specific(FileSystemType, Geometry) -> Geometry\n\n"
 "Attempt to find a file system and return the region it occupies.");
@@ -157,9 +196,46 @@ PyDoc_STRVAR(disk_new_fresh_doc,
 "the disk.");
 
 PyDoc_STRVAR(disk_new_doc,
-"disk_new(Device) -> Disk\n\n"
+"disk_new(Device[, read_only]) -> Disk\n\n"
 "Given the Device, create a new Disk object. And probe, read the details of\n"
-"the disk.");
+"the disk.  If read_only is True, a Device that is not already open is\n"
+"opened read-only and neither it nor its partitions have their buffer\n"
+"caches flushed, and the Disk and its partitions raise\n"
+"_ped.DiskException on any attempt to change or commit them.  The device\n"
+"stays open read-only until the Disk is freed, so probing or checking\n"
+"through it later reads the same way.  Until then, disk_new() without\n"
+"read_only, disk_new_fresh() and Device.open() on that device raise\n"
+"_ped.IOException, and Disks made on it earlier cannot commit.  Meant\n"
+"for inventory of devices that are in use.");
+
+PyDoc_STRVAR(device_pool_enable_doc,
+"device_pool_enable([size])\n\n"
+"Keep devices open once they are closed, so the next Device.open(), or\n"
+"any libparted call that opens the device itself, reuses the descriptor\n"
+"instead of opening it and flushing its buffer caches all over again.\n"
+"Only a Device.close() that would have really closed the device, with\n"
+"nothing written since the last flush, leaves it idle in the pool.  At\n"
+"most size devices are kept idle, the least recently used being closed\n"
+"to make room; the default is 64, or a quarter of RLIMIT_NOFILE if that\n"
+"is less.  Enabling again changes the size.  Device.open_count does not\n"
+"count the pool's open.  To other processes an idle device is still open,\n"
+"in lsof or fuser for instance; call device_pool_disable() before\n"
+"anything that needs it really closed.  Taking an idle device back\n"
+"flushes its buffer cache as opening it would have, so writes made\n"
+"meanwhile elsewhere are seen.  A read-only disk_new() closes an idle\n"
+"device first, so it can open it read-only.");
+
+PyDoc_STRVAR(device_pool_disable_doc,
+"device_pool_disable() -> boolean\n\n"
+"Close every idle device and stop keeping devices open.  Returns whether\n"
+"the pool was enabled.");
+
+PyDoc_STRVAR(device_pool_info_doc,
+"device_pool_info() -> dict\n\n"
+"Return None if the pool is disabled, or a dict with its size, the\n"
+"number of devices idle in it, the hits and misses of Device.open()\n"
+"calls that did or did not find the device there, and the number of\n"
+"evictions made to stay within size.");
 
 PyDoc_STRVAR(disk_flag_get_name_doc,
 "disk_flag_get_name(integer) -> string\n\n"
@@ -175,6 +251,106 @@ PyDoc_STRVAR(disk_flag_next_doc,
 "Given a disk flag, return the next flag.  If there is no next flag, 0\n"
 "is returned.");
 
+PyDoc_STRVAR(disk_new_from_layout_doc,
+"disk_new_from_layout(Device, bytes) -> Disk\n\n"
+"Create a fresh disk label on Device from the first layout record in\n"
+"bytes, as returned by Disk.export_layout(), with all of its partitions,\n"
+"flags, names and type identifiers.  Nothing is written to the device\n"
+"until the Disk is committed.  Raises DiskException if the record was\n"
+"made for a different sector size, UnknownTypeException if it names a\n"
+"label or file system type this libparted does not know, and ValueError\n"
+"if the data is not a valid layout record.");
+
+PyDoc_STRVAR(layout_header_doc,
+"layout_header(bytes) -> tuple\n\n"
+"Parse only the header of the layout record at the start of bytes and\n"
+"return (version, label type, sector size, device length, (alignment\n"
+"offset, alignment grain), entry count, record size).  The record size\n"
+"is the number of bytes the whole record takes, so a stream of records\n"
+"can be split without parsing their entries.");
+
+PyDoc_STRVAR(layout_diff_doc,
+"layout_diff(old, new) -> dict\n\n"
+"Compare two layout records and return what changed from old to new in\n"
+"the same form as Disk.diff(), without creating any Disk or Partition\n"
+"objects.");
+
+PyDoc_STRVAR(plan_layout_doc,
+"plan_layout(source, layout, Alignment=None) -> list\n\n"
+"Work out where the partitions in layout would go, without changing\n"
+"anything on disk.  source is a Device to plan over the whole device, a\n"
+"Geometry to plan inside it, or a Disk to plan in its largest free space\n"
+"region.  layout is a sequence of sizes, each a sector count, a string\n"
+"like '512MiB', '1.5GB' or '2048s', a percentage of the region like\n"
+"'20%', or 'rest'.  Entries marked 'rest' share whatever the others leave.\n\n"
+"Partitions start on a sector aligned to Alignment, or to the optimum\n"
+"alignment of the device if not given, and end right before one.  Fixed\n"
+"sizes are rounded up and percentages rounded down to whole grains.\n"
+"On a Disk the label's own alignment applies as well, every entry needs\n"
+"a free primary partition slot, and no partition may start or grow past\n"
+"what the label can address.\n"
+"Returns a list of (start, end) sector tuples, one per entry, and raises\n"
+"ConstraintException if the layout does not fit.");
+
+PyDoc_STRVAR(stats_doc,
+"stats(reset=False) -> dict\n\n"
+"Return the statistics gathered since stats_enable() was called.  'calls'\n"
+"maps the name of every _ped function or method called so far, such as\n"
+"'disk_new' or 'Disk.add_partition', to a tuple of (calls, errors, total\n"
+"seconds, max seconds).  'bytes_read' and 'bytes_written' count the data\n"
+"moved by the Device and Geometry read() and write() methods.  If reset\n"
+"is True the counters start over from zero.");
+
+PyDoc_STRVAR(stats_enable_doc,
+"stats_enable(enable=True)\n\n"
+"Start or stop gathering the statistics returned by stats().  Statistics\n"
+"are off by default, and calls cost nothing extra while they are off.\n"
+"While they are on, every call into _ped is timed and counted, which\n"
+"adds a clock read on either side of it.");
+
+PyDoc_STRVAR(label_scan_doc,
+"label_scan(devices[, workers]) -> list\n\n"
+"Checks the GPT or MBR on each of devices, a sequence of Device objects\n"
+"or paths, reading only the protective MBR, both GPT headers and both\n"
+"entry arrays through descriptors of its own.  Up to workers devices, 4\n"
+"by default, are scanned at once with the GIL released.  Returns a list\n"
+"of (path, label, problems) tuples in the order given, where label is\n"
+"'gpt', 'msdos' or None and problems is an or of the SCAN_ constants,\n"
+"0 for a healthy label.  No Disk is built and nothing is written.");
+
+PyDoc_STRVAR(label_stamp_doc,
+"label_stamp(template, Device) -> boolean\n\n"
+"Write the partition table rendered by Disk.label_template() to Device.\n"
+"If Device has the same length, sector size and BIOS geometry as the\n"
+"template's, the rendered sectors are written as they are, with new disk\n"
+"and partition GUIDs and CRCs for gpt or a new disk signature for msdos,\n"
+"and True is returned.  Otherwise, or for other label types, the table is\n"
+"committed through libparted and False is returned.  Boot code in the\n"
+"first sector is not preserved when stamping.  Either way the kernel is\n"
+"told about the new partitions.");
+
+PyDoc_STRVAR(try_disk_probe_doc,
+"try_disk_probe(Device) -> (DiskType, int)\n\n"
+"Like Device.disk_probe(), but returns a (DiskType, status) tuple instead\n"
+"of raising.  status is TRY_FOUND, TRY_UNRECOGNIZED if the Device has no\n"
+"label libparted knows, or TRY_FAILED if it could not be read; the\n"
+"DiskType is None unless it is TRY_FOUND.  Meant for sweeping many\n"
+"devices, most of them blank, without building an exception for each.");
+
+PyDoc_STRVAR(try_disk_new_doc,
+"try_disk_new(Device) -> (Disk, int)\n\n"
+"Like disk_new(), but returns a (Disk, status) tuple instead of raising.\n"
+"status is TRY_FOUND, TRY_UNRECOGNIZED if the Device has no label\n"
+"libparted knows, or TRY_FAILED if the label could not be read; the Disk\n"
+"is None unless it is TRY_FOUND.");
+
+PyDoc_STRVAR(try_file_system_probe_doc,
+"try_file_system_probe(Geometry) -> (FileSystemType, int)\n\n"
+"Like file_system_probe(), but returns a (FileSystemType, status) tuple\n"
+"instead of raising.  status is TRY_FOUND, TRY_UNRECOGNIZED if no file\n"
+"system, or more than one, was detected, or TRY_FAILED if the region could\n"
+"not be read; the FileSystemType is None unless it is TRY_FOUND.");
+
 PyDoc_STRVAR(unit_set_default_doc,
 "unit_set_default(Unit)\n\n"
 "Sets the default Unit to be used by further unit_* calls.  This\n"
@@ -193,6 +369,21 @@ PyDoc_STRVAR(unit_get_by_name_doc,
 "Returns a Unit given its textual representation.  Returns one of the\n"
 "UNIT_* constants.");
 
+PyDoc_STRVAR(wipe_signatures_doc,
+"wipe_signatures(targets, discard=False, free_space=False) -> dict\n\n"
+"Zero the first and last 512KiB of every region in targets, where file\n"
+"system, RAID, LVM and ZFS signatures live.  targets is a Disk, meaning its\n"
+"active partitions other than extended ones, or a sequence of Geometry.\n"
+"A busy partition, or for a Geometry a busy device, raises an exception\n"
+"before anything is written.  If discard is True the regions are\n"
+"discarded first.  The free space of a Disk is discarded only if\n"
+"free_space is True as well, since before a commit it can still hold a\n"
+"partition in use on the device.\n"
+"All of it is sorted and merged into one batch per device and runs with\n"
+"the GIL released.  Image files get holes punched instead.  Returns a\n"
+"dict with bytes_zeroed, bytes_discarded and the elapsed seconds; a\n"
+"device that cannot discard is not an error.");
+
 PyDoc_STRVAR(register_exn_handler_doc,
 "register_exn_handler(function)\n\n"
 "When parted raises an exception, the function registered here will be called\n"
@@ -204,7 +395,9 @@ PyDoc_STRVAR(register_exn_handler_doc,
 "one of the EXCEPTION_TYPE_* constants; (2) an integer corresponding to one of the\n"
 "EXCEPTION_OPT_* constants; and (3) a string that is the problem encountered by\n"
 "parted.  This string will already be translated.  The given function must return\n"
-"one of the EXCEPTION_RESOLVE_* constants instructing parted how to proceed.");
+"one of the EXCEPTION_RESOLVE_* constants instructing parted how to proceed.\n\n"
+"The function is called in the middle of the parted call that raised, which\n"
+"still holds its locks, so it must not use the Disk or Device involved.");
 
 PyDoc_STRVAR(clear_exn_handler_doc,
 "clear_exn_handler()\n\n"
@@ -252,7 +445,7 @@ static struct PyMethodDef PyPedModuleMethods[] = {
     {"libparted_version", (PyCFunction) py_libparted_get_version, METH_VARARGS, libparted_version_doc},
     {"pyparted_version", (PyCFunction) py_pyparted_version, METH_VARARGS, pyparted_version_doc},
     {"register_exn_handler", (PyCFunction) py_ped_register_exn_handler, METH_VARARGS, register_exn_handler_doc},
-    {"clear_exn_handler", (PyCFunction) py_ped_clear_exn_handler, METH_VARARGS, clear_exn_handler_doc},
+    {"clear_exn_handler", (PyCFunction) py_ped_clear_exn_handler, METH_NOARGS, clear_exn_handler_doc},
 
     /* pyconstraint.c */
     {"constraint_new_from_min_max", (PyCFunction) py_ped_constraint_new_from_min_max, METH_VARARGS, constraint_new_from_min_max_doc},
@@ -264,8 +457,9 @@ static struct PyMethodDef PyPedModuleMethods[] = {
     /* pydevice.c */
     {"device_get", (PyCFunction) py_ped_device_get, METH_VARARGS, device_get_doc},
     {"device_get_next", (PyCFunction) py_ped_device_get_next, METH_VARARGS, device_get_next_doc},
-    {"device_probe_all", (PyCFunction) py_ped_device_probe_all, METH_VARARGS, device_probe_all_doc},
-    {"device_free_all", (PyCFunction) py_ped_device_free_all, METH_VARARGS, device_free_all_doc},
+    {"device_probe_all", (PyCFunction) py_ped_device_probe_all, METH_NOARGS, device_probe_all_doc},
+    {"device_free_all", (PyCFunction) py_ped_device_free_all, METH_NOARGS, device_free_all_doc},
+    {"device_new_memory", (PyCFunction) py_ped_device_new_memory, METH_VARARGS, device_new_memory_doc},
 
     /* pydisk.c */
     {"disk_type_get_next", (PyCFunction) py_ped_disk_type_get_next, METH_VARARGS, disk_type_get_next_doc},
@@ -283,15 +477,50 @@ static struct PyMethodDef PyPedModuleMethods[] = {
     /* pyfilesys.c */
     {"file_system_probe", (PyCFunction) py_ped_file_system_probe, METH_VARARGS, file_system_probe_doc},
     {"file_system_probe_specific", (PyCFunction) py_ped_file_system_probe_specific, METH_VARARGS, file_system_probe_specific_doc},
+    {"file_system_probe_many", (PyCFunction) py_ped_file_system_probe_many, METH_VARARGS, file_system_probe_many_doc},
     {"file_system_type_get", (PyCFunction) py_ped_file_system_type_get, METH_VARARGS, file_system_type_get_doc},
     {"file_system_type_get_next", (PyCFunction) py_ped_file_system_type_get_next, METH_VARARGS, file_system_type_get_next_doc},
 
+    /* pylayout.c */
+    {"disk_new_from_layout", (PyCFunction) py_ped_disk_new_from_layout, METH_VARARGS, disk_new_from_layout_doc},
+    {"layout_header", (PyCFunction) py_ped_layout_header, METH_VARARGS, layout_header_doc},
+    {"layout_diff", (PyCFunction) py_ped_layout_diff, METH_VARARGS, layout_diff_doc},
+
+    /* pyplan.c */
+    {"plan_layout", (PyCFunction) py_ped_plan_layout, METH_VARARGS, plan_layout_doc},
+
+    /* pypool.c */
+    {"device_pool_enable", (PyCFunction) py_ped_device_pool_enable, METH_VARARGS, device_pool_enable_doc},
+    {"device_pool_disable", (PyCFunction) py_ped_device_pool_disable, METH_NOARGS, device_pool_disable_doc},
+    {"device_pool_info", (PyCFunction) py_ped_device_pool_info, METH_NOARGS, device_pool_info_doc},
+
+    /* pyscan.c */
+    {"label_scan", (PyCFunction) py_ped_label_scan, METH_VARARGS, label_scan_doc},
+
+    /* pysniff.c */
+    {"file_system_sniff", (PyCFunction) py_ped_file_system_sniff, METH_VARARGS, file_system_sniff_doc},
+
+    /* pystamp.c */
+    {"label_stamp", (PyCFunction) py_ped_label_stamp, METH_VARARGS, label_stamp_doc},
+
+    /* pystats.c */
+    {"stats", (PyCFunction) py_ped_stats, METH_VARARGS, stats_doc},
+    {"stats_enable", (PyCFunction) py_ped_stats_enable, METH_VARARGS, stats_enable_doc},
+
+    /* pytry.c */
+    {"try_disk_probe", (PyCFunction) py_ped_try_disk_probe, METH_VARARGS, try_disk_probe_doc},
+    {"try_disk_new", (PyCFunction) py_ped_try_disk_new, METH_VARARGS, try_disk_new_doc},
+    {"try_file_system_probe", (PyCFunction) py_ped_try_file_system_probe, METH_VARARGS, try_file_system_probe_doc},
+
     /* pyunit.c */
     {"unit_set_default", (PyCFunction) py_ped_unit_set_default, METH_VARARGS, unit_set_default_doc},
-    {"unit_get_default", (PyCFunction) py_ped_unit_get_default, METH_VARARGS, unit_get_default_doc},
+    {"unit_get_default", (PyCFunction) py_ped_unit_get_default, METH_NOARGS, unit_get_default_doc},
     {"unit_get_name", (PyCFunction) py_ped_unit_get_name, METH_VARARGS, unit_get_name_doc},
     {"unit_get_by_name", (PyCFunction) py_ped_unit_get_by_name, METH_VARARGS, unit_get_by_name_doc},
 
+    /* pywipe.c */
+    {"wipe_signatures", (PyCFunction) py_ped_wipe_signatures, METH_VARARGS, wipe_signatures_doc},
+
     { NULL, NULL, 0, NULL }
 };
 
@@ -372,7 +601,7 @@ PyObject *py_pyparted_version(PyObject *s, PyObject *args)
  * what to do with parted exceptions.  See the docs for the
  * py_ped_register_exn_handler function.
  */
-static PedExceptionOption partedExnHandler(PedException *e)
+static PedExceptionOption partedExnHandlerLocked(PedException *e)
 {
     PedExceptionOption ret;
 
@@ -468,6 +697,23 @@ static PedExceptionOption partedExnHandler(PedException *e)
     return PED_EXCEPTION_IGNORE;
 }
 
+/*
+ * libparted may raise exceptions from a call made with the GIL released,
+ * so take it back before touching any Python state.  The locks of the
+ * call that raised stay held while a Python handler runs, see pylock.h.
+ */
+static PedExceptionOption partedExnHandler(PedException *e)
+{
+    PedExceptionOption ret;
+    PyGILState_STATE gstate;
+
+    gstate = PyGILState_Ensure();
+    ret = partedExnHandlerLocked(e);
+    PyGILState_Release(gstate);
+
+    return ret;
+}
+
 MOD_INIT(_ped)
 {
     PyObject *m = NULL;
@@ -475,6 +721,31 @@ MOD_INIT(_ped)
     /* init the main Python module and add methods */
     m = PyModule_Create(&module_def);
 
+    /* locks guarding concurrent use of the same PedDevice */
+    if (_ped_Device_lock_init() == -1) {
+        return MOD_ERROR_VAL;
+    }
+
+    /* size of a layout record header, for reading record streams */
+    PyModule_AddIntConstant(m, "LAYOUT_HEADER_SIZE", LAYOUT_HEADER_SIZE);
+
+    /* problems reported by label_scan() */
+    PyModule_AddIntConstant(m, "SCAN_READ_ERROR", SCAN_READ_ERROR);
+    PyModule_AddIntConstant(m, "SCAN_PMBR_INVALID", SCAN_PMBR_INVALID);
+    PyModule_AddIntConstant(m, "SCAN_PRIMARY_HEADER_INVALID", SCAN_PRIMARY_HEADER_INVALID);
+    PyModule_AddIntConstant(m, "SCAN_PRIMARY_ENTRIES_INVALID", SCAN_PRIMARY_ENTRIES_INVALID);
+    PyModule_AddIntConstant(m, "SCAN_BACKUP_HEADER_INVALID", SCAN_BACKUP_HEADER_INVALID);
+    PyModule_AddIntConstant(m, "SCAN_BACKUP_ENTRIES_INVALID", SCAN_BACKUP_ENTRIES_INVALID);
+    PyModule_AddIntConstant(m, "SCAN_BACKUP_MISPLACED", SCAN_BACKUP_MISPLACED);
+    PyModule_AddIntConstant(m, "SCAN_HEADER_MISMATCH", SCAN_HEADER_MISMATCH);
+    PyModule_AddIntConstant(m, "SCAN_PARTITION_OUT_OF_RANGE", SCAN_PARTITION_OUT_OF_RANGE);
+    PyModule_AddIntConstant(m, "SCAN_PARTITION_OVERLAP", SCAN_PARTITION_OVERLAP);
+
+    /* status codes returned by the try_ functions */
+    PyModule_AddIntConstant(m, "TRY_FOUND", TRY_FOUND);
+    PyModule_AddIntConstant(m, "TRY_UNRECOGNIZED", TRY_UNRECOGNIZED);
+    PyModule_AddIntConstant(m, "TRY_FAILED", TRY_FAILED);
+
     /* PedUnit possible values */
     PyModule_AddIntConstant(m, "UNIT_SECTOR", PED_UNIT_SECTOR);
     PyModule_AddIntConstant(m, "UNIT_BYTE", PED_UNIT_BYTE);
@@ -764,6 +1035,22 @@ MOD_INIT(_ped)
     PyModule_AddIntConstant(m, "EXCEPTION_OPT_RETRY_CANCEL", PED_EXCEPTION_RETRY_CANCEL);
     PyModule_AddIntConstant(m, "EXCEPTION_OPT_RETRY_IGNORE_CANCEL", PED_EXCEPTION_RETRY_IGNORE_CANCEL);
 
+    /* every method table, so stats_enable() can count calls through them */
+    if (_ped_Stats_register(NULL, PyPedModuleMethods) == -1 ||
+        _ped_Stats_register(_ped_CHSGeometry_Type_obj.tp_name, _ped_CHSGeometry_Type_obj.tp_methods) == -1 ||
+        _ped_Stats_register(_ped_Device_Type_obj.tp_name, _ped_Device_Type_obj.tp_methods) == -1 ||
+        _ped_Stats_register(_ped_Timer_Type_obj.tp_name, _ped_Timer_Type_obj.tp_methods) == -1 ||
+        _ped_Stats_register(_ped_Geometry_Type_obj.tp_name, _ped_Geometry_Type_obj.tp_methods) == -1 ||
+        _ped_Stats_register(_ped_Alignment_Type_obj.tp_name, _ped_Alignment_Type_obj.tp_methods) == -1 ||
+        _ped_Stats_register(_ped_Constraint_Type_obj.tp_name, _ped_Constraint_Type_obj.tp_methods) == -1 ||
+        _ped_Stats_register(_ped_Partition_Type_obj.tp_name, _ped_Partition_Type_obj.tp_methods) == -1 ||
+        _ped_Stats_register(_ped_Disk_Type_obj.tp_name, _ped_Disk_Type_obj.tp_methods) == -1 ||
+        _ped_Stats_register(_ped_DiskType_Type_obj.tp_name, _ped_DiskType_Type_obj.tp_methods) == -1 ||
+        _ped_Stats_register(_ped_FileSystemType_Type_obj.tp_name, _ped_FileSystemType_Type_obj.tp_methods) == -1) {
+        PyErr_SetString(PyExc_RuntimeError, "Too many methods to gather statistics for");
+        return MOD_ERROR_VAL;
+    }
+
     exn_handler = Py_None;
     Py_INCREF(exn_handler);
 
@@ -15,7 +15,9 @@
 #include "pyconstraint.h"
 #include "pydevice.h"
 #include "pygeom.h"
+#include "pymemdev.h"
 #include "pynatmath.h"
+#include "pypool.h"
 #include "pytimer.h"
 #include "pyunit.h"
 
@@ -287,10 +289,12 @@ _ped_Device *PedDevice2_ped_Device(PedDevice *device)
         goto error;
     }
 
+    ret->memory = _ped_MemoryDevice_hold(ret->path);
+
     ret->type = device->type;
     ret->sector_size = device->sector_size;
     ret->phys_sector_size = device->phys_sector_size;
-    ret->open_count = device->open_count;
+    ret->open_count = _ped_DevicePool_open_count(device);
     ret->read_only = device->read_only;
     ret->external_mode = device->external_mode;
     ret->dirty = device->dirty;
@@ -683,6 +687,11 @@ _ped_Partition *PedPartition2_ped_Partition(PedPartition *part, _ped_Disk *pydis
 
     ret->type = part->type;
     ret->ped_partition = part;
+
+    if (_ped_Disk_track_partition(ret) == -1) {
+        goto error;
+    }
+
     return ret;
 
 error:
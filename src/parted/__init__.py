@@ -529,6 +529,28 @@ def getDevice(path):
     return Device(path=path)
 
 
+@localeC
+def newMemoryDevice(
+    length,
+    sectorSize=512,
+    physicalSectorSize=None,
+    minimumAlignment=None,
+    optimumAlignment=None,
+):
+    """Return a Device of length sectors that is held entirely in memory,
+    for planning and testing layouts without touching real disks.  The
+    Alignment arguments stand in for what would be probed from hardware.
+    The memory is released when the Device is destroyed."""
+    from _ped import device_new_memory
+
+    args = [length, sectorSize, physicalSectorSize or 0]
+
+    for alignment in (minimumAlignment, optimumAlignment):
+        args.append(alignment.getPedAlignment() if alignment else None)
+
+    return Device(PedDevice=device_new_memory(*args))
+
+
 @localeC
 def getAllDevices():
     """Return a list of Device objects for all devices in the system."""
@@ -582,6 +604,56 @@ def probeFileSystem(geometry):
     return fstype.name
 
 
+@localeC
+def probeFileSystems(geometries, workers=4):
+    """Probe every Geometry in geometries for a file system, using up to
+    workers threads, and return a list of file system names in the same
+    order.  An entry is None if no file system was found, or the exception
+    probing raised; failures are returned rather than raised."""
+    from _ped import file_system_probe_many, FileSystemType
+
+    results = file_system_probe_many(
+        [geometry.getPedGeometry() for geometry in geometries], workers
+    )
+
+    return [
+        fstype.name if isinstance(fstype, FileSystemType) else fstype
+        for fstype in results
+    ]
+
+
+@localeC
+def wipeSignatures(geometries, discard=False):
+    """Zero the file system, RAID, LVM and ZFS signatures at both ends of
+    every Geometry in geometries, discarding each of them first if discard
+    is True.  Raises DeviceException if the device of any of them is busy.
+    Everything is done as one batch per device.  Returns a dict with
+    bytes_zeroed, bytes_discarded and the elapsed seconds."""
+    from _ped import wipe_signatures
+
+    return wipe_signatures(
+        [geometry.getPedGeometry() for geometry in geometries], discard
+    )
+
+
+@localeC
+def scanLabels(devices, workers=4):
+    """Check the GPT or MBR of every Device or path in devices without
+    building a Disk, reading only the label sectors.  Up to workers devices
+    are scanned at once.  Returns a list of (path, label, problems) tuples,
+    where problems is an or of the _ped.SCAN_ constants and 0 means the
+    label is healthy."""
+    from _ped import label_scan
+
+    return label_scan(
+        [
+            device.getPedDevice() if isinstance(device, Device) else device
+            for device in devices
+        ],
+        workers,
+    )
+
+
 @localeC
 def freshDisk(device, ty):
     """Return a Disk object for this Device and using this DiskType.
@@ -602,15 +674,75 @@ def freshDisk(device, ty):
 
 
 @localeC
-def newDisk(device):
+def newDisk(device, readOnly=False):
     """Return a Disk object for this Device. Read the partition table off
-    a device (if one is found)."""
+    a device (if one is found).  With readOnly, a device that is not
+    already open is opened read-only without flushing any buffer caches,
+    and stays so for as long as the Disk lives.  The Disk refuses to be
+    changed or committed.  While it lives, nothing can be written to the
+    device: a writable newDisk() or freshDisk() and Device.open() on it
+    raise IOException, and Disks made on it before cannot commit."""
     from _ped import disk_new
 
-    peddisk = disk_new(device.getPedDevice())
+    peddisk = disk_new(device.getPedDevice(), readOnly)
     return Disk(PedDisk=peddisk)
 
 
+@localeC
+def stampLabel(template, device):
+    """Write the partition table in template, as returned by
+    Disk.labelTemplate(), to device.  Devices of the same size and geometry
+    as the template's get the rendered sectors with fresh disk and partition
+    identifiers, and True is returned.  Any other device gets the table
+    committed the usual way, and False is returned.  Either way the kernel
+    is told about the new partitions."""
+    from _ped import label_stamp
+
+    return label_stamp(template, device.getPedDevice())
+
+
+@localeC
+def newDiskFromLayout(device, data):
+    """Return a Disk object for this Device with a fresh label holding the
+    partitions in the layout record data, as returned by
+    Disk.exportLayout().  Like freshDisk(), nothing is written to the
+    device until the Disk is committed."""
+    from _ped import disk_new_from_layout
+
+    peddisk = disk_new_from_layout(device.getPedDevice(), data)
+    return Disk(device=device, PedDisk=peddisk)
+
+
+def diffLayouts(old, new):
+    """Compare two layout records and return what changed from old to new,
+    in the same form as Disk.diff()."""
+    from _ped import layout_diff
+
+    return layout_diff(old, new)
+
+
+def readLayouts(fileobj):
+    """Read concatenated layout records from a binary file object, yielding
+    each record as bytes.  Only the headers are parsed here, so large
+    inventories can be fed to diffLayouts() or newDiskFromLayout() one
+    record at a time."""
+    from _ped import layout_header, LAYOUT_HEADER_SIZE
+
+    while True:
+        header = fileobj.read(LAYOUT_HEADER_SIZE)
+
+        if not header:
+            return
+
+        recordSize = layout_header(header)[-1]
+        record = header + fileobj.read(recordSize - len(header))
+
+        if len(record) != recordSize:
+            raise ValueError("Invalid layout data: record is truncated")
+
+        yield record
+
+
 @localeC
 def version():
     """Return a dict containing the pyparted and libparted versions."""
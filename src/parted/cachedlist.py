@@ -83,3 +83,13 @@ class CachedList(Sequence):
         changes.  The next access to the list will result in the provided
         list construction function being called to build a new list."""
         self._invalid = True
+
+    def merge(self, values, key):
+        """Add values to a list that is otherwise still valid, keeping it
+        sorted by key.  This avoids calling the list construction function
+        again after a known set of additions.  If the list has already been
+        invalidated, it will be rebuilt on the next access as usual."""
+        if self._invalid or not values:
+            return
+
+        self._lst = sorted(self._lst + list(values), key=key)
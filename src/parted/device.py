@@ -12,7 +12,9 @@ if sys.version_info >= (3,):
     long = int
 
 import math
+from contextlib import contextmanager
 from decimal import Decimal
+from operator import attrgetter
 import warnings
 
 import parted
@@ -32,6 +34,8 @@ class Device(object):
 
     For information on the individual methods, see help(Device.METHODNAME)"""
 
+    __slots__ = ("__device", "__weakref__")
+
     @localeC
     def __init__(self, path=None, PedDevice=None):
         """Create a new Device object based on the specified path or the
@@ -63,44 +67,44 @@ class Device(object):
     def __getCHS(self, geometry):
         return (geometry.cylinders, geometry.heads, geometry.sectors)
 
-    @property
-    def model(self):
-        """Model name and vendor of this device."""
-        return self.__device.model
+    model = property(
+        attrgetter("_Device__device.model"),
+        doc="""Model name and vendor of this device.""",
+    )
 
-    @property
-    def path(self):
-        """Filesystem node path of this device (e.g., /dev/sda)."""
-        return self.__device.path
+    path = property(
+        attrgetter("_Device__device.path"),
+        doc="""Filesystem node path of this device (e.g., /dev/sda).""",
+    )
 
-    @property
-    def type(self):
-        """Type of this device.  An integer constant corresponding
+    type = property(
+        attrgetter("_Device__device.type"),
+        doc="""Type of this device.  An integer constant corresponding
         to one of the parted.DEVICE_* values.
-        """
-        return self.__device.type
+        """,
+    )
 
-    @property
-    def sectorSize(self):
-        """Sector size (in bytes) for this device."""
-        return self.__device.sector_size
+    sectorSize = property(
+        attrgetter("_Device__device.sector_size"),
+        doc="""Sector size (in bytes) for this device.""",
+    )
 
-    @property
-    def physicalSectorSize(self):
-        """Physical sector size (in bytes) for this device.  Not always
+    physicalSectorSize = property(
+        attrgetter("_Device__device.phys_sector_size"),
+        doc="""Physical sector size (in bytes) for this device.  Not always
         the same as sectorSize, but is a multiple of sectorSize.
-        """
-        return self.__device.phys_sector_size
+        """,
+    )
 
-    @property
-    def length(self):
-        """The size of this device in sectors."""
-        return self.__device.length
+    length = property(
+        attrgetter("_Device__device.length"),
+        doc="""The size of this device in sectors.""",
+    )
 
-    @property
-    def openCount(self):
-        """How many times the open() method has been called on this device."""
-        return self.__device.open_count
+    openCount = property(
+        attrgetter("_Device__device.open_count"),
+        doc="""How many times the open() method has been called on this device.""",
+    )
 
     @property
     def readOnly(self):
@@ -128,15 +132,15 @@ class Device(object):
         """True if the device is marked boot dirty, False otherwise."""
         return bool(self.__device.boot_dirty)
 
-    @property
-    def host(self):
-        """The host value of this device."""
-        return self.__device.host
+    host = property(
+        attrgetter("_Device__device.host"),
+        doc="""The host value of this device.""",
+    )
 
-    @property
-    def did(self):
-        """The did value of this device."""
-        return self.__device.did
+    did = property(
+        attrgetter("_Device__device.did"),
+        doc="""The did value of this device.""",
+    )
 
     @property
     def busy(self):
@@ -262,6 +266,55 @@ class Device(object):
         system specific check on count sectors."""
         return self.__device.check(start, count)
 
+    @localeC
+    def enableSectorCache(self, size=8 * 1024 * 1024, blockSize=64 * 1024):
+        """Keep the sectors read from this Device in memory, up to size
+        bytes, so repeated probing of labels and file systems only reads
+        each region from the device once.  Reads are done in blocks of
+        blockSize bytes.  Writes and syncs through pyparted keep the
+        cache correct, but changes made by other programs are not seen;
+        disable the cache or sync() before relying on those."""
+        return self.__device.sector_cache_enable(size, blockSize)
+
+    @localeC
+    def disableSectorCache(self):
+        """Stop caching sectors of this Device."""
+        return self.__device.sector_cache_disable()
+
+    @property
+    def sectorCacheInfo(self):
+        """A dict describing the sector cache of this Device and how well
+        it did, or None if it has none."""
+        return self.__device.sector_cache_info()
+
+    @contextmanager
+    def traceIO(self):
+        """Record the sector I/O libparted does on this Device while the
+        with block runs, to see what a call such as parted.newDisk() reads
+        and how often it reads the same sectors again:
+
+            with device.traceIO() as trace:
+                disk = parted.newDisk(device)
+            print(trace["sectors_read"], trace["read_amplification"])
+
+        The dict is filled in when the block exits; see
+        _ped.Device.trace_stop() for its contents."""
+        trace = {}
+        self.__device.trace_start()
+
+        try:
+            yield trace
+        except BaseException:
+            # an error from the block matters more than the lost trace
+            try:
+                trace.update(self.__device.trace_stop())
+            except Exception:
+                pass
+
+            raise
+
+        trace.update(self.__device.trace_stop())
+
     @localeC
     def startSectorToCylinder(self, sector):
         """Return the closest cylinder (round down) to sector on
@@ -355,6 +408,27 @@ class Device(object):
         alignment = self.__device.get_optimum_alignment()
         return parted.Alignment(PedAlignment=alignment)
 
+    @localeC
+    def planLayout(self, layout, alignment=None):
+        """Work out where the partitions in layout would go on this Device,
+        without changing anything on it.  layout is a list of sizes such as
+        ["512MiB", "1GiB", "20%", "rest"]; see _ped.plan_layout for the
+        accepted forms.  Partitions are aligned to alignment, or to the
+        optimum alignment of the Device if not given.  The whole Device is
+        planned over, so leave room for the disk label or plan on a Disk
+        instead.  Returns a list of Geometry objects."""
+        if alignment:
+            regions = _ped.plan_layout(
+                self.__device, layout, alignment.getPedAlignment()
+            )
+        else:
+            regions = _ped.plan_layout(self.__device, layout)
+
+        return [
+            parted.Geometry(device=self, start=start, length=end - start + 1)
+            for (start, end) in regions
+        ]
+
     def getPedDevice(self):
         """Return the _ped.Device object contained in this Device.
         For internal module use only."""
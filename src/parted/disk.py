@@ -183,6 +183,12 @@ class Disk(object):
         """The underlying Device holding this disk and partitions."""
         return self._device
 
+    @property
+    def readOnly(self):
+        """True if this disk was read with parted.newDisk(device, True) and
+        refuses to be changed or committed."""
+        return bool(self.__disk.read_only)
+
     type = property(
         lambda s: s.__disk.type.name,
         lambda s, v: setattr(s.__disk, "type", parted.diskType[v]),
@@ -193,6 +199,48 @@ class Disk(object):
         """Make a deep copy of this Disk."""
         return Disk(PedDisk=self.__disk.duplicate())
 
+    @localeC
+    def snapshot(self):
+        """Record the current partition table so it can be brought back
+        with restore().  Much cheaper than duplicate() when trying out
+        several layouts on the same Disk."""
+        return self.__disk.snapshot()
+
+    @localeC
+    def diff(self, base):
+        """Compare this Disk against base, another Disk or a snapshot(),
+        and return a dict of the partition numbers that were 'added',
+        'removed', 'resized', 'renamed' or 'modified' since base.  'disk'
+        is True if the label type or disk flags changed."""
+        if isinstance(base, Disk):
+            base = base.getPedDisk()
+
+        return self.__disk.diff(base)
+
+    @localeC
+    def exportLayout(self):
+        """Return the partition table of this Disk as a compact binary
+        layout record, which parted.newDiskFromLayout() can recreate on
+        another Device.  Records can be concatenated into one inventory and
+        read back with parted.readLayouts()."""
+        return self.__disk.export_layout()
+
+    @localeC
+    def labelTemplate(self):
+        """Render the partition table of this Disk once and return it as a
+        template for parted.stampLabel(), which writes it to other Devices
+        far faster than committing a Disk to each.  This Disk is not
+        written."""
+        return self.__disk.label_template()
+
+    @localeC
+    def restore(self, snapshot):
+        """Bring the partition table back to the state recorded by
+        snapshot().  Only the partitions that changed since are touched."""
+        self.partitions.invalidate()
+
+        return self.__disk.restore(snapshot)
+
     @localeC
     def destroy(self):
         """Closes the Disk ensuring all outstanding writes are flushed."""
@@ -215,6 +263,19 @@ class Disk(object):
 
         return self.__disk.commit_to_dev()
 
+    @localeC
+    def commitChanges(self, base):
+        """Write the partition table and inform the operating system, but
+        only if it differs from base, a Disk or snapshot() taken earlier.
+        The operating system is only told about partitions that were added,
+        removed or resized.  Returns False if there was nothing to write."""
+        self.partitions.invalidate()
+
+        if isinstance(base, Disk):
+            base = base.getPedDisk()
+
+        return self.__disk.commit_changes(base)
+
     @localeC
     def commitToOS(self):
         """Tell the operating system kernel about the partition table
@@ -228,6 +289,33 @@ class Disk(object):
         """Perform a sanity check on the partition table of this Disk."""
         return self.__disk.check()
 
+    @localeC
+    def probeFileSystems(self, workers=4):
+        """Probe every partition of this Disk that can hold a file system,
+        without holding the GIL.  Returns a dict mapping partition numbers
+        to the name of the file system found, None if there is none, or
+        the exception probing raised; a failure on one partition does not
+        stop the others.  Partitions of one Disk are probed one at a time,
+        so workers only helps parted.probeFileSystems() across Disks."""
+        results = self.__disk.probe_file_systems(workers)
+
+        return {
+            num: fstype.name if isinstance(fstype, _ped.FileSystemType) else fstype
+            for (num, fstype) in results.items()
+        }
+
+    @localeC
+    def wipeSignatures(self, discard=False, freeSpace=False):
+        """Zero the file system, RAID, LVM and ZFS signatures at both ends
+        of every partition of this Disk, leaving the label alone.  Raises
+        PartitionException if a partition is busy.  If discard is True the
+        partitions are discarded first, and the free space too if freeSpace
+        is True.  Works from the partitions as this Disk describes them,
+        committed or not, so only ask for freeSpace once the layout has
+        been committed.  Returns a dict with bytes_zeroed, bytes_discarded
+        and the elapsed seconds."""
+        return _ped.wipe_signatures(self.__disk, discard, freeSpace)
+
     @localeC
     def supportsFeature(self, feature):
         """Check that the disk type supports the provided feature."""
@@ -254,6 +342,52 @@ class Disk(object):
         else:
             return False
 
+    @localeC
+    def addPartitions(self, partitions, constraint=None):
+        """Add several new partitions to this Disk in one call.  partitions
+        is a sequence of (type, fs, start, end, flags, name) tuples, where
+        fs is a FileSystem, a file system type name or None, flags is a
+        sequence of PARTITION_* flags to set and name is the partition name
+        or None.  flags and name may be left off.  All partitions are added
+        with the same Constraint.
+
+        Returns a list with one item per entry: the new Partition, or the
+        exception raised while adding it.  A failed entry does not stop the
+        entries after it."""
+        entries = []
+
+        for entry in partitions:
+            if isinstance(entry, (tuple, list)):
+                entry = tuple(entry)
+
+                if len(entry) > 1 and isinstance(entry[1], parted.FileSystem):
+                    entry = (entry[0], entry[1].type) + entry[2:]
+
+            entries.append(entry)
+
+        if constraint:
+            results = self.__disk.add_partitions(
+                entries, constraint.getPedConstraint()
+            )
+        else:
+            results = self.__disk.add_partitions(entries)
+
+        added = []
+
+        for i, result in enumerate(results):
+            if isinstance(result, _ped.Partition):
+                results[i] = parted.Partition(disk=self, PedPartition=result)
+                added.append(results[i])
+
+        # extended partitions change what the disk reports for their
+        # logicals and free space, so only plain partitions are merged
+        if any(p.type & parted.PARTITION_EXTENDED for p in added):
+            self.partitions.invalidate()
+        else:
+            self.partitions.merge(added, key=lambda p: p.geometry.start)
+
+        return results
+
     @localeC
     def removePartition(self, partition=None):
         """Removes specified Partition from this Disk.  NOTE:  If the
@@ -414,6 +548,26 @@ class Disk(object):
 
         return freespace
 
+    @localeC
+    def planLayout(self, layout, alignment=None):
+        """Work out where the partitions in layout would go in the largest
+        free space region of this Disk, without adding them.  layout is a
+        list of sizes such as ["512MiB", "1GiB", "20%", "rest"]; see
+        _ped.plan_layout for the accepted forms.  Partitions are aligned to
+        alignment, or to the optimum alignment of the Device if not given,
+        and to whatever the disk label itself requires.  The layout must fit
+        in the primary partitions the label has left.  Returns a list of
+        Geometry objects."""
+        if alignment:
+            regions = _ped.plan_layout(self.__disk, layout, alignment.getPedAlignment())
+        else:
+            regions = _ped.plan_layout(self.__disk, layout)
+
+        return [
+            parted.Geometry(device=self.device, start=start, length=end - start + 1)
+            for (start, end) in regions
+        ]
+
     @localeC
     def getFreeSpacePartitions(self):
         """Return a list of Partition objects representing the available
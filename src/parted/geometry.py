@@ -8,6 +8,7 @@
 
 import math
 import warnings
+from operator import attrgetter
 
 import parted
 import _ped
@@ -23,6 +24,8 @@ class Geometry(object):
     Many methods (read and write methods in particular) throughout pyparted
     take in a Geometry object as an argument."""
 
+    __slots__ = ("__geometry", "_device", "__weakref__")
+
     @localeC
     def __init__(
         self, device=None, start=None, length=None, end=None, PedGeometry=None
@@ -83,17 +86,20 @@ class Geometry(object):
         )
         return s
 
-    @property
-    def device(self):
-        """The Device this geometry describes."""
-        return self._device
-
+    # Getters are attrgetter()s so reading a property is the property
+    # descriptor calling attrgetter, both in C, with no Python frame.
+    device = property(
+        attrgetter("_device"), doc="""The Device this geometry describes."""
+    )
     start = property(
-        lambda s: s.__geometry.start, lambda s, v: s.__geometry.set_start(v)
+        attrgetter("_Geometry__geometry.start"),
+        lambda s, v: s.__geometry.set_start(v),
+    )
+    end = property(
+        attrgetter("_Geometry__geometry.end"), lambda s, v: s.__geometry.set_end(v)
     )
-    end = property(lambda s: s.__geometry.end, lambda s, v: s.__geometry.set_end(v))
     length = property(
-        lambda s: s.__geometry.length,
+        attrgetter("_Geometry__geometry.length"),
         lambda s, v: s.__geometry.set(s.__geometry.start, v),
     )
 
@@ -120,6 +126,20 @@ class Geometry(object):
         """Return whether the sectory is contained entirely within self."""
         return self.__geometry.test_sector_inside(sector)
 
+    @localeC
+    def copyTo(self, dst, timer=None):
+        """Copy the contents of the region described by self to the start of
+        Geometry dst, which must be at least as long, and return the number
+        of sectors copied.  The devices of both must be open.  The regions
+        may overlap, so this can be used to move a partition.  Copies
+        between image files keep their holes.
+        dst   -- The Geometry to copy to.
+        timer -- An optional _ped.Timer updated as the copy progresses."""
+        if not timer:
+            return self.__geometry.copy_to(dst.getPedGeometry())
+        else:
+            return self.__geometry.copy_to(dst.getPedGeometry(), timer)
+
     @localeC
     def getSize(self, unit="MB"):
         """Return the size of the geometry in the unit specified.  The unit
@@ -8,6 +8,7 @@
 
 import math
 import warnings
+from operator import attrgetter
 
 import _ped
 import parted
@@ -18,6 +19,8 @@ from parted.decorators import localeC
 
 
 class Partition(object):
+    __slots__ = ("__partition", "_disk", "_geometry", "_fileSystem", "__weakref__")
+
     # pylint: disable=W0622
     @localeC
     def __init__(self, disk=None, type=None, fs=None, geometry=None, PedPartition=None):
@@ -118,10 +121,9 @@ class Partition(object):
         """True if the partition is active, False otherwise."""
         return bool(self.__partition.is_busy())
 
-    @property
-    def disk(self):
-        """The Disk this partition belongs to."""
-        return self._disk
+    disk = property(
+        attrgetter("_disk"), doc="""The Disk this partition belongs to."""
+    )
 
     @property
     @localeC
@@ -129,10 +131,9 @@ class Partition(object):
         """The filesystem path to this partition's device node."""
         return self.__partition.get_path()
 
-    @property
-    def number(self):
-        """The partition number."""
-        return self.__partition.num
+    number = property(
+        attrgetter("_Partition__partition.num"), doc="""The partition number."""
+    )
 
     @localeC
     def set_name(self, name):
@@ -185,14 +186,17 @@ class Partition(object):
             return None
 
     fileSystem = property(
-        lambda s: s._fileSystem, lambda s, v: setattr(s, "_fileSystem", v)
+        attrgetter("_fileSystem"), lambda s, v: setattr(s, "_fileSystem", v)
+    )
+    geometry = property(
+        attrgetter("_geometry"), lambda s, v: setattr(s, "_geometry", v)
     )
-    geometry = property(lambda s: s._geometry, lambda s, v: setattr(s, "_geometry", v))
     system = property(
         lambda s: s.__writeOnly("system"), lambda s, v: s.__partition.set_system(v)
     )
     type = property(
-        lambda s: s.__partition.type, lambda s, v: setattr(s.__partition, "type", v)
+        attrgetter("_Partition__partition.type"),
+        lambda s, v: setattr(s.__partition, "type", v),
     )
     name = property(get_name, set_name)
     type_uuid = property(get_type_uuid, set_type_uuid)
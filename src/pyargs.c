@@ -0,0 +1,90 @@
+/*
+ * pyargs.c
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <Python.h>
+#include <limits.h>
+
+#include "pyargs.h"
+
+int _ped_args_count(const char *name, Py_ssize_t nargs, Py_ssize_t min, Py_ssize_t max)
+{
+    if (nargs >= min && nargs <= max) {
+        return 0;
+    }
+
+    if (min == max) {
+        PyErr_Format(PyExc_TypeError, "%s() takes exactly %zd argument%s (%zd given)",
+                     name, min, min == 1 ? "" : "s", nargs);
+    } else if (nargs < min) {
+        PyErr_Format(PyExc_TypeError, "%s() takes at least %zd argument%s (%zd given)",
+                     name, min, min == 1 ? "" : "s", nargs);
+    } else {
+        PyErr_Format(PyExc_TypeError, "%s() takes at most %zd argument%s (%zd given)",
+                     name, max, max == 1 ? "" : "s", nargs);
+    }
+
+    return -1;
+}
+
+/* pos is zero based, the message uses the one based position */
+int _ped_args_object(const char *name, Py_ssize_t pos, PyObject *arg, PyTypeObject *type)
+{
+    if (PyObject_TypeCheck(arg, type)) {
+        return 0;
+    }
+
+    PyErr_Format(PyExc_TypeError, "%s() argument %zd must be %s, not %s",
+                 name, pos + 1, type->tp_name, Py_TYPE(arg)->tp_name);
+    return -1;
+}
+
+int _ped_args_int(PyObject *arg, int *out)
+{
+    long val;
+
+    /* PyArg_ParseTuple() refuses floats, so do we */
+    if (PyFloat_Check(arg)) {
+        PyErr_SetString(PyExc_TypeError, "integer argument expected, got float");
+        return -1;
+    }
+
+    val = PyLong_AsLong(arg);
+
+    if (val == -1 && PyErr_Occurred()) {
+        return -1;
+    }
+
+    if (val > INT_MAX) {
+        PyErr_SetString(PyExc_OverflowError, "signed integer is greater than maximum");
+        return -1;
+    } else if (val < INT_MIN) {
+        PyErr_SetString(PyExc_OverflowError, "signed integer is less than minimum");
+        return -1;
+    }
+
+    *out = (int) val;
+    return 0;
+}
+
+int _ped_args_sector(PyObject *arg, PedSector *out)
+{
+    PedSector val;
+
+    if (PyFloat_Check(arg)) {
+        PyErr_SetString(PyExc_TypeError, "integer argument expected, got float");
+        return -1;
+    }
+
+    val = PyLong_AsLongLong(arg);
+
+    if (val == -1 && PyErr_Occurred()) {
+        return -1;
+    }
+
+    *out = val;
+    return 0;
+}
@@ -0,0 +1,492 @@
+/*
+ * pycache.c
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <Python.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "convert.h"
+#include "pycache.h"
+#include "pydevice.h"
+#include "pydevops.h"
+
+typedef struct _ped_CacheBlock {
+    PedSector index;
+
+    /* hash chain, and least recently used list */
+    struct _ped_CacheBlock *chain;
+    struct _ped_CacheBlock *prev, *next;
+
+    unsigned char data[];
+} _ped_CacheBlock;
+
+typedef struct _ped_SectorCache {
+    const PedDevice *dev;
+    pthread_mutex_t mutex;
+
+    PedSector block_sectors;
+    size_t block_bytes;
+    size_t max_blocks, n_blocks;
+    size_t n_buckets;
+    _ped_CacheBlock **buckets;
+
+    /* sentinel, most recently used block first */
+    _ped_CacheBlock lru;
+
+    unsigned long long hits, misses, device_reads, evictions;
+
+    /* bumped by every write and clear, so a read that raced one knows */
+    unsigned long long generation;
+
+    /* one for being on the list, one for each thread using it */
+    int users;
+    struct _ped_SectorCache *next;
+} _ped_SectorCache;
+
+static _ped_CacheBlock *block_find(_ped_SectorCache *cache, PedSector index)
+{
+    _ped_CacheBlock *block = cache->buckets[index & (cache->n_buckets - 1)];
+
+    while (block != NULL && block->index != index) {
+        block = block->chain;
+    }
+
+    return block;
+}
+
+static void block_unlink(_ped_CacheBlock *block)
+{
+    block->prev->next = block->next;
+    block->next->prev = block->prev;
+}
+
+static void block_push(_ped_SectorCache *cache, _ped_CacheBlock *block)
+{
+    block->prev = &cache->lru;
+    block->next = cache->lru.next;
+    cache->lru.next->prev = block;
+    cache->lru.next = block;
+}
+
+static void block_drop(_ped_SectorCache *cache, _ped_CacheBlock *block)
+{
+    _ped_CacheBlock **link = &cache->buckets[block->index & (cache->n_buckets - 1)];
+
+    while (*link != block) {
+        link = &(*link)->chain;
+    }
+
+    *link = block->chain;
+    block_unlink(block);
+    cache->n_blocks--;
+    free(block);
+}
+
+static void cache_clear(_ped_SectorCache *cache)
+{
+    while (cache->lru.next != &cache->lru) {
+        block_drop(cache, cache->lru.next);
+    }
+
+    cache->generation++;
+}
+
+/*
+ * The list of caches has its own mutex, and each cache one more that
+ * guards its blocks and counters.  That one is never held across device
+ * I/O: a failing read ends up in the exception handler, which takes the
+ * GIL, while threads holding the GIL take the mutex for info() and for
+ * invalidating.  Caches are reference counted so one can be taken off
+ * the list while a read is still using it.
+ */
+static int n_caches = 0;
+static _ped_SectorCache *caches = NULL;
+static pthread_mutex_t caches_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void cache_free(_ped_SectorCache *cache)
+{
+    cache_clear(cache);
+    pthread_mutex_destroy(&cache->mutex);
+    free(cache->buckets);
+    free(cache);
+}
+
+/* Drop a reference, freeing the cache with the last one. */
+static void cache_put(_ped_SectorCache *cache)
+{
+    int last;
+
+    pthread_mutex_lock(&caches_mutex);
+    last = --cache->users == 0;
+    pthread_mutex_unlock(&caches_mutex);
+
+    if (last) {
+        cache_free(cache);
+    }
+}
+
+/* Find and lock the cache for dev, or return NULL if it has none. */
+static _ped_SectorCache *cache_get(const PedDevice *dev)
+{
+    _ped_SectorCache *cache = NULL;
+
+    if (__atomic_load_n(&n_caches, __ATOMIC_RELAXED) == 0) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&caches_mutex);
+
+    for (cache = caches; cache != NULL; cache = cache->next) {
+        if (cache->dev == dev) {
+            cache->users++;
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&caches_mutex);
+
+    if (cache != NULL) {
+        pthread_mutex_lock(&cache->mutex);
+    }
+
+    return cache;
+}
+
+/* Unlock a cache returned by cache_get(). */
+static void cache_release(_ped_SectorCache *cache)
+{
+    pthread_mutex_unlock(&cache->mutex);
+    cache_put(cache);
+}
+
+/* Take the cache for dev off the list; returns whether it had one. */
+static int cache_remove(const PedDevice *dev)
+{
+    _ped_SectorCache **cache = NULL, *found = NULL;
+
+    pthread_mutex_lock(&caches_mutex);
+
+    for (cache = &caches; *cache != NULL; cache = &(*cache)->next) {
+        if ((*cache)->dev == dev) {
+            found = *cache;
+            *cache = found->next;
+            __atomic_sub_fetch(&n_caches, 1, __ATOMIC_RELAXED);
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&caches_mutex);
+
+    if (found != NULL) {
+        cache_put(found);
+    }
+
+    return found != NULL;
+}
+
+/* Store a copy of one block, evicting the least recently used if full. */
+static void block_insert(_ped_SectorCache *cache, PedSector index, const unsigned char *data, size_t len)
+{
+    _ped_CacheBlock *block = NULL;
+    size_t bucket = index & (cache->n_buckets - 1);
+
+    /* another reader may have fetched it while the mutex was dropped */
+    if (block_find(cache, index) != NULL) {
+        return;
+    }
+
+    if (cache->n_blocks == cache->max_blocks) {
+        block_drop(cache, cache->lru.prev);
+        cache->evictions++;
+    }
+
+    block = malloc(sizeof(*block) + cache->block_bytes);
+
+    /* not caching it is always an option */
+    if (block == NULL) {
+        return;
+    }
+
+    block->index = index;
+    memcpy(block->data, data, len);
+    block->chain = cache->buckets[bucket];
+    cache->buckets[bucket] = block;
+    block_push(cache, block);
+    cache->n_blocks++;
+}
+
+/* Copy the part of block index that falls in [start, start + count). */
+static void block_copy(const _ped_SectorCache *cache, PedSector index, const unsigned char *data,
+                       unsigned char *buffer, PedSector start, PedSector count)
+{
+    PedSector first = index * cache->block_sectors;
+    PedSector last = first + cache->block_sectors;
+    long long sector_size = cache->dev->sector_size;
+
+    if (first < start) {
+        first = start;
+    }
+
+    if (last > start + count) {
+        last = start + count;
+    }
+
+    memcpy(buffer + (first - start) * sector_size, data + (first - index * cache->block_sectors) * sector_size,
+           (last - first) * sector_size);
+}
+
+int _ped_SectorCache_read(const PedDevice *dev, void *buffer, PedSector start, PedSector count)
+{
+    _ped_SectorCache *cache = NULL;
+    PedSector index, last, run;
+    int ret = 1;
+
+    /* let libparted deal with anything out of range */
+    if (start < 0 || count <= 0 || start + count > dev->length || (cache = cache_get(dev)) == NULL) {
+        return _ped_DevOps_read_raw(dev, buffer, start, count);
+    }
+
+    index = start / cache->block_sectors;
+    last = (start + count - 1) / cache->block_sectors;
+
+    while (index <= last) {
+        _ped_CacheBlock *block = block_find(cache, index);
+        PedSector run_start, run_length;
+        unsigned long long generation;
+        unsigned char *data = NULL;
+
+        if (block != NULL) {
+            block_copy(cache, index, block->data, buffer, start, count);
+            block_unlink(block);
+            block_push(cache, block);
+            cache->hits++;
+            index++;
+            continue;
+        }
+
+        /* fetch the whole run of missing blocks in one go */
+        for (run = index + 1; run <= last && block_find(cache, run) == NULL; run++);
+
+        run_start = index * cache->block_sectors;
+        run_length = run * cache->block_sectors;
+
+        if (run_length > dev->length) {
+            run_length = dev->length;
+        }
+
+        run_length -= run_start;
+        data = malloc(run_length * dev->sector_size);
+
+        if (data == NULL) {
+            cache_release(cache);
+            return _ped_DevOps_read_raw(dev, buffer, start, count);
+        }
+
+        cache->device_reads++;
+        generation = cache->generation;
+
+        /* read without the mutex, see above */
+        pthread_mutex_unlock(&cache->mutex);
+        ret = _ped_DevOps_read_raw(dev, data, run_start, run_length);
+        pthread_mutex_lock(&cache->mutex);
+
+        if (!ret) {
+            free(data);
+            break;
+        }
+
+        for (; index < run; index++) {
+            unsigned char *block_data = data + (index * cache->block_sectors - run_start) * dev->sector_size;
+            PedSector block_length = run_start + run_length - index * cache->block_sectors;
+
+            if (block_length > cache->block_sectors) {
+                block_length = cache->block_sectors;
+            }
+
+            block_copy(cache, index, block_data, buffer, start, count);
+            cache->misses++;
+
+            /* what was read may predate a write that landed meanwhile */
+            if (cache->generation == generation) {
+                block_insert(cache, index, block_data, block_length * dev->sector_size);
+            }
+        }
+
+        free(data);
+    }
+
+    cache_release(cache);
+    return ret;
+}
+
+int _ped_SectorCache_write(PedDevice *dev, const void *buffer, PedSector start, PedSector count)
+{
+    _ped_SectorCache *cache = NULL;
+    _ped_CacheBlock *block = NULL, *next = NULL;
+    PedSector first, last, index;
+    int ret;
+
+    ret = _ped_DevOps_orig.write(dev, buffer, start, count);
+    cache = cache_get(dev);
+
+    if (cache == NULL) {
+        return ret;
+    }
+
+    cache->generation++;
+
+    /* drop what was overwritten, whether the write worked or not */
+    first = start / cache->block_sectors;
+    last = (start + count - 1) / cache->block_sectors;
+
+    if (count <= 0) {
+        /* nothing was written */
+    } else if ((size_t) (last - first) < cache->n_blocks) {
+        for (index = first; index <= last; index++) {
+            if ((block = block_find(cache, index)) != NULL) {
+                block_drop(cache, block);
+            }
+        }
+    } else {
+        for (block = cache->lru.next; block != &cache->lru; block = next) {
+            next = block->next;
+
+            if (block->index >= first && block->index <= last) {
+                block_drop(cache, block);
+            }
+        }
+    }
+
+    cache_release(cache);
+    return ret;
+}
+
+void _ped_SectorCache_invalidate(const PedDevice *dev)
+{
+    _ped_SectorCache *cache = cache_get(dev);
+
+    if (cache != NULL) {
+        cache_clear(cache);
+        cache_release(cache);
+    }
+}
+
+void _ped_SectorCache_forget(const PedDevice *dev)
+{
+    cache_remove(dev);
+}
+
+PyObject *py_ped_device_sector_cache_enable(PyObject *s, PyObject *args)
+{
+    long long max_bytes = SECTOR_CACHE_SIZE, block_bytes = SECTOR_CACHE_BLOCK_SIZE;
+    PedDevice *device = NULL;
+    _ped_SectorCache *cache = NULL;
+
+    if (!PyArg_ParseTuple(args, "|LL", &max_bytes, &block_bytes)) {
+        return NULL;
+    }
+
+    device = _ped_Device2PedDevice(s);
+
+    if (device == NULL) {
+        return NULL;
+    }
+
+    if (block_bytes <= 0 || block_bytes % device->sector_size) {
+        PyErr_Format(PyExc_ValueError, "block size must be a positive multiple of the %lld byte sector size", device->sector_size);
+        return NULL;
+    }
+
+    if (max_bytes < block_bytes) {
+        PyErr_SetString(PyExc_ValueError, "cache size must be at least one block");
+        return NULL;
+    }
+
+    cache = calloc(1, sizeof(*cache));
+
+    if (cache == NULL) {
+        return PyErr_NoMemory();
+    }
+
+    cache->dev = device;
+    cache->block_sectors = block_bytes / device->sector_size;
+    cache->block_bytes = block_bytes;
+    cache->max_blocks = max_bytes / block_bytes;
+    cache->lru.prev = cache->lru.next = &cache->lru;
+    cache->users = 1;
+
+    for (cache->n_buckets = 16; cache->n_buckets < cache->max_blocks; cache->n_buckets *= 2);
+
+    cache->buckets = calloc(cache->n_buckets, sizeof(*cache->buckets));
+
+    if (cache->buckets == NULL || pthread_mutex_init(&cache->mutex, NULL) != 0) {
+        free(cache->buckets);
+        free(cache);
+        return PyErr_NoMemory();
+    }
+
+    _ped_DevOps_install();
+
+    /* enabling again starts over with the new limits */
+    cache_remove(device);
+
+    pthread_mutex_lock(&caches_mutex);
+    cache->next = caches;
+    caches = cache;
+    __atomic_add_fetch(&n_caches, 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&caches_mutex);
+
+    Py_RETURN_NONE;
+}
+
+PyObject *py_ped_device_sector_cache_disable(PyObject *s, PyObject *args)
+{
+    PedDevice *device = NULL;
+
+    device = _ped_Device2PedDevice(s);
+
+    if (device == NULL) {
+        return NULL;
+    }
+
+    if (cache_remove(device)) {
+        Py_RETURN_TRUE;
+    } else {
+        Py_RETURN_FALSE;
+    }
+}
+
+PyObject *py_ped_device_sector_cache_info(PyObject *s, PyObject *args)
+{
+    PedDevice *device = NULL;
+    _ped_SectorCache *cache = NULL;
+    PyObject *ret = NULL;
+
+    device = _ped_Device2PedDevice(s);
+
+    if (device == NULL) {
+        return NULL;
+    }
+
+    cache = cache_get(device);
+
+    if (cache == NULL) {
+        Py_RETURN_NONE;
+    }
+
+    ret = Py_BuildValue("{snsnsnsKsKsKsK}",
+                        "size", (Py_ssize_t) (cache->max_blocks * cache->block_bytes),
+                        "block_size", (Py_ssize_t) cache->block_bytes,
+                        "blocks", (Py_ssize_t) cache->n_blocks,
+                        "hits", cache->hits,
+                        "misses", cache->misses,
+                        "device_reads", cache->device_reads,
+                        "evictions", cache->evictions);
+    cache_release(cache);
+    return ret;
+}
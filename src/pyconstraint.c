@@ -9,6 +9,7 @@
 
 #include "convert.h"
 #include "exceptions.h"
+#include "pyargs.h"
 #include "pyconstraint.h"
 #include "pygeom.h"
 #include "pynatmath.h"
@@ -32,6 +33,11 @@ void _ped_Constraint_dealloc(_ped_Constraint *self)
     Py_CLEAR(self->end_range);
     self->end_range = NULL;
 
+    if (self->ped_constraint) {
+        ped_constraint_destroy(self->ped_constraint);
+        self->ped_constraint = NULL;
+    }
+
     PyObject_GC_Del(self);
 }
 
@@ -156,6 +162,48 @@ int _ped_Constraint_clear(_ped_Constraint *self)
     return 0;
 }
 
+/*
+ * Fill in the values the PedConstraint for self would be built from.
+ * Returns -1 if the members are not what they should be, in which case
+ * the constraint is never cached.
+ */
+static int constraint_key(_ped_Constraint *self, _ped_ConstraintKey *key)
+{
+    _ped_Alignment *start_align = (_ped_Alignment *) self->start_align;
+    _ped_Alignment *end_align = (_ped_Alignment *) self->end_align;
+    PedGeometry *start_range = NULL, *end_range = NULL;
+
+    if (start_align == NULL || !PyObject_TypeCheck(start_align, &_ped_Alignment_Type_obj)
+        || end_align == NULL || !PyObject_TypeCheck(end_align, &_ped_Alignment_Type_obj)
+        || self->start_range == NULL || !PyObject_TypeCheck(self->start_range, &_ped_Geometry_Type_obj)
+        || self->end_range == NULL || !PyObject_TypeCheck(self->end_range, &_ped_Geometry_Type_obj)) {
+        return -1;
+    }
+
+    start_range = ((_ped_Geometry *) self->start_range)->ped_geometry;
+    end_range = ((_ped_Geometry *) self->end_range)->ped_geometry;
+
+    if (start_range == NULL || end_range == NULL) {
+        return -1;
+    }
+
+    /* compared with memcmp(), so clear the padding too */
+    memset(key, 0, sizeof(*key));
+    key->start_align[0] = start_align->offset;
+    key->start_align[1] = start_align->grain_size;
+    key->end_align[0] = end_align->offset;
+    key->end_align[1] = end_align->grain_size;
+    key->start_dev = start_range->dev;
+    key->end_dev = end_range->dev;
+    key->start_range[0] = start_range->start;
+    key->start_range[1] = start_range->length;
+    key->end_range[0] = end_range->start;
+    key->end_range[1] = end_range->length;
+    key->min_size = self->min_size;
+    key->max_size = self->max_size;
+    return 0;
+}
+
 int _ped_Constraint_init(_ped_Constraint *self, PyObject *args, PyObject *kwds)
 {
     static char *kwlist[] = {"start_align", "end_align", "start_range", "end_range", "min_size", "max_size", NULL};
@@ -223,7 +271,18 @@ int _ped_Constraint_init(_ped_Constraint *self, PyObject *args, PyObject *kwds)
     /* clean up libparted objects we created */
     ped_alignment_destroy(start_align);
     ped_alignment_destroy(end_align);
-    ped_constraint_destroy(constraint);
+
+    /* and keep the constraint around as the compiled one */
+    if (self->users == 0 && constraint_key(self, &self->key) == 0) {
+        if (self->ped_constraint) {
+            ped_constraint_destroy(self->ped_constraint);
+        }
+
+        self->ped_constraint = constraint;
+    } else {
+        ped_constraint_destroy(constraint);
+    }
+
     return 0;
 }
 
@@ -275,6 +334,66 @@ int _ped_Constraint_set(_ped_Constraint *self, PyObject *value, void *closure)
     return 0;
 }
 
+PedConstraint *_ped_Constraint_acquire(PyObject *s)
+{
+    _ped_Constraint *self = (_ped_Constraint *) s;
+    _ped_ConstraintKey key;
+    PedConstraint *constraint = NULL;
+
+    if (self == NULL) {
+        PyErr_SetString(PyExc_TypeError, "Empty _ped.Constraint()");
+        return NULL;
+    }
+
+    if (constraint_key(self, &key) == -1) {
+        /* let the converter complain about the members */
+        return _ped_Constraint2PedConstraint(s);
+    }
+
+    if (self->ped_constraint && !memcmp(&key, &self->key, sizeof(key))) {
+        self->users++;
+        return self->ped_constraint;
+    }
+
+    constraint = _ped_Constraint2PedConstraint(s);
+
+    if (constraint == NULL) {
+        return NULL;
+    }
+
+    /*
+     * A caller further up the stack may still be using the old one, for
+     * example from an exception handler callback.  In that case hand out
+     * a private copy and leave the cache alone.
+     */
+    if (self->users == 0) {
+        if (self->ped_constraint) {
+            ped_constraint_destroy(self->ped_constraint);
+        }
+
+        self->ped_constraint = constraint;
+        self->key = key;
+        self->users++;
+    }
+
+    return constraint;
+}
+
+void _ped_Constraint_release(PyObject *s, PedConstraint *constraint)
+{
+    _ped_Constraint *self = (_ped_Constraint *) s;
+
+    if (constraint == NULL) {
+        return;
+    }
+
+    if (constraint == self->ped_constraint) {
+        self->users--;
+    } else {
+        ped_constraint_destroy(constraint);
+    }
+}
+
 /* 1:1 function mappings for constraint.h in libparted */
 PyObject *py_ped_constraint_new_from_min_max(PyObject *s, PyObject *args)
 {
@@ -383,14 +502,14 @@ PyObject *py_ped_constraint_duplicate(PyObject *s, PyObject *args)
     PedConstraint *constraint = NULL, *dup_constraint = NULL;
     _ped_Constraint *ret = NULL;
 
-    constraint = _ped_Constraint2PedConstraint(s);
+    constraint = _ped_Constraint_acquire(s);
 
     if (constraint == NULL) {
         return NULL;
     }
 
     dup_constraint = ped_constraint_duplicate(constraint);
-    ped_constraint_destroy(constraint);
+    _ped_Constraint_release(s, constraint);
 
     if (dup_constraint) {
         ret = PedConstraint2_ped_Constraint(dup_constraint);
@@ -414,22 +533,22 @@ PyObject *py_ped_constraint_intersect(PyObject *s, PyObject *args)
         return NULL;
     }
 
-    constraintA = _ped_Constraint2PedConstraint(s);
+    constraintA = _ped_Constraint_acquire(s);
 
     if (constraintA == NULL) {
         return NULL;
     }
 
-    constraintB = _ped_Constraint2PedConstraint(in_constraintB);
+    constraintB = _ped_Constraint_acquire(in_constraintB);
 
     if (constraintB == NULL) {
-        ped_constraint_destroy(constraintA);
+        _ped_Constraint_release(s, constraintA);
         return NULL;
     }
 
     constraint = ped_constraint_intersect(constraintA, constraintB);
-    ped_constraint_destroy(constraintA);
-    ped_constraint_destroy(constraintB);
+    _ped_Constraint_release(s, constraintA);
+    _ped_Constraint_release(in_constraintB, constraintB);
 
     if (constraint) {
         ret = PedConstraint2_ped_Constraint(constraint);
@@ -448,14 +567,14 @@ PyObject *py_ped_constraint_solve_max(PyObject *s, PyObject *args)
     PedGeometry *geometry = NULL;
     _ped_Geometry *ret = NULL;
 
-    constraint = _ped_Constraint2PedConstraint(s);
+    constraint = _ped_Constraint_acquire(s);
 
     if (constraint == NULL) {
         return NULL;
     }
 
     geometry = ped_constraint_solve_max(constraint);
-    ped_constraint_destroy(constraint);
+    _ped_Constraint_release(s, constraint);
 
     if (geometry) {
         ret = PedGeometry2_ped_Geometry(geometry);
@@ -476,7 +595,7 @@ PyObject *py_ped_constraint_solve_max(PyObject *s, PyObject *args)
     return (PyObject *) ret;
 }
 
-PyObject *py_ped_constraint_solve_nearest(PyObject *s, PyObject *args)
+PyObject *py_ped_constraint_solve_nearest(PyObject *s, PyObject *const *args, Py_ssize_t nargs)
 {
     PyObject *in_geometry = NULL;
     PedConstraint *constraint = NULL;
@@ -484,11 +603,14 @@ PyObject *py_ped_constraint_solve_nearest(PyObject *s, PyObject *args)
     PedGeometry *geometry = NULL;
     _ped_Geometry *ret = NULL;
 
-    if (!PyArg_ParseTuple(args, "O!", &_ped_Geometry_Type_obj, &in_geometry)) {
+    if (_ped_args_count("solve_nearest", nargs, 1, 1) == -1 ||
+        _ped_args_object("solve_nearest", 0, args[0], &_ped_Geometry_Type_obj) == -1) {
         return NULL;
     }
 
-    constraint = _ped_Constraint2PedConstraint(s);
+    in_geometry = args[0];
+
+    constraint = _ped_Constraint_acquire(s);
 
     if (constraint == NULL) {
         return NULL;
@@ -497,12 +619,12 @@ PyObject *py_ped_constraint_solve_nearest(PyObject *s, PyObject *args)
     out_geometry = _ped_Geometry2PedGeometry(in_geometry);
 
     if (out_geometry == NULL) {
-        ped_constraint_destroy(constraint);
+        _ped_Constraint_release(s, constraint);
         return NULL;
     }
 
     geometry = ped_constraint_solve_nearest(constraint, out_geometry);
-    ped_constraint_destroy(constraint);
+    _ped_Constraint_release(s, constraint);
 
     if (geometry) {
         ret = PedGeometry2_ped_Geometry(geometry);
@@ -514,18 +636,21 @@ PyObject *py_ped_constraint_solve_nearest(PyObject *s, PyObject *args)
     return (PyObject *) ret;
 }
 
-PyObject *py_ped_constraint_is_solution(PyObject *s, PyObject *args)
+PyObject *py_ped_constraint_is_solution(PyObject *s, PyObject *const *args, Py_ssize_t nargs)
 {
     PyObject *in_geometry = NULL;
     PedConstraint *constraint = NULL;
     PedGeometry *out_geometry = NULL;
     int ret = 0;
 
-    if (!PyArg_ParseTuple(args, "O!", &_ped_Geometry_Type_obj, &in_geometry)) {
+    if (_ped_args_count("is_solution", nargs, 1, 1) == -1 ||
+        _ped_args_object("is_solution", 0, args[0], &_ped_Geometry_Type_obj) == -1) {
         return NULL;
     }
 
-    constraint = _ped_Constraint2PedConstraint(s);
+    in_geometry = args[0];
+
+    constraint = _ped_Constraint_acquire(s);
 
     if (constraint == NULL) {
         return NULL;
@@ -534,12 +659,12 @@ PyObject *py_ped_constraint_is_solution(PyObject *s, PyObject *args)
     out_geometry = _ped_Geometry2PedGeometry(in_geometry);
 
     if (out_geometry == NULL) {
-        ped_constraint_destroy(constraint);
+        _ped_Constraint_release(s, constraint);
         return NULL;
     }
 
     ret = ped_constraint_is_solution(constraint, out_geometry);
-    ped_constraint_destroy(constraint);
+    _ped_Constraint_release(s, constraint);
 
     if (ret) {
         Py_RETURN_TRUE;
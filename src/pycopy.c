@@ -0,0 +1,585 @@
+/*
+ * pycopy.c
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <Python.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "convert.h"
+#include "exceptions.h"
+#include "pycache.h"
+#include "pycopy.h"
+#include "pydevops.h"
+#include "pygeom.h"
+#include "pylock.h"
+#include "pypool.h"
+#include "pystats.h"
+#include "pytimer.h"
+#include "pytrace.h"
+
+/*
+ * A copy runs as a pipeline: a reader thread fills a ring of buffers while
+ * the calling thread, with the GIL released, writes them out.  Chunk i of
+ * the copy always lives in buffers[i % COPY_BUFFERS].
+ *
+ * When the destination lies after the source on the same device, the copy
+ * runs from the end of the region back to its start, so a partition can
+ * be moved over a region that overlaps its old one.  Either way every
+ * sector is read before anything that could overwrite it is written, no
+ * matter how far the reader runs ahead.
+ *
+ * libparted seeks and reads on the one descriptor it keeps per device, so
+ * when both regions are on the same device the reader and writer take
+ * turns through io_mutex.
+ */
+typedef struct {
+    PedGeometry *src;
+    PedGeometry *dst;
+    PedSector total;
+    PedSector chunk;
+    PedSector n_chunks;
+    int backward;
+    int shared;
+
+    void *buffers[COPY_BUFFERS];
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    pthread_mutex_t io_mutex;
+
+    /* chunks read and written so far, guarded by mutex */
+    PedSector read;
+    PedSector written;
+    int stop;
+
+    /* why the reader stopped, it cannot raise on its own */
+    int read_failed;
+    char *read_error;
+
+    /* set when the copy was done between image files, see copy_sparse() */
+    int sparse;
+    PedSector sparse_data;
+
+    /* the caller's _ped.Timer, kept up to date as chunks are written */
+    PyObject *in_timer;
+} _ped_Copy;
+
+/* The part of the region chunk i covers, in sectors from its start. */
+static void copy_chunk(const _ped_Copy *copy, PedSector i, PedSector *offset, PedSector *count)
+{
+    PedSector start = i * copy->chunk;
+
+    *count = copy->total - start < copy->chunk ? copy->total - start : copy->chunk;
+    *offset = copy->backward ? copy->total - start - *count : start;
+}
+
+static int copy_io(_ped_Copy *copy, int write, void *buf, PedSector offset, PedSector count)
+{
+    int ret;
+
+    if (copy->shared) {
+        pthread_mutex_lock(&copy->io_mutex);
+    }
+
+    if (write) {
+        ret = ped_geometry_write(copy->dst, buf, offset, count);
+    } else {
+        ret = ped_geometry_read(copy->src, buf, offset, count);
+    }
+
+    if (copy->shared) {
+        pthread_mutex_unlock(&copy->io_mutex);
+    }
+
+    return ret;
+}
+
+static void *copy_reader(void *data)
+{
+    _ped_Copy *copy = data;
+    PedSector i, offset, count;
+    int ok;
+
+    for (i = 0; i < copy->n_chunks; i++) {
+        pthread_mutex_lock(&copy->mutex);
+
+        while (copy->read - copy->written == COPY_BUFFERS && !copy->stop) {
+            pthread_cond_wait(&copy->cond, &copy->mutex);
+        }
+
+        ok = !copy->stop;
+        pthread_mutex_unlock(&copy->mutex);
+
+        if (!ok) {
+            break;
+        }
+
+        copy_chunk(copy, i, &offset, &count);
+        ok = copy_io(copy, 0, copy->buffers[i % COPY_BUFFERS], offset, count);
+
+        pthread_mutex_lock(&copy->mutex);
+
+        if (ok) {
+            copy->read++;
+        } else {
+            copy->stop = 1;
+            copy->read_failed = 1;
+
+            /* the exception state is per thread, so pick it up here */
+            if (partedExnRaised) {
+                partedExnRaised = 0;
+                copy->read_error = partedExnMessage;
+                partedExnMessage = NULL;
+            }
+        }
+
+        pthread_cond_signal(&copy->cond);
+        pthread_mutex_unlock(&copy->mutex);
+
+        if (!ok) {
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+/* Hand the progress the copy made back to the caller's _ped.Timer. */
+static void copy_timer_done(PyObject *in_timer, const PedTimer *timer)
+{
+    _ped_Timer *ret = (_ped_Timer *) in_timer;
+
+    ret->frac = timer->frac;
+    ret->start = timer->start;
+    ret->now = timer->now;
+    ret->predicted_end = timer->predicted_end;
+}
+
+/*
+ * Report that the first n chunks are written.  This runs without the GIL,
+ * so take it just long enough to hand the progress to the caller's
+ * _ped.Timer, which another thread may be watching.
+ */
+static void copy_progress(_ped_Copy *copy, PedTimer *timer, PedSector n)
+{
+    PyGILState_STATE gstate;
+
+    if (timer == NULL) {
+        return;
+    }
+
+    ped_timer_update(timer, (float) n / copy->n_chunks);
+
+    if (copy->in_timer) {
+        gstate = PyGILState_Ensure();
+        copy_timer_done(copy->in_timer, timer);
+        PyGILState_Release(gstate);
+    }
+}
+
+/* Returns 0 if a write failed, 1 otherwise. */
+static int copy_writer(_ped_Copy *copy, PedTimer *timer)
+{
+    PedSector i, offset, count;
+    int ok = 1;
+
+    for (i = 0; i < copy->n_chunks && ok; i++) {
+        pthread_mutex_lock(&copy->mutex);
+
+        while (copy->read <= i && !copy->stop) {
+            pthread_cond_wait(&copy->cond, &copy->mutex);
+        }
+
+        ok = !copy->stop;
+        pthread_mutex_unlock(&copy->mutex);
+
+        if (!ok) {
+            /* the reader failed, it says why */
+            return 1;
+        }
+
+        copy_chunk(copy, i, &offset, &count);
+        ok = copy_io(copy, 1, copy->buffers[i % COPY_BUFFERS], offset, count);
+
+        pthread_mutex_lock(&copy->mutex);
+
+        if (ok) {
+            copy->written++;
+        } else {
+            copy->stop = 1;
+        }
+
+        pthread_cond_signal(&copy->cond);
+        pthread_mutex_unlock(&copy->mutex);
+
+        if (ok) {
+            copy_progress(copy, timer, i + 1);
+        }
+    }
+
+    return ok;
+}
+
+/* Lock both devices, in address order so two copies cannot deadlock. */
+static void copy_lock(_ped_Lock *a, _ped_Lock *b)
+{
+    if (a == b) {
+        _ped_Lock_write(a);
+    } else if (a < b) {
+        _ped_Lock_write(a);
+        _ped_Lock_write(b);
+    } else {
+        _ped_Lock_write(b);
+        _ped_Lock_write(a);
+    }
+}
+
+static void copy_unlock(_ped_Lock *a, _ped_Lock *b)
+{
+    _ped_Lock_release(a);
+
+    if (a != b) {
+        _ped_Lock_release(b);
+    }
+}
+
+static int copy_check_device(PedDevice *device)
+{
+    if (_ped_DevicePool_open_count(device) <= 0) {
+        PyErr_Format(IOException, "Device %s is not open.", device->path);
+        return -1;
+    }
+
+    if (device->external_mode) {
+        PyErr_Format(IOException, "Device %s is already open for external access.", device->path);
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * Copy length bytes between two image files, with copy_file_range() so a
+ * file system that can share extents (btrfs, xfs, NFS and so on) does not
+ * copy anything at all.  Falls back to reading and writing through buf.
+ * Returns 0 on failure.
+ */
+static int copy_extent(int in, off_t in_offset, int out, off_t out_offset, off_t length, void *buf, size_t size)
+{
+    ssize_t n;
+
+    while (length > 0) {
+        n = copy_file_range(in, &in_offset, out, &out_offset, length, 0);
+
+        if (n <= 0) {
+            break;
+        }
+
+        length -= n;
+    }
+
+    while (length > 0) {
+        n = pread(in, buf, (size_t) length < size ? (size_t) length : size, in_offset);
+
+        if (n <= 0 || pwrite(out, buf, n, out_offset) != n) {
+            return 0;
+        }
+
+        in_offset += n;
+        out_offset += n;
+        length -= n;
+    }
+
+    return 1;
+}
+
+/*
+ * Image files, memory devices among them, are usually mostly holes.  When
+ * both ends of the copy are image files, walk the data extents of the
+ * source with SEEK_DATA and SEEK_HOLE, copy only those and punch holes in
+ * the destination for the rest, so the copy stays as sparse as the
+ * original and its cost follows the data rather than the size.
+ *
+ * This goes around libparted with descriptors of our own, so the sector
+ * cache of the destination is dropped afterwards.  Returns 0, having
+ * possibly done part of the work, if the copy has to go through libparted
+ * instead: the devices are not image files, the destination is read-only,
+ * the regions overlap, or the file system does not support something
+ * needed.
+ */
+static int copy_sparse(_ped_Copy *copy)
+{
+    PedDevice *src_dev = copy->src->dev, *dst_dev = copy->dst->dev;
+    off_t src_start = copy->src->start * src_dev->sector_size;
+    off_t dst_start = copy->dst->start * dst_dev->sector_size;
+    off_t length = copy->total * src_dev->sector_size;
+    off_t pos, data, hole;
+    PedSector first, count;
+    int in = -1, out = -1, ret = 0;
+
+    if (src_dev->type != PED_DEVICE_FILE || dst_dev->type != PED_DEVICE_FILE) {
+        return 0;
+    }
+
+    /* libparted is the one to refuse writing where it may not */
+    if (dst_dev->read_only || _ped_DevOps_is_read_only(dst_dev)) {
+        return 0;
+    }
+
+    if (copy->shared && src_start < dst_start + length && dst_start < src_start + length) {
+        return 0;
+    }
+
+    if ((in = open(src_dev->path, O_RDONLY | O_CLOEXEC)) == -1 ||
+        (out = open(dst_dev->path, O_WRONLY | O_CLOEXEC)) == -1) {
+        goto out;
+    }
+
+    for (pos = 0; pos < length; pos = hole) {
+        data = lseek(in, src_start + pos, SEEK_DATA);
+
+        /* nothing but a hole up to the end of the file */
+        if (data == -1 && errno == ENXIO) {
+            data = src_start + length;
+        } else if (data == -1) {
+            goto out;
+        }
+
+        data = data - src_start < length ? data - src_start : length;
+
+        if (data > pos && fallocate(out, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, dst_start + pos, data - pos) == -1) {
+            goto out;
+        }
+
+        if (data == length) {
+            break;
+        }
+
+        if ((hole = lseek(in, src_start + data, SEEK_HOLE)) == -1) {
+            goto out;
+        }
+
+        hole = hole - src_start < length ? hole - src_start : length;
+
+        if (!copy_extent(in, src_start + data, out, dst_start + data, hole - data,
+                         copy->buffers[0], copy->chunk * src_dev->sector_size)) {
+            goto out;
+        }
+
+        /* a file ending mid-sector still touched that whole sector */
+        first = data / src_dev->sector_size;
+        count = (hole + src_dev->sector_size - 1) / src_dev->sector_size - first;
+
+        _ped_Trace_record(src_dev, TRACE_READ, copy->src->start + first, count);
+        _ped_Trace_record(dst_dev, TRACE_WRITE, copy->dst->start + first, count);
+        copy->sparse_data += count;
+    }
+
+    ret = 1;
+
+out:
+    if (in != -1) {
+        close(in);
+    }
+
+    if (out != -1) {
+        close(out);
+    }
+
+    _ped_SectorCache_invalidate(dst_dev);
+    copy->sparse = ret;
+    return ret;
+}
+
+/* When no reader thread could be started, read and write in turn. */
+static int copy_serial(_ped_Copy *copy, PedTimer *timer)
+{
+    PedSector i, offset, count;
+
+    for (i = 0; i < copy->n_chunks; i++) {
+        copy_chunk(copy, i, &offset, &count);
+
+        if (!copy_io(copy, 0, copy->buffers[0], offset, count)) {
+            copy->read_failed = 1;
+            return 1;
+        }
+
+        copy->read++;
+
+        if (!copy_io(copy, 1, copy->buffers[0], offset, count)) {
+            return 0;
+        }
+
+        copy->written++;
+        copy_progress(copy, timer, i + 1);
+    }
+
+    return 1;
+}
+
+/* Sectors in the first n chunks. */
+static PedSector copy_sectors(const _ped_Copy *copy, PedSector n)
+{
+    return n * copy->chunk < copy->total ? n * copy->chunk : copy->total;
+}
+
+PyObject *py_ped_geometry_copy_to(PyObject *s, PyObject *args)
+{
+    PyObject *in_dst = NULL, *in_timer = NULL, *ret = NULL;
+    PedTimer *timer = NULL;
+    _ped_Lock *src_lock, *dst_lock;
+    _ped_Copy copy;
+    pthread_t reader;
+    long page_size = sysconf(_SC_PAGESIZE);
+    int i, written = 1;
+
+    if (!PyArg_ParseTuple(args, "O!|O!", &_ped_Geometry_Type_obj, &in_dst, &_ped_Timer_Type_obj, &in_timer)) {
+        return NULL;
+    }
+
+    memset(&copy, 0, sizeof(copy));
+    copy.src = _ped_Geometry2PedGeometry(s);
+    copy.dst = _ped_Geometry2PedGeometry(in_dst);
+
+    if (copy.src == NULL || copy.dst == NULL) {
+        return NULL;
+    }
+
+    if (copy_check_device(copy.src->dev) == -1 || copy_check_device(copy.dst->dev) == -1) {
+        return NULL;
+    }
+
+    if (copy.src->dev->sector_size != copy.dst->dev->sector_size) {
+        PyErr_SetString(PyExc_ValueError, "source and destination devices have different sector sizes");
+        return NULL;
+    }
+
+    if (copy.dst->length < copy.src->length) {
+        PyErr_SetString(PyExc_ValueError, "destination is smaller than the source");
+        return NULL;
+    }
+
+    copy.total = copy.src->length;
+    copy.shared = copy.src->dev == copy.dst->dev;
+    copy.backward = copy.shared && copy.dst->start > copy.src->start;
+    copy.chunk = COPY_CHUNK_SIZE / copy.src->dev->sector_size;
+
+    if (copy.chunk < 1) {
+        copy.chunk = 1;
+    }
+
+    /* a small region needs no more buffer than the region itself */
+    if (copy.chunk > copy.total && copy.total > 0) {
+        copy.chunk = copy.total;
+    }
+
+    /* copying a region onto itself is a no-op */
+    if (!copy.shared || copy.dst->start != copy.src->start) {
+        copy.n_chunks = (copy.total + copy.chunk - 1) / copy.chunk;
+    }
+
+    for (i = 0; i < COPY_BUFFERS && i < copy.n_chunks; i++) {
+        /* aligned for devices opened with O_DIRECT */
+        if (posix_memalign(&copy.buffers[i], page_size, copy.chunk * copy.src->dev->sector_size) != 0) {
+            copy.buffers[i] = NULL;
+            PyErr_NoMemory();
+            goto out;
+        }
+    }
+
+    if (in_timer) {
+        timer = _ped_Timer2PedTimer(in_timer);
+
+        if (timer == NULL) {
+            goto out;
+        }
+
+        ped_timer_reset(timer);
+        copy.in_timer = in_timer;
+    }
+
+    pthread_mutex_init(&copy.mutex, NULL);
+    pthread_cond_init(&copy.cond, NULL);
+    pthread_mutex_init(&copy.io_mutex, NULL);
+
+    src_lock = _ped_Device_lock(copy.src->dev);
+    dst_lock = _ped_Device_lock(copy.dst->dev);
+    copy_lock(src_lock, dst_lock);
+
+    Py_BEGIN_ALLOW_THREADS
+
+    if (copy.n_chunks == 0 || copy_sparse(&copy)) {
+        ped_timer_update(timer, 1.0);
+    } else if (pthread_create(&reader, NULL, copy_reader, &copy) == 0) {
+        written = copy_writer(&copy, timer);
+        pthread_join(reader, NULL);
+    } else {
+        written = copy_serial(&copy, timer);
+    }
+
+    Py_END_ALLOW_THREADS
+
+    copy_unlock(src_lock, dst_lock);
+
+    pthread_mutex_destroy(&copy.mutex);
+    pthread_cond_destroy(&copy.cond);
+    pthread_mutex_destroy(&copy.io_mutex);
+
+    if (copy.sparse) {
+        STATS_READ(copy.src->dev, copy.sparse_data);
+        STATS_WRITE(copy.dst->dev, copy.sparse_data);
+    } else {
+        STATS_READ(copy.src->dev, copy_sectors(&copy, copy.read));
+        STATS_WRITE(copy.dst->dev, copy_sectors(&copy, copy.written));
+    }
+
+    if (timer) {
+        copy_timer_done(in_timer, timer);
+    }
+
+    if (copy.read_failed) {
+        if (copy.read_error != NULL) {
+            PyErr_SetString(IOException, copy.read_error);
+        } else if (partedExnRaised) {
+            partedExnRaised = 0;
+
+            if (!PyErr_ExceptionMatches(PartedException) && !PyErr_ExceptionMatches(PyExc_NotImplementedError)) {
+                PyErr_SetString(IOException, partedExnMessage);
+            }
+        } else {
+            PyErr_SetString(IOException, "Could not read from source region");
+        }
+    } else if (!written) {
+        if (partedExnRaised) {
+            partedExnRaised = 0;
+
+            if (!PyErr_ExceptionMatches(PartedException) && !PyErr_ExceptionMatches(PyExc_NotImplementedError)) {
+                PyErr_SetString(IOException, partedExnMessage);
+            }
+        } else {
+            PyErr_SetString(IOException, "Could not write to destination region");
+        }
+    } else {
+        ret = PyLong_FromLongLong(copy.total);
+    }
+
+out:
+    if (timer) {
+        free((char *) timer->state_name);
+        ped_timer_destroy(timer);
+    }
+
+    for (i = 0; i < COPY_BUFFERS; i++) {
+        free(copy.buffers[i]);
+    }
+
+    free(copy.read_error);
+    return ret;
+}
@@ -9,16 +9,30 @@
 
 #include "convert.h"
 #include "exceptions.h"
+#include "pycache.h"
 #include "pyconstraint.h"
 #include "pydevice.h"
+#include "pydevops.h"
+#include "pyfreelist.h"
+#include "pylock.h"
+#include "pymemdev.h"
+#include "pypool.h"
+#include "pystats.h"
+#include "pytrace.h"
 #include "docstrings/pydevice.h"
 #include "typeobjects/pydevice.h"
 
+static _ped_FreeList chs_geometry_freelist = FREELIST_INIT(&_ped_CHSGeometry_Type_obj);
+
 /* _ped.CHSGeometry functions */
+PyObject *_ped_CHSGeometry_alloc(PyTypeObject *type, Py_ssize_t nitems)
+{
+    return _ped_FreeList_alloc(&chs_geometry_freelist, type, nitems);
+}
+
 void _ped_CHSGeometry_dealloc(_ped_CHSGeometry *self)
 {
-    PyObject_GC_UnTrack(self);
-    PyObject_GC_Del(self);
+    _ped_FreeList_free(&chs_geometry_freelist, (PyObject *) self);
 }
 
 int _ped_CHSGeometry_compare(_ped_CHSGeometry *self, PyObject *obj)
@@ -81,16 +95,6 @@ PyObject *_ped_CHSGeometry_str(_ped_CHSGeometry *self)
     return ret;
 }
 
-int _ped_CHSGeometry_traverse(_ped_CHSGeometry *self, visitproc visit, void *arg)
-{
-    return 0;
-}
-
-int _ped_CHSGeometry_clear(_ped_CHSGeometry *self)
-{
-    return 0;
-}
-
 PyObject *_ped_CHSGeometry_get(_ped_CHSGeometry *self, void *closure)
 {
     char *member = (char *) closure;
@@ -120,6 +124,10 @@ void _ped_Device_dealloc(_ped_Device *self)
     free(self->model);
     free(self->path);
 
+    if (self->memory != 0) {
+        _ped_MemoryDevice_release(self->memory);
+    }
+
     Py_CLEAR(self->hw_geom);
     self->hw_geom = NULL;
 
@@ -245,6 +253,21 @@ int _ped_Device_clear(_ped_Device *self)
     return 0;
 }
 
+/*
+ * Returns -1 with an exception set if a read-only Disk holds device.  It
+ * is open through a read-only descriptor until that Disk is freed, so
+ * nothing opened or made for writing on it now could write anything.
+ */
+int _ped_Device_check_writable(const PedDevice *device)
+{
+    if (_ped_DevOps_is_read_only(device)) {
+        PyErr_Format(IOException, "Device %s is held open read-only by a read-only Disk", device->path);
+        return -1;
+    }
+
+    return 0;
+}
+
 PyObject *_ped_Device_get(_ped_Device *self, void *closure)
 {
     char *member = (char *) closure;
@@ -319,7 +342,11 @@ PyObject *py_ped_disk_probe(PyObject *s, PyObject *args)
     device = _ped_Device2PedDevice(s);
 
     if (device) {
+        _ped_Lock_write(_ped_Device_lock(device));
+        Py_BEGIN_ALLOW_THREADS
         type = ped_disk_probe(device);
+        Py_END_ALLOW_THREADS
+        _ped_Lock_release(_ped_Device_lock(device));
 
         if (type == NULL) {
             PyErr_Format(IOException, "Could not probe device %s", device->path);
@@ -346,6 +373,7 @@ PyObject *py_ped_device_probe_all(PyObject *s, PyObject *args)
 PyObject *py_ped_device_free_all(PyObject *s, PyObject *args)
 {
     ped_device_free_all();
+    _ped_MemoryDevice_forget_all();
     Py_RETURN_NONE;
 }
 
@@ -425,7 +453,11 @@ PyObject *py_ped_device_is_busy(PyObject *s, PyObject *args)
         return NULL;
     }
 
+    _ped_Lock_read(_ped_Device_lock(device));
+    Py_BEGIN_ALLOW_THREADS
     ret = ped_device_is_busy(device);
+    Py_END_ALLOW_THREADS
+    _ped_Lock_release(_ped_Device_lock(device));
 
     if (ret) {
         Py_RETURN_TRUE;
@@ -450,7 +482,20 @@ PyObject *py_ped_device_open(PyObject *s, PyObject *args)
         return NULL;
     }
 
+    if (_ped_Device_check_writable(device) == -1) {
+        return NULL;
+    }
+
+    if (_ped_DevicePool_take(device)) {
+        ((_ped_Device *) s)->open_count = device->open_count;
+        Py_RETURN_TRUE;
+    }
+
+    _ped_Lock_write(_ped_Device_lock(device));
+    Py_BEGIN_ALLOW_THREADS
     ret = ped_device_open(device);
+    Py_END_ALLOW_THREADS
+    _ped_Lock_release(_ped_Device_lock(device));
 
     if (ret == 0) {
         if (partedExnRaised) {
@@ -486,7 +531,7 @@ PyObject *py_ped_device_close(PyObject *s, PyObject *args)
         return NULL;
     }
 
-    if (!device->open_count) {
+    if (!_ped_DevicePool_open_count(device)) {
         PyErr_Format(IOException, "Device %s is not open.", device->path);
         return NULL;
     }
@@ -496,7 +541,18 @@ PyObject *py_ped_device_close(PyObject *s, PyObject *args)
         return NULL;
     }
 
-    ret = ped_device_close(device);
+    _ped_Lock_write(_ped_Device_lock(device));
+
+    if (_ped_DevicePool_put(device)) {
+        ret = 1;
+    } else {
+        Py_BEGIN_ALLOW_THREADS
+        ret = ped_device_close(device);
+        Py_END_ALLOW_THREADS
+    }
+
+    _ped_Lock_release(_ped_Device_lock(device));
+    _ped_DevicePool_trim();
 
     if (ret == 0) {
         if (partedExnRaised) {
@@ -512,7 +568,7 @@ PyObject *py_ped_device_close(PyObject *s, PyObject *args)
         return NULL;
     }
 
-    ((_ped_Device *) s)->open_count = device->open_count;
+    ((_ped_Device *) s)->open_count = _ped_DevicePool_open_count(device);
 
     if (ret) {
         Py_RETURN_TRUE;
@@ -532,7 +588,10 @@ PyObject *py_ped_device_destroy(PyObject *s, PyObject *args)
         return NULL;
     }
 
+    _ped_Lock_write(_ped_Device_lock(device));
     ped_device_destroy(device);
+    _ped_Lock_release(_ped_Device_lock(device));
+    _ped_MemoryDevice_forget(dev->path);
 
     Py_CLEAR(dev->hw_geom);
     dev->hw_geom = NULL;
@@ -555,7 +614,9 @@ PyObject *py_ped_device_cache_remove(PyObject *s, PyObject *args)
         return NULL;
     }
 
+    _ped_Lock_write(_ped_Device_lock(device));
     ped_device_cache_remove(device);
+    _ped_Lock_release(_ped_Device_lock(device));
     Py_RETURN_NONE;
 }
 
@@ -575,7 +636,11 @@ PyObject *py_ped_device_begin_external_access(PyObject *s, PyObject *args)
         return NULL;
     }
 
+    _ped_Lock_write(_ped_Device_lock(device));
+    Py_BEGIN_ALLOW_THREADS
     ret = ped_device_begin_external_access(device);
+    Py_END_ALLOW_THREADS
+    _ped_Lock_release(_ped_Device_lock(device));
 
     if (ret == 0) {
         if (partedExnRaised) {
@@ -593,6 +658,9 @@ PyObject *py_ped_device_begin_external_access(PyObject *s, PyObject *args)
 
     ((_ped_Device *) s)->external_mode = device->external_mode;
 
+    /* whatever was done to the device meanwhile is not in the cache */
+    _ped_SectorCache_invalidate(device);
+
     if (ret) {
         Py_RETURN_TRUE;
     } else {
@@ -616,7 +684,11 @@ PyObject *py_ped_device_end_external_access(PyObject *s, PyObject *args)
         return NULL;
     }
 
+    _ped_Lock_write(_ped_Device_lock(device));
+    Py_BEGIN_ALLOW_THREADS
     ret = ped_device_end_external_access(device);
+    Py_END_ALLOW_THREADS
+    _ped_Lock_release(_ped_Device_lock(device));
 
     if (ret == 0) {
         if (partedExnRaised) {
@@ -645,6 +717,7 @@ PyObject *py_ped_device_read(PyObject *s, PyObject *args)
 {
     PyObject *ret = NULL;
     PedSector start, count;
+    int ret_read = 0;
     PedDevice *device = NULL;
     char *out_buf = NULL;
 
@@ -658,7 +731,7 @@ PyObject *py_ped_device_read(PyObject *s, PyObject *args)
         return NULL;
     }
 
-    if (!device->open_count) {
+    if (!_ped_DevicePool_open_count(device)) {
         PyErr_Format(IOException, "Device %s is not open.", device->path);
         return NULL;
     }
@@ -674,7 +747,17 @@ PyObject *py_ped_device_read(PyObject *s, PyObject *args)
         return PyErr_NoMemory();
     }
 
-    if (ped_device_read(device, out_buf, start, count) == 0) {
+    /*
+     * libparted seeks and reads on the one descriptor it keeps per device,
+     * so reads are serialized like writes.
+     */
+    _ped_Lock_write(_ped_Device_lock(device));
+    Py_BEGIN_ALLOW_THREADS
+    ret_read = ped_device_read(device, out_buf, start, count);
+    Py_END_ALLOW_THREADS
+    _ped_Lock_release(_ped_Device_lock(device));
+
+    if (ret_read == 0) {
         if (partedExnRaised) {
             partedExnRaised = 0;
 
@@ -689,6 +772,7 @@ PyObject *py_ped_device_read(PyObject *s, PyObject *args)
         return NULL;
     }
 
+    STATS_READ(device, count);
     ret = PyUnicode_FromString(out_buf);
     free(out_buf);
     return ret;
@@ -717,7 +801,7 @@ PyObject *py_ped_device_write(PyObject *s, PyObject *args)
         return NULL;
     }
 
-    if (!device->open_count) {
+    if (!_ped_DevicePool_open_count(device)) {
         PyErr_Format(IOException, "Device %s is not open.", device->path);
         return NULL;
     }
@@ -727,7 +811,11 @@ PyObject *py_ped_device_write(PyObject *s, PyObject *args)
         return NULL;
     }
 
+    _ped_Lock_write(_ped_Device_lock(device));
+    Py_BEGIN_ALLOW_THREADS
     ret = ped_device_write(device, out_buf, start, count);
+    Py_END_ALLOW_THREADS
+    _ped_Lock_release(_ped_Device_lock(device));
 
     if (ret == 0) {
         if (partedExnRaised) {
@@ -743,6 +831,7 @@ PyObject *py_ped_device_write(PyObject *s, PyObject *args)
         return NULL;
     }
 
+    STATS_WRITE(device, count);
     return PyLong_FromLong(ret);
 }
 
@@ -757,7 +846,7 @@ PyObject *py_ped_device_sync(PyObject *s, PyObject *args)
         return NULL;
     }
 
-    if (!device->open_count) {
+    if (!_ped_DevicePool_open_count(device)) {
         PyErr_Format(IOException, "Device %s is not open.", device->path);
         return NULL;
     }
@@ -767,7 +856,11 @@ PyObject *py_ped_device_sync(PyObject *s, PyObject *args)
         return NULL;
     }
 
+    _ped_Lock_write(_ped_Device_lock(device));
+    Py_BEGIN_ALLOW_THREADS
     ret = ped_device_sync(device);
+    Py_END_ALLOW_THREADS
+    _ped_Lock_release(_ped_Device_lock(device));
 
     if (ret == 0) {
         if (partedExnRaised) {
@@ -801,7 +894,7 @@ PyObject *py_ped_device_sync_fast(PyObject *s, PyObject *args)
         return NULL;
     }
 
-    if (!device->open_count) {
+    if (!_ped_DevicePool_open_count(device)) {
         PyErr_Format(IOException, "Device %s is not open.", device->path);
         return NULL;
     }
@@ -811,7 +904,11 @@ PyObject *py_ped_device_sync_fast(PyObject *s, PyObject *args)
         return NULL;
     }
 
+    _ped_Lock_write(_ped_Device_lock(device));
+    Py_BEGIN_ALLOW_THREADS
     ret = ped_device_sync_fast(device);
+    Py_END_ALLOW_THREADS
+    _ped_Lock_release(_ped_Device_lock(device));
 
     if (ret == 0) {
         if (partedExnRaised) {
@@ -850,7 +947,7 @@ PyObject *py_ped_device_check(PyObject *s, PyObject *args)
         return NULL;
     }
 
-    if (!device->open_count) {
+    if (!_ped_DevicePool_open_count(device)) {
         PyErr_Format(IOException, "Device %s is not open.", device->path);
         return NULL;
     }
@@ -866,7 +963,11 @@ PyObject *py_ped_device_check(PyObject *s, PyObject *args)
         return PyErr_NoMemory();
     }
 
+    _ped_Lock_write(_ped_Device_lock(device));
+    Py_BEGIN_ALLOW_THREADS
     ret = ped_device_check(device, out_buf, start, count);
+    Py_END_ALLOW_THREADS
+    _ped_Lock_release(_ped_Device_lock(device));
     free(out_buf);
     return PyLong_FromLongLong(ret);
 }
@@ -883,7 +984,9 @@ PyObject *py_ped_device_get_constraint(PyObject *s, PyObject *args)
         return NULL;
     }
 
+    _ped_Lock_read(_ped_Device_lock(device));
     constraint = ped_device_get_constraint(device);
+    _ped_Lock_release(_ped_Device_lock(device));
 
     if (constraint) {
         ret = PedConstraint2_ped_Constraint(constraint);
@@ -908,7 +1011,15 @@ PyObject *py_ped_device_get_minimal_aligned_constraint(PyObject *s, PyObject *ar
         return NULL;
     }
 
-    constraint = ped_device_get_minimal_aligned_constraint(device);
+    constraint = _ped_MemoryDevice_constraint(device, 0);
+
+    if (constraint == NULL) {
+        _ped_Lock_read(_ped_Device_lock(device));
+        Py_BEGIN_ALLOW_THREADS
+        constraint = ped_device_get_minimal_aligned_constraint(device);
+        Py_END_ALLOW_THREADS
+        _ped_Lock_release(_ped_Device_lock(device));
+    }
 
     if (!constraint) {
         PyErr_SetString(CreateException, "Could not create constraint");
@@ -932,7 +1043,15 @@ PyObject *py_ped_device_get_optimal_aligned_constraint(PyObject *s, PyObject *ar
         return NULL;
     }
 
-    constraint = ped_device_get_optimal_aligned_constraint(device);
+    constraint = _ped_MemoryDevice_constraint(device, 1);
+
+    if (constraint == NULL) {
+        _ped_Lock_read(_ped_Device_lock(device));
+        Py_BEGIN_ALLOW_THREADS
+        constraint = ped_device_get_optimal_aligned_constraint(device);
+        Py_END_ALLOW_THREADS
+        _ped_Lock_release(_ped_Device_lock(device));
+    }
 
     if (!constraint) {
         PyErr_SetString(CreateException, "Could not create constraint");
@@ -956,7 +1075,15 @@ PyObject *py_ped_device_get_minimum_alignment(PyObject *s, PyObject *args)
         return NULL;
     }
 
-    alignment = ped_device_get_minimum_alignment(device);
+    alignment = _ped_MemoryDevice_alignment(device, 0);
+
+    if (alignment == NULL) {
+        _ped_Lock_read(_ped_Device_lock(device));
+        Py_BEGIN_ALLOW_THREADS
+        alignment = ped_device_get_minimum_alignment(device);
+        Py_END_ALLOW_THREADS
+        _ped_Lock_release(_ped_Device_lock(device));
+    }
 
     if (!alignment) {
         PyErr_SetString(CreateException, "Could not get alignment for device");
@@ -980,7 +1107,15 @@ PyObject *py_ped_device_get_optimum_alignment(PyObject *s, PyObject *args)
         return NULL;
     }
 
-    alignment = ped_device_get_optimum_alignment(device);
+    alignment = _ped_MemoryDevice_alignment(device, 1);
+
+    if (alignment == NULL) {
+        _ped_Lock_read(_ped_Device_lock(device));
+        Py_BEGIN_ALLOW_THREADS
+        alignment = ped_device_get_optimum_alignment(device);
+        Py_END_ALLOW_THREADS
+        _ped_Lock_release(_ped_Device_lock(device));
+    }
 
     if (!alignment) {
         PyErr_SetString(CreateException, "Could not get alignment for device");
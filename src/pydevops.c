@@ -0,0 +1,310 @@
+/*
+ * pydevops.c
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <Python.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "pycache.h"
+#include "pydevops.h"
+#include "pypool.h"
+#include "pytrace.h"
+
+PedDeviceArchOps _ped_DevOps_orig;
+
+static int installed = 0;
+
+/*
+ * Devices held read-only by a read-only Disk.  Any thread may do I/O on
+ * them, with or without the GIL, so the list has a mutex of its own.
+ */
+typedef struct _ped_ReadOnly {
+    const PedDevice *dev;
+    int holds;
+
+    /* our descriptor while libparted has the device open, else -1 */
+    int fd;
+
+    /* dev->read_only before we opened it */
+    int saved;
+
+    struct _ped_ReadOnly *next;
+} _ped_ReadOnly;
+
+static pthread_mutex_t read_only_mutex = PTHREAD_MUTEX_INITIALIZER;
+static _ped_ReadOnly *read_only_list = NULL;
+
+/* Called with read_only_mutex held. */
+static _ped_ReadOnly **read_only_find(const PedDevice *dev)
+{
+    _ped_ReadOnly **link = &read_only_list;
+
+    while (*link != NULL && (*link)->dev != dev) {
+        link = &(*link)->next;
+    }
+
+    return link;
+}
+
+/* Called with read_only_mutex held, drops the entry once nothing uses it. */
+static void read_only_drop(_ped_ReadOnly **link, int force)
+{
+    _ped_ReadOnly *entry = *link;
+
+    if (force || (entry->holds == 0 && entry->fd == -1)) {
+        if (entry->fd != -1) {
+            close(entry->fd);
+        }
+
+        *link = entry->next;
+        free(entry);
+    }
+}
+
+/* Our descriptor for dev if it is open read-only, else -1. */
+static int read_only_fd(const PedDevice *dev)
+{
+    _ped_ReadOnly *entry = NULL;
+    int fd;
+
+    pthread_mutex_lock(&read_only_mutex);
+    entry = *read_only_find(dev);
+    fd = entry ? entry->fd : -1;
+    pthread_mutex_unlock(&read_only_mutex);
+    return fd;
+}
+
+int _ped_DevOps_read_only_hold(const PedDevice *dev)
+{
+    _ped_ReadOnly *entry = NULL;
+
+    pthread_mutex_lock(&read_only_mutex);
+    entry = *read_only_find(dev);
+
+    if (entry == NULL && (entry = malloc(sizeof(*entry))) != NULL) {
+        entry->dev = dev;
+        entry->holds = 0;
+        entry->fd = -1;
+        entry->saved = 0;
+        entry->next = read_only_list;
+        read_only_list = entry;
+    }
+
+    if (entry != NULL) {
+        entry->holds++;
+    }
+
+    pthread_mutex_unlock(&read_only_mutex);
+    return entry ? 0 : -1;
+}
+
+void _ped_DevOps_read_only_release(const PedDevice *dev)
+{
+    _ped_ReadOnly **link = NULL;
+
+    pthread_mutex_lock(&read_only_mutex);
+    link = read_only_find(dev);
+
+    if (*link != NULL) {
+        (*link)->holds--;
+        read_only_drop(link, 0);
+    }
+
+    pthread_mutex_unlock(&read_only_mutex);
+}
+
+int _ped_DevOps_is_read_only(const PedDevice *dev)
+{
+    return read_only_fd(dev) != -1;
+}
+
+/* Reads from the device itself, below the cache. */
+int _ped_DevOps_read_raw(const PedDevice *dev, void *buffer, PedSector start, PedSector count)
+{
+    size_t size = count * dev->sector_size, done = 0;
+    off_t offset = start * dev->sector_size;
+    ssize_t n;
+    int fd = read_only_fd(dev);
+
+    if (fd == -1) {
+        return _ped_DevOps_orig.read(dev, buffer, start, count);
+    }
+
+    while (done < size) {
+        n = pread(fd, (char *) buffer + done, size - done, offset + done);
+
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+
+        if (n <= 0) {
+            ped_exception_throw(PED_EXCEPTION_ERROR, PED_EXCEPTION_CANCEL, "%s during read on %s",
+                                n == 0 ? "end of file" : strerror(errno), dev->path);
+            return 0;
+        }
+
+        done += n;
+    }
+
+    return 1;
+}
+
+/* First open of a held device: a read-only descriptor, and no flushing. */
+static int devops_open(PedDevice *dev)
+{
+    _ped_ReadOnly *entry = NULL;
+    int fd;
+
+    pthread_mutex_lock(&read_only_mutex);
+    entry = *read_only_find(dev);
+
+    if (entry == NULL || entry->holds == 0 || entry->fd != -1) {
+        pthread_mutex_unlock(&read_only_mutex);
+        return _ped_DevOps_orig.open(dev);
+    }
+
+    fd = open(dev->path, O_RDONLY | O_CLOEXEC);
+
+    if (fd == -1) {
+        pthread_mutex_unlock(&read_only_mutex);
+        ped_exception_throw(PED_EXCEPTION_ERROR, PED_EXCEPTION_CANCEL, "Error opening %s: %s", dev->path, strerror(errno));
+        return 0;
+    }
+
+    entry->fd = fd;
+    entry->saved = dev->read_only;
+    dev->read_only = 1;
+    pthread_mutex_unlock(&read_only_mutex);
+    return 1;
+}
+
+static int devops_close(PedDevice *dev)
+{
+    _ped_ReadOnly **link = NULL;
+
+    pthread_mutex_lock(&read_only_mutex);
+    link = read_only_find(dev);
+
+    if (*link == NULL || (*link)->fd == -1) {
+        pthread_mutex_unlock(&read_only_mutex);
+        return _ped_DevOps_orig.close(dev);
+    }
+
+    close((*link)->fd);
+    (*link)->fd = -1;
+    dev->read_only = (*link)->saved;
+    read_only_drop(link, 0);
+    pthread_mutex_unlock(&read_only_mutex);
+    return 1;
+}
+
+/* libparted opening an open device, it may only be open in the pool */
+static int devops_refresh_open(PedDevice *dev)
+{
+    _ped_DevicePool_refresh(dev);
+    return _ped_DevOps_orig.refresh_open(dev);
+}
+
+/* requests are traced as libparted makes them, before the cache */
+static int devops_read(const PedDevice *dev, void *buffer, PedSector start, PedSector count)
+{
+    _ped_Trace_record(dev, TRACE_READ, start, count);
+    return _ped_SectorCache_read(dev, buffer, start, count);
+}
+
+static int devops_write(PedDevice *dev, const void *buffer, PedSector start, PedSector count)
+{
+    _ped_Trace_record(dev, TRACE_WRITE, start, count);
+
+    if (_ped_DevOps_is_read_only(dev)) {
+        ped_exception_throw(PED_EXCEPTION_ERROR, PED_EXCEPTION_CANCEL, "Can't write to %s, because it is opened read-only.", dev->path);
+        return 0;
+    }
+
+    return _ped_SectorCache_write(dev, buffer, start, count);
+}
+
+static PedSector devops_check(PedDevice *dev, void *buffer, PedSector start, PedSector count)
+{
+    _ped_Trace_record(dev, TRACE_READ, start, count);
+
+    if (_ped_DevOps_is_read_only(dev)) {
+        return _ped_DevOps_read_raw(dev, buffer, start, count) ? count : 0;
+    }
+
+    return _ped_DevOps_orig.check(dev, buffer, start, count);
+}
+
+static int devops_sync(PedDevice *dev)
+{
+    _ped_Trace_record(dev, TRACE_SYNC, 0, 0);
+
+    if (_ped_DevOps_is_read_only(dev)) {
+        return 1;
+    }
+
+    _ped_SectorCache_invalidate(dev);
+    return _ped_DevOps_orig.sync(dev);
+}
+
+static int devops_sync_fast(PedDevice *dev)
+{
+    _ped_Trace_record(dev, TRACE_SYNC, 0, 0);
+
+    if (_ped_DevOps_is_read_only(dev)) {
+        return 1;
+    }
+
+    _ped_SectorCache_invalidate(dev);
+    return _ped_DevOps_orig.sync_fast(dev);
+}
+
+/* a destroyed PedDevice's address may be reused, so drop what we keep */
+static void devops_destroy(PedDevice *dev)
+{
+    _ped_ReadOnly **link = NULL;
+
+    pthread_mutex_lock(&read_only_mutex);
+    link = read_only_find(dev);
+
+    if (*link != NULL) {
+        read_only_drop(link, 1);
+    }
+
+    pthread_mutex_unlock(&read_only_mutex);
+
+    _ped_Trace_forget(dev);
+    _ped_SectorCache_forget(dev);
+    _ped_DevicePool_forget(dev);
+    _ped_DevOps_orig.destroy(dev);
+}
+
+/* Called with the GIL held, so only one thread can get here at a time. */
+void _ped_DevOps_install(void)
+{
+    PedDeviceArchOps *ops = ped_architecture->dev_ops;
+
+    if (installed) {
+        return;
+    }
+
+    _ped_DevOps_orig = *ops;
+    ops->open = devops_open;
+    ops->refresh_open = devops_refresh_open;
+    ops->close = devops_close;
+    ops->read = devops_read;
+    ops->write = devops_write;
+    ops->check = devops_check;
+    ops->sync = devops_sync;
+    ops->sync_fast = devops_sync_fast;
+    ops->destroy = devops_destroy;
+    installed = 1;
+}
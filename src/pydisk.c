@@ -11,15 +11,45 @@
 
 #include "convert.h"
 #include "exceptions.h"
+#include "pyargs.h"
+#include "pydevops.h"
 #include "pydisk.h"
+#include "pyfilesys.h"
+#include "pyfreelist.h"
+#include "pylayout.h"
+#include "pylock.h"
+#include "pypool.h"
+#include "pysnapshot.h"
+#include "pystamp.h"
 #include "docstrings/pydisk.h"
 #include "typeobjects/pydisk.h"
 
+/* lock guarding the PedDisk a _ped.Disk wraps */
+#define DISK_LOCK(s) (&((_ped_Disk *) (s))->lock)
+
+/* lock guarding the PedDisk a _ped.Partition belongs to */
+static _ped_Lock *partition_lock(_ped_Partition *part)
+{
+    if (part == NULL || part->disk == NULL) {
+        return NULL;
+    }
+
+    return DISK_LOCK(part->disk);
+}
+
+static _ped_FreeList partition_freelist = FREELIST_INIT(&_ped_Partition_Type_obj);
+
 /* _ped.Partition functions */
+PyObject *_ped_Partition_alloc(PyTypeObject *type, Py_ssize_t nitems)
+{
+    return _ped_FreeList_alloc(&partition_freelist, type, nitems);
+}
+
 void _ped_Partition_dealloc(_ped_Partition *self)
 {
     PyObject_GC_UnTrack(self);
 
+    _ped_Disk_untrack_partition(self);
     Py_CLEAR(self->disk);
     self->disk = NULL;
 
@@ -29,7 +59,7 @@ void _ped_Partition_dealloc(_ped_Partition *self)
     Py_CLEAR(self->fs_type);
     self->fs_type = NULL;
 
-    PyObject_GC_Del(self);
+    _ped_FreeList_free(&partition_freelist, (PyObject *) self);
 }
 
 int _ped_Partition_compare(_ped_Partition *self, PyObject *obj)
@@ -131,6 +161,7 @@ int _ped_Partition_traverse(_ped_Partition *self, visitproc visit, void *arg)
 
 int _ped_Partition_clear(_ped_Partition *self)
 {
+    _ped_Disk_untrack_partition(self);
     Py_CLEAR(self->disk);
     self->disk = NULL;
 
@@ -151,6 +182,7 @@ int _ped_Partition_init(_ped_Partition *self, PyObject *args, PyObject *kwds)
     PedFileSystemType *fstype = NULL;
     PedPartition *part = NULL;
 
+    _ped_Disk_untrack_partition(self);
     self->fs_type = Py_None;
 
     if (kwds == NULL) {
@@ -181,7 +213,9 @@ int _ped_Partition_init(_ped_Partition *self, PyObject *args, PyObject *kwds)
         fstype = _ped_FileSystemType2PedFileSystemType(self->fs_type);
     }
 
+    _ped_Lock_read(DISK_LOCK(self->disk));
     part = ped_partition_new(disk, self->type, fstype, start, end);
+    _ped_Lock_release(DISK_LOCK(self->disk));
 
     if (part == NULL) {
         if (partedExnRaised) {
@@ -224,11 +258,18 @@ int _ped_Partition_init(_ped_Partition *self, PyObject *args, PyObject *kwds)
         return -4;
     }
 
-    self->ped_partition = part;
-
     /* On creation the object is not owned by any disk */
     self->_owned = 0;
 
+    if (_ped_Disk_track_partition(self) == -1) {
+        Py_CLEAR(self->disk);
+        Py_CLEAR(self->fs_type);
+        Py_CLEAR(self->geom);
+        ped_partition_destroy(part);
+        return -5;
+    }
+
+    self->ped_partition = part;
     return 0;
 }
 
@@ -261,6 +302,10 @@ int _ped_Partition_set(_ped_Partition *self, PyObject *value, void *closure)
     }
 
     if (!strcmp(member, "type")) {
+        if (_ped_Disk_check_writable(self->disk) == -1) {
+            return -1;
+        }
+
         self->type = PyLong_AsLong(value);
 
         if (PyErr_Occurred()) {
@@ -275,12 +320,266 @@ int _ped_Partition_set(_ped_Partition *self, PyObject *value, void *closure)
 }
 
 /* _ped.Disk functions */
+/* next _ped.Disk serial, only touched with the GIL held */
+static unsigned long long disk_serial = 0;
+
+PyObject *_ped_Disk_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    _ped_Disk *self = NULL;
+
+    self = (_ped_Disk *) PyType_GenericNew(type, args, kwds);
+
+    if (self == NULL) {
+        return NULL;
+    }
+
+    self->serial = ++disk_serial;
+
+    if (_ped_Lock_init(&self->lock) == -1) {
+        Py_DECREF(self);
+        return NULL;
+    }
+
+    return (PyObject *) self;
+}
+
+/* destroy the partitions restore() took off the disk */
+static void disk_free_detached(_ped_Disk *self)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i < self->n_detached; i++) {
+        ped_partition_destroy(self->detached[i]);
+    }
+
+    PyMem_Free(self->detached);
+    self->detached = NULL;
+    self->n_detached = self->detached_size = 0;
+}
+
+/*
+ * Take part off the disk without destroying it.  Returns 1 on success, 0
+ * if libparted refused and -1 with an exception set if out of memory.
+ * The caller must hold the disk lock for writing.
+ */
+int _ped_Disk_detach(_ped_Disk *self, PedPartition *part)
+{
+    if (self->n_detached == self->detached_size) {
+        Py_ssize_t size = self->detached_size ? self->detached_size * 2 : 16;
+        PedPartition **detached = PyMem_Resize(self->detached, PedPartition *, size);
+
+        if (detached == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+
+        self->detached = detached;
+        self->detached_size = size;
+    }
+
+    if (!ped_disk_remove_partition(self->ped_disk, part)) {
+        return 0;
+    }
+
+    self->detached[self->n_detached++] = part;
+    return 1;
+}
+
+static int pointer_compare(const void *a, const void *b)
+{
+    const void *pa = *(const void * const *) a, *pb = *(const void * const *) b;
+
+    return (pa > pb) - (pa < pb);
+}
+
+/*
+ * Destroy the detached partitions no live _ped.Partition points at.  If
+ * there is no memory to find out, they are all kept for another time.
+ * The caller must hold the disk lock for writing.
+ */
+void _ped_Disk_free_detached(_ped_Disk *self)
+{
+    PedPartition **used = NULL;
+    Py_ssize_t i, kept = 0;
+
+    if (self->n_detached == 0) {
+        return;
+    }
+
+    used = PyMem_New(PedPartition *, self->n_live > 0 ? self->n_live : 1);
+
+    if (used == NULL) {
+        return;
+    }
+
+    for (i = 0; i < self->n_live; i++) {
+        used[i] = self->live[i]->ped_partition;
+    }
+
+    qsort(used, self->n_live, sizeof(*used), pointer_compare);
+
+    for (i = 0; i < self->n_detached; i++) {
+        if (bsearch(&self->detached[i], used, self->n_live, sizeof(*used), pointer_compare)) {
+            self->detached[kept++] = self->detached[i];
+        } else {
+            ped_partition_destroy(self->detached[i]);
+        }
+    }
+
+    self->n_detached = kept;
+    PyMem_Free(used);
+}
+
+/*
+ * Add part to the live objects of its disk.  Returns -1 with an exception
+ * set if out of memory.
+ */
+int _ped_Disk_track_partition(_ped_Partition *part)
+{
+    _ped_Disk *disk = (_ped_Disk *) part->disk;
+
+    if (part->live != 0) {
+        return 0;
+    }
+
+    if (disk->n_live == disk->live_size) {
+        Py_ssize_t size = disk->live_size ? disk->live_size * 2 : 16;
+        _ped_Partition **live = PyMem_Resize(disk->live, _ped_Partition *, size);
+
+        if (live == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+
+        disk->live = live;
+        disk->live_size = size;
+    }
+
+    disk->live[disk->n_live++] = part;
+    part->live = disk->n_live;
+    return 0;
+}
+
+/* Take part off the live objects of its disk, before it lets go of the disk. */
+void _ped_Disk_untrack_partition(_ped_Partition *part)
+{
+    _ped_Disk *disk = (_ped_Disk *) part->disk;
+    _ped_Partition *last = NULL;
+
+    if (part->live == 0 || disk == NULL) {
+        return;
+    }
+
+    last = disk->live[--disk->n_live];
+    disk->live[part->live - 1] = last;
+    last->live = part->live;
+    part->live = 0;
+}
+
+/*
+ * Returns -1 with an exception set if s was opened read-only, so changes
+ * are refused before anything is touched rather than at commit time.
+ */
+int _ped_Disk_check_writable(PyObject *s)
+{
+    _ped_Disk *disk = (_ped_Disk *) s;
+
+    if (disk != NULL && disk->read_only) {
+        PyErr_Format(DiskException, "Disk on %s is read-only", disk->ped_disk ? disk->ped_disk->dev->path : "(destroyed)");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int partition_check_writable(_ped_Partition *part)
+{
+    return _ped_Disk_check_writable(part->disk);
+}
+
+/*
+ * Hold device read-only and open it, so it stays open through our own
+ * descriptor until disk_read_only_end().  Called without the GIL and with
+ * the device lock held.  Returns 0, with a libparted exception raised, on
+ * failure.
+ */
+static int disk_read_only_begin(PedDevice *device)
+{
+    if (_ped_DevOps_read_only_hold(device) == -1) {
+        ped_exception_throw(PED_EXCEPTION_ERROR, PED_EXCEPTION_CANCEL, "Out of memory.");
+        return 0;
+    }
+
+    /* an idle pooled open is read-write, let go of it to open read-only */
+    _ped_DevicePool_evict(device);
+
+    if (!ped_device_open(device)) {
+        _ped_DevOps_read_only_release(device);
+        return 0;
+    }
+
+    return 1;
+}
+
+static void disk_read_only_end(PedDevice *device)
+{
+    _ped_Lock_write(_ped_Device_lock(device));
+    Py_BEGIN_ALLOW_THREADS
+    ped_device_close(device);
+    _ped_DevOps_read_only_release(device);
+    Py_END_ALLOW_THREADS
+    _ped_Lock_release(_ped_Device_lock(device));
+}
+
+/*
+ * ped_disk_new(), with the device opened read-only and without flushing
+ * its buffer caches if read_only is set.  Nothing on a read-only Disk is
+ * ever written, so there is nothing to flush when it goes away either.
+ * A read-only Disk keeps that open until it is freed, so everything done
+ * through it later, such as probing or checking, reads the same way.
+ */
+static PedDisk *disk_read(PedDevice *device, int read_only)
+{
+    PedDisk *disk = NULL;
+
+    if (read_only) {
+        _ped_DevOps_install();
+    }
+
+    _ped_Lock_write(_ped_Device_lock(device));
+    Py_BEGIN_ALLOW_THREADS
+
+    if (!read_only || disk_read_only_begin(device)) {
+        disk = ped_disk_new(device);
+
+        if (disk == NULL && read_only) {
+            ped_device_close(device);
+            _ped_DevOps_read_only_release(device);
+        }
+    }
+
+    Py_END_ALLOW_THREADS
+    _ped_Lock_release(_ped_Device_lock(device));
+    return disk;
+}
+
 void _ped_Disk_dealloc(_ped_Disk *self)
 {
     if (self->ped_disk) {
+        PedDevice *device = self->ped_disk->dev;
+
+        disk_free_detached(self);
         ped_disk_destroy(self->ped_disk);
+
+        if (self->read_only) {
+            disk_read_only_end(device);
+        }
     }
 
+    PyMem_Free(self->live);
+
+    _ped_Lock_destroy(&self->lock);
+
     PyObject_GC_UnTrack(self);
 
     Py_CLEAR(self->dev);
@@ -385,17 +684,18 @@ int _ped_Disk_clear(_ped_Disk *self)
 
 int _ped_Disk_init(_ped_Disk *self, PyObject *args, PyObject *kwds)
 {
-    static char *kwlist[] = {"dev", NULL};
+    static char *kwlist[] = {"dev", "read_only", NULL};
     PedDevice *device = NULL;
     PedDisk *disk = NULL;
+    int read_only = 0;
 
     if (kwds == NULL) {
-        if (!PyArg_ParseTuple(args, "O!", &_ped_Device_Type_obj, &self->dev)) {
+        if (!PyArg_ParseTuple(args, "O!|p", &_ped_Device_Type_obj, &self->dev, &read_only)) {
             self->dev = NULL;
             return -1;
         }
     } else {
-        if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!", kwlist, &_ped_Device_Type_obj, &self->dev)) {
+        if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!|p", kwlist, &_ped_Device_Type_obj, &self->dev, &read_only)) {
             self->dev = NULL;
             return -2;
         }
@@ -408,7 +708,12 @@ int _ped_Disk_init(_ped_Disk *self, PyObject *args, PyObject *kwds)
         return -3;
     }
 
-    disk = ped_disk_new(device);
+    if (!read_only && _ped_Device_check_writable(device) == -1) {
+        self->dev = NULL;
+        return -5;
+    }
+
+    disk = disk_read(device, read_only);
 
     if (disk == NULL) {
         if (partedExnRaised) {
@@ -428,15 +733,16 @@ int _ped_Disk_init(_ped_Disk *self, PyObject *args, PyObject *kwds)
     Py_INCREF(self->dev);
     self->type = (PyObject *) PedDiskType2_ped_DiskType((PedDiskType *) disk->type);
     self->ped_disk = disk;
+    self->read_only = read_only;
+    self->serial = ++disk_serial;
     return 0;
 }
 
 /* _ped.DiskType functions */
 void _ped_DiskType_dealloc(_ped_DiskType *self)
 {
-    PyObject_GC_UnTrack(self);
     free(self->name);
-    PyObject_GC_Del(self);
+    Py_TYPE(self)->tp_free((PyObject *) self);
 }
 
 int _ped_DiskType_compare(_ped_DiskType *self, PyObject *obj)
@@ -499,16 +805,6 @@ PyObject *_ped_DiskType_str(_ped_DiskType *self)
     return ret;
 }
 
-int _ped_DiskType_traverse(_ped_DiskType *self, visitproc visit, void *arg)
-{
-    return 0;
-}
-
-int _ped_DiskType_clear(_ped_DiskType *self)
-{
-    return 0;
-}
-
 PyObject *_ped_DiskType_get(_ped_DiskType *self, void *closure)
 {
     char *member = (char *) closure;
@@ -625,7 +921,11 @@ PyObject *py_ped_disk_clobber(PyObject *s, PyObject *args)
         return NULL;
     }
 
+    _ped_Lock_write(_ped_Device_lock(device));
+    Py_BEGIN_ALLOW_THREADS
     ret = ped_disk_clobber(device);
+    Py_END_ALLOW_THREADS
+    _ped_Lock_release(_ped_Device_lock(device));
 
     if (ret == 0) {
         if (partedExnRaised) {
@@ -653,7 +953,9 @@ PyObject *py_ped_disk_duplicate(PyObject *s, PyObject *args)
     disk = _ped_Disk2PedDisk(s);
 
     if (disk) {
+        _ped_Lock_read(DISK_LOCK(s));
         pass_disk = ped_disk_duplicate(disk);
+        _ped_Lock_release(DISK_LOCK(s));
 
         if (pass_disk == NULL) {
             if (partedExnRaised) {
@@ -673,6 +975,34 @@ PyObject *py_ped_disk_duplicate(PyObject *s, PyObject *args)
         if (ret == NULL) {
             return NULL;
         }
+
+        /* the copy holds the device read-only for itself */
+        if (((_ped_Disk *) s)->read_only) {
+            int ok;
+
+            _ped_Lock_write(_ped_Device_lock(pass_disk->dev));
+            Py_BEGIN_ALLOW_THREADS
+            ok = disk_read_only_begin(pass_disk->dev);
+            Py_END_ALLOW_THREADS
+            _ped_Lock_release(_ped_Device_lock(pass_disk->dev));
+
+            if (!ok) {
+                if (partedExnRaised) {
+                    partedExnRaised = 0;
+
+                    if (!PyErr_ExceptionMatches(PartedException) && !PyErr_ExceptionMatches(PyExc_NotImplementedError)) {
+                        PyErr_SetString(IOException, partedExnMessage);
+                    }
+                } else {
+                    PyErr_Format(IOException, "Could not open device %s read-only", pass_disk->dev->path);
+                }
+
+                Py_DECREF(ret);
+                return NULL;
+            }
+
+            ret->read_only = 1;
+        }
     } else {
         return NULL;
     }
@@ -699,7 +1029,11 @@ PyObject *py_ped_disk_destroy(PyObject *s, PyObject *args)
         return NULL;
     }
 
+    _ped_Lock_write(DISK_LOCK(s));
+    disk_free_detached((_ped_Disk *) s);
     ped_disk_destroy(disk);
+    ((_ped_Disk *) s)->ped_disk = NULL;
+    _ped_Lock_release(DISK_LOCK(s));
     Py_CLEAR(s);
 
     Py_RETURN_NONE;
@@ -710,10 +1044,20 @@ PyObject *py_ped_disk_commit(PyObject *s, PyObject *args)
     PedDisk *disk = NULL;
     int ret = 0;
 
+    if (_ped_Disk_check_writable(s) == -1) {
+        return NULL;
+    }
+
     disk = _ped_Disk2PedDisk(s);
 
     if (disk) {
+        _ped_Lock_read(DISK_LOCK(s));
+        _ped_Lock_write(_ped_Device_lock(disk->dev));
+        Py_BEGIN_ALLOW_THREADS
         ret = ped_disk_commit(disk);
+        Py_END_ALLOW_THREADS
+        _ped_Lock_release(_ped_Device_lock(disk->dev));
+        _ped_Lock_release(DISK_LOCK(s));
 
         if (ret == 0) {
             if (partedExnRaised) {
@@ -742,10 +1086,20 @@ PyObject *py_ped_disk_commit_to_dev(PyObject *s, PyObject *args)
     PedDisk *disk = NULL;
     int ret = 0;
 
+    if (_ped_Disk_check_writable(s) == -1) {
+        return NULL;
+    }
+
     disk = _ped_Disk2PedDisk(s);
 
     if (disk) {
+        _ped_Lock_read(DISK_LOCK(s));
+        _ped_Lock_write(_ped_Device_lock(disk->dev));
+        Py_BEGIN_ALLOW_THREADS
         ret = ped_disk_commit_to_dev(disk);
+        Py_END_ALLOW_THREADS
+        _ped_Lock_release(_ped_Device_lock(disk->dev));
+        _ped_Lock_release(DISK_LOCK(s));
 
         if (ret == 0) {
             if (partedExnRaised) {
@@ -774,9 +1128,19 @@ PyObject *py_ped_disk_commit_to_os(PyObject *s, PyObject *args)
     PedDisk *disk = NULL;
     int ret = 0;
 
+    if (_ped_Disk_check_writable(s) == -1) {
+        return NULL;
+    }
+
     disk = _ped_Disk2PedDisk(s);
     if (disk) {
+        _ped_Lock_read(DISK_LOCK(s));
+        _ped_Lock_write(_ped_Device_lock(disk->dev));
+        Py_BEGIN_ALLOW_THREADS
         ret = ped_disk_commit_to_os(disk);
+        Py_END_ALLOW_THREADS
+        _ped_Lock_release(_ped_Device_lock(disk->dev));
+        _ped_Lock_release(DISK_LOCK(s));
         if (ret == 0) {
             if (partedExnRaised) {
                 partedExnRaised = 0;
@@ -807,7 +1171,11 @@ PyObject *py_ped_disk_check(PyObject *s, PyObject *args)
     disk = _ped_Disk2PedDisk(s);
 
     if (disk) {
+        _ped_Lock_read(DISK_LOCK(s));
+        Py_BEGIN_ALLOW_THREADS
         ret = ped_disk_check(disk);
+        Py_END_ALLOW_THREADS
+        _ped_Lock_release(DISK_LOCK(s));
 
         if (ret == 0) {
             if (partedExnRaised) {
@@ -838,7 +1206,9 @@ PyObject *py_ped_disk_print(PyObject *s, PyObject *args)
     disk = _ped_Disk2PedDisk(s);
 
     if (disk) {
+        _ped_Lock_read(DISK_LOCK(s));
         ped_disk_print(disk);
+        _ped_Lock_release(DISK_LOCK(s));
     }
 
     Py_RETURN_NONE;
@@ -852,7 +1222,9 @@ PyObject *py_ped_disk_get_primary_partition_count(PyObject *s, PyObject *args)
     disk = _ped_Disk2PedDisk(s);
 
     if (disk) {
+        _ped_Lock_read(DISK_LOCK(s));
         ret = ped_disk_get_primary_partition_count(disk);
+        _ped_Lock_release(DISK_LOCK(s));
     }
 
     return PyLong_FromLong(ret);
@@ -866,7 +1238,9 @@ PyObject *py_ped_disk_get_last_partition_num(PyObject *s, PyObject *args)
     disk = _ped_Disk2PedDisk(s);
 
     if (disk) {
+        _ped_Lock_read(DISK_LOCK(s));
         ret = ped_disk_get_last_partition_num(disk);
+        _ped_Lock_release(DISK_LOCK(s));
     }
 
     return PyLong_FromLong(ret);
@@ -880,7 +1254,9 @@ PyObject *py_ped_disk_get_max_primary_partition_count(PyObject *s, PyObject *arg
     disk = _ped_Disk2PedDisk(s);
 
     if (disk) {
+        _ped_Lock_read(DISK_LOCK(s));
         ret = ped_disk_get_max_primary_partition_count(disk);
+        _ped_Lock_release(DISK_LOCK(s));
     }
 
     return PyLong_FromLong(ret);
@@ -891,9 +1267,17 @@ PyObject *py_ped_disk_get_max_supported_partition_count(PyObject *s, PyObject *a
     PedDisk *disk = NULL;
     int max = 0;
 
+    int ret = 0;
+
     disk = _ped_Disk2PedDisk(s);
 
-    if (disk && ped_disk_get_max_supported_partition_count(disk, &max) == true) {
+    if (disk) {
+        _ped_Lock_read(DISK_LOCK(s));
+        ret = ped_disk_get_max_supported_partition_count(disk, &max);
+        _ped_Lock_release(DISK_LOCK(s));
+    }
+
+    if (ret == true) {
         return Py_BuildValue("i", max);
     }
 
@@ -912,7 +1296,9 @@ PyObject *py_ped_disk_get_partition_alignment(PyObject *s, PyObject *args)
         return NULL;
     }
 
+    _ped_Lock_read(DISK_LOCK(s));
     alignment = ped_disk_get_partition_alignment(disk);
+    _ped_Lock_release(DISK_LOCK(s));
 
     if (!alignment) {
         PyErr_SetString(CreateException, "Could not get alignment for device");
@@ -927,6 +1313,7 @@ PyObject *py_ped_disk_get_partition_alignment(PyObject *s, PyObject *args)
 PyObject *py_ped_disk_max_partition_length(PyObject *s, PyObject *args)
 {
     PedDisk *disk = NULL;
+    PedSector ret;
 
     disk = _ped_Disk2PedDisk(s);
 
@@ -934,12 +1321,17 @@ PyObject *py_ped_disk_max_partition_length(PyObject *s, PyObject *args)
         return NULL;
     }
 
-    return PyLong_FromUnsignedLongLong(ped_disk_max_partition_length(disk));
+    _ped_Lock_read(DISK_LOCK(s));
+    ret = ped_disk_max_partition_length(disk);
+    _ped_Lock_release(DISK_LOCK(s));
+
+    return PyLong_FromUnsignedLongLong(ret);
 }
 
 PyObject *py_ped_disk_max_partition_start_sector(PyObject *s, PyObject *args)
 {
     PedDisk *disk = NULL;
+    PedSector ret;
 
     disk = _ped_Disk2PedDisk(s);
 
@@ -947,15 +1339,25 @@ PyObject *py_ped_disk_max_partition_start_sector(PyObject *s, PyObject *args)
         return NULL;
     }
 
-    return PyLong_FromUnsignedLongLong(ped_disk_max_partition_start_sector(disk));
+    _ped_Lock_read(DISK_LOCK(s));
+    ret = ped_disk_max_partition_start_sector(disk);
+    _ped_Lock_release(DISK_LOCK(s));
+
+    return PyLong_FromUnsignedLongLong(ret);
 }
 
-PyObject *py_ped_disk_set_flag(PyObject *s, PyObject *args)
+PyObject *py_ped_disk_set_flag(PyObject *s, PyObject *const *args, Py_ssize_t nargs)
 {
     int ret, flag, state;
     PedDisk *disk = NULL;
 
-    if (!PyArg_ParseTuple(args, "ii", &flag, &state)) {
+    if (_ped_args_count("set_flag", nargs, 2, 2) == -1 ||
+        _ped_args_int(args[0], &flag) == -1 ||
+        _ped_args_int(args[1], &state) == -1) {
+        return NULL;
+    }
+
+    if (_ped_Disk_check_writable(s) == -1) {
         return NULL;
     }
 
@@ -965,7 +1367,9 @@ PyObject *py_ped_disk_set_flag(PyObject *s, PyObject *args)
         return NULL;
     }
 
+    _ped_Lock_write(DISK_LOCK(s));
     ret = ped_disk_set_flag(disk, flag, state);
+    _ped_Lock_release(DISK_LOCK(s));
 
     if (ret == 0) {
         if (partedExnRaised) {
@@ -984,12 +1388,13 @@ PyObject *py_ped_disk_set_flag(PyObject *s, PyObject *args)
     Py_RETURN_TRUE;
 }
 
-PyObject *py_ped_disk_get_flag(PyObject *s, PyObject *args)
+PyObject *py_ped_disk_get_flag(PyObject *s, PyObject *const *args, Py_ssize_t nargs)
 {
-    int flag;
+    int flag, ret;
     PedDisk *disk = NULL;
 
-    if (!PyArg_ParseTuple(args, "i", &flag)) {
+    if (_ped_args_count("get_flag", nargs, 1, 1) == -1 ||
+        _ped_args_int(args[0], &flag) == -1) {
         return NULL;
     }
 
@@ -999,19 +1404,24 @@ PyObject *py_ped_disk_get_flag(PyObject *s, PyObject *args)
         return NULL;
     }
 
-    if (ped_disk_get_flag(disk, flag)) {
+    _ped_Lock_read(DISK_LOCK(s));
+    ret = ped_disk_get_flag(disk, flag);
+    _ped_Lock_release(DISK_LOCK(s));
+
+    if (ret) {
         Py_RETURN_TRUE;
     } else {
         Py_RETURN_FALSE;
     }
 }
 
-PyObject *py_ped_disk_is_flag_available(PyObject *s, PyObject *args)
+PyObject *py_ped_disk_is_flag_available(PyObject *s, PyObject *const *args, Py_ssize_t nargs)
 {
-    int flag;
+    int flag, ret;
     PedDisk *disk = NULL;
 
-    if (!PyArg_ParseTuple(args, "i", &flag)) {
+    if (_ped_args_count("is_flag_available", nargs, 1, 1) == -1 ||
+        _ped_args_int(args[0], &flag) == -1) {
         return NULL;
     }
 
@@ -1021,7 +1431,11 @@ PyObject *py_ped_disk_is_flag_available(PyObject *s, PyObject *args)
         return NULL;
     }
 
-    if (ped_disk_is_flag_available(disk, flag)) {
+    _ped_Lock_read(DISK_LOCK(s));
+    ret = ped_disk_is_flag_available(disk, flag);
+    _ped_Lock_release(DISK_LOCK(s));
+
+    if (ret) {
         Py_RETURN_TRUE;
     } else {
         Py_RETURN_FALSE;
@@ -1096,13 +1510,19 @@ PyObject *py_ped_partition_destroy(_ped_Partition *s, PyObject *args)
 {
     PedPartition *partition = NULL;
 
+    if (partition_check_writable(s) == -1) {
+        return NULL;
+    }
+
     partition = _ped_Partition2PedPartition(s);
 
     if (partition == NULL) {
         return NULL;
     }
 
+    _ped_Lock_write(partition_lock(s));
     ped_partition_destroy(partition);
+    _ped_Lock_release(partition_lock(s));
     Py_CLEAR(s);
 
     Py_RETURN_NONE;
@@ -1116,7 +1536,9 @@ PyObject *py_ped_partition_is_active(_ped_Partition *s, PyObject *args)
     partition = _ped_Partition2PedPartition(s);
 
     if (partition) {
+        _ped_Lock_read(partition_lock(s));
         ret = ped_partition_is_active(partition);
+        _ped_Lock_release(partition_lock(s));
     }
 
     if (ret) {
@@ -1126,14 +1548,20 @@ PyObject *py_ped_partition_is_active(_ped_Partition *s, PyObject *args)
     }
 }
 
-PyObject *py_ped_partition_set_flag(_ped_Partition *s, PyObject *args)
+PyObject *py_ped_partition_set_flag(_ped_Partition *s, PyObject *const *args, Py_ssize_t nargs)
 {
     int in_state = -1;
     PedPartition *part = NULL;
     int flag;
     int ret = 0;
 
-    if (!PyArg_ParseTuple(args, "ii", &flag, &in_state)) {
+    if (_ped_args_count("set_flag", nargs, 2, 2) == -1 ||
+        _ped_args_int(args[0], &flag) == -1 ||
+        _ped_args_int(args[1], &in_state) == -1) {
+        return NULL;
+    }
+
+    if (partition_check_writable(s) == -1) {
         return NULL;
     }
 
@@ -1144,7 +1572,9 @@ PyObject *py_ped_partition_set_flag(_ped_Partition *s, PyObject *args)
     }
 
     if (part && flag && in_state > -1) {
+        _ped_Lock_write(partition_lock(s));
         ret = ped_partition_set_flag(part, flag, in_state);
+        _ped_Lock_release(partition_lock(s));
 
         if (ret == 0) {
             if (partedExnRaised) {
@@ -1168,13 +1598,14 @@ PyObject *py_ped_partition_set_flag(_ped_Partition *s, PyObject *args)
     }
 }
 
-PyObject *py_ped_partition_get_flag(_ped_Partition *s, PyObject *args)
+PyObject *py_ped_partition_get_flag(_ped_Partition *s, PyObject *const *args, Py_ssize_t nargs)
 {
     PedPartition *part = NULL;
     int flag;
     int ret = -1;
 
-    if (!PyArg_ParseTuple(args, "i", &flag)) {
+    if (_ped_args_count("get_flag", nargs, 1, 1) == -1 ||
+        _ped_args_int(args[0], &flag) == -1) {
         return NULL;
     }
 
@@ -1184,13 +1615,17 @@ PyObject *py_ped_partition_get_flag(_ped_Partition *s, PyObject *args)
         return NULL;
     }
 
+    _ped_Lock_read(partition_lock(s));
+
     /* ped_partition_get_flag will assert on this. */
     if (!ped_partition_is_active(part)) {
+        _ped_Lock_release(partition_lock(s));
         PyErr_Format(PartitionException, "Could not get flag on inactive partition %s%d", part->disk->dev->path, part->num);
         return NULL;
     }
 
     ret = ped_partition_get_flag(part, flag);
+    _ped_Lock_release(partition_lock(s));
 
     if (ret) {
         Py_RETURN_TRUE;
@@ -1199,13 +1634,14 @@ PyObject *py_ped_partition_get_flag(_ped_Partition *s, PyObject *args)
     }
 }
 
-PyObject *py_ped_partition_is_flag_available(_ped_Partition *s, PyObject *args)
+PyObject *py_ped_partition_is_flag_available(_ped_Partition *s, PyObject *const *args, Py_ssize_t nargs)
 {
     PedPartition *part = NULL;
     int flag;
     int ret = 0;
 
-    if (!PyArg_ParseTuple(args, "i", &flag)) {
+    if (_ped_args_count("is_flag_available", nargs, 1, 1) == -1 ||
+        _ped_args_int(args[0], &flag) == -1) {
         return NULL;
     }
 
@@ -1215,12 +1651,16 @@ PyObject *py_ped_partition_is_flag_available(_ped_Partition *s, PyObject *args)
         return NULL;
     }
 
+    _ped_Lock_read(partition_lock(s));
+
     if (!ped_partition_is_active(part)) {
+        _ped_Lock_release(partition_lock(s));
         PyErr_Format(PartitionException, "Flag is not available on inactive partition %s%d", part->disk->dev->path, part->num);
         return NULL;
     }
 
     ret = ped_partition_is_flag_available(part, flag);
+    _ped_Lock_release(partition_lock(s));
 
     if (ret) {
         Py_RETURN_TRUE;
@@ -1240,6 +1680,10 @@ PyObject *py_ped_partition_set_system(_ped_Partition *s, PyObject *args)
         return NULL;
     }
 
+    if (partition_check_writable(s) == -1) {
+        return NULL;
+    }
+
     part = _ped_Partition2PedPartition(s);
 
     if (part == NULL) {
@@ -1254,13 +1698,17 @@ PyObject *py_ped_partition_set_system(_ped_Partition *s, PyObject *args)
         }
     }
 
+    _ped_Lock_write(partition_lock(s));
+
     /* ped_partition_set_system will assert on this. */
     if (!ped_partition_is_active(part)) {
+        _ped_Lock_release(partition_lock(s));
         PyErr_Format(PartitionException, "Could not set system flag on inactive partition %s%d", part->disk->dev->path, part->num);
         return NULL;
     }
 
     ret = ped_partition_set_system(part, out_fstype);
+    _ped_Lock_release(partition_lock(s));
 
     if (ret == 0) {
         PyErr_Format(PartitionException, "Could not set system flag on partition %s%d", part->disk->dev->path, part->num);
@@ -1284,19 +1732,27 @@ PyObject *py_ped_partition_set_name(_ped_Partition *s, PyObject *args)
         return NULL;
     }
 
+    if (partition_check_writable(s) == -1) {
+        return NULL;
+    }
+
     part = _ped_Partition2PedPartition(s);
 
     if (part == NULL) {
         return NULL;
     }
 
+    _ped_Lock_write(partition_lock(s));
+
     /* ped_partition_set_name will assert on this. */
     if (!ped_partition_is_active(part)) {
+        _ped_Lock_release(partition_lock(s));
         PyErr_Format(PartitionException, "Could not set system flag on inactive partition %s%d", part->disk->dev->path, part->num);
         return NULL;
     }
 
     ret = ped_partition_set_name(part, in_name);
+    _ped_Lock_release(partition_lock(s));
 
     if (ret == 0) {
         if (partedExnRaised) {
@@ -1330,13 +1786,17 @@ PyObject *py_ped_partition_get_name(_ped_Partition *s, PyObject *args)
         return NULL;
     }
 
+    _ped_Lock_read(partition_lock(s));
+
     /* ped_partition_get_name will assert on this. */
     if (!ped_partition_is_active(part)) {
+        _ped_Lock_release(partition_lock(s));
         PyErr_Format(PartitionException, "Could not get name on inactive partition %s%d", part->disk->dev->path, part->num);
         return NULL;
     }
 
     ret = (char *) ped_partition_get_name(part);
+    _ped_Lock_release(partition_lock(s));
 
     if (ret == NULL) {
         if (partedExnRaised) {
@@ -1366,19 +1826,27 @@ PyObject *py_ped_partition_set_type_id(_ped_Partition *s, PyObject *args)
         return NULL;
     }
 
+    if (partition_check_writable(s) == -1) {
+        return NULL;
+    }
+
     part = _ped_Partition2PedPartition(s);
 
     if (part == NULL) {
         return NULL;
     }
 
+    _ped_Lock_write(partition_lock(s));
+
     /* ped_partition_set_type_id will assert on this. */
     if (!ped_partition_is_active(part)) {
+        _ped_Lock_release(partition_lock(s));
         PyErr_Format(PartitionException, "Could not set system flag on inactive partition %s%d", part->disk->dev->path, part->num);
         return NULL;
     }
 
     ret = ped_partition_set_type_id(part, (uint8_t)id);
+    _ped_Lock_release(partition_lock(s));
 
     if (ret == 0) {
         if (partedExnRaised) {
@@ -1412,13 +1880,17 @@ PyObject *py_ped_partition_get_type_id(_ped_Partition *s, PyObject *args)
         return NULL;
     }
 
+    _ped_Lock_read(partition_lock(s));
+
     /* ped_partition_get_type_id will assert on this. */
     if (!ped_partition_is_active(part)) {
+        _ped_Lock_release(partition_lock(s));
         PyErr_Format(PartitionException, "Could not get id on inactive partition %s%d", part->disk->dev->path, part->num);
         return NULL;
     }
 
     ret = ped_partition_get_type_id(part);
+    _ped_Lock_release(partition_lock(s));
     return PyLong_FromLong((long)ret);
 }
 #endif /* PED_DISK_TYPE_LAST_FEATURE > 2 */
@@ -1436,15 +1908,13 @@ PyObject *py_ped_partition_set_type_uuid(_ped_Partition *s, PyObject *args)
         return NULL;
     }
 
-    part = _ped_Partition2PedPartition(s);
-
-    if (part == NULL) {
+    if (partition_check_writable(s) == -1) {
         return NULL;
     }
 
-    /* ped_partition_set_type_uuid will assert on this. */
-    if (!ped_partition_is_active(part)) {
-        PyErr_Format(PartitionException, "Could not set system flag on inactive partition %s%d", part->disk->dev->path, part->num);
+    part = _ped_Partition2PedPartition(s);
+
+    if (part == NULL) {
         return NULL;
     }
 
@@ -1455,7 +1925,17 @@ PyObject *py_ped_partition_set_type_uuid(_ped_Partition *s, PyObject *args)
         return NULL;
     }
 
+    _ped_Lock_write(partition_lock(s));
+
+    /* ped_partition_set_type_uuid will assert on this. */
+    if (!ped_partition_is_active(part)) {
+        _ped_Lock_release(partition_lock(s));
+        PyErr_Format(PartitionException, "Could not set system flag on inactive partition %s%d", part->disk->dev->path, part->num);
+        return NULL;
+    }
+
     ret = ped_partition_set_type_uuid(part, (uint8_t *)in_uuid);
+    _ped_Lock_release(partition_lock(s));
 
     if (ret == 0) {
         if (partedExnRaised) {
@@ -1490,13 +1970,17 @@ PyObject *py_ped_partition_get_type_uuid(_ped_Partition *s, PyObject *args)
         return NULL;
     }
 
+    _ped_Lock_read(partition_lock(s));
+
     /* ped_partition_get_type_uuid will assert on this. */
     if (!ped_partition_is_active(part)) {
+        _ped_Lock_release(partition_lock(s));
         PyErr_Format(PartitionException, "Could not get uuid on inactive partition %s%d", part->disk->dev->path, part->num);
         return NULL;
     }
 
     ret = (char *) ped_partition_get_type_uuid(part);
+    _ped_Lock_release(partition_lock(s));
 
     if (ret == NULL) {
         if (partedExnRaised) {
@@ -1529,7 +2013,11 @@ PyObject *py_ped_partition_is_busy(_ped_Partition *s, PyObject *args)
         return NULL;
     }
 
+    _ped_Lock_read(partition_lock(s));
+    Py_BEGIN_ALLOW_THREADS
     ret = ped_partition_is_busy(part);
+    Py_END_ALLOW_THREADS
+    _ped_Lock_release(partition_lock(s));
 
     if (ret) {
         Py_RETURN_TRUE;
@@ -1549,7 +2037,9 @@ PyObject *py_ped_partition_get_path(_ped_Partition *s, PyObject *args)
         return NULL;
     }
 
+    _ped_Lock_read(partition_lock(s));
     ret = ped_partition_get_path(part);
+    _ped_Lock_release(partition_lock(s));
 
     if (ret == NULL) {
         PyErr_Format(PartitionException, "Could not get path for partition %s%d", part->disk->dev->path, part->num);
@@ -1563,13 +2053,19 @@ PyObject *py_ped_partition_reset_num(_ped_Partition *s, PyObject *args)
 {
     PedPartition *part = NULL;
 
+    if (partition_check_writable(s) == -1) {
+        return NULL;
+    }
+
     part = _ped_Partition2PedPartition(s);
 
     if (part == NULL) {
         return NULL;
     }
 
+    _ped_Lock_write(partition_lock(s));
     part->num = -1;
+    _ped_Lock_release(partition_lock(s));
     Py_RETURN_TRUE;
 }
 
@@ -1655,6 +2151,10 @@ PyObject *py_ped_disk_add_partition(PyObject *s, PyObject *args)
         return NULL;
     }
 
+    if (_ped_Disk_check_writable(s) == -1) {
+        return NULL;
+    }
+
     disk = _ped_Disk2PedDisk(s);
 
     if (disk == NULL) {
@@ -1680,17 +2180,19 @@ PyObject *py_ped_disk_add_partition(PyObject *s, PyObject *args)
     }
 
     if (in_constraint) {
-        out_constraint = _ped_Constraint2PedConstraint(in_constraint);
+        out_constraint = _ped_Constraint_acquire(in_constraint);
 
         if (out_constraint == NULL) {
             return NULL;
         }
     }
 
+    _ped_Lock_write(DISK_LOCK(s));
     ret = ped_disk_add_partition(disk, out_part, out_constraint);
+    _ped_Lock_release(DISK_LOCK(s));
 
     if (out_constraint) {
-        ped_constraint_destroy(out_constraint);
+        _ped_Constraint_release(in_constraint, out_constraint);
     }
 
     if (ret == 0) {
@@ -1719,6 +2221,259 @@ PyObject *py_ped_disk_add_partition(PyObject *s, PyObject *args)
     }
 }
 
+/*
+ * Raise the exception for a failed libparted call made while adding
+ * partitions in bulk, the same way py_ped_disk_add_partition() does.
+ */
+static void add_partitions_error(PedDisk *disk, const char *msg)
+{
+    if (partedExnRaised) {
+        partedExnRaised = 0;
+
+        if (!PyErr_ExceptionMatches(PartedException) && !PyErr_ExceptionMatches(PyExc_NotImplementedError)) {
+            PyErr_SetString(PartitionException, partedExnMessage);
+        }
+    } else {
+        PyErr_Format(PartitionException, "%s on %s", msg, disk->dev->path);
+    }
+}
+
+/*
+ * Create and add the partition described by one add_partitions() entry.
+ * Returns the new, owned _ped.Partition or NULL with an exception set, in
+ * which case the disk is left as it was before the entry.
+ */
+static PyObject *add_partitions_entry(PyObject *s, PedDisk *disk, PyObject *entry, PedConstraint *constraint)
+{
+    int type;
+    PedSector start, end;
+    PyObject *in_fs = Py_None, *in_flags = Py_None, *in_name = Py_None;
+    PyObject *flags = NULL;
+    const PedFileSystemType *fs_type = NULL;
+    const char *name = NULL;
+    int *flag_values = NULL;
+    Py_ssize_t i, nflags = 0;
+    PedPartition *part = NULL;
+    _ped_Partition *ret = NULL;
+
+    if (!PyTuple_Check(entry)) {
+        PyErr_Format(PyExc_TypeError, "partition entry must be a tuple, not %s", Py_TYPE(entry)->tp_name);
+        return NULL;
+    }
+
+    if (!PyArg_ParseTuple(entry, "iOLL|OO:add_partitions", &type, &in_fs, &start, &end, &in_flags, &in_name)) {
+        return NULL;
+    }
+
+    if (PyUnicode_Check(in_fs)) {
+        const char *fs_name = PyUnicode_AsUTF8(in_fs);
+
+        if (fs_name == NULL) {
+            return NULL;
+        }
+
+        fs_type = ped_file_system_type_get(fs_name);
+
+        if (fs_type == NULL) {
+            PyErr_SetString(UnknownTypeException, fs_name);
+            return NULL;
+        }
+    } else if (PyObject_TypeCheck(in_fs, &_ped_FileSystemType_Type_obj)) {
+        fs_type = _ped_FileSystemType2PedFileSystemType(in_fs);
+
+        if (fs_type == NULL) {
+            return NULL;
+        }
+    } else if (in_fs != Py_None) {
+        PyErr_Format(PyExc_TypeError, "file system must be a _ped.FileSystemType, str or None, not %s", Py_TYPE(in_fs)->tp_name);
+        return NULL;
+    }
+
+    if (in_name != Py_None) {
+        name = PyUnicode_AsUTF8(in_name);
+
+        if (name == NULL) {
+            return NULL;
+        }
+    }
+
+    if (in_flags != Py_None) {
+        flags = PySequence_Fast(in_flags, "partition flags must be a sequence");
+
+        if (flags == NULL) {
+            return NULL;
+        }
+
+        nflags = PySequence_Fast_GET_SIZE(flags);
+        flag_values = PyMem_New(int, nflags > 0 ? nflags : 1);
+
+        if (flag_values == NULL) {
+            Py_DECREF(flags);
+            PyErr_NoMemory();
+            return NULL;
+        }
+
+        for (i = 0; i < nflags; i++) {
+            if (_ped_args_int(PySequence_Fast_GET_ITEM(flags, i), &flag_values[i]) == -1) {
+                goto error;
+            }
+
+            /* libparted asserts on flags it does not know about */
+            if (flag_values[i] < PED_PARTITION_FIRST_FLAG || flag_values[i] > PED_PARTITION_LAST_FLAG) {
+                PyErr_Format(PyExc_ValueError, "Invalid partition flag %d", flag_values[i]);
+                goto error;
+            }
+        }
+    }
+
+    _ped_Lock_write(DISK_LOCK(s));
+
+    part = ped_partition_new(disk, type, fs_type, start, end);
+
+    if (part == NULL) {
+        _ped_Lock_release(DISK_LOCK(s));
+        add_partitions_error(disk, "Could not create partition");
+        goto error;
+    }
+
+    if (!ped_disk_add_partition(disk, part, constraint)) {
+        ped_partition_destroy(part);
+        _ped_Lock_release(DISK_LOCK(s));
+        add_partitions_error(disk, "Could not add partition");
+        goto error;
+    }
+
+    for (i = 0; i < nflags; i++) {
+        if (!ped_partition_set_flag(part, flag_values[i], 1)) {
+            ped_disk_delete_partition(disk, part);
+            _ped_Lock_release(DISK_LOCK(s));
+            add_partitions_error(disk, "Could not set flag on partition");
+            goto error;
+        }
+    }
+
+    if (name != NULL && !ped_partition_set_name(part, name)) {
+        ped_disk_delete_partition(disk, part);
+        _ped_Lock_release(DISK_LOCK(s));
+        add_partitions_error(disk, "Could not set name on partition");
+        goto error;
+    }
+
+    _ped_Lock_release(DISK_LOCK(s));
+
+    ret = PedPartition2_ped_Partition(part, (_ped_Disk *) s);
+
+    if (ret != NULL) {
+        ret->_owned = 1;
+    }
+
+error:
+    PyMem_Free(flag_values);
+    Py_XDECREF(flags);
+    return (PyObject *) ret;
+}
+
+/*
+ * Take the pending exception and return it as an object that can be put
+ * in the result list, or NULL if it is one that should propagate instead.
+ */
+static PyObject *add_partitions_failure(void)
+{
+    PyObject *type = NULL, *value = NULL, *tb = NULL;
+
+    if (!PyErr_ExceptionMatches(PyExc_Exception) || PyErr_ExceptionMatches(PyExc_MemoryError)) {
+        return NULL;
+    }
+
+    PyErr_Fetch(&type, &value, &tb);
+    PyErr_NormalizeException(&type, &value, &tb);
+
+    if (tb != NULL) {
+        PyException_SetTraceback(value, tb);
+    }
+
+    Py_XDECREF(type);
+    Py_XDECREF(tb);
+    return value;
+}
+
+PyObject *py_ped_disk_add_partitions(PyObject *s, PyObject *args)
+{
+    PyObject *in_entries = NULL, *in_constraint = Py_None;
+    PyObject *entries = NULL, *ret = NULL, *item = NULL;
+    PedDisk *disk = NULL;
+    PedConstraint *out_constraint = NULL;
+    Py_ssize_t i, count;
+
+    if (!PyArg_ParseTuple(args, "O|O", &in_entries, &in_constraint)) {
+        return NULL;
+    }
+
+    if (in_constraint != Py_None && !PyObject_TypeCheck(in_constraint, &_ped_Constraint_Type_obj)) {
+        PyErr_Format(PyExc_TypeError, "constraint must be a _ped.Constraint or None, not %s", Py_TYPE(in_constraint)->tp_name);
+        return NULL;
+    }
+
+    if (_ped_Disk_check_writable(s) == -1) {
+        return NULL;
+    }
+
+    disk = _ped_Disk2PedDisk(s);
+
+    if (disk == NULL) {
+        return NULL;
+    }
+
+    entries = PySequence_Fast(in_entries, "partitions must be a sequence");
+
+    if (entries == NULL) {
+        return NULL;
+    }
+
+    count = PySequence_Fast_GET_SIZE(entries);
+    ret = PyList_New(count);
+
+    if (ret == NULL) {
+        goto error;
+    }
+
+    /* every entry shares the one compiled constraint */
+    if (in_constraint != Py_None) {
+        out_constraint = _ped_Constraint_acquire(in_constraint);
+
+        if (out_constraint == NULL) {
+            goto error;
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        item = add_partitions_entry(s, disk, PySequence_Fast_GET_ITEM(entries, i), out_constraint);
+
+        if (item == NULL) {
+            item = add_partitions_failure();
+
+            if (item == NULL) {
+                goto error;
+            }
+        }
+
+        PyList_SET_ITEM(ret, i, item);
+    }
+
+    _ped_Constraint_release(in_constraint, out_constraint);
+    Py_DECREF(entries);
+    return ret;
+
+error:
+    if (out_constraint) {
+        _ped_Constraint_release(in_constraint, out_constraint);
+    }
+
+    Py_XDECREF(ret);
+    Py_DECREF(entries);
+    return NULL;
+}
+
 PyObject *py_ped_disk_remove_partition(PyObject *s, PyObject *args)
 {
     _ped_Partition *in_part = NULL;
@@ -1730,6 +2485,10 @@ PyObject *py_ped_disk_remove_partition(PyObject *s, PyObject *args)
         return NULL;
     }
 
+    if (_ped_Disk_check_writable(s) == -1) {
+        return NULL;
+    }
+
     disk = _ped_Disk2PedDisk(s);
 
     if (disk == NULL) {
@@ -1754,6 +2513,8 @@ PyObject *py_ped_disk_remove_partition(PyObject *s, PyObject *args)
         return NULL;
     }
 
+    _ped_Lock_write(DISK_LOCK(s));
+
     if (out_part->part_list != NULL) {
         PedPartition *part;
 
@@ -1764,12 +2525,14 @@ PyObject *py_ped_disk_remove_partition(PyObject *s, PyObject *args)
         }
 
         if (part) {
+            _ped_Lock_release(DISK_LOCK(s));
             PyErr_SetString(PartitionException, "Attempting to remove an extended partition that still contains logical partitions");
             return NULL;
         }
     }
 
     ret = ped_disk_remove_partition(disk, out_part);
+    _ped_Lock_release(DISK_LOCK(s));
 
     if (ret == 0) {
         if (partedExnRaised) {
@@ -1804,10 +2567,16 @@ PyObject *py_ped_disk_delete_all(PyObject *s, PyObject *args)
     PedDisk *disk = NULL;
     int ret = 0;
 
+    if (_ped_Disk_check_writable(s) == -1) {
+        return NULL;
+    }
+
     disk = _ped_Disk2PedDisk(s);
 
     if (disk) {
+        _ped_Lock_write(DISK_LOCK(s));
         ret = ped_disk_delete_all(disk);
+        _ped_Lock_release(DISK_LOCK(s));
 
         if (ret == 0) {
             if (partedExnRaised) {
@@ -1850,6 +2619,10 @@ PyObject *py_ped_disk_set_partition_geom(PyObject *s, PyObject *args)
         return NULL;
     }
 
+    if (_ped_Disk_check_writable(s) == -1) {
+        return NULL;
+    }
+
     disk = _ped_Disk2PedDisk(s);
 
     if (disk == NULL) {
@@ -1868,17 +2641,19 @@ PyObject *py_ped_disk_set_partition_geom(PyObject *s, PyObject *args)
     }
 
     if (in_constraint != Py_None) {
-        out_constraint = _ped_Constraint2PedConstraint(in_constraint);
+        out_constraint = _ped_Constraint_acquire(in_constraint);
 
         if (out_constraint == NULL) {
             return NULL;
         }
     }
 
+    _ped_Lock_write(DISK_LOCK(s));
     ret = ped_disk_set_partition_geom(disk, out_part, out_constraint, start, end);
+    _ped_Lock_release(DISK_LOCK(s));
 
     if (out_constraint) {
-        ped_constraint_destroy(out_constraint);
+        _ped_Constraint_release(in_constraint, out_constraint);
     }
 
     if (ret == 0) {
@@ -1917,6 +2692,10 @@ PyObject *py_ped_disk_maximize_partition(PyObject *s, PyObject *args)
         return NULL;
     }
 
+    if (_ped_Disk_check_writable(s) == -1) {
+        return NULL;
+    }
+
     disk = _ped_Disk2PedDisk(s);
 
     if (disk == NULL) {
@@ -1935,17 +2714,19 @@ PyObject *py_ped_disk_maximize_partition(PyObject *s, PyObject *args)
     }
 
     if (in_constraint) {
-        out_constraint = _ped_Constraint2PedConstraint(in_constraint);
+        out_constraint = _ped_Constraint_acquire(in_constraint);
 
         if (out_constraint == NULL) {
             return NULL;
         }
     }
 
+    _ped_Lock_write(DISK_LOCK(s));
     ret = ped_disk_maximize_partition(disk, out_part, out_constraint);
+    _ped_Lock_release(DISK_LOCK(s));
 
     if (out_constraint) {
-        ped_constraint_destroy(out_constraint);
+        _ped_Constraint_release(in_constraint, out_constraint);
     }
 
     if (ret == 0) {
@@ -2003,17 +2784,19 @@ PyObject *py_ped_disk_get_max_partition_geometry(PyObject *s, PyObject *args)
     }
 
     if (in_constraint) {
-        out_constraint = _ped_Constraint2PedConstraint(in_constraint);
+        out_constraint = _ped_Constraint_acquire(in_constraint);
 
         if (out_constraint == NULL) {
             return NULL;
         }
     }
 
+    _ped_Lock_read(DISK_LOCK(s));
     pass_geom = ped_disk_get_max_partition_geometry(disk, out_part, out_constraint);
+    _ped_Lock_release(DISK_LOCK(s));
 
     if (out_constraint) {
-        ped_constraint_destroy(out_constraint);
+        _ped_Constraint_release(in_constraint, out_constraint);
     }
 
     if (pass_geom == NULL) {
@@ -2044,10 +2827,16 @@ PyObject *py_ped_disk_minimize_extended_partition(PyObject *s, PyObject *args)
     PedDisk *disk = NULL;
     int ret = 0;
 
+    if (_ped_Disk_check_writable(s) == -1) {
+        return NULL;
+    }
+
     disk = _ped_Disk2PedDisk(s);
 
     if (disk) {
+        _ped_Lock_write(DISK_LOCK(s));
         ret = ped_disk_minimize_extended_partition(disk);
+        _ped_Lock_release(DISK_LOCK(s));
 
         if (ret == 0) {
             if (partedExnRaised) {
@@ -2071,7 +2860,7 @@ PyObject *py_ped_disk_minimize_extended_partition(PyObject *s, PyObject *args)
     }
 }
 
-PyObject *py_ped_disk_next_partition(PyObject *s, PyObject *args)
+PyObject *py_ped_disk_next_partition(PyObject *s, PyObject *const *args, Py_ssize_t nargs)
 {
     _ped_Partition *in_part = NULL;
     PedDisk *disk = NULL;
@@ -2079,10 +2868,18 @@ PyObject *py_ped_disk_next_partition(PyObject *s, PyObject *args)
     PedPartition *pass_part = NULL;
     _ped_Partition *ret = NULL;
 
-    if (!PyArg_ParseTuple(args, "|O!", &_ped_Partition_Type_obj, &in_part)) {
+    if (_ped_args_count("next_partition", nargs, 0, 1) == -1) {
         return NULL;
     }
 
+    if (nargs == 1) {
+        if (_ped_args_object("next_partition", 0, args[0], &_ped_Partition_Type_obj) == -1) {
+            return NULL;
+        }
+
+        in_part = (_ped_Partition *) args[0];
+    }
+
     disk = _ped_Disk2PedDisk(s);
 
     if (disk == NULL) {
@@ -2102,7 +2899,9 @@ PyObject *py_ped_disk_next_partition(PyObject *s, PyObject *args)
         }
     }
 
+    _ped_Lock_read(DISK_LOCK(s));
     pass_part = ped_disk_next_partition(disk, out_part);
+    _ped_Lock_release(DISK_LOCK(s));
 
     if (pass_part == NULL) {
         Py_RETURN_NONE;
@@ -2117,21 +2916,24 @@ PyObject *py_ped_disk_next_partition(PyObject *s, PyObject *args)
     return (PyObject *) ret;
 }
 
-PyObject *py_ped_disk_get_partition(PyObject *s, PyObject *args)
+PyObject *py_ped_disk_get_partition(PyObject *s, PyObject *const *args, Py_ssize_t nargs)
 {
     int num;
     PedDisk *disk = NULL;
     PedPartition *pass_part = NULL;
     _ped_Partition *ret = NULL;
 
-    if (!PyArg_ParseTuple(args, "i", &num)) {
+    if (_ped_args_count("get_partition", nargs, 1, 1) == -1 ||
+        _ped_args_int(args[0], &num) == -1) {
         return NULL;
     }
 
     disk = _ped_Disk2PedDisk(s);
 
     if (disk) {
+        _ped_Lock_read(DISK_LOCK(s));
         pass_part = ped_disk_get_partition(disk, num);
+        _ped_Lock_release(DISK_LOCK(s));
 
         if (pass_part == NULL) {
             PyErr_SetString(PartitionException, "Partition does not exist");
@@ -2150,14 +2952,15 @@ PyObject *py_ped_disk_get_partition(PyObject *s, PyObject *args)
     return (PyObject *) ret;
 }
 
-PyObject *py_ped_disk_get_partition_by_sector(PyObject *s, PyObject *args)
+PyObject *py_ped_disk_get_partition_by_sector(PyObject *s, PyObject *const *args, Py_ssize_t nargs)
 {
     PedDisk *disk = NULL;
     PedSector sector;
     PedPartition *pass_part = NULL;
     _ped_Partition *ret = NULL;
 
-    if (!PyArg_ParseTuple(args, "L", &sector)) {
+    if (_ped_args_count("get_partition_by_sector", nargs, 1, 1) == -1 ||
+        _ped_args_sector(args[0], &sector) == -1) {
         return NULL;
     }
 
@@ -2167,7 +2970,9 @@ PyObject *py_ped_disk_get_partition_by_sector(PyObject *s, PyObject *args)
         return NULL;
     }
 
+    _ped_Lock_read(DISK_LOCK(s));
     pass_part = ped_disk_get_partition_by_sector(disk, sector);
+    _ped_Lock_release(DISK_LOCK(s));
 
     if (pass_part == NULL) {
         PyErr_SetString(PartitionException, "Partition does not exist");
@@ -2193,7 +2998,9 @@ PyObject *py_ped_disk_extended_partition(PyObject *s, PyObject *args)
     disk = _ped_Disk2PedDisk(s);
 
     if (disk) {
+        _ped_Lock_read(DISK_LOCK(s));
         pass_part = ped_disk_extended_partition(disk);
+        _ped_Lock_release(DISK_LOCK(s));
 
         if (pass_part == NULL) {
             PyErr_SetString(PartitionException, "Extended partition does not exist");
@@ -2237,7 +3044,13 @@ PyObject *py_ped_disk_new_fresh(PyObject *s, PyObject *args)
         return NULL;
     }
 
+    if (_ped_Device_check_writable(device) == -1) {
+        return NULL;
+    }
+
+    _ped_Lock_read(_ped_Device_lock(device));
     disk = ped_disk_new_fresh(device, type);
+    _ped_Lock_release(_ped_Device_lock(device));
 
     if (!disk) {
         if (partedExnRaised) {
@@ -2267,8 +3080,9 @@ PyObject *py_ped_disk_new(PyObject *s, PyObject *args)
     PedDevice *device = NULL;
     PedDisk *disk = NULL;
     _ped_Disk *ret = NULL;
+    int read_only = 0;
 
-    if (!PyArg_ParseTuple(args, "O!", &_ped_Device_Type_obj, &in_device)) {
+    if (!PyArg_ParseTuple(args, "O!|p", &_ped_Device_Type_obj, &in_device, &read_only)) {
         return NULL;
     }
 
@@ -2278,7 +3092,11 @@ PyObject *py_ped_disk_new(PyObject *s, PyObject *args)
         return NULL;
     }
 
-    disk = ped_disk_new(device);
+    if (!read_only && _ped_Device_check_writable(device) == -1) {
+        return NULL;
+    }
+
+    disk = disk_read(device, read_only);
 
     if (!disk) {
         if (partedExnRaised) {
@@ -2299,5 +3117,12 @@ PyObject *py_ped_disk_new(PyObject *s, PyObject *args)
     }
 
     ret = PedDisk2_ped_Disk(disk);
+
+    if (ret != NULL) {
+        ret->read_only = read_only;
+    } else if (read_only) {
+        disk_read_only_end(device);
+    }
+
     return (PyObject *) ret;
 }
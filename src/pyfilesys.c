@@ -6,21 +6,26 @@
  */
 
 #include <Python.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "convert.h"
 #include "exceptions.h"
 #include "pydevice.h"
+#include "pydisk.h"
 #include "pyfilesys.h"
 #include "pygeom.h"
+#include "pylock.h"
+#include "pysniff.h"
 #include "docstrings/pyfilesys.h"
 #include "typeobjects/pyfilesys.h"
 
 /* _ped.FileSystemType functions */
 void _ped_FileSystemType_dealloc(_ped_FileSystemType *self)
 {
-    PyObject_GC_UnTrack(self);
     free(self->name);
-    PyObject_GC_Del(self);
+    Py_TYPE(self)->tp_free((PyObject *) self);
 }
 
 int _ped_FileSystemType_compare(_ped_FileSystemType *self, PyObject *obj)
@@ -83,16 +88,6 @@ PyObject *_ped_FileSystemType_str(_ped_FileSystemType *self)
     return ret;
 }
 
-int _ped_FileSystemType_traverse(_ped_FileSystemType *self, visitproc visit, void *arg)
-{
-    return 0;
-}
-
-int _ped_FileSystemType_clear(_ped_FileSystemType *self)
-{
-    return 0;
-}
-
 PyObject *_ped_FileSystemType_get(_ped_FileSystemType *self, void *closure)
 {
     char *member = (char *) closure;
@@ -345,7 +340,11 @@ PyObject *py_ped_file_system_probe_specific(PyObject *s, PyObject *args)
         return NULL;
     }
 
+    _ped_Lock_write(_ped_Device_lock(out_geom->dev));
+    Py_BEGIN_ALLOW_THREADS
     geom = ped_file_system_probe_specific(fstype, out_geom);
+    Py_END_ALLOW_THREADS
+    _ped_Lock_release(_ped_Device_lock(out_geom->dev));
 
     if (geom) {
         ret = PedGeometry2_ped_Geometry(geom);
@@ -381,7 +380,11 @@ PyObject *py_ped_file_system_probe(PyObject *s, PyObject *args)
         return NULL;
     }
 
-    fstype = ped_file_system_probe(out_geom);
+    _ped_Lock_write(_ped_Device_lock(out_geom->dev));
+    Py_BEGIN_ALLOW_THREADS
+    fstype = (PedFileSystemType *) _ped_FileSystem_probe(out_geom);
+    Py_END_ALLOW_THREADS
+    _ped_Lock_release(_ped_Device_lock(out_geom->dev));
 
     if (fstype) {
         ret = PedFileSystemType2_ped_FileSystemType(fstype);
@@ -401,3 +404,324 @@ PyObject *py_ped_file_system_probe(PyObject *s, PyObject *args)
 
     return (PyObject *) ret;
 }
+
+/*
+ * Probing many geometries at once.  libparted seeks and reads on the one
+ * descriptor it keeps per device and counts opens without a lock, so
+ * probes on the same device have to run one after the other under the
+ * device lock, just like Device.disk_probe() does.  Jobs are therefore
+ * grouped by device and a worker takes a whole group at a time: different
+ * devices are probed in parallel and a device is only locked once per
+ * group.
+ */
+typedef struct {
+    Py_ssize_t index;
+    PedGeometry *geom;
+    const PedFileSystemType *fstype;
+    char *error;
+} _ped_ProbeJob;
+
+typedef struct {
+    _ped_ProbeJob *jobs;
+    Py_ssize_t count;
+
+    /* indexes of the first job of each device, and one past the last */
+    Py_ssize_t *groups;
+    Py_ssize_t n_groups;
+    Py_ssize_t next_group;
+} _ped_ProbeQueue;
+
+static int probe_job_compare(const void *a, const void *b)
+{
+    const PedDevice *x = ((const _ped_ProbeJob *) a)->geom->dev;
+    const PedDevice *y = ((const _ped_ProbeJob *) b)->geom->dev;
+
+    return (x > y) - (x < y);
+}
+
+static void *probe_worker(void *data)
+{
+    _ped_ProbeQueue *queue = data;
+    Py_ssize_t group, i;
+
+    while ((group = __atomic_fetch_add(&queue->next_group, 1, __ATOMIC_RELAXED)) < queue->n_groups) {
+        PedDevice *device = queue->jobs[queue->groups[group]].geom->dev;
+
+        _ped_Lock_write_nogil(_ped_Device_lock(device));
+
+        for (i = queue->groups[group]; i < queue->groups[group + 1]; i++) {
+            _ped_ProbeJob *job = &queue->jobs[i];
+
+            job->fstype = _ped_FileSystem_probe(job->geom);
+
+            /* the exception state is per thread, so pick it up here */
+            if (job->fstype == NULL && partedExnRaised) {
+                partedExnRaised = 0;
+                job->error = partedExnMessage;
+                partedExnMessage = NULL;
+            }
+        }
+
+        _ped_Lock_release(_ped_Device_lock(device));
+    }
+
+    return NULL;
+}
+
+/*
+ * Probe every job with up to workers threads, with the GIL released.
+ * The jobs are reordered by device.  Returns -1 with an exception set if
+ * nothing could be probed.
+ */
+static int probe_many(_ped_ProbeJob *jobs, Py_ssize_t count, long workers)
+{
+    _ped_ProbeQueue queue = { jobs, count, NULL, 0, 0 };
+    pthread_t *threads = NULL;
+    long started = 0, i;
+
+    if (workers < 1) {
+        PyErr_SetString(PyExc_ValueError, "workers must be at least 1");
+        return -1;
+    }
+
+    qsort(jobs, count, sizeof(*jobs), probe_job_compare);
+    queue.groups = PyMem_New(Py_ssize_t, count + 1);
+
+    if (queue.groups == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (i == 0 || jobs[i].geom->dev != jobs[i - 1].geom->dev) {
+            queue.groups[queue.n_groups++] = i;
+        }
+    }
+
+    queue.groups[queue.n_groups] = count;
+
+    if (workers > queue.n_groups) {
+        workers = queue.n_groups;
+    }
+
+    /* the calling thread is one of the workers */
+    if (workers > 1 && (threads = PyMem_New(pthread_t, workers - 1)) == NULL) {
+        PyMem_Free(queue.groups);
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+
+    for (started = 0; started < workers - 1; started++) {
+        /* fewer threads than asked for still get the job done */
+        if (pthread_create(&threads[started], NULL, probe_worker, &queue) != 0) {
+            break;
+        }
+    }
+
+    probe_worker(&queue);
+
+    for (i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    Py_END_ALLOW_THREADS
+
+    PyMem_Free(threads);
+    PyMem_Free(queue.groups);
+    return 0;
+}
+
+/* FileSystemType, None, or the exception describing why probing failed */
+static PyObject *probe_result(const _ped_ProbeJob *job)
+{
+    if (job->fstype != NULL) {
+        return (PyObject *) PedFileSystemType2_ped_FileSystemType((PedFileSystemType *) job->fstype);
+    } else if (job->error != NULL) {
+        return PyObject_CallFunction(IOException, "s", job->error);
+    }
+
+    Py_RETURN_NONE;
+}
+
+static void probe_jobs_free(_ped_ProbeJob *jobs, Py_ssize_t count)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i < count; i++) {
+        if (jobs[i].geom != NULL) {
+            ped_geometry_destroy(jobs[i].geom);
+        }
+
+        free(jobs[i].error);
+    }
+
+    PyMem_Free(jobs);
+}
+
+PyObject *py_ped_file_system_probe_many(PyObject *s, PyObject *args)
+{
+    PyObject *in_geoms = NULL, *seq = NULL, *ret = NULL;
+    _ped_ProbeJob *jobs = NULL;
+    Py_ssize_t count, i;
+    long workers = 1;
+
+    if (!PyArg_ParseTuple(args, "O|l", &in_geoms, &workers)) {
+        return NULL;
+    }
+
+    seq = PySequence_Fast(in_geoms, "geometries must be a sequence of _ped.Geometry");
+
+    if (seq == NULL) {
+        return NULL;
+    }
+
+    count = PySequence_Fast_GET_SIZE(seq);
+    jobs = PyMem_Calloc(count ? count : 1, sizeof(*jobs));
+
+    if (jobs == NULL) {
+        Py_DECREF(seq);
+        return PyErr_NoMemory();
+    }
+
+    /* private copies, so the Geometry objects can change meanwhile */
+    for (i = 0; i < count; i++) {
+        PyObject *item = PySequence_Fast_GET_ITEM(seq, i);
+        PedGeometry *geom = NULL;
+
+        if (!PyObject_TypeCheck(item, &_ped_Geometry_Type_obj)) {
+            PyErr_Format(PyExc_TypeError, "geometries must be _ped.Geometry objects, not %s", Py_TYPE(item)->tp_name);
+            goto out;
+        }
+
+        geom = _ped_Geometry2PedGeometry(item);
+
+        if (geom == NULL) {
+            goto out;
+        }
+
+        jobs[i].index = i;
+        jobs[i].geom = ped_geometry_duplicate(geom);
+
+        if (jobs[i].geom == NULL) {
+            PyErr_NoMemory();
+            goto out;
+        }
+    }
+
+    if (probe_many(jobs, count, workers) == -1) {
+        goto out;
+    }
+
+    ret = PyList_New(count);
+
+    if (ret == NULL) {
+        goto out;
+    }
+
+    for (i = 0; i < count; i++) {
+        PyObject *result = probe_result(&jobs[i]);
+
+        if (result == NULL) {
+            Py_CLEAR(ret);
+            goto out;
+        }
+
+        PyList_SET_ITEM(ret, jobs[i].index, result);
+    }
+
+out:
+    probe_jobs_free(jobs, count);
+    Py_DECREF(seq);
+    return ret;
+}
+
+PyObject *py_ped_disk_probe_file_systems(PyObject *s, PyObject *args)
+{
+    PedDisk *disk = NULL;
+    PedPartition *part = NULL;
+    _ped_ProbeJob *jobs = NULL;
+    Py_ssize_t count = 0, size = 0, i;
+    PyObject *ret = NULL;
+    long workers = 1;
+
+    if (!PyArg_ParseTuple(args, "|l", &workers)) {
+        return NULL;
+    }
+
+    disk = _ped_Disk2PedDisk(s);
+
+    if (disk == NULL) {
+        return NULL;
+    }
+
+    /* copy the geometries so the partitions may change while probing */
+    _ped_Lock_read(&((_ped_Disk *) s)->lock);
+
+    for (part = ped_disk_next_partition(disk, NULL); part; part = ped_disk_next_partition(disk, part)) {
+        if (!ped_partition_is_active(part) || part->type & PED_PARTITION_EXTENDED) {
+            continue;
+        }
+
+        if (count == size) {
+            _ped_ProbeJob *grown = NULL;
+
+            size = size ? size * 2 : 16;
+            grown = PyMem_Realloc(jobs, size * sizeof(*jobs));
+
+            if (grown == NULL) {
+                PyErr_NoMemory();
+                break;
+            }
+
+            jobs = grown;
+        }
+
+        memset(&jobs[count], 0, sizeof(*jobs));
+        jobs[count].index = part->num;
+        jobs[count].geom = ped_geometry_duplicate(&part->geom);
+
+        if (jobs[count++].geom == NULL) {
+            PyErr_NoMemory();
+            break;
+        }
+    }
+
+    _ped_Lock_release(&((_ped_Disk *) s)->lock);
+
+    if (PyErr_Occurred() || probe_many(jobs, count, workers) == -1) {
+        goto out;
+    }
+
+    ret = PyDict_New();
+
+    if (ret == NULL) {
+        goto out;
+    }
+
+    for (i = 0; i < count; i++) {
+        PyObject *num = PyLong_FromSsize_t(jobs[i].index);
+        PyObject *result = probe_result(&jobs[i]);
+        int rc = -1;
+
+        if (num != NULL && result != NULL) {
+            rc = PyDict_SetItem(ret, num, result);
+        }
+
+        Py_XDECREF(num);
+        Py_XDECREF(result);
+
+        if (rc == -1) {
+            Py_CLEAR(ret);
+            goto out;
+        }
+    }
+
+out:
+    if (jobs != NULL) {
+        probe_jobs_free(jobs, count);
+    }
+
+    return ret;
+}
@@ -0,0 +1,61 @@
+/*
+ * pyfreelist.c
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <Python.h>
+#include <string.h>
+
+#include "pyfreelist.h"
+
+/*
+ * Recycling objects behind the interpreter's back is not safe when it
+ * keeps its own bookkeeping of every live object (Py_TRACE_REFS) or when
+ * objects can be released from several threads at once (free-threaded
+ * builds), so fall back to the regular allocator there.
+ */
+#if defined(Py_TRACE_REFS) || defined(Py_GIL_DISABLED)
+#define FREELIST_DISABLED 1
+#endif
+
+PyObject *_ped_FreeList_alloc(_ped_FreeList *list, PyTypeObject *type, Py_ssize_t nitems)
+{
+#ifndef FREELIST_DISABLED
+    PyObject *obj = NULL;
+
+    if (type == list->type && list->count > 0) {
+        obj = list->items[--list->count];
+        list->items[list->count] = NULL;
+
+        /* same state PyType_GenericAlloc() would hand out */
+        memset(obj, 0, type->tp_basicsize);
+        PyObject_Init(obj, type);
+
+        if (PyType_IS_GC(type)) {
+            PyObject_GC_Track(obj);
+        }
+
+        return obj;
+    }
+#endif
+
+    return PyType_GenericAlloc(type, nitems);
+}
+
+/*
+ * Called last thing from a dealloc, once the object has been untracked
+ * (for GC types) and its references dropped.
+ */
+void _ped_FreeList_free(_ped_FreeList *list, PyObject *obj)
+{
+#ifndef FREELIST_DISABLED
+    if (Py_TYPE(obj) == list->type && list->count < FREELIST_SIZE) {
+        list->items[list->count++] = obj;
+        return;
+    }
+#endif
+
+    Py_TYPE(obj)->tp_free(obj);
+}
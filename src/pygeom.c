@@ -9,12 +9,25 @@
 
 #include "convert.h"
 #include "exceptions.h"
+#include "pyargs.h"
+#include "pycopy.h"
+#include "pyfreelist.h"
 #include "pygeom.h"
+#include "pylock.h"
 #include "pynatmath.h"
+#include "pypool.h"
+#include "pystats.h"
 #include "docstrings/pygeom.h"
 #include "typeobjects/pygeom.h"
 
+static _ped_FreeList geometry_freelist = FREELIST_INIT(&_ped_Geometry_Type_obj);
+
 /* _ped.Geometry functions */
+PyObject *_ped_Geometry_alloc(PyTypeObject *type, Py_ssize_t nitems)
+{
+    return _ped_FreeList_alloc(&geometry_freelist, type, nitems);
+}
+
 void _ped_Geometry_dealloc(_ped_Geometry *self)
 {
     if (self->ped_geometry) {
@@ -26,7 +39,7 @@ void _ped_Geometry_dealloc(_ped_Geometry *self)
     Py_CLEAR(self->dev);
     self->dev = NULL;
 
-    PyObject_GC_Del(self);
+    _ped_FreeList_free(&geometry_freelist, (PyObject *) self);
 }
 
 int _ped_Geometry_compare(_ped_Geometry *self, PyObject *obj)
@@ -314,13 +327,15 @@ PyObject *py_ped_geometry_intersect(PyObject *s, PyObject *args)
     return (PyObject *) ret;
 }
 
-PyObject *py_ped_geometry_set(PyObject *s, PyObject *args)
+PyObject *py_ped_geometry_set(PyObject *s, PyObject *const *args, Py_ssize_t nargs)
 {
     int ret = -1;
     PedGeometry *geom = NULL;
     PedSector start, length;
 
-    if (!PyArg_ParseTuple(args, "LL", &start, &length)) {
+    if (_ped_args_count("set", nargs, 2, 2) == -1 ||
+        _ped_args_sector(args[0], &start) == -1 ||
+        _ped_args_sector(args[1], &length) == -1) {
         return NULL;
     }
 
@@ -353,13 +368,14 @@ PyObject *py_ped_geometry_set(PyObject *s, PyObject *args)
     }
 }
 
-PyObject *py_ped_geometry_set_start(PyObject *s, PyObject *args)
+PyObject *py_ped_geometry_set_start(PyObject *s, PyObject *const *args, Py_ssize_t nargs)
 {
     int ret = -1;
     PedGeometry *geom = NULL;
     PedSector start;
 
-    if (!PyArg_ParseTuple(args, "L", &start)) {
+    if (_ped_args_count("set_start", nargs, 1, 1) == -1 ||
+        _ped_args_sector(args[0], &start) == -1) {
         return NULL;
     }
 
@@ -392,13 +408,14 @@ PyObject *py_ped_geometry_set_start(PyObject *s, PyObject *args)
     }
 }
 
-PyObject *py_ped_geometry_set_end(PyObject *s, PyObject *args)
+PyObject *py_ped_geometry_set_end(PyObject *s, PyObject *const *args, Py_ssize_t nargs)
 {
     int ret = -1;
     PedGeometry *geom = NULL;
     PedSector end;
 
-    if (!PyArg_ParseTuple(args, "L", &end)) {
+    if (_ped_args_count("set_end", nargs, 1, 1) == -1 ||
+        _ped_args_sector(args[0], &end) == -1) {
         return NULL;
     }
 
@@ -431,16 +448,19 @@ PyObject *py_ped_geometry_set_end(PyObject *s, PyObject *args)
     }
 }
 
-PyObject *py_ped_geometry_test_overlap(PyObject *s, PyObject *args)
+PyObject *py_ped_geometry_test_overlap(PyObject *s, PyObject *const *args, Py_ssize_t nargs)
 {
     int ret = -1;
     PyObject *in_b = NULL;
     PedGeometry *out_a = NULL, *out_b = NULL;
 
-    if (!PyArg_ParseTuple(args, "O!", &_ped_Geometry_Type_obj, &in_b)) {
+    if (_ped_args_count("test_overlap", nargs, 1, 1) == -1 ||
+        _ped_args_object("test_overlap", 0, args[0], &_ped_Geometry_Type_obj) == -1) {
         return NULL;
     }
 
+    in_b = args[0];
+
     out_a = _ped_Geometry2PedGeometry(s);
 
     if (out_a == NULL) {
@@ -462,16 +482,19 @@ PyObject *py_ped_geometry_test_overlap(PyObject *s, PyObject *args)
     }
 }
 
-PyObject *py_ped_geometry_test_inside(PyObject *s, PyObject *args)
+PyObject *py_ped_geometry_test_inside(PyObject *s, PyObject *const *args, Py_ssize_t nargs)
 {
     int ret = -1;
     PyObject *in_b = NULL;
     PedGeometry *out_a = NULL, *out_b = NULL;
 
-    if (!PyArg_ParseTuple(args, "O!", &_ped_Geometry_Type_obj, &in_b)) {
+    if (_ped_args_count("test_inside", nargs, 1, 1) == -1 ||
+        _ped_args_object("test_inside", 0, args[0], &_ped_Geometry_Type_obj) == -1) {
         return NULL;
     }
 
+    in_b = args[0];
+
     out_a = _ped_Geometry2PedGeometry(s);
 
     if (out_a == NULL) {
@@ -493,16 +516,19 @@ PyObject *py_ped_geometry_test_inside(PyObject *s, PyObject *args)
     }
 }
 
-PyObject *py_ped_geometry_test_equal(PyObject *s, PyObject *args)
+PyObject *py_ped_geometry_test_equal(PyObject *s, PyObject *const *args, Py_ssize_t nargs)
 {
     int ret = -1;
     PyObject *in_b = NULL;
     PedGeometry *out_a = NULL, *out_b = NULL;
 
-    if (!PyArg_ParseTuple(args, "O!", &_ped_Geometry_Type_obj, &in_b)) {
+    if (_ped_args_count("test_equal", nargs, 1, 1) == -1 ||
+        _ped_args_object("test_equal", 0, args[0], &_ped_Geometry_Type_obj) == -1) {
         return NULL;
     }
 
+    in_b = args[0];
+
     out_a = _ped_Geometry2PedGeometry(s);
 
     if (out_a == NULL) {
@@ -524,13 +550,14 @@ PyObject *py_ped_geometry_test_equal(PyObject *s, PyObject *args)
     }
 }
 
-PyObject *py_ped_geometry_test_sector_inside(PyObject *s, PyObject *args)
+PyObject *py_ped_geometry_test_sector_inside(PyObject *s, PyObject *const *args, Py_ssize_t nargs)
 {
     int ret = -1;
     PedGeometry *geom = NULL;
     PedSector sector;
 
-    if (!PyArg_ParseTuple(args, "L", &sector)) {
+    if (_ped_args_count("test_sector_inside", nargs, 1, 1) == -1 ||
+        _ped_args_sector(args[0], &sector) == -1) {
         return NULL;
     }
 
@@ -555,6 +582,7 @@ PyObject *py_ped_geometry_read(PyObject *s, PyObject *args)
     PedGeometry *geom = NULL;
     char *out_buf = NULL;
     PedSector offset, count;
+    int ret_read = 0;
 
     if (!PyArg_ParseTuple(args, "LL", &offset, &count)) {
         return NULL;
@@ -567,7 +595,7 @@ PyObject *py_ped_geometry_read(PyObject *s, PyObject *args)
     }
 
     /* py_device_read will ASSERT if the device isn't open yet. */
-    if (geom->dev->open_count <= 0) {
+    if (_ped_DevicePool_open_count(geom->dev) <= 0) {
         PyErr_SetString(IOException, "Attempting to read from a unopened device");
         return NULL;
     }
@@ -584,7 +612,17 @@ PyObject *py_ped_geometry_read(PyObject *s, PyObject *args)
         return PyErr_NoMemory();
     }
 
-    if (ped_geometry_read(geom, out_buf, offset, count) == 0) {
+    /*
+     * libparted seeks and reads on the one descriptor it keeps per device,
+     * so reads are serialized like writes, as in Device.read().
+     */
+    _ped_Lock_write(_ped_Device_lock(geom->dev));
+    Py_BEGIN_ALLOW_THREADS
+    ret_read = ped_geometry_read(geom, out_buf, offset, count);
+    Py_END_ALLOW_THREADS
+    _ped_Lock_release(_ped_Device_lock(geom->dev));
+
+    if (ret_read == 0) {
         if (partedExnRaised) {
             partedExnRaised = 0;
 
@@ -599,6 +637,7 @@ PyObject *py_ped_geometry_read(PyObject *s, PyObject *args)
         return NULL;
     }
 
+    STATS_READ(geom->dev, count);
     ret = PyUnicode_FromString(out_buf);
     free(out_buf);
     return ret;
@@ -615,7 +654,11 @@ PyObject *py_ped_geometry_sync(PyObject *s, PyObject *args)
         return NULL;
     }
 
+    _ped_Lock_write(_ped_Device_lock(geom->dev));
+    Py_BEGIN_ALLOW_THREADS
     ret = ped_geometry_sync(geom);
+    Py_END_ALLOW_THREADS
+    _ped_Lock_release(_ped_Device_lock(geom->dev));
 
     if (ret == 0) {
         PyErr_SetString(IOException, "Could not sync");
@@ -640,7 +683,11 @@ PyObject *py_ped_geometry_sync_fast(PyObject *s, PyObject *args)
         return NULL;
     }
 
+    _ped_Lock_write(_ped_Device_lock(geom->dev));
+    Py_BEGIN_ALLOW_THREADS
     ret = ped_geometry_sync_fast(geom);
+    Py_END_ALLOW_THREADS
+    _ped_Lock_release(_ped_Device_lock(geom->dev));
 
     if (ret == 0) {
         PyErr_SetString(IOException, "Could not sync");
@@ -673,7 +720,7 @@ PyObject *py_ped_geometry_write(PyObject *s, PyObject *args)
     }
 
     /* py_device_write will ASSERT if the device isn't open yet. */
-    if (geom->dev->open_count <= 0) {
+    if (_ped_DevicePool_open_count(geom->dev) <= 0) {
         PyErr_SetString(IOException, "Attempting to write to a unopened device");
         return NULL;
     }
@@ -684,7 +731,12 @@ PyObject *py_ped_geometry_write(PyObject *s, PyObject *args)
         return NULL;
     }
 
+    _ped_Lock_write(_ped_Device_lock(geom->dev));
+    Py_BEGIN_ALLOW_THREADS
     ret = ped_geometry_write(geom, in_buf, offset, count);
+    Py_END_ALLOW_THREADS
+    _ped_Lock_release(_ped_Device_lock(geom->dev));
+
     if (ret == 0) {
         if (partedExnRaised) {
             partedExnRaised = 0;
@@ -699,6 +751,8 @@ PyObject *py_ped_geometry_write(PyObject *s, PyObject *args)
         return NULL;
     }
 
+    STATS_WRITE(geom->dev, count);
+
     if (ret) {
         Py_RETURN_TRUE;
     } else {
@@ -723,7 +777,7 @@ PyObject *py_ped_geometry_check(PyObject *s, PyObject *args) {
         return NULL;
     }
 
-    if (!geom->dev->open_count) {
+    if (!_ped_DevicePool_open_count(geom->dev)) {
         PyErr_Format(IOException, "Device %s is not open.", geom->dev->path);
         return NULL;
     }
@@ -746,23 +800,29 @@ PyObject *py_ped_geometry_check(PyObject *s, PyObject *args) {
         return PyErr_NoMemory();
     }
 
+    _ped_Lock_write(_ped_Device_lock(geom->dev));
     ret = ped_geometry_check(geom, out_buf, 32, offset, granularity, count, out_timer);
+    _ped_Lock_release(_ped_Device_lock(geom->dev));
     ped_timer_destroy(out_timer);
     free(out_buf);
     return PyLong_FromLongLong(ret);
 }
 
-PyObject *py_ped_geometry_map(PyObject *s, PyObject *args)
+PyObject *py_ped_geometry_map(PyObject *s, PyObject *const *args, Py_ssize_t nargs)
 {
     int ret = -1;
     PyObject *in_dst = NULL;
     PedGeometry *out_dst = NULL, *src = NULL;
     PedSector sector;
 
-    if (!PyArg_ParseTuple(args, "O!L", &_ped_Geometry_Type_obj, &in_dst, &sector)) {
+    if (_ped_args_count("map", nargs, 2, 2) == -1 ||
+        _ped_args_object("map", 0, args[0], &_ped_Geometry_Type_obj) == -1 ||
+        _ped_args_sector(args[1], &sector) == -1) {
         return NULL;
     }
 
+    in_dst = args[0];
+
     src = _ped_Geometry2PedGeometry(s);
 
     if (src == NULL) {
@@ -0,0 +1,545 @@
+/*
+ * pylayout.c
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <Python.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "convert.h"
+#include "exceptions.h"
+#include "pydevice.h"
+#include "pydisk.h"
+#include "pylayout.h"
+#include "pylock.h"
+#include "pysnapshot.h"
+
+/* size of the fixed part of an entry, before the two names */
+#define LAYOUT_ENTRY_SIZE 61
+
+/* one bit per flag is stored, so only the first 64 flags survive */
+#define LAYOUT_FLAG_BITS 64
+
+/* partition numbers past this are not a real table */
+#define LAYOUT_NUM_MAX 65535
+
+/* the partition types a snapshot entry can have */
+#define LAYOUT_TYPE_BITS (PED_PARTITION_LOGICAL | PED_PARTITION_EXTENDED | PED_PARTITION_PROTECTED)
+
+/* bits in an entry's "has" byte */
+#define LAYOUT_HAS_TYPE_ID 0x01
+#define LAYOUT_HAS_TYPE_UUID 0x02
+#define LAYOUT_HAS_NAME 0x04
+
+typedef struct {
+    unsigned int version;
+    unsigned int header_size;
+    uint32_t record_size;
+    char label[17];
+    uint32_t sector_size;
+    int64_t length;
+    int64_t align_offset;
+    int64_t align_grain;
+    uint32_t count;
+} _ped_LayoutHeader;
+
+static void put_u16(unsigned char *p, uint16_t v)
+{
+    p[0] = v & 0xff;
+    p[1] = v >> 8;
+}
+
+static void put_u32(unsigned char *p, uint32_t v)
+{
+    put_u16(p, v & 0xffff);
+    put_u16(p + 2, v >> 16);
+}
+
+static void put_u64(unsigned char *p, uint64_t v)
+{
+    put_u32(p, v & 0xffffffff);
+    put_u32(p + 4, v >> 32);
+}
+
+static uint16_t get_u16(const unsigned char *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t get_u32(const unsigned char *p)
+{
+    return get_u16(p) | ((uint32_t) get_u16(p + 2) << 16);
+}
+
+static uint64_t get_u64(const unsigned char *p)
+{
+    return get_u32(p) | ((uint64_t) get_u32(p + 4) << 32);
+}
+
+static Py_ssize_t entry_size(const _ped_SnapshotEntry *entry)
+{
+    Py_ssize_t size = LAYOUT_ENTRY_SIZE + 2;
+
+    if (entry->fs_type != NULL) {
+        size += strlen(entry->fs_type->name);
+    }
+
+    if (entry->name != NULL) {
+        size += strlen(entry->name);
+    }
+
+    return size;
+}
+
+static void write_entry(unsigned char *p, const _ped_SnapshotEntry *entry)
+{
+    size_t fs_len = entry->fs_type ? strlen(entry->fs_type->name) : 0;
+    size_t name_len = entry->name ? strlen(entry->name) : 0;
+    uint64_t known = 0, set = 0;
+    int f;
+
+    for (f = 0; f <= PED_PARTITION_LAST_FLAG && f < LAYOUT_FLAG_BITS; f++) {
+        if (entry->flags[f] != -1) {
+            known |= (uint64_t) 1 << f;
+            set |= (uint64_t) entry->flags[f] << f;
+        }
+    }
+
+    put_u16(p, entry_size(entry));
+    p[2] = (entry->has_type_id ? LAYOUT_HAS_TYPE_ID : 0) |
+           (entry->has_type_uuid ? LAYOUT_HAS_TYPE_UUID : 0) |
+           (entry->name ? LAYOUT_HAS_NAME : 0);
+    p[3] = entry->type_id;
+    put_u32(p + 4, entry->num);
+    put_u32(p + 8, entry->type);
+    put_u64(p + 12, entry->start);
+    put_u64(p + 20, entry->end);
+    put_u64(p + 28, known);
+    put_u64(p + 36, set);
+    memcpy(p + 44, entry->type_uuid, 16);
+    p[60] = fs_len;
+    memcpy(p + 61, entry->fs_type ? entry->fs_type->name : "", fs_len);
+    put_u16(p + 61 + fs_len, name_len);
+    memcpy(p + 63 + fs_len, entry->name ? entry->name : "", name_len);
+}
+
+PyObject *py_ped_disk_export_layout(PyObject *s, PyObject *args)
+{
+    PedDisk *disk = NULL;
+    PedAlignment *align = NULL;
+    _ped_DiskSnapshot *snap = NULL;
+    PyObject *ret = NULL;
+    unsigned char *p = NULL;
+    Py_ssize_t size = LAYOUT_HEADER_SIZE;
+    uint32_t known = 0, set = 0;
+    int i, f;
+
+    disk = _ped_Disk2PedDisk(s);
+
+    if (disk == NULL) {
+        return NULL;
+    }
+
+    _ped_Lock_read(&((_ped_Disk *) s)->lock);
+    snap = _ped_DiskSnapshot_take(disk);
+    align = ped_disk_get_partition_alignment(disk);
+    _ped_Lock_release(&((_ped_Disk *) s)->lock);
+
+    if (snap == NULL) {
+        goto out;
+    }
+
+    for (i = 0; i < snap->count; i++) {
+        Py_ssize_t len = entry_size(&snap->entries[i]);
+
+        if (len > UINT16_MAX || (snap->entries[i].fs_type && strlen(snap->entries[i].fs_type->name) > UINT8_MAX)) {
+            PyErr_Format(PyExc_ValueError, "Partition %d on %s has names too long to export", snap->entries[i].num, disk->dev->path);
+            goto out;
+        }
+
+        size += len;
+    }
+
+    if (strlen(disk->type->name) > 16 || size > UINT32_MAX) {
+        PyErr_Format(PyExc_ValueError, "Cannot export the layout of %s", disk->dev->path);
+        goto out;
+    }
+
+    for (f = 0; f <= PED_DISK_LAST_FLAG && f < 32; f++) {
+        if (snap->disk_flags[f] != -1) {
+            known |= (uint32_t) 1 << f;
+            set |= (uint32_t) snap->disk_flags[f] << f;
+        }
+    }
+
+    ret = PyBytes_FromStringAndSize(NULL, size);
+
+    if (ret == NULL) {
+        goto out;
+    }
+
+    p = (unsigned char *) PyBytes_AS_STRING(ret);
+    memset(p, 0, LAYOUT_HEADER_SIZE);
+    memcpy(p, LAYOUT_MAGIC, 4);
+    put_u16(p + 4, LAYOUT_VERSION);
+    put_u16(p + 6, LAYOUT_HEADER_SIZE);
+    put_u32(p + 8, size);
+    memcpy(p + 12, disk->type->name, strlen(disk->type->name));
+    put_u32(p + 28, disk->dev->sector_size);
+    put_u64(p + 32, disk->dev->length);
+    put_u64(p + 40, align ? align->offset : 0);
+    put_u64(p + 48, align ? align->grain_size : 0);
+    put_u32(p + 56, known);
+    put_u32(p + 60, set);
+    put_u32(p + 64, snap->count);
+    p += LAYOUT_HEADER_SIZE;
+
+    for (i = 0; i < snap->count; i++) {
+        write_entry(p, &snap->entries[i]);
+        p += get_u16(p);
+    }
+
+out:
+    if (align != NULL) {
+        ped_alignment_destroy(align);
+    }
+
+    _ped_DiskSnapshot_free(snap);
+    return ret;
+}
+
+static int layout_invalid(const char *why)
+{
+    PyErr_Format(PyExc_ValueError, "Invalid layout data: %s", why);
+    return -1;
+}
+
+static int read_header(const unsigned char *p, Py_ssize_t len, _ped_LayoutHeader *hdr)
+{
+    if (len < LAYOUT_HEADER_SIZE || memcmp(p, LAYOUT_MAGIC, 4)) {
+        return layout_invalid("no layout header");
+    }
+
+    hdr->version = get_u16(p + 4);
+    hdr->header_size = get_u16(p + 6);
+    hdr->record_size = get_u32(p + 8);
+
+    if (hdr->version < 1 || hdr->header_size < LAYOUT_HEADER_SIZE || hdr->record_size < hdr->header_size) {
+        return layout_invalid("bad header");
+    }
+
+    memcpy(hdr->label, p + 12, 16);
+    hdr->label[16] = '\0';
+    hdr->sector_size = get_u32(p + 28);
+    hdr->length = get_u64(p + 32);
+    hdr->align_offset = get_u64(p + 40);
+    hdr->align_grain = get_u64(p + 48);
+    hdr->count = get_u32(p + 64);
+    return 0;
+}
+
+/*
+ * Parse the first record in p into a snapshot with no disk attached.
+ * The snapshot is what the restore and diff code already work on, so
+ * nothing here builds Python objects per partition.
+ */
+static _ped_DiskSnapshot *read_layout(const unsigned char *p, Py_ssize_t len, _ped_LayoutHeader *hdr)
+{
+    _ped_DiskSnapshot *snap = NULL;
+    const unsigned char *end = NULL;
+    uint32_t known, set, i;
+    int f;
+
+    if (read_header(p, len, hdr) == -1) {
+        return NULL;
+    }
+
+    if (hdr->record_size > len) {
+        layout_invalid("record is truncated");
+        return NULL;
+    }
+
+    /* every entry takes at least its fixed part */
+    if (hdr->count > (hdr->record_size - hdr->header_size) / (LAYOUT_ENTRY_SIZE + 2)) {
+        layout_invalid("too many entries");
+        return NULL;
+    }
+
+    snap = PyMem_Calloc(1, sizeof(*snap));
+
+    if (snap == NULL || (snap->entries = PyMem_Calloc(hdr->count ? hdr->count : 1, sizeof(_ped_SnapshotEntry))) == NULL) {
+        PyMem_Free(snap);
+        PyErr_NoMemory();
+        return NULL;
+    }
+
+    snap->type = ped_disk_type_get(hdr->label);
+
+    if (snap->type == NULL) {
+        PyErr_SetString(UnknownTypeException, hdr->label);
+        goto error;
+    }
+
+    known = get_u32(p + 56);
+    set = get_u32(p + 60);
+
+    for (f = 0; f <= PED_DISK_LAST_FLAG; f++) {
+        snap->disk_flags[f] = f < 32 && (known >> f) & 1 ? (set >> f) & 1 : -1;
+    }
+
+    end = p + hdr->record_size;
+    p += hdr->header_size;
+
+    for (i = 0; i < hdr->count; i++) {
+        _ped_SnapshotEntry *entry = &snap->entries[i];
+        uint64_t flags_known, flags_set;
+        unsigned int size, fs_len, name_len;
+        char fs_name[256];
+
+        if (end - p < LAYOUT_ENTRY_SIZE + 2 || (size = get_u16(p)) > end - p) {
+            layout_invalid("entry is truncated");
+            goto error;
+        }
+
+        fs_len = p[60];
+
+        if (size < LAYOUT_ENTRY_SIZE + 2 + fs_len || size < LAYOUT_ENTRY_SIZE + 2 + fs_len + (name_len = get_u16(p + 61 + fs_len))) {
+            layout_invalid("entry is truncated");
+            goto error;
+        }
+
+        entry->num = (int32_t) get_u32(p + 4);
+        entry->type = get_u32(p + 8);
+        entry->start = get_u64(p + 12);
+        entry->end = get_u64(p + 20);
+        entry->has_type_id = (p[2] & LAYOUT_HAS_TYPE_ID) != 0;
+        entry->type_id = p[3];
+        entry->has_type_uuid = (p[2] & LAYOUT_HAS_TYPE_UUID) != 0;
+        memcpy(entry->type_uuid, p + 44, 16);
+        flags_known = get_u64(p + 28);
+        flags_set = get_u64(p + 36);
+        snap->count++;
+
+        if (entry->num < 1 || entry->num > LAYOUT_NUM_MAX) {
+            layout_invalid("bad partition number");
+            goto error;
+        }
+
+        if ((entry->type & ~LAYOUT_TYPE_BITS) || ((entry->type & PED_PARTITION_LOGICAL) && (entry->type & PED_PARTITION_EXTENDED))) {
+            layout_invalid("bad partition type");
+            goto error;
+        }
+
+        if (entry->start < 0 || entry->end < entry->start || (hdr->length > 0 && entry->end >= hdr->length)) {
+            layout_invalid("partition is out of range");
+            goto error;
+        }
+
+        for (f = 0; f <= PED_PARTITION_LAST_FLAG; f++) {
+            entry->flags[f] = f < LAYOUT_FLAG_BITS && (flags_known >> f) & 1 ? (flags_set >> f) & 1 : -1;
+        }
+
+        if (fs_len > 0) {
+            memcpy(fs_name, p + 61, fs_len);
+            fs_name[fs_len] = '\0';
+            entry->fs_type = ped_file_system_type_get(fs_name);
+
+            if (entry->fs_type == NULL) {
+                PyErr_SetString(UnknownTypeException, fs_name);
+                goto error;
+            }
+        }
+
+        if (p[2] & LAYOUT_HAS_NAME) {
+            entry->name = PyMem_Malloc(name_len + 1);
+
+            if (entry->name == NULL) {
+                PyErr_NoMemory();
+                goto error;
+            }
+
+            memcpy(entry->name, p + 63 + fs_len, name_len);
+            entry->name[name_len] = '\0';
+        }
+
+        p += size;
+    }
+
+    return snap;
+
+error:
+    _ped_DiskSnapshot_free(snap);
+    return NULL;
+}
+
+/*
+ * Check the entries of snap fit the fresh label disk was given: numbers
+ * the label supports, and, where the label wants different alignment than
+ * the one recorded in hdr, starts on sectors it accepts.  Returns 0 with
+ * an exception set if not.
+ */
+static int check_layout(PedDisk *disk, const _ped_LayoutHeader *hdr, const _ped_DiskSnapshot *snap)
+{
+    PedAlignment *align = ped_disk_get_partition_alignment(disk);
+    int i, max = 0, supported = 0, same;
+
+    same = align == NULL || (hdr->align_grain == align->grain_size && hdr->align_offset == align->offset);
+
+    if (!ped_disk_get_max_supported_partition_count(disk, &supported)) {
+        supported = 0;
+    }
+
+    max = supported ? supported : LAYOUT_NUM_MAX;
+
+    for (i = 0; i < snap->count; i++) {
+        const _ped_SnapshotEntry *entry = &snap->entries[i];
+
+        if (entry->num > max || entry->end >= disk->dev->length) {
+            PyErr_Format(DiskException, "Partition %d of the layout does not fit on %s", entry->num, disk->dev->path);
+            break;
+        }
+
+        if (!same && !ped_alignment_is_aligned(align, NULL, entry->start)) {
+            PyErr_Format(DiskException, "Partition %d of the layout is not aligned for %s", entry->num, disk->dev->path);
+            break;
+        }
+    }
+
+    if (align != NULL) {
+        ped_alignment_destroy(align);
+    }
+
+    return i == snap->count;
+}
+
+PyObject *py_ped_disk_new_from_layout(PyObject *s, PyObject *args)
+{
+    _ped_Device *in_device = NULL;
+    Py_buffer data;
+    _ped_LayoutHeader hdr;
+    _ped_DiskSnapshot *snap = NULL;
+    PedDevice *device = NULL;
+    PedDisk *disk = NULL;
+    _ped_Disk *ret = NULL;
+    int ok = 0;
+
+    if (!PyArg_ParseTuple(args, "O!y*", &_ped_Device_Type_obj, &in_device, &data)) {
+        return NULL;
+    }
+
+    snap = read_layout(data.buf, data.len, &hdr);
+    PyBuffer_Release(&data);
+
+    if (snap == NULL) {
+        return NULL;
+    }
+
+    device = _ped_Device2PedDevice((PyObject *) in_device);
+
+    if (device == NULL) {
+        goto out;
+    }
+
+    if (hdr.sector_size != device->sector_size) {
+        PyErr_Format(DiskException, "Layout is for %u byte sectors but %s has %lld byte sectors", hdr.sector_size, device->path, device->sector_size);
+        goto out;
+    }
+
+    if (hdr.length > device->length) {
+        PyErr_Format(DiskException, "Layout is for %lld sectors but %s only has %lld", (long long) hdr.length, device->path, device->length);
+        goto out;
+    }
+
+    if (_ped_Device_check_writable(device) == -1) {
+        goto out;
+    }
+
+    _ped_Lock_read(_ped_Device_lock(device));
+    disk = ped_disk_new_fresh(device, snap->type);
+    _ped_Lock_release(_ped_Device_lock(device));
+
+    if (disk == NULL) {
+        if (partedExnRaised) {
+            partedExnRaised = 0;
+
+            if (!PyErr_ExceptionMatches(PartedException) && !PyErr_ExceptionMatches(PyExc_NotImplementedError)) {
+                PyErr_SetString(DiskException, partedExnMessage);
+            }
+        } else {
+            PyErr_Format(DiskException, "Could not create new disk label on %s", device->path);
+        }
+
+        goto out;
+    }
+
+    ret = PedDisk2_ped_Disk(disk);
+
+    if (ret == NULL) {
+        goto out;
+    }
+
+    _ped_Lock_write(&ret->lock);
+    ok = check_layout(disk, &hdr, snap) && _ped_DiskSnapshot_restore(ret, disk, snap);
+    _ped_Lock_release(&ret->lock);
+
+    if (!ok) {
+        Py_CLEAR(ret);
+    }
+
+out:
+    _ped_DiskSnapshot_free(snap);
+    return (PyObject *) ret;
+}
+
+PyObject *py_ped_layout_header(PyObject *s, PyObject *args)
+{
+    Py_buffer data;
+    _ped_LayoutHeader hdr;
+    int rc;
+
+    if (!PyArg_ParseTuple(args, "y*", &data)) {
+        return NULL;
+    }
+
+    rc = read_header(data.buf, data.len, &hdr);
+    PyBuffer_Release(&data);
+
+    if (rc == -1) {
+        return NULL;
+    }
+
+    return Py_BuildValue("(IsIL(LL)II)", hdr.version, hdr.label, hdr.sector_size, (long long) hdr.length,
+                         (long long) hdr.align_offset, (long long) hdr.align_grain, hdr.count, hdr.record_size);
+}
+
+PyObject *py_ped_layout_diff(PyObject *s, PyObject *args)
+{
+    Py_buffer old_data, new_data;
+    _ped_LayoutHeader old_hdr, new_hdr;
+    _ped_DiskSnapshot *old = NULL, *new = NULL;
+    PyObject *ret = NULL;
+
+    if (!PyArg_ParseTuple(args, "y*y*", &old_data, &new_data)) {
+        return NULL;
+    }
+
+    old = read_layout(old_data.buf, old_data.len, &old_hdr);
+
+    if (old != NULL) {
+        new = read_layout(new_data.buf, new_data.len, &new_hdr);
+    }
+
+    PyBuffer_Release(&old_data);
+    PyBuffer_Release(&new_data);
+
+    if (new != NULL) {
+        ret = _ped_DiskSnapshot_diff(old, new);
+    }
+
+    _ped_DiskSnapshot_free(old);
+    _ped_DiskSnapshot_free(new);
+    return ret;
+}
@@ -0,0 +1,105 @@
+/*
+ * pylock.c
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <Python.h>
+#include <stdint.h>
+
+#include "pylock.h"
+
+static _ped_Lock device_locks[DEVICE_LOCK_COUNT];
+
+int _ped_Lock_init(_ped_Lock *lock)
+{
+    if (pthread_rwlock_init(&lock->rwlock, NULL) != 0) {
+        lock->initialized = 0;
+        PyErr_SetString(PyExc_RuntimeError, "Could not initialize lock");
+        return -1;
+    }
+
+    lock->initialized = 1;
+    return 0;
+}
+
+void _ped_Lock_destroy(_ped_Lock *lock)
+{
+    if (lock->initialized) {
+        pthread_rwlock_destroy(&lock->rwlock);
+        lock->initialized = 0;
+    }
+}
+
+/*
+ * The caller must hold the GIL.  If the lock is not immediately available
+ * the GIL is dropped while waiting so the thread holding the lock can
+ * finish whatever it is doing, even if that means calling back into Python.
+ */
+void _ped_Lock_read(_ped_Lock *lock)
+{
+    if (lock == NULL || !lock->initialized) {
+        return;
+    }
+
+    if (pthread_rwlock_tryrdlock(&lock->rwlock) == 0) {
+        return;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    pthread_rwlock_rdlock(&lock->rwlock);
+    Py_END_ALLOW_THREADS
+}
+
+void _ped_Lock_write(_ped_Lock *lock)
+{
+    if (lock == NULL || !lock->initialized) {
+        return;
+    }
+
+    if (pthread_rwlock_trywrlock(&lock->rwlock) == 0) {
+        return;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    pthread_rwlock_wrlock(&lock->rwlock);
+    Py_END_ALLOW_THREADS
+}
+
+/* For threads that do not hold the GIL, such as worker threads. */
+void _ped_Lock_write_nogil(_ped_Lock *lock)
+{
+    if (lock != NULL && lock->initialized) {
+        pthread_rwlock_wrlock(&lock->rwlock);
+    }
+}
+
+void _ped_Lock_release(_ped_Lock *lock)
+{
+    if (lock != NULL && lock->initialized) {
+        pthread_rwlock_unlock(&lock->rwlock);
+    }
+}
+
+int _ped_Device_lock_init(void)
+{
+    int i;
+
+    for (i = 0; i < DEVICE_LOCK_COUNT; i++) {
+        if (_ped_Lock_init(&device_locks[i]) == -1) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+_ped_Lock *_ped_Device_lock(const PedDevice *device)
+{
+    uintptr_t key = (uintptr_t) device;
+
+    /* PedDevice allocations are at least 16 byte aligned */
+    key = (key >> 4) ^ (key >> 10);
+    return &device_locks[key & (DEVICE_LOCK_COUNT - 1)];
+}
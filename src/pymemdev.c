@@ -0,0 +1,341 @@
+/*
+ * pymemdev.c
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <Python.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "convert.h"
+#include "exceptions.h"
+#include "pydevice.h"
+#include "pymemdev.h"
+#include "pynatmath.h"
+
+typedef struct _ped_MemoryDevice {
+    char path[32];
+    int fd;
+
+    /* identifies this device to the _ped.Device objects made for it */
+    unsigned long serial;
+    Py_ssize_t refs;
+
+    /* grain_size 0 means no alignment was given */
+    PedSector align_offset[2];
+    PedSector align_grain[2];
+
+    struct _ped_MemoryDevice *next;
+} _ped_MemoryDevice;
+
+static _ped_MemoryDevice *memory_devices = NULL;
+static unsigned long memory_serial = 0;
+
+/* tries at finding a descriptor whose path libparted has not cached */
+#define MEMORY_DEVICE_PATH_TRIES 16
+
+static _ped_MemoryDevice *memory_device_find(const char *path)
+{
+    _ped_MemoryDevice *mem;
+
+    for (mem = memory_devices; mem != NULL; mem = mem->next) {
+        if (!strcmp(mem->path, path)) {
+            return mem;
+        }
+    }
+
+    return NULL;
+}
+
+static PedDevice *memory_device_cached(const char *path)
+{
+    PedDevice *device;
+
+    for (device = ped_device_get_next(NULL); device != NULL; device = ped_device_get_next(device)) {
+        if (!strcmp(device->path, path)) {
+            return device;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Destroy the cached PedDevice and close the memfd of the memory device
+ * with this serial, if it is still around.  Only called once nothing in
+ * Python refers to the device any more, so no other thread can be using
+ * it and the device lock is not needed.
+ */
+static void memory_device_drop(unsigned long serial)
+{
+    _ped_MemoryDevice *mem;
+    PedDevice *device;
+    char path[sizeof(mem->path)];
+
+    for (mem = memory_devices; mem != NULL; mem = mem->next) {
+        if (mem->serial == serial) {
+            break;
+        }
+    }
+
+    if (mem == NULL) {
+        return;
+    }
+
+    /* destroying the device may already forget mem */
+    memcpy(path, mem->path, sizeof(path));
+    device = memory_device_cached(path);
+
+    if (device != NULL) {
+        ped_device_destroy(device);
+    }
+
+    _ped_MemoryDevice_forget(path);
+}
+
+static int memory_device_hint(PyObject *in, _ped_MemoryDevice *mem, int optimum)
+{
+    if (in == Py_None) {
+        return 0;
+    }
+
+    if (!PyObject_TypeCheck(in, &_ped_Alignment_Type_obj)) {
+        PyErr_Format(PyExc_TypeError, "alignment must be a _ped.Alignment or None, not %s", Py_TYPE(in)->tp_name);
+        return -1;
+    }
+
+    if (((_ped_Alignment *) in)->grain_size <= 0) {
+        PyErr_SetString(PyExc_ValueError, "alignment grain size must be positive");
+        return -1;
+    }
+
+    mem->align_offset[optimum] = ((_ped_Alignment *) in)->offset;
+    mem->align_grain[optimum] = ((_ped_Alignment *) in)->grain_size;
+    return 0;
+}
+
+PyObject *py_ped_device_new_memory(PyObject *s, PyObject *args)
+{
+    PedSector length;
+    long long sector_size = PED_SECTOR_SIZE_DEFAULT, phys_sector_size = 0;
+    PyObject *in_minimum = Py_None, *in_optimum = Py_None;
+    _ped_MemoryDevice *mem = NULL;
+    PedDevice *device = NULL;
+    _ped_Device *ret = NULL;
+    unsigned long serial;
+    int fd, tries;
+
+    if (!PyArg_ParseTuple(args, "L|LLOO", &length, &sector_size, &phys_sector_size, &in_minimum, &in_optimum)) {
+        return NULL;
+    }
+
+    if (phys_sector_size == 0) {
+        phys_sector_size = sector_size;
+    }
+
+    if (sector_size < PED_SECTOR_SIZE_DEFAULT || (sector_size & (sector_size - 1))) {
+        PyErr_Format(PyExc_ValueError, "Invalid sector size %lld", sector_size);
+        return NULL;
+    }
+
+    if (phys_sector_size < sector_size || phys_sector_size % sector_size) {
+        PyErr_Format(PyExc_ValueError, "Invalid physical sector size %lld", phys_sector_size);
+        return NULL;
+    }
+
+    if (length <= 0 || length > PY_LLONG_MAX / sector_size) {
+        PyErr_Format(PyExc_ValueError, "Invalid device length %lld", length);
+        return NULL;
+    }
+
+    mem = PyMem_Calloc(1, sizeof(*mem));
+
+    if (mem == NULL) {
+        return PyErr_NoMemory();
+    }
+
+    if (memory_device_hint(in_minimum, mem, 0) == -1 || memory_device_hint(in_optimum, mem, 1) == -1) {
+        PyMem_Free(mem);
+        return NULL;
+    }
+
+#ifdef MFD_CLOEXEC
+    mem->fd = memfd_create("pyparted", MFD_CLOEXEC);
+#else
+    mem->fd = -1;
+    errno = ENOSYS;
+#endif
+
+    if (mem->fd == -1 || ftruncate(mem->fd, length * sector_size) == -1) {
+        PyErr_Format(IOException, "Could not create memory device: %s", strerror(errno));
+
+        if (mem->fd != -1) {
+            close(mem->fd);
+        }
+
+        PyMem_Free(mem);
+        return NULL;
+    }
+
+    PyOS_snprintf(mem->path, sizeof(mem->path), "/proc/self/fd/%d", mem->fd);
+
+    /*
+     * A recycled descriptor number may still be cached for another file,
+     * possibly by a live _ped.Device.  Move to a higher descriptor rather
+     * than pull that PedDevice out from under it.
+     */
+    for (tries = 0; memory_device_cached(mem->path) != NULL; tries++) {
+        fd = tries < MEMORY_DEVICE_PATH_TRIES ? fcntl(mem->fd, F_DUPFD_CLOEXEC, mem->fd + 1) : -1;
+
+        if (fd == -1) {
+            PyErr_Format(DeviceException, "Could not create memory device, %s is already in use", mem->path);
+            close(mem->fd);
+            PyMem_Free(mem);
+            return NULL;
+        }
+
+        close(mem->fd);
+        mem->fd = fd;
+        PyOS_snprintf(mem->path, sizeof(mem->path), "/proc/self/fd/%d", mem->fd);
+    }
+
+    device = ped_device_get(mem->path);
+
+    if (device == NULL) {
+        if (partedExnRaised) {
+            partedExnRaised = 0;
+
+            if (!PyErr_ExceptionMatches(PartedException) && !PyErr_ExceptionMatches(PyExc_NotImplementedError)) {
+                PyErr_SetString(IOException, partedExnMessage);
+            }
+        } else {
+            PyErr_Format(DeviceException, "Could not create memory device %s", mem->path);
+        }
+
+        close(mem->fd);
+        PyMem_Free(mem);
+        return NULL;
+    }
+
+    /*
+     * The probe treats the memfd like any image file, 512 byte sectors
+     * included.  libparted does all of its I/O in units of the fields
+     * below, so overriding them is enough to emulate other sector sizes.
+     */
+    device->sector_size = sector_size;
+    device->phys_sector_size = phys_sector_size;
+    device->length = length;
+
+    if (device->bios_geom.heads > 0 && device->bios_geom.sectors > 0) {
+        device->bios_geom.cylinders = length / (device->bios_geom.heads * device->bios_geom.sectors);
+        device->hw_geom = device->bios_geom;
+    }
+
+    mem->serial = serial = ++memory_serial;
+    mem->next = memory_devices;
+    memory_devices = mem;
+
+    ret = PedDevice2_ped_Device(device);
+
+    if (ret == NULL) {
+        memory_device_drop(serial);
+    }
+
+    return (PyObject *) ret;
+}
+
+unsigned long _ped_MemoryDevice_hold(const char *path)
+{
+    _ped_MemoryDevice *mem = memory_device_find(path);
+
+    if (mem == NULL) {
+        return 0;
+    }
+
+    mem->refs++;
+    return mem->serial;
+}
+
+void _ped_MemoryDevice_release(unsigned long serial)
+{
+    _ped_MemoryDevice *mem;
+
+    for (mem = memory_devices; mem != NULL; mem = mem->next) {
+        if (mem->serial == serial) {
+            if (--mem->refs == 0) {
+                memory_device_drop(serial);
+            }
+
+            return;
+        }
+    }
+}
+
+PedAlignment *_ped_MemoryDevice_alignment(const PedDevice *dev, int optimum)
+{
+    _ped_MemoryDevice *mem = memory_device_find(dev->path);
+
+    if (mem == NULL || mem->align_grain[optimum] == 0) {
+        return NULL;
+    }
+
+    return ped_alignment_new(mem->align_offset[optimum], mem->align_grain[optimum]);
+}
+
+/* mirrors the aligned constraint libparted builds for real devices */
+PedConstraint *_ped_MemoryDevice_constraint(const PedDevice *dev, int optimum)
+{
+    PedAlignment *start_align = NULL, *end_align = NULL;
+    PedGeometry *whole = NULL;
+    PedConstraint *ret = NULL;
+
+    start_align = _ped_MemoryDevice_alignment(dev, optimum);
+
+    if (start_align == NULL) {
+        return NULL;
+    }
+
+    end_align = ped_alignment_new(start_align->offset - 1, start_align->grain_size);
+    whole = ped_geometry_new(dev, 0, dev->length);
+
+    if (end_align != NULL && whole != NULL) {
+        ret = ped_constraint_new(start_align, end_align, whole, whole, 1, dev->length);
+    }
+
+    if (whole != NULL) {
+        ped_geometry_destroy(whole);
+    }
+
+    if (end_align != NULL) {
+        ped_alignment_destroy(end_align);
+    }
+
+    ped_alignment_destroy(start_align);
+    return ret;
+}
+
+void _ped_MemoryDevice_forget(const char *path)
+{
+    _ped_MemoryDevice **link, *mem;
+
+    for (link = &memory_devices; (mem = *link) != NULL; link = &mem->next) {
+        if (!strcmp(mem->path, path)) {
+            *link = mem->next;
+            close(mem->fd);
+            PyMem_Free(mem);
+            return;
+        }
+    }
+}
+
+void _ped_MemoryDevice_forget_all(void)
+{
+    while (memory_devices != NULL) {
+        _ped_MemoryDevice_forget(memory_devices->path);
+    }
+}
@@ -9,16 +9,24 @@
 
 #include "convert.h"
 #include "exceptions.h"
+#include "pyargs.h"
 #include "pydevice.h"
+#include "pyfreelist.h"
 #include "pynatmath.h"
 #include "docstrings/pynatmath.h"
 #include "typeobjects/pynatmath.h"
 
+static _ped_FreeList alignment_freelist = FREELIST_INIT(&_ped_Alignment_Type_obj);
+
 /* _ped.Alignment functions */
+PyObject *_ped_Alignment_alloc(PyTypeObject *type, Py_ssize_t nitems)
+{
+    return _ped_FreeList_alloc(&alignment_freelist, type, nitems);
+}
+
 void _ped_Alignment_dealloc(_ped_Alignment *self)
 {
-    PyObject_GC_UnTrack(self);
-    PyObject_GC_Del(self);
+    _ped_FreeList_free(&alignment_freelist, (PyObject *) self);
 }
 
 int _ped_Alignment_compare(_ped_Alignment *self, PyObject *obj)
@@ -81,16 +89,6 @@ PyObject *_ped_Alignment_str(_ped_Alignment *self)
     return ret;
 }
 
-int _ped_Alignment_traverse(_ped_Alignment *self, visitproc visit, void *arg)
-{
-    return 0;
-}
-
-int _ped_Alignment_clear(_ped_Alignment *self)
-{
-    return 0;
-}
-
 int _ped_Alignment_init(_ped_Alignment *self, PyObject *args, PyObject *kwds)
 {
     static char *kwlist[] = { "offset", "grain_size", NULL };
@@ -222,17 +220,21 @@ PyObject *py_ped_alignment_intersect(PyObject *s, PyObject *args)
     return (PyObject *) ret;
 }
 
-PyObject *py_ped_alignment_align_up(PyObject *s, PyObject *args)
+PyObject *py_ped_alignment_align_up(PyObject *s, PyObject *const *args, Py_ssize_t nargs)
 {
     PyObject *in_geom = NULL;
     PedAlignment *align = NULL;
     PedGeometry *out_geom = NULL;
     PedSector sector, ret;
 
-    if (!PyArg_ParseTuple(args, "O!L", &_ped_Geometry_Type_obj, &in_geom, &sector)) {
+    if (_ped_args_count("align_up", nargs, 2, 2) == -1 ||
+        _ped_args_object("align_up", 0, args[0], &_ped_Geometry_Type_obj) == -1 ||
+        _ped_args_sector(args[1], &sector) == -1) {
         return NULL;
     }
 
+    in_geom = args[0];
+
     align = _ped_Alignment2PedAlignment(s);
 
     if (align == NULL) {
@@ -256,17 +258,21 @@ PyObject *py_ped_alignment_align_up(PyObject *s, PyObject *args)
     return PyLong_FromLongLong(ret);
 }
 
-PyObject *py_ped_alignment_align_down(PyObject *s, PyObject *args)
+PyObject *py_ped_alignment_align_down(PyObject *s, PyObject *const *args, Py_ssize_t nargs)
 {
     PyObject *in_geom = NULL;
     PedAlignment *align = NULL;
     PedGeometry *out_geom = NULL;
     PedSector sector, ret;
 
-    if (!PyArg_ParseTuple(args, "O!L", &_ped_Geometry_Type_obj, &in_geom, &sector)) {
+    if (_ped_args_count("align_down", nargs, 2, 2) == -1 ||
+        _ped_args_object("align_down", 0, args[0], &_ped_Geometry_Type_obj) == -1 ||
+        _ped_args_sector(args[1], &sector) == -1) {
         return NULL;
     }
 
+    in_geom = args[0];
+
     align = _ped_Alignment2PedAlignment(s);
 
     if (align == NULL) {
@@ -290,17 +296,21 @@ PyObject *py_ped_alignment_align_down(PyObject *s, PyObject *args)
     return PyLong_FromLongLong(ret);
 }
 
-PyObject *py_ped_alignment_align_nearest(PyObject *s, PyObject *args)
+PyObject *py_ped_alignment_align_nearest(PyObject *s, PyObject *const *args, Py_ssize_t nargs)
 {
     PyObject *in_geom = NULL;
     PedAlignment *align = NULL;
     PedGeometry *out_geom = NULL;
     PedSector sector, ret;
 
-    if (!PyArg_ParseTuple(args, "O!L", &_ped_Geometry_Type_obj, &in_geom, &sector)) {
+    if (_ped_args_count("align_nearest", nargs, 2, 2) == -1 ||
+        _ped_args_object("align_nearest", 0, args[0], &_ped_Geometry_Type_obj) == -1 ||
+        _ped_args_sector(args[1], &sector) == -1) {
         return NULL;
     }
 
+    in_geom = args[0];
+
     align = _ped_Alignment2PedAlignment(s);
 
     if (align == NULL) {
@@ -324,7 +334,7 @@ PyObject *py_ped_alignment_align_nearest(PyObject *s, PyObject *args)
     return PyLong_FromLongLong(ret);
 }
 
-PyObject *py_ped_alignment_is_aligned(PyObject *s, PyObject *args)
+PyObject *py_ped_alignment_is_aligned(PyObject *s, PyObject *const *args, Py_ssize_t nargs)
 {
     int ret = -1;
     PyObject *in_geom = NULL;
@@ -332,10 +342,14 @@ PyObject *py_ped_alignment_is_aligned(PyObject *s, PyObject *args)
     PedGeometry *out_geom = NULL;
     PedSector sector;
 
-    if (!PyArg_ParseTuple(args, "O!L", &_ped_Geometry_Type_obj, &in_geom, &sector)) {
+    if (_ped_args_count("is_aligned", nargs, 2, 2) == -1 ||
+        _ped_args_object("is_aligned", 0, args[0], &_ped_Geometry_Type_obj) == -1 ||
+        _ped_args_sector(args[1], &sector) == -1) {
         return NULL;
     }
 
+    in_geom = args[0];
+
     align = _ped_Alignment2PedAlignment(s);
 
     if (align == NULL) {
@@ -0,0 +1,431 @@
+/*
+ * pyplan.c
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <Python.h>
+#include <string.h>
+
+#include "convert.h"
+#include "exceptions.h"
+#include "pyargs.h"
+#include "pydevice.h"
+#include "pydisk.h"
+#include "pygeom.h"
+#include "pylock.h"
+#include "pymemdev.h"
+#include "pynatmath.h"
+#include "pyplan.h"
+
+/* what a single layout entry asks for */
+enum {
+    PLAN_SECTORS,
+    PLAN_PERCENT,
+    PLAN_REST
+};
+
+typedef struct {
+    int kind;
+    double value;             /* sectors or percent, unused for PLAN_REST */
+    PedSector size;           /* aligned size once the layout is solved */
+} _ped_PlanEntry;
+
+/* what the disk label allows when planning on a Disk */
+typedef struct {
+    int primaries;            /* primary partitions still free, -1 if unlimited */
+    PedSector max_start;
+    PedSector max_length;
+    PedAlignment *alignment;  /* label alignment, NULL if none */
+} _ped_PlanLimits;
+
+static const struct {
+    const char *name;
+    double bytes;
+} plan_units[] = {
+    { "B", 1.0 },
+    { "kB", 1e3 },
+    { "MB", 1e6 },
+    { "GB", 1e9 },
+    { "TB", 1e12 },
+    { "PB", 1e15 },
+    { "EB", 1e18 },
+    { "KiB", 1024.0 },
+    { "MiB", 1048576.0 },
+    { "GiB", 1073741824.0 },
+    { "TiB", 1099511627776.0 },
+    { "PiB", 1125899906842624.0 },
+    { "EiB", 1152921504606846976.0 },
+    { NULL, 0.0 }
+};
+
+/* sizes at or past this do not fit in a PedSector */
+#define PLAN_SECTOR_MAX 9.0e18
+
+/*
+ * Parse one layout entry: a sector count, "rest", a percentage such as
+ * "20%" or a size such as "512MiB", "1.5GB" or "2048s".
+ */
+static int plan_parse_entry(PyObject *item, long long sector_size, _ped_PlanEntry *entry)
+{
+    const char *str, *unit;
+    char *end = NULL;
+    double value;
+    int i;
+
+    if (!PyUnicode_Check(item)) {
+        PedSector sectors;
+
+        if (_ped_args_sector(item, &sectors) == -1) {
+            return -1;
+        }
+
+        entry->kind = PLAN_SECTORS;
+        entry->value = (double) sectors;
+    } else {
+        str = PyUnicode_AsUTF8(item);
+
+        if (str == NULL) {
+            return -1;
+        }
+
+        while (*str == ' ') {
+            str++;
+        }
+
+        if (!strcmp(str, "rest")) {
+            entry->kind = PLAN_REST;
+            entry->value = 0.0;
+            return 0;
+        }
+
+        value = PyOS_string_to_double(str, &end, NULL);
+
+        if (value == -1.0 && PyErr_Occurred()) {
+            return -1;
+        }
+
+        for (unit = end; *unit == ' '; unit++);
+
+        if (!strcmp(unit, "%")) {
+            if (!(value <= 100.0)) {
+                PyErr_Format(PyExc_ValueError, "Invalid layout size '%s'", str);
+                return -1;
+            }
+
+            entry->kind = PLAN_PERCENT;
+            entry->value = value;
+        } else if (!strcmp(unit, "s")) {
+            entry->kind = PLAN_SECTORS;
+            entry->value = value;
+        } else {
+            for (i = 0; plan_units[i].name != NULL; i++) {
+                if (!strcmp(unit, plan_units[i].name)) {
+                    break;
+                }
+            }
+
+            if (plan_units[i].name == NULL) {
+                PyErr_Format(PyExc_ValueError, "Invalid layout size '%s'", str);
+                return -1;
+            }
+
+            entry->kind = PLAN_SECTORS;
+            entry->value = value * plan_units[i].bytes / sector_size;
+        }
+    }
+
+    if (!(entry->value > 0.0)) {
+        PyErr_SetString(PyExc_ValueError, "Layout sizes must be positive");
+        return -1;
+    }
+
+    if (entry->value >= PLAN_SECTOR_MAX) {
+        PyErr_SetString(PyExc_OverflowError, "Layout size is too large");
+        return -1;
+    }
+
+    return 0;
+}
+
+/* modulo that stays positive for negative sector differences */
+static PedSector plan_mod(PedSector a, PedSector grain)
+{
+    PedSector r = a % grain;
+
+    return r < 0 ? r + grain : r;
+}
+
+/*
+ * Find the region to plan in: a Geometry as is, a whole Device, or the
+ * largest primary free space region of a Disk.  For a Disk the label's
+ * limits are filled in too.  Returns the device or NULL with an exception
+ * set.
+ */
+static PedDevice *plan_region(PyObject *source, PedSector *start, PedSector *end, _ped_PlanLimits *limits)
+{
+    PedDevice *dev = NULL;
+
+    if (PyObject_TypeCheck(source, &_ped_Disk_Type_obj)) {
+        PedDisk *disk = _ped_Disk2PedDisk(source);
+        PedPartition *part = NULL;
+        PedSector best = 0;
+
+        if (disk == NULL) {
+            return NULL;
+        }
+
+        _ped_Lock_read(&((_ped_Disk *) source)->lock);
+
+        for (part = ped_disk_next_partition(disk, NULL); part; part = ped_disk_next_partition(disk, part)) {
+            if (part->type == PED_PARTITION_FREESPACE && part->geom.length > best) {
+                best = part->geom.length;
+                *start = part->geom.start;
+                *end = part->geom.end;
+            }
+        }
+
+        limits->primaries = ped_disk_get_max_primary_partition_count(disk) - ped_disk_get_primary_partition_count(disk);
+        limits->max_start = ped_disk_max_partition_start_sector(disk);
+        limits->max_length = ped_disk_max_partition_length(disk);
+        limits->alignment = ped_disk_get_partition_alignment(disk);
+
+        _ped_Lock_release(&((_ped_Disk *) source)->lock);
+
+        if (best == 0) {
+            ped_alignment_destroy(limits->alignment);
+            limits->alignment = NULL;
+            PyErr_Format(ConstraintException, "No free space on %s", disk->dev->path);
+            return NULL;
+        }
+
+        dev = disk->dev;
+    } else if (PyObject_TypeCheck(source, &_ped_Geometry_Type_obj)) {
+        PedGeometry *geom = _ped_Geometry2PedGeometry(source);
+
+        if (geom == NULL) {
+            return NULL;
+        }
+
+        *start = geom->start;
+        *end = geom->end;
+        dev = geom->dev;
+    } else if (PyObject_TypeCheck(source, &_ped_Device_Type_obj)) {
+        dev = _ped_Device2PedDevice(source);
+
+        if (dev == NULL) {
+            return NULL;
+        }
+
+        *start = 0;
+        *end = dev->length - 1;
+    } else {
+        PyErr_Format(PyExc_TypeError, "plan_layout() argument 1 must be _ped.Device, _ped.Disk or _ped.Geometry, not %s", Py_TYPE(source)->tp_name);
+    }
+
+    return dev;
+}
+
+PyObject *py_ped_plan_layout(PyObject *s, PyObject *args)
+{
+    PyObject *in_source = NULL, *in_layout = NULL, *in_alignment = Py_None;
+    PyObject *layout = NULL, *ret = NULL, *item = NULL;
+    _ped_PlanEntry *entries = NULL;
+    PedDevice *dev = NULL;
+    PedAlignment *alignment = NULL, *combined = NULL;
+    _ped_PlanLimits limits = { -1, 0, 0, NULL };
+    PedSector region_start = 0, region_end = -1;
+    PedSector offset = 0, grain = 1, first, limit, avail, fixed = 0, left = 0, share = 0, start;
+    Py_ssize_t i, count, nrest = 0, rest_seen = 0;
+
+    if (!PyArg_ParseTuple(args, "OO|O", &in_source, &in_layout, &in_alignment)) {
+        return NULL;
+    }
+
+    if (in_alignment != Py_None && !PyObject_TypeCheck(in_alignment, &_ped_Alignment_Type_obj)) {
+        PyErr_Format(PyExc_TypeError, "alignment must be a _ped.Alignment or None, not %s", Py_TYPE(in_alignment)->tp_name);
+        return NULL;
+    }
+
+    dev = plan_region(in_source, &region_start, &region_end, &limits);
+
+    if (dev == NULL) {
+        return NULL;
+    }
+
+    if (in_alignment != Py_None) {
+        alignment = ped_alignment_new(((_ped_Alignment *) in_alignment)->offset, ((_ped_Alignment *) in_alignment)->grain_size);
+    } else {
+        alignment = _ped_MemoryDevice_alignment(dev, 1);
+
+        if (alignment == NULL) {
+            _ped_Lock_read(_ped_Device_lock(dev));
+            Py_BEGIN_ALLOW_THREADS
+            alignment = ped_device_get_optimum_alignment(dev);
+            Py_END_ALLOW_THREADS
+            _ped_Lock_release(_ped_Device_lock(dev));
+        }
+    }
+
+    if (alignment == NULL) {
+        PyErr_SetString(CreateException, "Could not get alignment for device");
+        ped_alignment_destroy(limits.alignment);
+        return NULL;
+    }
+
+    /* partitions on a Disk must also satisfy the label's own alignment */
+    if (limits.alignment != NULL) {
+        combined = ped_alignment_intersect(alignment, limits.alignment);
+        ped_alignment_destroy(alignment);
+        ped_alignment_destroy(limits.alignment);
+        alignment = combined;
+
+        if (alignment == NULL) {
+            PyErr_Format(ConstraintException, "Alignment is incompatible with the disk label on %s", dev->path);
+            return NULL;
+        }
+    }
+
+    offset = alignment->offset;
+    grain = alignment->grain_size;
+    ped_alignment_destroy(alignment);
+
+    /* no partition on a Disk can end past what the label can address */
+    if (limits.max_length > 0 && region_end > limits.max_start + limits.max_length - 1) {
+        region_end = limits.max_start + limits.max_length - 1;
+    }
+
+    /* a zero grain means no alignment beyond single sectors */
+    if (grain <= 0) {
+        grain = 1;
+        offset = 0;
+    }
+
+    layout = PySequence_Fast(in_layout, "layout must be a sequence");
+
+    if (layout == NULL) {
+        return NULL;
+    }
+
+    count = PySequence_Fast_GET_SIZE(layout);
+
+    if (limits.primaries >= 0 && count > limits.primaries) {
+        PyErr_Format(ConstraintException, "Layout needs %zd primary partitions but %s has room for %d", count, dev->path, limits.primaries);
+        Py_DECREF(layout);
+        return NULL;
+    }
+
+    entries = PyMem_New(_ped_PlanEntry, count > 0 ? count : 1);
+
+    if (entries == NULL) {
+        Py_DECREF(layout);
+        return PyErr_NoMemory();
+    }
+
+    for (i = 0; i < count; i++) {
+        if (plan_parse_entry(PySequence_Fast_GET_ITEM(layout, i), dev->sector_size, &entries[i]) == -1) {
+            goto error;
+        }
+    }
+
+    /*
+     * Every partition starts on an aligned sector and ends right before
+     * one, so each size is a whole number of grains inside the aligned
+     * part of the region.
+     */
+    first = region_start + plan_mod(offset - region_start, grain);
+    limit = (region_end + 1) - plan_mod(region_end + 1 - offset, grain);
+    avail = limit > first ? limit - first : 0;
+
+    for (i = 0; i < count; i++) {
+        PedSector size;
+
+        switch (entries[i].kind) {
+            case PLAN_SECTORS:
+                size = (PedSector) entries[i].value;
+
+                /* partial sectors and grains round up */
+                if ((double) size < entries[i].value) {
+                    size++;
+                }
+
+                size += plan_mod(-size, grain);
+                break;
+            case PLAN_PERCENT:
+                size = (PedSector) ((double) avail * entries[i].value / 100.0);
+                size -= plan_mod(size, grain);
+
+                if (size < grain) {
+                    size = grain;
+                }
+
+                break;
+            default:
+                nrest++;
+                size = 0;
+                break;
+        }
+
+        entries[i].size = size;
+
+        if (size > avail - fixed) {
+            PyErr_Format(ConstraintException, "Layout does not fit in the %lld aligned sectors available on %s", avail, dev->path);
+            goto error;
+        }
+
+        fixed += size;
+    }
+
+    if (nrest > 0) {
+        left = avail - fixed;
+        share = left / nrest;
+        share -= plan_mod(share, grain);
+
+        if (share == 0) {
+            PyErr_Format(ConstraintException, "No space left for the rest of the layout on %s", dev->path);
+            goto error;
+        }
+    }
+
+    ret = PyList_New(count);
+
+    if (ret == NULL) {
+        goto error;
+    }
+
+    start = first;
+
+    for (i = 0; i < count; i++) {
+        PedSector size = entries[i].size;
+
+        if (entries[i].kind == PLAN_REST) {
+            /* the last rest entry also takes what rounding left over */
+            size = ++rest_seen == nrest ? left - share * (nrest - 1) : share;
+        }
+
+        if (limits.max_length > 0 && (start > limits.max_start || size > limits.max_length)) {
+            PyErr_Format(ConstraintException, "Partition %zd of the layout is out of the range the disk label on %s can address", i + 1, dev->path);
+            goto error;
+        }
+
+        item = Py_BuildValue("LL", start, start + size - 1);
+
+        if (item == NULL) {
+            goto error;
+        }
+
+        PyList_SET_ITEM(ret, i, item);
+        start += size;
+    }
+
+    PyMem_Free(entries);
+    Py_DECREF(layout);
+    return ret;
+
+error:
+    Py_XDECREF(ret);
+    PyMem_Free(entries);
+    Py_DECREF(layout);
+    return NULL;
+}
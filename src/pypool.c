@@ -0,0 +1,347 @@
+/*
+ * pypool.c
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <Python.h>
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "pycache.h"
+#include "pydevops.h"
+#include "pylock.h"
+#include "pypool.h"
+
+/* Number of hash buckets, must be a power of two. */
+#define POOL_BUCKETS 256
+
+typedef struct _ped_PoolEntry {
+    PedDevice *dev;
+
+    /* hash chain, and least recently used list */
+    struct _ped_PoolEntry *chain;
+    struct _ped_PoolEntry *prev, *next;
+} _ped_PoolEntry;
+
+/*
+ * Devices destroyed from a libparted call running without the GIL are
+ * forgotten from that thread, so the table has a mutex of its own.
+ */
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static _ped_PoolEntry *buckets[POOL_BUCKETS];
+
+/* sentinel, most recently used entry first */
+static _ped_PoolEntry lru = { NULL, NULL, &lru, &lru };
+
+static int enabled = 0;
+static size_t max_idle = 0, n_idle = 0;
+static unsigned long long hits = 0, misses = 0, evictions = 0;
+
+static _ped_PoolEntry **bucket(const PedDevice *dev)
+{
+    uintptr_t key = (uintptr_t) dev;
+
+    /* PedDevice allocations are at least 16 byte aligned */
+    key = (key >> 4) ^ (key >> 12);
+    return &buckets[key & (POOL_BUCKETS - 1)];
+}
+
+static _ped_PoolEntry *entry_find(const PedDevice *dev)
+{
+    _ped_PoolEntry *entry = *bucket(dev);
+
+    while (entry != NULL && entry->dev != dev) {
+        entry = entry->chain;
+    }
+
+    return entry;
+}
+
+/* Takes dev out of the pool, returning whether it was there. */
+static int entry_remove(const PedDevice *dev)
+{
+    _ped_PoolEntry **link = bucket(dev), *entry;
+
+    while (*link != NULL && (*link)->dev != dev) {
+        link = &(*link)->chain;
+    }
+
+    if ((entry = *link) == NULL) {
+        return 0;
+    }
+
+    *link = entry->chain;
+    entry->prev->next = entry->next;
+    entry->next->prev = entry->prev;
+    n_idle--;
+    free(entry);
+    return 1;
+}
+
+/*
+ * What a first open through libparted would have done, since a pooled
+ * device skips it: drop the buffer cache of the device, so what was
+ * written meanwhile through another node, such as mkfs on one of its
+ * partitions, is read back.  Image files share the page cache with every
+ * writer and need nothing more than our own sector cache dropped.
+ */
+static void pool_flush(const PedDevice *dev)
+{
+    int fd;
+
+    _ped_SectorCache_invalidate(dev);
+
+    if (dev->type == PED_DEVICE_FILE || dev->read_only) {
+        return;
+    }
+
+    if ((fd = open(dev->path, O_RDONLY | O_CLOEXEC)) != -1) {
+        ioctl(fd, BLKFLSBUF);
+        close(fd);
+    }
+}
+
+/*
+ * Device.open() on an idle device: the pool's open becomes the caller's.
+ * Returns 1 if so, 0 if the device has to be opened through libparted.
+ */
+int _ped_DevicePool_take(const PedDevice *dev)
+{
+    int ret;
+
+    pthread_mutex_lock(&pool_mutex);
+    ret = entry_remove(dev);
+
+    if (ret) {
+        hits++;
+    } else if (enabled && dev->open_count == 0) {
+        misses++;
+    }
+
+    pthread_mutex_unlock(&pool_mutex);
+
+    if (ret) {
+        pool_flush(dev);
+    }
+
+    return ret;
+}
+
+/*
+ * libparted opening a device that already is open, from disk_new() for
+ * instance.  If the only open was the pool's, flush as its first open
+ * would have.  Called from the open hook, possibly without the GIL.
+ */
+void _ped_DevicePool_refresh(const PedDevice *dev)
+{
+    int idle;
+
+    pthread_mutex_lock(&pool_mutex);
+    idle = entry_find(dev) != NULL && dev->open_count == 1;
+    pthread_mutex_unlock(&pool_mutex);
+
+    if (idle) {
+        pool_flush(dev);
+    }
+}
+
+/*
+ * Really close dev if it is idle, so the next open goes through libparted
+ * again, read-only for instance.  The caller holds the device lock.
+ * Called without the GIL.
+ */
+void _ped_DevicePool_evict(PedDevice *dev)
+{
+    int idle;
+
+    pthread_mutex_lock(&pool_mutex);
+    idle = entry_remove(dev);
+
+    if (idle) {
+        evictions++;
+    }
+
+    pthread_mutex_unlock(&pool_mutex);
+
+    if (idle) {
+        ped_device_close(dev);
+    }
+}
+
+/*
+ * Device.close() on its last open: keep the device open and idle if the
+ * pool is on and closing would not have flushed anything.  Returns 1 if
+ * the pool took the open over, 0 if the device should really be closed.
+ * The caller holds the device lock and should call _ped_DevicePool_trim()
+ * once it has let go of it.
+ */
+int _ped_DevicePool_put(PedDevice *dev)
+{
+    _ped_PoolEntry *entry = NULL, **head;
+
+    if (!enabled || dev->open_count != 1 || dev->dirty || dev->external_mode) {
+        return 0;
+    }
+
+    entry = malloc(sizeof(*entry));
+
+    if (entry == NULL) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&pool_mutex);
+
+    entry->dev = dev;
+    head = bucket(dev);
+    entry->chain = *head;
+    *head = entry;
+
+    entry->prev = &lru;
+    entry->next = lru.next;
+    lru.next->prev = entry;
+    lru.next = entry;
+    n_idle++;
+
+    pthread_mutex_unlock(&pool_mutex);
+    return 1;
+}
+
+/* Really close least recently used idle devices until within the limit. */
+void _ped_DevicePool_trim(void)
+{
+    _ped_PoolEntry *entry = NULL;
+    PedDevice *dev = NULL;
+
+    while (1) {
+        pthread_mutex_lock(&pool_mutex);
+
+        /* devices in external access mode can not be closed, skip them */
+        for (entry = lru.prev; entry != &lru && entry->dev->external_mode; entry = entry->prev);
+
+        if (n_idle <= max_idle || entry == &lru) {
+            pthread_mutex_unlock(&pool_mutex);
+            return;
+        }
+
+        dev = entry->dev;
+        pthread_mutex_unlock(&pool_mutex);
+
+        /*
+         * Someone may take the device or destroy it while we wait for the
+         * lock, so only close it if it is still idle afterwards.
+         */
+        _ped_Lock_write(_ped_Device_lock(dev));
+        pthread_mutex_lock(&pool_mutex);
+
+        if (entry_remove(dev)) {
+            evictions++;
+            pthread_mutex_unlock(&pool_mutex);
+
+            Py_BEGIN_ALLOW_THREADS
+            ped_device_close(dev);
+            Py_END_ALLOW_THREADS
+        } else {
+            pthread_mutex_unlock(&pool_mutex);
+        }
+
+        _ped_Lock_release(_ped_Device_lock(dev));
+    }
+}
+
+/* The number of opens on dev that are not the pool's. */
+int _ped_DevicePool_open_count(const PedDevice *dev)
+{
+    int ret = dev->open_count;
+
+    pthread_mutex_lock(&pool_mutex);
+
+    if (entry_find(dev) != NULL) {
+        ret--;
+    }
+
+    pthread_mutex_unlock(&pool_mutex);
+    return ret;
+}
+
+/* ped_device_destroy() closes the device itself, just drop the entry. */
+void _ped_DevicePool_forget(const PedDevice *dev)
+{
+    pthread_mutex_lock(&pool_mutex);
+    entry_remove(dev);
+    pthread_mutex_unlock(&pool_mutex);
+}
+
+PyObject *py_ped_device_pool_enable(PyObject *s, PyObject *args)
+{
+    long long size = -1;
+    struct rlimit limit;
+
+    if (!PyArg_ParseTuple(args, "|L", &size)) {
+        return NULL;
+    }
+
+    if (size == -1) {
+        size = DEVICE_POOL_SIZE;
+
+        /* leave most descriptors for everything else */
+        if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY && (long long) limit.rlim_cur / 4 < size) {
+            size = limit.rlim_cur / 4;
+        }
+    }
+
+    if (size < 1) {
+        PyErr_SetString(PyExc_ValueError, "pool size must be at least 1");
+        return NULL;
+    }
+
+    /* destroyed devices must leave the pool */
+    _ped_DevOps_install();
+
+    max_idle = size;
+    enabled = 1;
+    _ped_DevicePool_trim();
+
+    Py_RETURN_NONE;
+}
+
+PyObject *py_ped_device_pool_disable(PyObject *s, PyObject *args)
+{
+    int was_enabled = enabled;
+
+    enabled = 0;
+    max_idle = 0;
+    _ped_DevicePool_trim();
+
+    if (was_enabled) {
+        Py_RETURN_TRUE;
+    } else {
+        Py_RETURN_FALSE;
+    }
+}
+
+PyObject *py_ped_device_pool_info(PyObject *s, PyObject *args)
+{
+    PyObject *ret = NULL;
+
+    if (!enabled) {
+        Py_RETURN_NONE;
+    }
+
+    pthread_mutex_lock(&pool_mutex);
+    ret = Py_BuildValue("{snsnsKsKsK}",
+                        "size", (Py_ssize_t) max_idle,
+                        "idle", (Py_ssize_t) n_idle,
+                        "hits", hits,
+                        "misses", misses,
+                        "evictions", evictions);
+    pthread_mutex_unlock(&pool_mutex);
+    return ret;
+}
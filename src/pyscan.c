@@ -0,0 +1,430 @@
+/*
+ * pyscan.c
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <Python.h>
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "convert.h"
+#include "pydevice.h"
+#include "pygpt.h"
+#include "pyscan.h"
+
+/*
+ * Auditing labels across a fleet with ped_disk_new() and Disk.check()
+ * probes every label type and builds every partition.  The scanner reads
+ * only what is needed to judge a GPT or MBR: LBA 0 and 1, both entry
+ * arrays and the backup header, through descriptors of its own, and runs
+ * any number of devices in parallel without the GIL.
+ */
+typedef struct {
+    char *path;
+    long long sector_size;
+    PedSector length;
+
+    const char *label;
+    int problems;
+} _ped_ScanJob;
+
+typedef struct {
+    _ped_ScanJob *jobs;
+    Py_ssize_t count;
+    Py_ssize_t next;
+} _ped_ScanQueue;
+
+static uint32_t get32(const unsigned char *p)
+{
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t) p[3] << 24;
+}
+
+static uint64_t get64(const unsigned char *p)
+{
+    return get32(p) | (uint64_t) get32(p + 4) << 32;
+}
+
+static int scan_read(int fd, void *buf, size_t size, PedSector sector, long long sector_size)
+{
+    return pread(fd, buf, size, sector * sector_size) == (ssize_t) size;
+}
+
+/*
+ * Check the GPT header at lba, which must say it lives there, and its
+ * entry array.  header must hold a sector.  Returns the problems found,
+ * with the header flag set if it is not a GPT header at all.
+ */
+static int scan_gpt_header(int fd, const _ped_ScanJob *job, unsigned char *header, PedSector lba, int header_flag, int entries_flag)
+{
+    unsigned char *entries = NULL;
+    uint32_t size, crc, count, entry_size;
+    uint64_t bytes;
+    int ret = 0;
+
+    if (!scan_read(fd, header, job->sector_size, lba, job->sector_size)) {
+        /* the caller looks for a signature even in a header it could not read */
+        memset(header, 0, job->sector_size);
+        return header_flag;
+    }
+
+    size = get32(header + GPT_HEADER_SIZE);
+
+    if (memcmp(header, GPT_SIGNATURE, 8) || size < GPT_HEADER_MIN_SIZE || size > job->sector_size ||
+        get64(header + GPT_MY_LBA) != (uint64_t) lba) {
+        return header_flag;
+    }
+
+    crc = get32(header + GPT_HEADER_CRC);
+    memset(header + GPT_HEADER_CRC, 0, 4);
+
+    if (_ped_crc32(header, size) != crc) {
+        ret |= header_flag;
+    }
+
+    /* put it back so the headers can be compared */
+    header[GPT_HEADER_CRC] = crc;
+    header[GPT_HEADER_CRC + 1] = crc >> 8;
+    header[GPT_HEADER_CRC + 2] = crc >> 16;
+    header[GPT_HEADER_CRC + 3] = crc >> 24;
+
+    count = get32(header + GPT_ENTRIES_COUNT);
+    entry_size = get32(header + GPT_ENTRY_SIZE);
+    bytes = (uint64_t) count * entry_size;
+
+    if (entry_size < GPT_ENTRY_MIN_SIZE || bytes > SCAN_MAX_ENTRIES_SIZE || (entries = malloc(bytes ? bytes : 1)) == NULL) {
+        return ret | entries_flag;
+    }
+
+    if (!scan_read(fd, entries, bytes, get64(header + GPT_ENTRIES_LBA), job->sector_size) ||
+        _ped_crc32(entries, bytes) != get32(header + GPT_ENTRIES_CRC)) {
+        ret |= entries_flag;
+    }
+
+    free(entries);
+    return ret;
+}
+
+/* The fields both GPT headers must agree on. */
+static int scan_gpt_headers_match(const unsigned char *primary, const unsigned char *backup)
+{
+    return get64(primary + GPT_ALTERNATE_LBA) == get64(backup + GPT_MY_LBA) &&
+           get64(backup + GPT_ALTERNATE_LBA) == get64(primary + GPT_MY_LBA) &&
+           get64(primary + GPT_FIRST_USABLE_LBA) == get64(backup + GPT_FIRST_USABLE_LBA) &&
+           get64(primary + GPT_LAST_USABLE_LBA) == get64(backup + GPT_LAST_USABLE_LBA) &&
+           !memcmp(primary + GPT_DISK_GUID, backup + GPT_DISK_GUID, 16) &&
+           get32(primary + GPT_ENTRIES_COUNT) == get32(backup + GPT_ENTRIES_COUNT) &&
+           get32(primary + GPT_ENTRY_SIZE) == get32(backup + GPT_ENTRY_SIZE) &&
+           get32(primary + GPT_ENTRIES_CRC) == get32(backup + GPT_ENTRIES_CRC);
+}
+
+static void scan_gpt(int fd, _ped_ScanJob *job, const unsigned char *mbr, int protective)
+{
+    unsigned char *primary = NULL, *backup = NULL;
+    PedSector last = job->length - 1, alternate = last;
+    int problems;
+
+    primary = malloc(job->sector_size);
+    backup = malloc(job->sector_size);
+
+    if (primary == NULL || backup == NULL) {
+        job->problems |= SCAN_READ_ERROR;
+        goto out;
+    }
+
+    problems = scan_gpt_header(fd, job, primary, 1, SCAN_PRIMARY_HEADER_INVALID, SCAN_PRIMARY_ENTRIES_INVALID);
+
+    /* no GPT at all, and nothing in the MBR says there should be one */
+    if ((problems & SCAN_PRIMARY_HEADER_INVALID) && memcmp(primary, GPT_SIGNATURE, 8) && !protective) {
+        goto out;
+    }
+
+    job->label = "gpt";
+    job->problems |= problems;
+
+    if (!protective) {
+        job->problems |= SCAN_PMBR_INVALID;
+    }
+
+    if (!(problems & SCAN_PRIMARY_HEADER_INVALID)) {
+        alternate = get64(primary + GPT_ALTERNATE_LBA);
+
+        /* typically a disk or image that has grown since it was labeled */
+        if (alternate != last) {
+            job->problems |= SCAN_BACKUP_MISPLACED;
+        }
+
+        if (alternate < 1 || alternate > last) {
+            alternate = last;
+        }
+    }
+
+    problems = scan_gpt_header(fd, job, backup, alternate, SCAN_BACKUP_HEADER_INVALID, SCAN_BACKUP_ENTRIES_INVALID);
+
+    if ((problems & SCAN_BACKUP_HEADER_INVALID) && alternate != last &&
+        !(scan_gpt_header(fd, job, backup, last, SCAN_BACKUP_HEADER_INVALID, SCAN_BACKUP_ENTRIES_INVALID) & SCAN_BACKUP_HEADER_INVALID)) {
+        problems = 0;
+    }
+
+    job->problems |= problems;
+
+    if (!(job->problems & (SCAN_PRIMARY_HEADER_INVALID | SCAN_BACKUP_HEADER_INVALID)) && !scan_gpt_headers_match(primary, backup)) {
+        job->problems |= SCAN_HEADER_MISMATCH;
+    }
+
+out:
+    free(primary);
+    free(backup);
+}
+
+/* The primary partitions must fit the device and not overlap. */
+static void scan_msdos(_ped_ScanJob *job, const unsigned char *mbr)
+{
+    uint64_t start[4], end[4];
+    int i, j, n = 0;
+
+    for (i = 0; i < 4; i++) {
+        const unsigned char *entry = mbr + MSDOS_ENTRIES + i * MSDOS_ENTRY_SIZE;
+
+        /* anything but 0x00 or 0x80 here is not a partition table */
+        if (entry[0] != 0x00 && entry[0] != 0x80) {
+            return;
+        }
+    }
+
+    job->label = "msdos";
+
+    for (i = 0; i < 4; i++) {
+        const unsigned char *entry = mbr + MSDOS_ENTRIES + i * MSDOS_ENTRY_SIZE;
+        uint32_t length = get32(entry + MSDOS_ENTRY_LENGTH);
+
+        if (entry[MSDOS_ENTRY_TYPE] == 0 || length == 0) {
+            continue;
+        }
+
+        start[n] = get32(entry + MSDOS_ENTRY_START);
+        end[n] = start[n] + length - 1;
+
+        if (start[n] == 0 || end[n] > (uint64_t) job->length - 1) {
+            job->problems |= SCAN_PARTITION_OUT_OF_RANGE;
+        }
+
+        for (j = 0; j < n; j++) {
+            if (start[n] <= end[j] && start[j] <= end[n]) {
+                job->problems |= SCAN_PARTITION_OVERLAP;
+            }
+        }
+
+        n++;
+    }
+}
+
+static void scan_one(_ped_ScanJob *job)
+{
+    unsigned char *mbr = NULL;
+    int fd, protective = 0, i;
+    struct stat st;
+
+    fd = open(job->path, O_RDONLY | O_CLOEXEC);
+
+    if (fd == -1 || fstat(fd, &st) == -1) {
+        job->problems |= SCAN_READ_ERROR;
+        goto out;
+    }
+
+    /* paths carry no sector size or length, find them out */
+    if (job->sector_size == 0) {
+        int sector_size = 512;
+        uint64_t bytes = st.st_size;
+
+        if (S_ISBLK(st.st_mode) && (ioctl(fd, BLKSSZGET, &sector_size) == -1 || ioctl(fd, BLKGETSIZE64, &bytes) == -1)) {
+            job->problems |= SCAN_READ_ERROR;
+            goto out;
+        }
+
+        job->sector_size = sector_size;
+        job->length = bytes / sector_size;
+    }
+
+    if (job->length < 2 || (mbr = malloc(job->sector_size)) == NULL || !scan_read(fd, mbr, job->sector_size, 0, job->sector_size)) {
+        job->problems |= SCAN_READ_ERROR;
+        goto out;
+    }
+
+    if (mbr[MSDOS_MAGIC] != 0x55 || mbr[MSDOS_MAGIC + 1] != 0xaa) {
+        /* a GPT may still be there behind a damaged protective MBR */
+        scan_gpt(fd, job, mbr, 0);
+        goto out;
+    }
+
+    for (i = 0; i < 4; i++) {
+        protective |= mbr[MSDOS_ENTRIES + i * MSDOS_ENTRY_SIZE + MSDOS_ENTRY_TYPE] == MSDOS_TYPE_GPT;
+    }
+
+    scan_gpt(fd, job, mbr, protective);
+
+    if (job->label == NULL) {
+        scan_msdos(job, mbr);
+    }
+
+out:
+    if (fd != -1) {
+        close(fd);
+    }
+
+    free(mbr);
+}
+
+static void *scan_worker(void *data)
+{
+    _ped_ScanQueue *queue = data;
+    Py_ssize_t i;
+
+    while ((i = __atomic_fetch_add(&queue->next, 1, __ATOMIC_RELAXED)) < queue->count) {
+        scan_one(&queue->jobs[i]);
+    }
+
+    return NULL;
+}
+
+static void scan_jobs_free(_ped_ScanJob *jobs, Py_ssize_t count)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i < count; i++) {
+        free(jobs[i].path);
+    }
+
+    PyMem_Free(jobs);
+}
+
+/* A Device, with its sector size and length, or a path to find them for. */
+static int scan_job_init(_ped_ScanJob *job, PyObject *item)
+{
+    const char *path = NULL;
+
+    if (PyObject_TypeCheck(item, &_ped_Device_Type_obj)) {
+        PedDevice *device = _ped_Device2PedDevice(item);
+
+        if (device == NULL) {
+            return -1;
+        }
+
+        path = device->path;
+        job->sector_size = device->sector_size;
+        job->length = device->length;
+    } else if (PyUnicode_Check(item)) {
+        path = PyUnicode_AsUTF8(item);
+
+        if (path == NULL) {
+            return -1;
+        }
+    } else {
+        PyErr_Format(PyExc_TypeError, "expected a _ped.Device or a path, not %s", Py_TYPE(item)->tp_name);
+        return -1;
+    }
+
+    job->path = strdup(path);
+
+    if (job->path == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    return 0;
+}
+
+PyObject *py_ped_label_scan(PyObject *s, PyObject *args)
+{
+    PyObject *in_devices = NULL, *seq = NULL, *ret = NULL;
+    _ped_ScanQueue queue = { NULL, 0, 0 };
+    pthread_t *threads = NULL;
+    long workers = 4, started = 0, i;
+
+    if (!PyArg_ParseTuple(args, "O|l", &in_devices, &workers)) {
+        return NULL;
+    }
+
+    if (workers < 1) {
+        PyErr_SetString(PyExc_ValueError, "workers must be at least 1");
+        return NULL;
+    }
+
+    seq = PySequence_Fast(in_devices, "expected a sequence of _ped.Device or paths");
+
+    if (seq == NULL) {
+        return NULL;
+    }
+
+    queue.jobs = PyMem_Calloc(PySequence_Fast_GET_SIZE(seq) + 1, sizeof(*queue.jobs));
+
+    if (queue.jobs == NULL) {
+        Py_DECREF(seq);
+        return PyErr_NoMemory();
+    }
+
+    for (queue.count = 0; queue.count < PySequence_Fast_GET_SIZE(seq); queue.count++) {
+        if (scan_job_init(&queue.jobs[queue.count], PySequence_Fast_GET_ITEM(seq, queue.count)) == -1) {
+            goto out;
+        }
+    }
+
+    if (workers > queue.count) {
+        workers = queue.count > 0 ? queue.count : 1;
+    }
+
+    /* the calling thread is one of the workers */
+    if (workers > 1 && (threads = PyMem_New(pthread_t, workers - 1)) == NULL) {
+        PyErr_NoMemory();
+        goto out;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+
+    for (started = 0; started < workers - 1; started++) {
+        /* fewer threads than asked for still get the job done */
+        if (pthread_create(&threads[started], NULL, scan_worker, &queue) != 0) {
+            break;
+        }
+    }
+
+    scan_worker(&queue);
+
+    for (i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    Py_END_ALLOW_THREADS
+
+    ret = PyList_New(queue.count);
+
+    if (ret == NULL) {
+        goto out;
+    }
+
+    for (i = 0; i < queue.count; i++) {
+        _ped_ScanJob *job = &queue.jobs[i];
+        PyObject *record = Py_BuildValue("(szi)", job->path, job->label, job->problems);
+
+        if (record == NULL) {
+            Py_CLEAR(ret);
+            goto out;
+        }
+
+        PyList_SET_ITEM(ret, i, record);
+    }
+
+out:
+    PyMem_Free(threads);
+    scan_jobs_free(queue.jobs, queue.count);
+    Py_DECREF(seq);
+    return ret;
+}
@@ -0,0 +1,953 @@
+/*
+ * pysnapshot.c
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <Python.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/blkpg.h>
+#include <sys/ioctl.h>
+#endif
+
+#include "convert.h"
+#include "exceptions.h"
+#include "pydevice.h"
+#include "pydisk.h"
+#include "pylock.h"
+#include "pysnapshot.h"
+
+#define SNAPSHOT_CAPSULE "_ped.DiskSnapshot"
+
+static void snapshot_record(const PedDisk *disk, const PedPartition *part, _ped_SnapshotEntry *entry)
+{
+    int f;
+
+    memset(entry, 0, sizeof(*entry));
+    entry->num = part->num;
+    entry->type = part->type;
+    entry->start = part->geom.start;
+    entry->end = part->geom.end;
+    entry->fs_type = part->fs_type;
+
+    for (f = 0; f <= PED_PARTITION_LAST_FLAG; f++) {
+        if (f >= PED_PARTITION_FIRST_FLAG && ped_partition_is_flag_available(part, f)) {
+            entry->flags[f] = ped_partition_get_flag(part, f) ? 1 : 0;
+        } else {
+            entry->flags[f] = -1;
+        }
+    }
+
+    if (part->type & PED_PARTITION_EXTENDED) {
+        return;
+    }
+
+    if (ped_disk_type_check_feature(disk->type, PED_DISK_TYPE_PARTITION_TYPE_ID)) {
+        entry->has_type_id = 1;
+        entry->type_id = ped_partition_get_type_id(part);
+    }
+
+    if (ped_disk_type_check_feature(disk->type, PED_DISK_TYPE_PARTITION_TYPE_UUID)) {
+        uint8_t *uuid = ped_partition_get_type_uuid(part);
+
+        if (uuid != NULL) {
+            entry->has_type_uuid = 1;
+            memcpy(entry->type_uuid, uuid, sizeof(entry->type_uuid));
+            free(uuid);
+        }
+    }
+}
+
+_ped_DiskSnapshot *_ped_DiskSnapshot_take(const PedDisk *disk)
+{
+    _ped_DiskSnapshot *snap = NULL;
+    PedPartition *part = NULL;
+    int count = 0, f, names;
+
+    snap = PyMem_Calloc(1, sizeof(*snap));
+
+    if (snap == NULL) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+
+    snap->type = disk->type;
+
+    for (f = 0; f <= PED_DISK_LAST_FLAG; f++) {
+        if (f >= PED_DISK_FIRST_FLAG && ped_disk_is_flag_available(disk, f)) {
+            snap->disk_flags[f] = ped_disk_get_flag(disk, f) ? 1 : 0;
+        } else {
+            snap->disk_flags[f] = -1;
+        }
+    }
+
+    for (part = ped_disk_next_partition(disk, NULL); part; part = ped_disk_next_partition(disk, part)) {
+        if (ped_partition_is_active(part)) {
+            count++;
+        }
+    }
+
+    snap->entries = PyMem_New(_ped_SnapshotEntry, count > 0 ? count : 1);
+
+    if (snap->entries == NULL) {
+        PyMem_Free(snap);
+        PyErr_NoMemory();
+        return NULL;
+    }
+
+    names = ped_disk_type_check_feature(disk->type, PED_DISK_TYPE_PARTITION_NAME);
+
+    for (part = ped_disk_next_partition(disk, NULL); part; part = ped_disk_next_partition(disk, part)) {
+        _ped_SnapshotEntry *entry = &snap->entries[snap->count];
+
+        if (!ped_partition_is_active(part)) {
+            continue;
+        }
+
+        snapshot_record(disk, part, entry);
+        snap->count++;
+
+        if (names && !(part->type & PED_PARTITION_EXTENDED)) {
+            const char *name = ped_partition_get_name(part);
+
+            entry->name = PyMem_Malloc(strlen(name ? name : "") + 1);
+
+            if (entry->name == NULL) {
+                _ped_DiskSnapshot_free(snap);
+                PyErr_NoMemory();
+                return NULL;
+            }
+
+            strcpy(entry->name, name ? name : "");
+        }
+    }
+
+    return snap;
+}
+
+void _ped_DiskSnapshot_free(_ped_DiskSnapshot *snap)
+{
+    int i;
+
+    if (snap == NULL) {
+        return;
+    }
+
+    for (i = 0; i < snap->count; i++) {
+        PyMem_Free(snap->entries[i].name);
+    }
+
+    PyMem_Free(snap->entries);
+    PyMem_Free(snap);
+}
+
+static void snapshot_capsule_destructor(PyObject *capsule)
+{
+    _ped_DiskSnapshot_free(PyCapsule_GetPointer(capsule, SNAPSHOT_CAPSULE));
+}
+
+_ped_DiskSnapshot *_ped_DiskSnapshot_get(PyObject *obj)
+{
+    if (!PyCapsule_IsValid(obj, SNAPSHOT_CAPSULE)) {
+        PyErr_Format(PyExc_TypeError, "expected a snapshot returned by _ped.Disk.snapshot(), not %s", Py_TYPE(obj)->tp_name);
+        return NULL;
+    }
+
+    return PyCapsule_GetPointer(obj, SNAPSHOT_CAPSULE);
+}
+
+static int entry_matches(const _ped_SnapshotEntry *entry, const PedPartition *part)
+{
+    return entry->type == part->type && entry->start == part->geom.start && entry->end == part->geom.end;
+}
+
+/* the active partitions of a disk, in disk order and by number */
+typedef struct {
+    PedPartition **parts;
+    int count;
+    PedPartition **by_num;
+    int max_num;
+} _ped_RestoreIndex;
+
+/*
+ * Find the partition matching entry.  Partitions are looked up by number,
+ * as they normally keep theirs, and if search is set the others are tried
+ * in case libparted numbered it differently.
+ */
+static PedPartition *restore_find(const _ped_RestoreIndex *index, const _ped_SnapshotEntry *entry, int search)
+{
+    PedPartition *part = NULL;
+    int i;
+
+    if (entry->num > 0 && entry->num <= index->max_num) {
+        part = index->by_num[entry->num];
+
+        if (part != NULL && entry_matches(entry, part)) {
+            return part;
+        }
+    }
+
+    for (i = 0; search && i < index->count; i++) {
+        if (index->parts[i] != NULL && entry_matches(entry, index->parts[i])) {
+            return index->parts[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void restore_index_free(_ped_RestoreIndex *index)
+{
+    PyMem_Free(index->parts);
+    PyMem_Free(index->by_num);
+    memset(index, 0, sizeof(*index));
+}
+
+/* Collect the active partitions of disk into index.  Returns 0 if out of memory. */
+static int restore_collect(PedDisk *disk, _ped_RestoreIndex *index)
+{
+    PedPartition *part = NULL;
+    int n = 0, max_num = 0;
+
+    restore_index_free(index);
+
+    for (part = ped_disk_next_partition(disk, NULL); part; part = ped_disk_next_partition(disk, part)) {
+        if (ped_partition_is_active(part)) {
+            n++;
+
+            if (part->num > max_num) {
+                max_num = part->num;
+            }
+        }
+    }
+
+    index->parts = PyMem_New(PedPartition *, n > 0 ? n : 1);
+    index->by_num = PyMem_Calloc(max_num + 1, sizeof(PedPartition *));
+
+    if (index->parts == NULL || index->by_num == NULL) {
+        restore_index_free(index);
+        return 0;
+    }
+
+    index->max_num = max_num;
+
+    for (part = ped_disk_next_partition(disk, NULL); part; part = ped_disk_next_partition(disk, part)) {
+        if (ped_partition_is_active(part)) {
+            index->parts[index->count++] = part;
+
+            if (part->num > 0) {
+                index->by_num[part->num] = part;
+            }
+        }
+    }
+
+    return 1;
+}
+
+/* Put back flags, type and name on a partition whose geometry matches. */
+static int restore_attributes(PedDisk *disk, PedPartition *part, const _ped_SnapshotEntry *entry)
+{
+    int f;
+
+    if (!(part->type & PED_PARTITION_EXTENDED) && part->fs_type != entry->fs_type) {
+        if (!ped_partition_set_system(part, entry->fs_type)) {
+            return 0;
+        }
+    }
+
+    for (f = PED_PARTITION_FIRST_FLAG; f <= PED_PARTITION_LAST_FLAG; f++) {
+        if (entry->flags[f] == -1 || !ped_partition_is_flag_available(part, f)) {
+            continue;
+        }
+
+        if ((ped_partition_get_flag(part, f) ? 1 : 0) != entry->flags[f]) {
+            if (!ped_partition_set_flag(part, f, entry->flags[f])) {
+                return 0;
+            }
+        }
+    }
+
+    if (entry->has_type_id && ped_partition_get_type_id(part) != entry->type_id) {
+        if (!ped_partition_set_type_id(part, entry->type_id)) {
+            return 0;
+        }
+    }
+
+    if (entry->has_type_uuid) {
+        uint8_t *uuid = ped_partition_get_type_uuid(part);
+        int same = uuid != NULL && !memcmp(uuid, entry->type_uuid, sizeof(entry->type_uuid));
+
+        free(uuid);
+
+        if (!same && !ped_partition_set_type_uuid(part, entry->type_uuid)) {
+            return 0;
+        }
+    }
+
+    if (entry->name != NULL) {
+        const char *name = ped_partition_get_name(part);
+
+        if (strcmp(name ? name : "", entry->name) && !ped_partition_set_name(part, entry->name)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * Bring disk back to the state recorded in snap, which need not have been
+ * taken from it as long as the disk types match.  Partitions that still
+ * match their entry are left alone, the rest are taken off the disk and
+ * the missing entries are added back.  Returns 0 with an exception set on
+ * failure, in which case the disk may be partially restored.  Either way
+ * the partitions taken off that nothing points at any more are destroyed.
+ */
+int _ped_DiskSnapshot_restore(_ped_Disk *pydisk, PedDisk *disk, const _ped_DiskSnapshot *snap)
+{
+    _ped_RestoreIndex index = { NULL, 0, NULL, 0 };
+    PedPartition **parts = NULL, *part = NULL;
+    const _ped_SnapshotEntry **entry_by_num = NULL;
+    char *stale = NULL;
+    int count = 0, i, j, pass, extended_stale = 0, f, max_num = 0;
+    const char *msg = NULL;
+
+    for (j = 0; j < snap->count; j++) {
+        if (snap->entries[j].num > max_num) {
+            max_num = snap->entries[j].num;
+        }
+    }
+
+    entry_by_num = PyMem_Calloc(max_num + 1, sizeof(*entry_by_num));
+
+    if (entry_by_num == NULL || !restore_collect(disk, &index)) {
+        PyErr_NoMemory();
+        goto error;
+    }
+
+    for (j = 0; j < snap->count; j++) {
+        if (snap->entries[j].num > 0) {
+            entry_by_num[snap->entries[j].num] = &snap->entries[j];
+        }
+    }
+
+    parts = index.parts;
+    count = index.count;
+    stale = PyMem_Calloc(count > 0 ? count : 1, 1);
+
+    if (stale == NULL) {
+        PyErr_NoMemory();
+        goto error;
+    }
+
+    /* keep the partitions that are still exactly where the snapshot has them */
+    for (i = 0; i < count; i++) {
+        const _ped_SnapshotEntry *entry = NULL;
+
+        if (parts[i]->num > 0 && parts[i]->num <= max_num) {
+            entry = entry_by_num[parts[i]->num];
+        }
+
+        if (entry == NULL || !entry_matches(entry, parts[i])) {
+            stale[i] = 1;
+            extended_stale |= (parts[i]->type & PED_PARTITION_EXTENDED) != 0;
+        }
+    }
+
+    /*
+     * An extended partition can only be taken off once its logical
+     * partitions are gone, and those have to go with it.  Remove the
+     * logical partitions on the first pass and everything else on the
+     * second.
+     */
+    for (pass = 0; pass < 2; pass++) {
+        for (i = count - 1; i >= 0; i--) {
+            int logical = (parts[i]->type & PED_PARTITION_LOGICAL) != 0;
+
+            if (logical != (pass == 0) || !(stale[i] || (logical && extended_stale))) {
+                continue;
+            }
+
+            switch (_ped_Disk_detach(pydisk, parts[i])) {
+                case -1:
+                    goto error;
+                case 0:
+                    msg = "Could not remove partition";
+                    goto parted_error;
+            }
+
+            stale[i] = 1;
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        if (stale[i]) {
+            if (parts[i]->num > 0) {
+                index.by_num[parts[i]->num] = NULL;
+            }
+
+            parts[i] = NULL;
+        }
+    }
+
+    /* add back what is missing, in disk order so logicals follow their extended */
+    for (j = 0; j < snap->count; j++) {
+        const _ped_SnapshotEntry *entry = &snap->entries[j];
+        PedConstraint *constraint = NULL;
+        int ok = 0;
+
+        /* what was kept matched its entry by number */
+        if (restore_find(&index, entry, 0)) {
+            continue;
+        }
+
+        part = ped_partition_new(disk, entry->type, entry->fs_type, entry->start, entry->end);
+
+        if (part == NULL) {
+            msg = "Could not create partition";
+            goto parted_error;
+        }
+
+        part->num = entry->num;
+        constraint = ped_constraint_exact(&part->geom);
+
+        if (constraint != NULL) {
+            ok = ped_disk_add_partition(disk, part, constraint);
+            ped_constraint_destroy(constraint);
+        }
+
+        if (!ok) {
+            ped_partition_destroy(part);
+            msg = "Could not add partition";
+            goto parted_error;
+        }
+    }
+
+    if (!restore_collect(disk, &index)) {
+        PyErr_NoMemory();
+        goto error;
+    }
+
+    for (j = 0; j < snap->count; j++) {
+        part = restore_find(&index, &snap->entries[j], 1);
+
+        if (part == NULL || !restore_attributes(disk, part, &snap->entries[j])) {
+            msg = "Could not restore partition";
+            goto parted_error;
+        }
+    }
+
+    for (f = PED_DISK_FIRST_FLAG; f <= PED_DISK_LAST_FLAG; f++) {
+        if (snap->disk_flags[f] == -1 || !ped_disk_is_flag_available(disk, f)) {
+            continue;
+        }
+
+        if ((ped_disk_get_flag(disk, f) ? 1 : 0) != snap->disk_flags[f] && !ped_disk_set_flag(disk, f, snap->disk_flags[f])) {
+            msg = "Could not restore disk flag";
+            goto parted_error;
+        }
+    }
+
+    PyMem_Free(stale);
+    PyMem_Free(entry_by_num);
+    restore_index_free(&index);
+    _ped_Disk_free_detached(pydisk);
+    return 1;
+
+parted_error:
+    if (partedExnRaised) {
+        partedExnRaised = 0;
+
+        if (!PyErr_ExceptionMatches(PartedException) && !PyErr_ExceptionMatches(PyExc_NotImplementedError)) {
+            PyErr_SetString(PartitionException, partedExnMessage);
+        }
+    } else {
+        PyErr_Format(PartitionException, "%s on %s", msg, disk->dev->path);
+    }
+
+error:
+    PyMem_Free(stale);
+    PyMem_Free(entry_by_num);
+    restore_index_free(&index);
+    _ped_Disk_free_detached(pydisk);
+    return 0;
+}
+
+PyObject *py_ped_disk_snapshot(PyObject *s, PyObject *args)
+{
+    PedDisk *disk = NULL;
+    _ped_DiskSnapshot *snap = NULL;
+    PyObject *ret = NULL;
+
+    disk = _ped_Disk2PedDisk(s);
+
+    if (disk == NULL) {
+        return NULL;
+    }
+
+    _ped_Lock_read(&((_ped_Disk *) s)->lock);
+    snap = _ped_DiskSnapshot_take(disk);
+    _ped_Lock_release(&((_ped_Disk *) s)->lock);
+
+    if (snap == NULL) {
+        return NULL;
+    }
+
+    snap->disk_serial = ((_ped_Disk *) s)->serial;
+    ret = PyCapsule_New(snap, SNAPSHOT_CAPSULE, snapshot_capsule_destructor);
+
+    if (ret == NULL) {
+        _ped_DiskSnapshot_free(snap);
+    }
+
+    return ret;
+}
+
+PyObject *py_ped_disk_restore(PyObject *s, PyObject *args)
+{
+    PyObject *in_snap = NULL;
+    _ped_DiskSnapshot *snap = NULL;
+    PedDisk *disk = NULL;
+    int ret = 0;
+
+    if (!PyArg_ParseTuple(args, "O", &in_snap)) {
+        return NULL;
+    }
+
+    if (_ped_Disk_check_writable(s) == -1) {
+        return NULL;
+    }
+
+    snap = _ped_DiskSnapshot_get(in_snap);
+
+    if (snap == NULL) {
+        return NULL;
+    }
+
+    disk = _ped_Disk2PedDisk(s);
+
+    if (disk == NULL) {
+        return NULL;
+    }
+
+    /* a freed disk's address may be reused, its serial never is */
+    if (snap->disk_serial != ((_ped_Disk *) s)->serial || snap->type != disk->type) {
+        PyErr_Format(DiskException, "Snapshot was not taken from this disk label on %s", disk->dev->path);
+        return NULL;
+    }
+
+    _ped_Lock_write(&((_ped_Disk *) s)->lock);
+    ret = _ped_DiskSnapshot_restore((_ped_Disk *) s, disk, snap);
+    _ped_Lock_release(&((_ped_Disk *) s)->lock);
+
+    if (!ret) {
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+/* kinds of differences between two snapshots, in the order they are reported */
+enum {
+    CHANGE_ADDED,
+    CHANGE_REMOVED,
+    CHANGE_RESIZED,
+    CHANGE_RENAMED,
+    CHANGE_MODIFIED,
+    CHANGE_KINDS
+};
+
+static const char *change_names[CHANGE_KINDS] = {
+    "added", "removed", "resized", "renamed", "modified"
+};
+
+typedef struct {
+    int kind;
+    const _ped_SnapshotEntry *old;
+    const _ped_SnapshotEntry *new;
+} _ped_SnapshotChange;
+
+static const _ped_SnapshotEntry *snapshot_find_num(const _ped_DiskSnapshot *snap, int num)
+{
+    int i;
+
+    for (i = 0; i < snap->count; i++) {
+        if (snap->entries[i].num == num) {
+            return &snap->entries[i];
+        }
+    }
+
+    return NULL;
+}
+
+static int entry_modified(const _ped_SnapshotEntry *a, const _ped_SnapshotEntry *b)
+{
+    if (a->type != b->type || a->fs_type != b->fs_type || memcmp(a->flags, b->flags, sizeof(a->flags))) {
+        return 1;
+    }
+
+    if (a->has_type_id != b->has_type_id || (a->has_type_id && a->type_id != b->type_id)) {
+        return 1;
+    }
+
+    return a->has_type_uuid != b->has_type_uuid ||
+           (a->has_type_uuid && memcmp(a->type_uuid, b->type_uuid, sizeof(a->type_uuid)));
+}
+
+/*
+ * List what changed going from old to new.  Partitions are matched up by
+ * number.  Returns a new array the caller must PyMem_Free(), or NULL with
+ * an exception set.
+ */
+static _ped_SnapshotChange *snapshot_diff(const _ped_DiskSnapshot *old, const _ped_DiskSnapshot *new, int *count)
+{
+    _ped_SnapshotChange *changes = NULL;
+    const _ped_SnapshotEntry *a, *b;
+    int i, n = 0;
+
+    /* at most three changes per matched partition, one otherwise */
+    changes = PyMem_New(_ped_SnapshotChange, 3 * (old->count + new->count) + 1);
+
+    if (changes == NULL) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+
+    for (i = 0; i < new->count; i++) {
+        b = &new->entries[i];
+        a = snapshot_find_num(old, b->num);
+
+        if (a == NULL) {
+            changes[n++] = (_ped_SnapshotChange) { CHANGE_ADDED, NULL, b };
+            continue;
+        }
+
+        if (a->start != b->start || a->end != b->end) {
+            changes[n++] = (_ped_SnapshotChange) { CHANGE_RESIZED, a, b };
+        }
+
+        if ((a->name == NULL) != (b->name == NULL) || (a->name && strcmp(a->name, b->name))) {
+            changes[n++] = (_ped_SnapshotChange) { CHANGE_RENAMED, a, b };
+        }
+
+        if (entry_modified(a, b)) {
+            changes[n++] = (_ped_SnapshotChange) { CHANGE_MODIFIED, a, b };
+        }
+    }
+
+    for (i = 0; i < old->count; i++) {
+        a = &old->entries[i];
+
+        if (snapshot_find_num(new, a->num) == NULL) {
+            changes[n++] = (_ped_SnapshotChange) { CHANGE_REMOVED, a, NULL };
+        }
+    }
+
+    *count = n;
+    return changes;
+}
+
+/*
+ * Get a snapshot to compare against from either a snapshot or a _ped.Disk.
+ * *taken is set if the snapshot was made here and must be freed.
+ */
+static _ped_DiskSnapshot *snapshot_of(PyObject *obj, int *taken)
+{
+    _ped_DiskSnapshot *snap = NULL;
+    PedDisk *disk = NULL;
+
+    *taken = 0;
+
+    if (!PyObject_TypeCheck(obj, &_ped_Disk_Type_obj)) {
+        return _ped_DiskSnapshot_get(obj);
+    }
+
+    disk = _ped_Disk2PedDisk(obj);
+
+    if (disk == NULL) {
+        return NULL;
+    }
+
+    _ped_Lock_read(&((_ped_Disk *) obj)->lock);
+    snap = _ped_DiskSnapshot_take(disk);
+    _ped_Lock_release(&((_ped_Disk *) obj)->lock);
+
+    *taken = snap != NULL;
+    return snap;
+}
+
+/* Snapshot s and its base, and diff them.  Returns 0 with an exception set on failure. */
+static int disk_diff(PyObject *s, PyObject *in_base, _ped_DiskSnapshot **base, int *base_taken,
+                     _ped_DiskSnapshot **current, _ped_SnapshotChange **changes, int *count)
+{
+    PedDisk *disk = _ped_Disk2PedDisk(s);
+
+    *current = NULL;
+    *changes = NULL;
+
+    if (disk == NULL) {
+        return 0;
+    }
+
+    *base = snapshot_of(in_base, base_taken);
+
+    if (*base == NULL) {
+        return 0;
+    }
+
+    _ped_Lock_read(&((_ped_Disk *) s)->lock);
+    *current = _ped_DiskSnapshot_take(disk);
+    _ped_Lock_release(&((_ped_Disk *) s)->lock);
+
+    if (*current != NULL) {
+        *changes = snapshot_diff(*base, *current, count);
+    }
+
+    if (*changes == NULL) {
+        if (*base_taken) {
+            _ped_DiskSnapshot_free(*base);
+        }
+
+        _ped_DiskSnapshot_free(*current);
+        return 0;
+    }
+
+    return 1;
+}
+
+static void disk_diff_free(_ped_DiskSnapshot *base, int base_taken, _ped_DiskSnapshot *current, _ped_SnapshotChange *changes)
+{
+    if (base_taken) {
+        _ped_DiskSnapshot_free(base);
+    }
+
+    _ped_DiskSnapshot_free(current);
+    PyMem_Free(changes);
+}
+
+static int disk_flags_changed(const _ped_DiskSnapshot *base, const _ped_DiskSnapshot *current)
+{
+    return base->type != current->type || memcmp(base->disk_flags, current->disk_flags, sizeof(base->disk_flags));
+}
+
+PyObject *_ped_DiskSnapshot_diff(const _ped_DiskSnapshot *base, const _ped_DiskSnapshot *current)
+{
+    PyObject *ret = NULL, *lists[CHANGE_KINDS] = { NULL };
+    _ped_SnapshotChange *changes = NULL;
+    int count = 0, i;
+
+    changes = snapshot_diff(base, current, &count);
+
+    if (changes == NULL) {
+        return NULL;
+    }
+
+    ret = PyDict_New();
+
+    if (ret == NULL) {
+        goto error;
+    }
+
+    for (i = 0; i < CHANGE_KINDS; i++) {
+        lists[i] = PyList_New(0);
+
+        if (lists[i] == NULL || PyDict_SetItemString(ret, change_names[i], lists[i]) == -1) {
+            goto error;
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        const _ped_SnapshotEntry *entry = changes[i].new ? changes[i].new : changes[i].old;
+        PyObject *num = PyLong_FromLong(entry->num);
+
+        if (num == NULL || PyList_Append(lists[changes[i].kind], num) == -1) {
+            Py_XDECREF(num);
+            goto error;
+        }
+
+        Py_DECREF(num);
+    }
+
+    if (PyDict_SetItemString(ret, "disk", disk_flags_changed(base, current) ? Py_True : Py_False) == -1) {
+        goto error;
+    }
+
+    for (i = 0; i < CHANGE_KINDS; i++) {
+        Py_DECREF(lists[i]);
+    }
+
+    PyMem_Free(changes);
+    return ret;
+
+error:
+    for (i = 0; i < CHANGE_KINDS; i++) {
+        Py_XDECREF(lists[i]);
+    }
+
+    Py_XDECREF(ret);
+    PyMem_Free(changes);
+    return NULL;
+}
+
+PyObject *py_ped_disk_diff(PyObject *s, PyObject *args)
+{
+    PyObject *in_base = NULL, *ret = NULL;
+    _ped_DiskSnapshot *base = NULL, *current = NULL;
+    _ped_SnapshotChange *changes = NULL;
+    int base_taken = 0, count = 0;
+
+    if (!PyArg_ParseTuple(args, "O", &in_base)) {
+        return NULL;
+    }
+
+    if (!disk_diff(s, in_base, &base, &base_taken, &current, &changes, &count)) {
+        return NULL;
+    }
+
+    ret = _ped_DiskSnapshot_diff(base, current);
+    disk_diff_free(base, base_taken, current, changes);
+    return ret;
+}
+
+#ifdef __linux__
+/*
+ * Tell the kernel about one partition the way libparted does.  Only the
+ * first sectors of an extended partition are exposed to the kernel.
+ */
+static int blkpg_partition(int fd, int op, const PedDevice *dev, const _ped_SnapshotEntry *entry)
+{
+    struct blkpg_partition part;
+    struct blkpg_ioctl_arg arg;
+
+    memset(&part, 0, sizeof(part));
+    part.pno = entry->num;
+
+    if (op != BLKPG_DEL_PARTITION) {
+        part.start = entry->start * dev->sector_size;
+
+        if (entry->type & PED_PARTITION_EXTENDED) {
+            part.length = dev->sector_size > 1024 ? dev->sector_size : 1024;
+        } else {
+            part.length = (entry->end - entry->start + 1) * dev->sector_size;
+        }
+    }
+
+    memset(&arg, 0, sizeof(arg));
+    arg.op = op;
+    arg.datalen = sizeof(part);
+    arg.data = &part;
+
+    return ioctl(fd, BLKPG, &arg) == 0;
+}
+
+/*
+ * Apply only the partition changes the kernel cares about.  Returns 0 if
+ * any of them failed, in which case the caller falls back to a full
+ * ped_disk_commit_to_os().
+ */
+static int notify_changes(const PedDevice *dev, const _ped_SnapshotChange *changes, int count)
+{
+    int fd, i, ok = 1;
+
+    fd = open(dev->path, O_RDONLY | O_CLOEXEC);
+
+    if (fd == -1) {
+        return 0;
+    }
+
+    /* removals first so that added partitions can reuse their numbers */
+    for (i = 0; ok && i < count; i++) {
+        if (changes[i].kind == CHANGE_REMOVED) {
+            ok = blkpg_partition(fd, BLKPG_DEL_PARTITION, dev, changes[i].old);
+        } else if (changes[i].kind == CHANGE_RESIZED && changes[i].old->start != changes[i].new->start) {
+            ok = blkpg_partition(fd, BLKPG_DEL_PARTITION, dev, changes[i].old);
+        }
+    }
+
+    for (i = 0; ok && i < count; i++) {
+        if (changes[i].kind == CHANGE_ADDED) {
+            ok = blkpg_partition(fd, BLKPG_ADD_PARTITION, dev, changes[i].new);
+        } else if (changes[i].kind == CHANGE_RESIZED) {
+            int op = changes[i].old->start != changes[i].new->start ? BLKPG_ADD_PARTITION : BLKPG_RESIZE_PARTITION;
+
+            ok = blkpg_partition(fd, op, dev, changes[i].new);
+        }
+    }
+
+    close(fd);
+    return ok;
+}
+#endif
+
+PyObject *py_ped_disk_commit_changes(PyObject *s, PyObject *args)
+{
+    PyObject *in_base = NULL;
+    _ped_DiskSnapshot *base = NULL, *current = NULL;
+    _ped_SnapshotChange *changes = NULL;
+    PedDisk *disk = NULL;
+    int base_taken = 0, count = 0, ret = 0, notified = 0;
+
+    if (!PyArg_ParseTuple(args, "O", &in_base)) {
+        return NULL;
+    }
+
+    if (_ped_Disk_check_writable(s) == -1) {
+        return NULL;
+    }
+
+    if (!disk_diff(s, in_base, &base, &base_taken, &current, &changes, &count)) {
+        return NULL;
+    }
+
+    disk = ((_ped_Disk *) s)->ped_disk;
+
+    if (count == 0 && !disk_flags_changed(base, current)) {
+        disk_diff_free(base, base_taken, current, changes);
+        Py_RETURN_FALSE;
+    }
+
+    _ped_Lock_read(&((_ped_Disk *) s)->lock);
+    _ped_Lock_write(_ped_Device_lock(disk->dev));
+    Py_BEGIN_ALLOW_THREADS
+    ret = ped_disk_commit_to_dev(disk);
+
+    if (ret && disk->dev->type != PED_DEVICE_FILE) {
+#ifdef __linux__
+        /* a new label type means every partition may have changed */
+        if (base->type == current->type && disk->dev->type != PED_DEVICE_DM) {
+            notified = notify_changes(disk->dev, changes, count);
+        }
+#endif
+
+        if (!notified) {
+            ret = ped_disk_commit_to_os(disk);
+        }
+    }
+    Py_END_ALLOW_THREADS
+    _ped_Lock_release(_ped_Device_lock(disk->dev));
+    _ped_Lock_release(&((_ped_Disk *) s)->lock);
+
+    disk_diff_free(base, base_taken, current, changes);
+
+    if (ret == 0) {
+        if (partedExnRaised) {
+            partedExnRaised = 0;
+
+            if (!PyErr_ExceptionMatches(PartedException) && !PyErr_ExceptionMatches(PyExc_NotImplementedError)) {
+                PyErr_SetString(IOException, partedExnMessage);
+            }
+        } else {
+            PyErr_Format(DiskException, "Could not commit to disk %s, (%s)", disk->dev->path, __func__);
+        }
+
+        return NULL;
+    }
+
+    Py_RETURN_TRUE;
+}
@@ -0,0 +1,305 @@
+/*
+ * pysniff.c
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <Python.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "convert.h"
+#include "exceptions.h"
+#include "pyfilesys.h"
+#include "pygeom.h"
+#include "pylock.h"
+#include "pysniff.h"
+
+/* sectors value for signatures placed at the end of the first page */
+#define SNIFF_PAGE_END -1
+
+/*
+ * Where each probe in libparted looks for its magic number: sectors
+ * device sectors plus offset bytes into the region.  A type may have
+ * several entries and is a candidate if any of them match.  Types that
+ * are not listed here are always probed.
+ */
+typedef struct {
+    const char *name;
+    int sectors;
+    int offset;
+    const char *magic;
+    int length;
+} _ped_Signature;
+
+static const _ped_Signature signatures[] = {
+    { "ext2", 0, 0x438, "\x53\xef", 2 },
+    { "ext3", 0, 0x438, "\x53\xef", 2 },
+    { "ext4", 0, 0x438, "\x53\xef", 2 },
+    { "xfs", 0, 0, "XFSB", 4 },
+    { "btrfs", 0, 0x10040, "_BHRfS_M", 8 },
+    { "fat16", 0, 0x1fe, "\x55\xaa", 2 },
+    { "fat32", 0, 0x1fe, "\x55\xaa", 2 },
+    { "ntfs", 0, 3, "NTFS", 4 },
+    { "jfs", 0, 0x8000, "JFS1", 4 },
+    { "hfs", 0, 0x400, "BD", 2 },
+    { "hfs+", 0, 0x400, "H+", 2 },
+    { "hfs+", 0, 0x400, "BD", 2 },
+    { "hfsx", 0, 0x400, "HX", 2 },
+    { "hfsx", 0, 0x400, "BD", 2 },
+    { "reiserfs", 16, 52, "ReIsEr", 6 },
+    { "reiserfs", 128, 52, "ReIsEr", 6 },
+    { "linux-swap(v0)", SNIFF_PAGE_END, -10, "SWAP-SPACE", 10 },
+    { "linux-swap(v1)", SNIFF_PAGE_END, -10, "SWAPSPACE2", 10 },
+};
+
+#define N_SIGNATURES (sizeof(signatures) / sizeof(signatures[0]))
+
+/* byte offset of a signature in a region on dev */
+static long long signature_offset(const _ped_Signature *sig, const PedDevice *dev)
+{
+    if (sig->sectors == SNIFF_PAGE_END) {
+        return sysconf(_SC_PAGESIZE) + sig->offset;
+    }
+
+    return (long long) sig->sectors * dev->sector_size + sig->offset;
+}
+
+/*
+ * Fill candidates with the file system types worth probing on geom, in
+ * libparted's order, and return how many there are.  Returns -1, with a
+ * libparted exception thrown, if the start of the region could not be read.
+ */
+static int sniff(PedGeometry *geom, const PedFileSystemType **candidates, int size)
+{
+    const PedFileSystemType *type = NULL;
+    unsigned char *buf = NULL;
+    long long needed = 0, have;
+    PedSector count;
+    int n = 0;
+    size_t i;
+
+    for (i = 0; i < N_SIGNATURES; i++) {
+        long long end = signature_offset(&signatures[i], geom->dev) + signatures[i].length;
+
+        if (end > needed) {
+            needed = end;
+        }
+    }
+
+    count = (needed + geom->dev->sector_size - 1) / geom->dev->sector_size;
+
+    if (count > geom->length) {
+        count = geom->length;
+    }
+
+    have = count * geom->dev->sector_size;
+    buf = malloc(have);
+
+    if (buf == NULL) {
+        ped_exception_throw(PED_EXCEPTION_ERROR, PED_EXCEPTION_CANCEL, "Out of memory.");
+        return -1;
+    }
+
+    if (!ped_geometry_read(geom, buf, 0, count)) {
+        free(buf);
+        return -1;
+    }
+
+    while ((type = ped_file_system_type_get_next(type)) != NULL && n < size) {
+        int listed = 0, matched = 0;
+
+        for (i = 0; i < N_SIGNATURES && !matched; i++) {
+            const _ped_Signature *sig = &signatures[i];
+            long long offset;
+
+            if (strcmp(sig->name, type->name)) {
+                continue;
+            }
+
+            listed = 1;
+            offset = signature_offset(sig, geom->dev);
+            matched = offset >= 0 && offset + sig->length <= have && !memcmp(buf + offset, sig->magic, sig->length);
+        }
+
+        if (!listed || matched) {
+            candidates[n++] = type;
+        }
+    }
+
+    free(buf);
+    return n;
+}
+
+static int count_types(void)
+{
+    const PedFileSystemType *type = NULL;
+    int n = 0;
+
+    while ((type = ped_file_system_type_get_next(type)) != NULL) {
+        n++;
+    }
+
+    return n;
+}
+
+/* Same measure of how well a probe matched as libparted uses. */
+static PedSector geometry_error(const PedGeometry *a, const PedGeometry *b)
+{
+    return llabs(a->start - b->start) + llabs(a->end - b->end);
+}
+
+const PedFileSystemType *_ped_FileSystem_probe(PedGeometry *geom)
+{
+    const PedFileSystemType **candidates = NULL, *ret = NULL;
+    PedSector *errors = NULL, tolerance;
+    int n_types, n, detected = 0, best = 0, i;
+
+    n_types = count_types();
+    candidates = malloc((n_types ? n_types : 1) * sizeof(*candidates));
+    errors = malloc((n_types ? n_types : 1) * sizeof(*errors));
+
+    if (candidates == NULL || errors == NULL) {
+        free(candidates);
+        free(errors);
+        return ped_file_system_probe(geom);
+    }
+
+    if (!ped_device_open(geom->dev)) {
+        free(candidates);
+        free(errors);
+        return NULL;
+    }
+
+    /*
+     * Nothing is fetched yet, so a failed read reaches our handler like
+     * any other error rather than passing for an unrecognized region.
+     */
+    n = sniff(geom, candidates, n_types);
+
+    if (n == -1) {
+        ped_device_close(geom->dev);
+        free(candidates);
+        free(errors);
+        return NULL;
+    }
+
+    ped_exception_fetch_all();
+
+    for (i = 0; i < n; i++) {
+        PedGeometry *probed = ped_file_system_probe_specific(candidates[i], geom);
+
+        if (probed != NULL) {
+            candidates[detected] = candidates[i];
+            errors[detected++] = geometry_error(geom, probed);
+            ped_geometry_destroy(probed);
+        } else {
+            ped_exception_catch();
+        }
+    }
+
+    ped_exception_leave_all();
+    ped_device_close(geom->dev);
+
+    /*
+     * As in libparted, the best match has to be clearly better than
+     * every other one, or the result is ambiguous.
+     */
+    if (detected > 0) {
+        tolerance = geom->length / 100 > 4096 ? geom->length / 100 : 4096;
+
+        for (i = 1; i < detected; i++) {
+            if (errors[i] < errors[best]) {
+                best = i;
+            }
+        }
+
+        ret = candidates[best];
+
+        for (i = 0; i < detected; i++) {
+            if (i != best && llabs(errors[best] - errors[i]) < tolerance) {
+                ret = NULL;
+                break;
+            }
+        }
+    }
+
+    free(candidates);
+    free(errors);
+    return ret;
+}
+
+PyObject *py_ped_file_system_sniff(PyObject *s, PyObject *args)
+{
+    PyObject *in_geom = NULL, *ret = NULL;
+    PedGeometry *geom = NULL;
+    const PedFileSystemType **candidates = NULL;
+    int n_types, n, i;
+
+    if (!PyArg_ParseTuple(args, "O!", &_ped_Geometry_Type_obj, &in_geom)) {
+        return NULL;
+    }
+
+    geom = _ped_Geometry2PedGeometry(in_geom);
+
+    if (geom == NULL) {
+        return NULL;
+    }
+
+    n_types = count_types();
+    candidates = PyMem_New(const PedFileSystemType *, n_types ? n_types : 1);
+
+    if (candidates == NULL) {
+        return PyErr_NoMemory();
+    }
+
+    _ped_Lock_write(_ped_Device_lock(geom->dev));
+    Py_BEGIN_ALLOW_THREADS
+
+    if (!ped_device_open(geom->dev)) {
+        n = -1;
+    } else {
+        n = sniff(geom, candidates, n_types);
+        ped_device_close(geom->dev);
+    }
+
+    Py_END_ALLOW_THREADS
+    _ped_Lock_release(_ped_Device_lock(geom->dev));
+
+    if (n == -1) {
+        if (partedExnRaised) {
+            partedExnRaised = 0;
+
+            if (!PyErr_ExceptionMatches(PartedException) && !PyErr_ExceptionMatches(PyExc_NotImplementedError)) {
+                PyErr_SetString(IOException, partedExnMessage);
+            }
+        } else {
+            PyErr_SetString(IOException, "Could not read from given region");
+        }
+
+        goto out;
+    }
+
+    ret = PyList_New(n);
+
+    if (ret == NULL) {
+        goto out;
+    }
+
+    for (i = 0; i < n; i++) {
+        PyObject *name = PyUnicode_FromString(candidates[i]->name);
+
+        if (name == NULL) {
+            Py_CLEAR(ret);
+            goto out;
+        }
+
+        PyList_SET_ITEM(ret, i, name);
+    }
+
+out:
+    PyMem_Free(candidates);
+    return ret;
+}
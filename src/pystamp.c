@@ -0,0 +1,502 @@
+/*
+ * pystamp.c
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <Python.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/random.h>
+
+#include "convert.h"
+#include "exceptions.h"
+#include "pydevice.h"
+#include "pydisk.h"
+#include "pygpt.h"
+#include "pylock.h"
+#include "pymemdev.h"
+#include "pysnapshot.h"
+#include "pystamp.h"
+#include "pytrace.h"
+
+#define TEMPLATE_CAPSULE "_ped.LabelTemplate"
+
+static void template_free(_ped_LabelTemplate *tpl)
+{
+    if (tpl != NULL) {
+        _ped_DiskSnapshot_free(tpl->snap);
+        free(tpl->extents);
+        free(tpl->data);
+        free(tpl);
+    }
+}
+
+static void template_capsule_destructor(PyObject *capsule)
+{
+    template_free(PyCapsule_GetPointer(capsule, TEMPLATE_CAPSULE));
+}
+
+/*
+ * The rendered contents of sectors first to first + count - 1, or NULL if
+ * they were not all written in one extent.
+ */
+static unsigned char *template_sectors(const _ped_LabelTemplate *tpl, unsigned char *data, PedSector first, PedSector count)
+{
+    size_t i;
+
+    for (i = 0; i < tpl->count; i++) {
+        PedSector start = tpl->extents[i * 2], end = tpl->extents[i * 2 + 1];
+
+        if (first >= start && first + count - 1 <= end) {
+            return data + (first - start) * tpl->sector_size;
+        }
+
+        data += (end - start + 1) * tpl->sector_size;
+    }
+
+    return NULL;
+}
+
+static uint32_t get32(const unsigned char *p)
+{
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t) p[3] << 24;
+}
+
+static uint64_t get64(const unsigned char *p)
+{
+    return get32(p) | (uint64_t) get32(p + 4) << 32;
+}
+
+static void put32(unsigned char *p, uint32_t v)
+{
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+}
+
+/* A random version 4 GUID, in the mixed endian layout GPT uses. */
+static int stamp_guid(unsigned char *guid)
+{
+    if (getrandom(guid, 16, 0) != 16) {
+        return 0;
+    }
+
+    guid[7] = (guid[7] & 0x0f) | 0x40;
+    guid[8] = (guid[8] & 0x3f) | 0x80;
+    return 1;
+}
+
+static int stamp_gpt_header(unsigned char *header, const unsigned char *guid, uint32_t entries_crc)
+{
+    uint32_t size = get32(header + GPT_HEADER_SIZE);
+
+    if (size < GPT_ENTRIES_CRC + 4 || size > 512) {
+        return 0;
+    }
+
+    memcpy(header + GPT_DISK_GUID, guid, 16);
+    put32(header + GPT_ENTRIES_CRC, entries_crc);
+    put32(header + GPT_HEADER_CRC, 0);
+    put32(header + GPT_HEADER_CRC, _ped_crc32(header, size));
+    return 1;
+}
+
+/*
+ * Give the disk and every used partition entry new GUIDs, in both copies
+ * of the table, and fix up the CRCs.  Returns 0 if the rendered label is
+ * not laid out as expected.
+ */
+static int stamp_gpt(const _ped_LabelTemplate *tpl, unsigned char *data)
+{
+    unsigned char *primary = NULL, *backup = NULL, *entries = NULL, *backup_entries = NULL;
+    unsigned char guid[16];
+    uint32_t count, size, crc, i;
+    PedSector sectors;
+
+    primary = template_sectors(tpl, data, 1, 1);
+
+    if (primary == NULL || memcmp(primary, GPT_SIGNATURE, 8)) {
+        return 0;
+    }
+
+    backup = template_sectors(tpl, data, get64(primary + GPT_ALTERNATE_LBA), 1);
+    count = get32(primary + GPT_ENTRIES_COUNT);
+    size = get32(primary + GPT_ENTRY_SIZE);
+
+    if (backup == NULL || memcmp(backup, GPT_SIGNATURE, 8) || size < GPT_ENTRY_UNIQUE_GUID + 16) {
+        return 0;
+    }
+
+    sectors = ((PedSector) count * size + tpl->sector_size - 1) / tpl->sector_size;
+    entries = template_sectors(tpl, data, get64(primary + GPT_ENTRIES_LBA), sectors);
+    backup_entries = template_sectors(tpl, data, get64(backup + GPT_ENTRIES_LBA), sectors);
+
+    if (entries == NULL || backup_entries == NULL) {
+        return 0;
+    }
+
+    for (i = 0; i < count; i++) {
+        unsigned char *entry = entries + (size_t) i * size;
+        static const unsigned char unused[16];
+
+        /* an all zero partition type GUID marks an unused entry */
+        if (memcmp(entry, unused, 16) && !stamp_guid(entry + GPT_ENTRY_UNIQUE_GUID)) {
+            return 0;
+        }
+    }
+
+    memcpy(backup_entries, entries, (size_t) count * size);
+    crc = _ped_crc32(entries, (size_t) count * size);
+
+    return stamp_guid(guid) && stamp_gpt_header(primary, guid, crc) && stamp_gpt_header(backup, guid, crc);
+}
+
+static int stamp_msdos(const _ped_LabelTemplate *tpl, unsigned char *data)
+{
+    unsigned char *mbr = template_sectors(tpl, data, 0, 1);
+    uint32_t id = 0;
+
+    while (mbr != NULL && id == 0) {
+        if (getrandom(&id, sizeof(id), 0) != sizeof(id)) {
+            return 0;
+        }
+    }
+
+    if (mbr == NULL) {
+        return 0;
+    }
+
+    put32(mbr + MSDOS_DISK_ID, id);
+    return 1;
+}
+
+/*
+ * Make a copy of the rendered sectors with this disk's identifiers in.
+ * Returns NULL, without an exception, if the label type has identifiers
+ * we do not know how to replace.
+ */
+static unsigned char *stamp_render(const _ped_LabelTemplate *tpl)
+{
+    unsigned char *data = malloc(tpl->size ? tpl->size : 1);
+    int ok = 0;
+
+    if (data == NULL) {
+        return NULL;
+    }
+
+    memcpy(data, tpl->data, tpl->size);
+
+    if (!strcmp(tpl->type->name, "gpt")) {
+        ok = stamp_gpt(tpl, data);
+    } else if (!strcmp(tpl->type->name, "msdos")) {
+        ok = stamp_msdos(tpl, data);
+    }
+
+    if (!ok) {
+        free(data);
+        return NULL;
+    }
+
+    return data;
+}
+
+/*
+ * Commit a Disk built from snap to device through libparted, and tell the
+ * kernel about it as well if to_os is set.
+ */
+static int template_commit(PedDevice *device, const _ped_DiskSnapshot *snap, int to_os)
+{
+    PedDisk *disk = NULL;
+    _ped_Disk *pydisk = NULL;
+    int ret = 0;
+
+    disk = ped_disk_new_fresh(device, snap->type);
+
+    if (disk == NULL) {
+        goto parted_error;
+    }
+
+    pydisk = PedDisk2_ped_Disk(disk);
+
+    if (pydisk == NULL) {
+        return 0;
+    }
+
+    if (!_ped_DiskSnapshot_restore(pydisk, disk, snap)) {
+        Py_DECREF(pydisk);
+        return 0;
+    }
+
+    _ped_Lock_write(_ped_Device_lock(device));
+    Py_BEGIN_ALLOW_THREADS
+    ret = to_os ? ped_disk_commit(disk) : ped_disk_commit_to_dev(disk);
+    Py_END_ALLOW_THREADS
+    _ped_Lock_release(_ped_Device_lock(device));
+    Py_DECREF(pydisk);
+
+    if (ret) {
+        return 1;
+    }
+
+parted_error:
+    if (partedExnRaised) {
+        partedExnRaised = 0;
+
+        if (!PyErr_ExceptionMatches(PartedException) && !PyErr_ExceptionMatches(PyExc_NotImplementedError)) {
+            PyErr_SetString(IOException, partedExnMessage);
+        }
+    } else {
+        PyErr_Format(DiskException, "Could not commit to disk %s", device->path);
+    }
+
+    return 0;
+}
+
+/* Commit snap to a memory device like dev and record what was written. */
+static int template_render(_ped_LabelTemplate *tpl, const PedDevice *dev)
+{
+    PyObject *memory = NULL, *args = NULL;
+    PedDevice *mem = NULL;
+    unsigned char *p = NULL;
+    size_t i;
+    int ok = 0;
+
+    args = Py_BuildValue("(LLL)", dev->length, dev->sector_size, dev->phys_sector_size);
+
+    if (args == NULL) {
+        return 0;
+    }
+
+    memory = py_ped_device_new_memory(NULL, args);
+    Py_DECREF(args);
+
+    if (memory == NULL || (mem = _ped_Device2PedDevice(memory)) == NULL) {
+        goto out;
+    }
+
+    /* msdos records CHS addresses, those have to come out the same */
+    mem->bios_geom = dev->bios_geom;
+    mem->hw_geom = dev->hw_geom;
+
+    if (_ped_Trace_start(mem) == -1) {
+        goto out;
+    }
+
+    ok = template_commit(mem, tpl->snap, 0);
+    free(tpl->extents);
+    tpl->extents = _ped_Trace_stop(mem, TRACE_WRITE, &tpl->count);
+
+    if (!ok || tpl->extents == NULL) {
+        ok = 0;
+        goto out;
+    }
+
+    for (i = 0; i < tpl->count; i++) {
+        tpl->size += (tpl->extents[i * 2 + 1] - tpl->extents[i * 2] + 1) * dev->sector_size;
+    }
+
+    tpl->data = malloc(tpl->size ? tpl->size : 1);
+
+    if (tpl->data == NULL) {
+        PyErr_NoMemory();
+        ok = 0;
+        goto out;
+    }
+
+    ok = ped_device_open(mem);
+
+    for (i = 0, p = tpl->data; ok && i < tpl->count; i++) {
+        PedSector count = tpl->extents[i * 2 + 1] - tpl->extents[i * 2] + 1;
+
+        ok = ped_device_read(mem, p, tpl->extents[i * 2], count);
+        p += count * dev->sector_size;
+    }
+
+    if (ok) {
+        ped_device_close(mem);
+    } else {
+        PyErr_SetString(IOException, "Could not read the rendered label back");
+    }
+
+out:
+    if (mem != NULL) {
+        ped_device_destroy(mem);
+        _ped_MemoryDevice_forget(((_ped_Device *) memory)->path);
+    }
+
+    Py_XDECREF(memory);
+    return ok;
+}
+
+/* The minimum or optimum alignment of dev, a grain of 0 if it has none. */
+static void template_alignment(const PedDevice *dev, int optimum, PedSector *offset, PedSector *grain)
+{
+    PedAlignment *align = NULL;
+
+    if (optimum) {
+        align = ped_device_get_optimum_alignment(dev);
+    } else {
+        align = ped_device_get_minimum_alignment(dev);
+    }
+
+    *offset = align ? align->offset : 0;
+    *grain = align ? align->grain_size : 0;
+    ped_alignment_destroy(align);
+}
+
+PyObject *py_ped_disk_label_template(PyObject *s, PyObject *args)
+{
+    PedDisk *disk = NULL;
+    _ped_LabelTemplate *tpl = NULL;
+    PyObject *ret = NULL;
+
+    disk = _ped_Disk2PedDisk(s);
+
+    if (disk == NULL) {
+        return NULL;
+    }
+
+    tpl = calloc(1, sizeof(*tpl));
+
+    if (tpl == NULL) {
+        return PyErr_NoMemory();
+    }
+
+    _ped_Lock_read(&((_ped_Disk *) s)->lock);
+    tpl->snap = _ped_DiskSnapshot_take(disk);
+    _ped_Lock_release(&((_ped_Disk *) s)->lock);
+
+    if (tpl->snap == NULL) {
+        template_free(tpl);
+        return NULL;
+    }
+
+    tpl->type = disk->type;
+    tpl->sector_size = disk->dev->sector_size;
+    tpl->phys_sector_size = disk->dev->phys_sector_size;
+    tpl->length = disk->dev->length;
+    tpl->bios_geom = disk->dev->bios_geom;
+    template_alignment(disk->dev, 0, &tpl->align_offset[0], &tpl->align_grain[0]);
+    template_alignment(disk->dev, 1, &tpl->align_offset[1], &tpl->align_grain[1]);
+
+    if (!template_render(tpl, disk->dev)) {
+        template_free(tpl);
+        return NULL;
+    }
+
+    ret = PyCapsule_New(tpl, TEMPLATE_CAPSULE, template_capsule_destructor);
+
+    if (ret == NULL) {
+        template_free(tpl);
+    }
+
+    return ret;
+}
+
+static int template_matches(const _ped_LabelTemplate *tpl, const PedDevice *dev)
+{
+    PedSector offset, grain;
+    int i;
+
+    if (dev->sector_size != tpl->sector_size || dev->phys_sector_size != tpl->phys_sector_size ||
+        dev->length != tpl->length || dev->bios_geom.cylinders != tpl->bios_geom.cylinders ||
+        dev->bios_geom.heads != tpl->bios_geom.heads || dev->bios_geom.sectors != tpl->bios_geom.sectors) {
+        return 0;
+    }
+
+    /* the layout was aligned for the template's device, not this one */
+    for (i = 0; i < 2; i++) {
+        template_alignment(dev, i, &offset, &grain);
+
+        if (offset != tpl->align_offset[i] || grain != tpl->align_grain[i]) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+PyObject *py_ped_label_stamp(PyObject *s, PyObject *args)
+{
+    PyObject *in_template = NULL, *in_device = NULL;
+    _ped_LabelTemplate *tpl = NULL;
+    PedDevice *device = NULL;
+    PedDisk *disk = NULL;
+    unsigned char *data = NULL, *p = NULL;
+    size_t i;
+    int ok, opened;
+
+    if (!PyArg_ParseTuple(args, "OO!", &in_template, &_ped_Device_Type_obj, &in_device)) {
+        return NULL;
+    }
+
+    if (!PyCapsule_IsValid(in_template, TEMPLATE_CAPSULE)) {
+        PyErr_Format(PyExc_TypeError, "expected a template returned by _ped.Disk.label_template(), not %s", Py_TYPE(in_template)->tp_name);
+        return NULL;
+    }
+
+    tpl = PyCapsule_GetPointer(in_template, TEMPLATE_CAPSULE);
+    device = _ped_Device2PedDevice(in_device);
+
+    if (device == NULL) {
+        return NULL;
+    }
+
+    if (!template_matches(tpl, device) || (data = stamp_render(tpl)) == NULL) {
+        if (PyErr_Occurred() || !template_commit(device, tpl->snap, 1)) {
+            return NULL;
+        }
+
+        Py_RETURN_FALSE;
+    }
+
+    _ped_Lock_write(_ped_Device_lock(device));
+    Py_BEGIN_ALLOW_THREADS
+
+    opened = ok = ped_device_open(device);
+
+    for (i = 0, p = data; ok && i < tpl->count; i++) {
+        PedSector count = tpl->extents[i * 2 + 1] - tpl->extents[i * 2] + 1;
+
+        ok = ped_device_write(device, p, tpl->extents[i * 2], count);
+        p += count * tpl->sector_size;
+    }
+
+    if (ok) {
+        ok = ped_device_sync(device);
+    }
+
+    /* the kernel learns of the partitions from the label just written */
+    if (ok && (ok = (disk = ped_disk_new(device)) != NULL)) {
+        ok = ped_disk_commit_to_os(disk);
+        ped_disk_destroy(disk);
+    }
+
+    if (opened) {
+        ped_device_close(device);
+    }
+
+    Py_END_ALLOW_THREADS
+    _ped_Lock_release(_ped_Device_lock(device));
+    free(data);
+
+    if (!ok) {
+        if (partedExnRaised) {
+            partedExnRaised = 0;
+
+            if (!PyErr_ExceptionMatches(PartedException) && !PyErr_ExceptionMatches(PyExc_NotImplementedError)) {
+                PyErr_SetString(IOException, partedExnMessage);
+            }
+        } else {
+            PyErr_Format(IOException, "Could not write label to %s", device->path);
+        }
+
+        return NULL;
+    }
+
+    Py_RETURN_TRUE;
+}
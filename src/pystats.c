@@ -0,0 +1,240 @@
+/*
+ * pystats.c
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <Python.h>
+#include <string.h>
+#include <time.h>
+
+#include "pystats.h"
+
+/*
+ * Number of methods that can be counted.  C has no closures, so every
+ * counted method needs a trampoline of its own that knows which entry to
+ * charge; they are generated below, one per slot.  Methods registered
+ * past this many are left uncounted.
+ */
+#define STATS_SLOTS 256
+
+typedef struct {
+    PyMethodDef *def;
+    PyCFunction orig;
+    const char *owner;
+    unsigned long long calls;
+    unsigned long long errors;
+    unsigned long long total_ns;
+    unsigned long long max_ns;
+} _ped_StatsEntry;
+
+typedef PyObject *(*_ped_FastCFunction)(PyObject *, PyObject *const *, Py_ssize_t);
+
+int _ped_stats_enabled = 0;
+unsigned long long _ped_stats_bytes_read = 0;
+unsigned long long _ped_stats_bytes_written = 0;
+
+static _ped_StatsEntry entries[STATS_SLOTS];
+static int n_entries = 0;
+
+static unsigned long long now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * The real function may drop the GIL, but it is held again by the time
+ * it returns, so the counters need no locking of their own.
+ */
+static PyObject *stats_account(_ped_StatsEntry *entry, unsigned long long start, PyObject *ret)
+{
+    unsigned long long elapsed = now_ns() - start;
+
+    entry->calls++;
+    entry->total_ns += elapsed;
+
+    if (elapsed > entry->max_ns) {
+        entry->max_ns = elapsed;
+    }
+
+    if (ret == NULL) {
+        entry->errors++;
+    }
+
+    return ret;
+}
+
+static PyObject *stats_call(int slot, PyObject *s, PyObject *args)
+{
+    unsigned long long start = now_ns();
+
+    return stats_account(&entries[slot], start, entries[slot].orig(s, args));
+}
+
+static PyObject *stats_fastcall(int slot, PyObject *s, PyObject *const *args, Py_ssize_t nargs)
+{
+    unsigned long long start = now_ns();
+    _ped_FastCFunction orig = (_ped_FastCFunction) (void (*)(void)) entries[slot].orig;
+
+    return stats_account(&entries[slot], start, orig(s, args, nargs));
+}
+
+#define STATS_TRAMPOLINE(n) \
+    static PyObject *stats_call_##n(PyObject *s, PyObject *args) \
+    { \
+        return stats_call(0x##n, s, args); \
+    } \
+    static PyObject *stats_fastcall_##n(PyObject *s, PyObject *const *args, Py_ssize_t nargs) \
+    { \
+        return stats_fastcall(0x##n, s, args, nargs); \
+    }
+
+#define STATS_ROW(h, X) \
+    X(h##0) X(h##1) X(h##2) X(h##3) X(h##4) X(h##5) X(h##6) X(h##7) \
+    X(h##8) X(h##9) X(h##a) X(h##b) X(h##c) X(h##d) X(h##e) X(h##f)
+
+#define STATS_TABLE(X) \
+    STATS_ROW(0, X) STATS_ROW(1, X) STATS_ROW(2, X) STATS_ROW(3, X) \
+    STATS_ROW(4, X) STATS_ROW(5, X) STATS_ROW(6, X) STATS_ROW(7, X) \
+    STATS_ROW(8, X) STATS_ROW(9, X) STATS_ROW(a, X) STATS_ROW(b, X) \
+    STATS_ROW(c, X) STATS_ROW(d, X) STATS_ROW(e, X) STATS_ROW(f, X)
+
+#define STATS_CALL_ENTRY(n) stats_call_##n,
+#define STATS_FASTCALL_ENTRY(n) stats_fastcall_##n,
+
+STATS_TABLE(STATS_TRAMPOLINE)
+
+static PyCFunction call_trampolines[STATS_SLOTS] = { STATS_TABLE(STATS_CALL_ENTRY) };
+static _ped_FastCFunction fastcall_trampolines[STATS_SLOTS] = { STATS_TABLE(STATS_FASTCALL_ENTRY) };
+
+/*
+ * Record every method in defs as belonging to owner, a type name or NULL
+ * for module functions.  Called once per method table at module init,
+ * after PyType_Ready() has seen the table.
+ */
+int _ped_Stats_register(const char *owner, PyMethodDef *defs)
+{
+    PyMethodDef *def = NULL;
+
+    if (owner != NULL && strchr(owner, '.') != NULL) {
+        owner = strrchr(owner, '.') + 1;
+    }
+
+    for (def = defs; def != NULL && def->ml_name != NULL; def++) {
+        if (n_entries == STATS_SLOTS) {
+            return -1;
+        }
+
+        entries[n_entries].def = def;
+        entries[n_entries].orig = def->ml_meth;
+        entries[n_entries].owner = owner;
+        n_entries++;
+    }
+
+    return 0;
+}
+
+/*
+ * Method objects look up ml_meth on every call, so swapping it here takes
+ * effect for method objects that already exist.
+ */
+static void stats_switch(int enable)
+{
+    int i;
+
+    for (i = 0; i < n_entries; i++) {
+        PyMethodDef *def = entries[i].def;
+
+        if (!enable) {
+            def->ml_meth = entries[i].orig;
+        } else if (def->ml_flags & METH_FASTCALL) {
+            def->ml_meth = (PyCFunction) (void (*)(void)) fastcall_trampolines[i];
+        } else {
+            def->ml_meth = call_trampolines[i];
+        }
+    }
+
+    _ped_stats_enabled = enable;
+}
+
+PyObject *py_ped_stats_enable(PyObject *s, PyObject *args)
+{
+    int enable = 1;
+
+    if (!PyArg_ParseTuple(args, "|p", &enable)) {
+        return NULL;
+    }
+
+    if (enable != _ped_stats_enabled) {
+        stats_switch(enable);
+    }
+
+    Py_RETURN_NONE;
+}
+
+PyObject *py_ped_stats(PyObject *s, PyObject *args)
+{
+    int reset = 0, i;
+    PyObject *calls = NULL, *ret = NULL;
+
+    if (!PyArg_ParseTuple(args, "|p", &reset)) {
+        return NULL;
+    }
+
+    calls = PyDict_New();
+
+    if (calls == NULL) {
+        return NULL;
+    }
+
+    for (i = 0; i < n_entries; i++) {
+        _ped_StatsEntry *entry = &entries[i];
+        PyObject *key = NULL, *value = NULL;
+        int rc;
+
+        if (entry->calls == 0) {
+            continue;
+        }
+
+        if (entry->owner != NULL) {
+            key = PyUnicode_FromFormat("%s.%s", entry->owner, entry->def->ml_name);
+        } else {
+            key = PyUnicode_FromString(entry->def->ml_name);
+        }
+
+        value = Py_BuildValue("(KKdd)", entry->calls, entry->errors, entry->total_ns / 1e9, entry->max_ns / 1e9);
+
+        if (key == NULL || value == NULL) {
+            Py_XDECREF(key);
+            Py_XDECREF(value);
+            goto out;
+        }
+
+        rc = PyDict_SetItem(calls, key, value);
+        Py_DECREF(key);
+        Py_DECREF(value);
+
+        if (rc == -1) {
+            goto out;
+        }
+    }
+
+    ret = Py_BuildValue("{sOsKsKsO}", "calls", calls, "bytes_read", _ped_stats_bytes_read,
+                        "bytes_written", _ped_stats_bytes_written, "enabled", _ped_stats_enabled ? Py_True : Py_False);
+
+    if (ret != NULL && reset) {
+        for (i = 0; i < n_entries; i++) {
+            entries[i].calls = entries[i].errors = entries[i].total_ns = entries[i].max_ns = 0;
+        }
+
+        _ped_stats_bytes_read = _ped_stats_bytes_written = 0;
+    }
+
+out:
+    Py_DECREF(calls);
+    return ret;
+}
@@ -0,0 +1,365 @@
+/*
+ * pytrace.c
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <Python.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "convert.h"
+#include "pydevice.h"
+#include "pydevops.h"
+#include "pytrace.h"
+
+static const char *trace_op_names[TRACE_OPS] = { "read", "write", "sync" };
+
+typedef struct {
+    int op;
+    PedSector start;
+    PedSector count;
+    unsigned long long ns;
+} _ped_TraceEvent;
+
+typedef struct _ped_Trace {
+    const PedDevice *dev;
+    unsigned long long started;
+    _ped_TraceEvent *events;
+    size_t count, size, dropped;
+
+    /* totals over every event, kept or dropped */
+    unsigned long long ops[TRACE_OPS];
+    PedSector sectors[TRACE_OPS];
+
+    struct _ped_Trace *next;
+} _ped_Trace;
+
+/*
+ * Events are recorded from the device op wrappers in pydevops.c with the
+ * GIL released, so the trace list has a mutex of its own and nothing in
+ * here touches Python objects.
+ */
+static int n_traces = 0;
+static _ped_Trace *traces = NULL;
+static pthread_mutex_t trace_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static unsigned long long now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* call with trace_mutex held */
+static _ped_Trace **trace_find(const PedDevice *dev)
+{
+    _ped_Trace **trace;
+
+    for (trace = &traces; *trace != NULL; trace = &(*trace)->next) {
+        if ((*trace)->dev == dev) {
+            return trace;
+        }
+    }
+
+    return NULL;
+}
+
+static void trace_free(_ped_Trace *trace)
+{
+    if (trace != NULL) {
+        free(trace->events);
+        free(trace);
+    }
+}
+
+void _ped_Trace_record(const PedDevice *dev, int op, PedSector start, PedSector count)
+{
+    _ped_Trace **found = NULL;
+    _ped_Trace *trace = NULL;
+
+    if (__atomic_load_n(&n_traces, __ATOMIC_RELAXED) == 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&trace_mutex);
+    found = trace_find(dev);
+
+    if (found == NULL) {
+        goto out;
+    }
+
+    trace = *found;
+    trace->ops[op]++;
+    trace->sectors[op] += count;
+
+    if (trace->count == trace->size) {
+        size_t size = trace->size ? trace->size * 2 : 64;
+        _ped_TraceEvent *events = NULL;
+
+        if (size > TRACE_MAX_EVENTS || (events = realloc(trace->events, size * sizeof(*events))) == NULL) {
+            trace->dropped++;
+            goto out;
+        }
+
+        trace->events = events;
+        trace->size = size;
+    }
+
+    trace->events[trace->count].op = op;
+    trace->events[trace->count].start = start;
+    trace->events[trace->count].count = count;
+    trace->events[trace->count].ns = now_ns() - trace->started;
+    trace->count++;
+
+out:
+    pthread_mutex_unlock(&trace_mutex);
+}
+
+/* unlink and return the trace of dev, if there is one */
+static _ped_Trace *trace_take(const PedDevice *dev)
+{
+    _ped_Trace **found = NULL;
+    _ped_Trace *trace = NULL;
+
+    pthread_mutex_lock(&trace_mutex);
+    found = trace_find(dev);
+
+    if (found != NULL) {
+        trace = *found;
+        *found = trace->next;
+        __atomic_sub_fetch(&n_traces, 1, __ATOMIC_RELAXED);
+    }
+
+    pthread_mutex_unlock(&trace_mutex);
+    return trace;
+}
+
+void _ped_Trace_forget(const PedDevice *dev)
+{
+    trace_free(trace_take(dev));
+}
+
+int _ped_Trace_start(const PedDevice *device)
+{
+    _ped_Trace **found = NULL;
+    _ped_Trace *trace = NULL;
+
+    trace = calloc(1, sizeof(*trace));
+
+    if (trace == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    trace->dev = device;
+    trace->started = now_ns();
+    _ped_DevOps_install();
+
+    /* starting again throws away whatever was recorded so far */
+    pthread_mutex_lock(&trace_mutex);
+    found = trace_find(device);
+
+    if (found != NULL) {
+        trace->next = (*found)->next;
+        trace_free(*found);
+        *found = trace;
+    } else {
+        trace->next = traces;
+        traces = trace;
+        __atomic_add_fetch(&n_traces, 1, __ATOMIC_RELAXED);
+    }
+
+    pthread_mutex_unlock(&trace_mutex);
+    return 0;
+}
+
+PyObject *py_ped_device_trace_start(PyObject *s, PyObject *args)
+{
+    PedDevice *device = NULL;
+
+    device = _ped_Device2PedDevice(s);
+
+    if (device == NULL) {
+        return NULL;
+    }
+
+    if (_ped_Trace_start(device) == -1) {
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+static int extent_compare(const void *a, const void *b)
+{
+    const PedSector *x = a, *y = b;
+
+    return (x[0] > y[0]) - (x[0] < y[0]);
+}
+
+/*
+ * The sectors touched by the events of the given op, as sorted and merged
+ * pairs of first and last sector.  Returns NULL if out of memory.
+ */
+static PedSector *trace_extents(const _ped_Trace *trace, int op, size_t *count)
+{
+    PedSector *extents = NULL;
+    size_t i, n = 0;
+
+    extents = malloc((trace->count ? trace->count : 1) * 2 * sizeof(PedSector));
+
+    if (extents == NULL) {
+        return NULL;
+    }
+
+    for (i = 0; i < trace->count; i++) {
+        if (trace->events[i].op == op && trace->events[i].count > 0) {
+            extents[n * 2] = trace->events[i].start;
+            extents[n * 2 + 1] = trace->events[i].start + trace->events[i].count - 1;
+            n++;
+        }
+    }
+
+    qsort(extents, n, 2 * sizeof(PedSector), extent_compare);
+    *count = 0;
+
+    for (i = 0; i < n; i++) {
+        PedSector *last = *count > 0 ? &extents[(*count - 1) * 2] : NULL;
+
+        if (last != NULL && extents[i * 2] <= last[1] + 1) {
+            if (extents[i * 2 + 1] > last[1]) {
+                last[1] = extents[i * 2 + 1];
+            }
+        } else {
+            extents[*count * 2] = extents[i * 2];
+            extents[*count * 2 + 1] = extents[i * 2 + 1];
+            (*count)++;
+        }
+    }
+
+    return extents;
+}
+
+/* number of distinct sectors covered by the events of the given op */
+static PedSector trace_unique(const _ped_Trace *trace, int op)
+{
+    PedSector *extents = NULL, unique = 0;
+    size_t i, n;
+
+    extents = trace_extents(trace, op, &n);
+
+    if (extents == NULL) {
+        return -1;
+    }
+
+    for (i = 0; i < n; i++) {
+        unique += extents[i * 2 + 1] - extents[i * 2] + 1;
+    }
+
+    free(extents);
+    return unique;
+}
+
+PedSector *_ped_Trace_stop(const PedDevice *device, int op, size_t *count)
+{
+    _ped_Trace *trace = trace_take(device);
+    PedSector *ret = NULL;
+
+    if (trace == NULL) {
+        PyErr_Format(PyExc_RuntimeError, "Device %s is not being traced", device->path);
+        return NULL;
+    }
+
+    ret = trace_extents(trace, op, count);
+    trace_free(trace);
+
+    if (ret == NULL) {
+        PyErr_NoMemory();
+    }
+
+    return ret;
+}
+
+static PyObject *trace_summary(const _ped_Trace *trace)
+{
+    PyObject *events = NULL, *ret = NULL;
+    PedSector kept[TRACE_OPS] = { 0 }, unique[2];
+    double amplification[2];
+    size_t i;
+    int op;
+
+    events = PyList_New(trace->count);
+
+    if (events == NULL) {
+        return NULL;
+    }
+
+    for (i = 0; i < trace->count; i++) {
+        const _ped_TraceEvent *event = &trace->events[i];
+        PyObject *item = Py_BuildValue("(sLLd)", trace_op_names[event->op], event->start, event->count, event->ns / 1e9);
+
+        if (item == NULL) {
+            Py_DECREF(events);
+            return NULL;
+        }
+
+        PyList_SET_ITEM(events, i, item);
+        kept[event->op] += event->count;
+    }
+
+    /* only the kept events say which sectors were touched */
+    for (op = TRACE_READ; op <= TRACE_WRITE; op++) {
+        unique[op] = trace_unique(trace, op);
+
+        if (unique[op] == -1) {
+            Py_DECREF(events);
+            return PyErr_NoMemory();
+        }
+
+        amplification[op] = unique[op] ? (double) kept[op] / unique[op] : 1.0;
+    }
+
+    ret = Py_BuildValue("{sOsKsKsKsLsLsLsLsdsdsn}",
+                        "events", events,
+                        "reads", trace->ops[TRACE_READ],
+                        "writes", trace->ops[TRACE_WRITE],
+                        "syncs", trace->ops[TRACE_SYNC],
+                        "sectors_read", trace->sectors[TRACE_READ],
+                        "sectors_written", trace->sectors[TRACE_WRITE],
+                        "unique_sectors_read", unique[TRACE_READ],
+                        "unique_sectors_written", unique[TRACE_WRITE],
+                        "read_amplification", amplification[TRACE_READ],
+                        "write_amplification", amplification[TRACE_WRITE],
+                        "dropped", (Py_ssize_t) trace->dropped);
+    Py_DECREF(events);
+    return ret;
+}
+
+PyObject *py_ped_device_trace_stop(PyObject *s, PyObject *args)
+{
+    PedDevice *device = NULL;
+    _ped_Trace *trace = NULL;
+    PyObject *ret = NULL;
+
+    device = _ped_Device2PedDevice(s);
+
+    if (device == NULL) {
+        return NULL;
+    }
+
+    trace = trace_take(device);
+
+    if (trace == NULL) {
+        PyErr_Format(PyExc_RuntimeError, "Device %s is not being traced", device->path);
+        return NULL;
+    }
+
+    ret = trace_summary(trace);
+    trace_free(trace);
+    return ret;
+}
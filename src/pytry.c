@@ -0,0 +1,167 @@
+/*
+ * pytry.c
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <Python.h>
+#include <stdlib.h>
+
+#include "convert.h"
+#include "exceptions.h"
+#include "pydevice.h"
+#include "pygeom.h"
+#include "pylock.h"
+#include "pysniff.h"
+#include "pytry.h"
+
+/*
+ * Status of a probe that found nothing.  libparted runs the label and file
+ * system probes with exceptions fetched, so an unrecognized device never
+ * reaches our handler and only real errors, such as the device failing to
+ * open, set partedExnRaised.  Returns -1 if the handler raised.
+ */
+static int not_found(void)
+{
+    if (!partedExnRaised) {
+        return TRY_UNRECOGNIZED;
+    }
+
+    partedExnRaised = 0;
+    free(partedExnMessage);
+    partedExnMessage = NULL;
+
+    /* set by the handler for parted bugs and unsupported features */
+    if (PyErr_Occurred()) {
+        return -1;
+    }
+
+    return TRY_FAILED;
+}
+
+/* Steals a reference to result, which may be NULL if nothing was found. */
+static PyObject *try_result(PyObject *result, int status)
+{
+    if (status == -1) {
+        Py_XDECREF(result);
+        return NULL;
+    }
+
+    if (status == TRY_FOUND && result == NULL) {
+        return NULL;
+    }
+
+    if (result == NULL) {
+        result = Py_None;
+        Py_INCREF(result);
+    }
+
+    return Py_BuildValue("(Ni)", result, status);
+}
+
+PyObject *py_ped_try_disk_probe(PyObject *s, PyObject *args)
+{
+    PyObject *in_device = NULL;
+    PedDevice *device = NULL;
+    PedDiskType *type = NULL;
+
+    if (!PyArg_ParseTuple(args, "O!", &_ped_Device_Type_obj, &in_device)) {
+        return NULL;
+    }
+
+    device = _ped_Device2PedDevice(in_device);
+
+    if (device == NULL) {
+        return NULL;
+    }
+
+    partedExnRaised = 0;
+    _ped_Lock_write(_ped_Device_lock(device));
+    Py_BEGIN_ALLOW_THREADS
+    type = ped_disk_probe(device);
+    Py_END_ALLOW_THREADS
+    _ped_Lock_release(_ped_Device_lock(device));
+
+    if (type == NULL) {
+        return try_result(NULL, not_found());
+    }
+
+    return try_result((PyObject *) PedDiskType2_ped_DiskType(type), TRY_FOUND);
+}
+
+PyObject *py_ped_try_disk_new(PyObject *s, PyObject *args)
+{
+    PyObject *in_device = NULL;
+    PedDevice *device = NULL;
+    PedDiskType *type = NULL;
+    PedDisk *disk = NULL;
+    int status = TRY_FOUND;
+
+    if (!PyArg_ParseTuple(args, "O!", &_ped_Device_Type_obj, &in_device)) {
+        return NULL;
+    }
+
+    device = _ped_Device2PedDevice(in_device);
+
+    if (device == NULL) {
+        return NULL;
+    }
+
+    /*
+     * ped_disk_new() reports an unrecognized label by throwing an error,
+     * so probe first and only read the label if there is one.
+     */
+    partedExnRaised = 0;
+    _ped_Lock_write(_ped_Device_lock(device));
+    Py_BEGIN_ALLOW_THREADS
+    type = ped_disk_probe(device);
+
+    if (type != NULL) {
+        disk = ped_disk_new(device);
+    }
+    Py_END_ALLOW_THREADS
+    _ped_Lock_release(_ped_Device_lock(device));
+
+    if (type == NULL) {
+        status = not_found();
+    } else if (disk == NULL) {
+        status = not_found() == -1 ? -1 : TRY_FAILED;
+    }
+
+    if (disk == NULL) {
+        return try_result(NULL, status);
+    }
+
+    return try_result((PyObject *) PedDisk2_ped_Disk(disk), TRY_FOUND);
+}
+
+PyObject *py_ped_try_file_system_probe(PyObject *s, PyObject *args)
+{
+    PyObject *in_geom = NULL;
+    PedGeometry *geom = NULL;
+    const PedFileSystemType *fstype = NULL;
+
+    if (!PyArg_ParseTuple(args, "O!", &_ped_Geometry_Type_obj, &in_geom)) {
+        return NULL;
+    }
+
+    geom = _ped_Geometry2PedGeometry(in_geom);
+
+    if (geom == NULL) {
+        return NULL;
+    }
+
+    partedExnRaised = 0;
+    _ped_Lock_write(_ped_Device_lock(geom->dev));
+    Py_BEGIN_ALLOW_THREADS
+    fstype = _ped_FileSystem_probe(geom);
+    Py_END_ALLOW_THREADS
+    _ped_Lock_release(_ped_Device_lock(geom->dev));
+
+    if (fstype == NULL) {
+        return try_result(NULL, not_found());
+    }
+
+    return try_result((PyObject *) PedFileSystemType2_ped_FileSystemType(fstype), TRY_FOUND);
+}
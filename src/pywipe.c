@@ -0,0 +1,382 @@
+/*
+ * pywipe.c
+ *
+ * Copyright The pyparted Project Authors
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <Python.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "convert.h"
+#include "exceptions.h"
+#include "pycache.h"
+#include "pydevops.h"
+#include "pydisk.h"
+#include "pygeom.h"
+#include "pylock.h"
+#include "pywipe.h"
+
+/* Size of the buffer of zeros written where nothing better is available. */
+#define WIPE_ZERO_SIZE (1024 * 1024)
+
+/*
+ * Everything to be done is collected first, then sorted by device and
+ * merged, so each device is opened and locked once and adjacent regions
+ * turn into a single call.  Discards go first: a discarded range is not
+ * guaranteed to read back as zeros, the signature zeroing after it is.
+ */
+enum {
+    WIPE_DISCARD,
+    WIPE_ZERO
+};
+
+typedef struct {
+    PedDevice *dev;
+    int op;
+    long long start;
+    long long end;
+} _ped_WipeRange;
+
+typedef struct {
+    _ped_WipeRange *ranges;
+    Py_ssize_t count;
+    Py_ssize_t size;
+
+    long long zeroed;
+    long long discarded;
+
+    /* the first failure, reported once everything else is done */
+    int error;
+    const char *error_path;
+} _ped_Wipe;
+
+static int wipe_add(_ped_Wipe *wipe, PedDevice *dev, int op, long long start, long long end)
+{
+    if (start >= end) {
+        return 0;
+    }
+
+    if (wipe->count == wipe->size) {
+        _ped_WipeRange *grown = NULL;
+
+        wipe->size = wipe->size ? wipe->size * 2 : 32;
+        grown = PyMem_Realloc(wipe->ranges, wipe->size * sizeof(*grown));
+
+        if (grown == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+
+        wipe->ranges = grown;
+    }
+
+    wipe->ranges[wipe->count].dev = dev;
+    wipe->ranges[wipe->count].op = op;
+    wipe->ranges[wipe->count].start = start;
+    wipe->ranges[wipe->count++].end = end;
+    return 0;
+}
+
+/* Signatures at both ends of geom, and all of it if discard is set. */
+static int wipe_add_geometry(_ped_Wipe *wipe, const PedGeometry *geom, int discard)
+{
+    long long start = geom->start * geom->dev->sector_size;
+    long long end = (geom->end + 1) * geom->dev->sector_size;
+    long long head = end - start < WIPE_HEAD_SIZE ? end : start + WIPE_HEAD_SIZE;
+    long long tail = end - start < WIPE_TAIL_SIZE ? start : end - WIPE_TAIL_SIZE;
+
+    /* where ZFS puts its last two labels */
+    long long zfs = start + (end - start) / WIPE_ZFS_LABEL_SIZE * WIPE_ZFS_LABEL_SIZE - 2 * WIPE_ZFS_LABEL_SIZE;
+
+    if (zfs < tail) {
+        tail = zfs < start ? start : zfs;
+    }
+
+    if (discard && wipe_add(wipe, geom->dev, WIPE_DISCARD, start, end) == -1) {
+        return -1;
+    }
+
+    if (wipe_add(wipe, geom->dev, WIPE_ZERO, start, head) == -1) {
+        return -1;
+    }
+
+    return wipe_add(wipe, geom->dev, WIPE_ZERO, tail > head ? tail : head, end);
+}
+
+static int wipe_range_compare(const void *a, const void *b)
+{
+    const _ped_WipeRange *x = a, *y = b;
+
+    if (x->dev != y->dev) {
+        return ((uintptr_t) x->dev > (uintptr_t) y->dev) - ((uintptr_t) x->dev < (uintptr_t) y->dev);
+    }
+
+    if (x->op != y->op) {
+        return x->op - y->op;
+    }
+
+    return (x->start > y->start) - (x->start < y->start);
+}
+
+/* Sort and merge overlapping or touching ranges of the same kind. */
+static void wipe_coalesce(_ped_Wipe *wipe)
+{
+    Py_ssize_t i, n = 0;
+
+    if (wipe->count == 0) {
+        return;
+    }
+
+    qsort(wipe->ranges, wipe->count, sizeof(*wipe->ranges), wipe_range_compare);
+
+    for (i = 1; i < wipe->count; i++) {
+        _ped_WipeRange *last = &wipe->ranges[n], *range = &wipe->ranges[i];
+
+        if (range->dev == last->dev && range->op == last->op && range->start <= last->end) {
+            if (range->end > last->end) {
+                last->end = range->end;
+            }
+        } else {
+            wipe->ranges[++n] = *range;
+        }
+    }
+
+    wipe->count = n + 1;
+}
+
+static int wipe_write_zeros(int fd, long long start, long long end)
+{
+    static const char zeros[WIPE_ZERO_SIZE];
+    ssize_t n;
+
+    while (start < end) {
+        n = pwrite(fd, zeros, end - start < WIPE_ZERO_SIZE ? end - start : WIPE_ZERO_SIZE, start);
+
+        if (n <= 0) {
+            /* a short write says nothing in errno */
+            if (n == 0) {
+                errno = EIO;
+            }
+
+            return -1;
+        }
+
+        start += n;
+    }
+
+    return 0;
+}
+
+/*
+ * Image files get holes punched for both, which reads back as zeros.
+ * Block devices are asked to zero the range themselves, which many can do
+ * without moving any data, and to discard it.  A device that cannot
+ * discard is not an error, the range just does not count as discarded.
+ */
+static int wipe_range(_ped_Wipe *wipe, int fd, int file, const _ped_WipeRange *range)
+{
+    uint64_t span[2] = { range->start, range->end - range->start };
+
+    if (file) {
+        if (fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, range->start, range->end - range->start) == 0) {
+            if (range->op == WIPE_DISCARD) {
+                wipe->discarded += range->end - range->start;
+            } else {
+                wipe->zeroed += range->end - range->start;
+            }
+
+            return 0;
+        }
+
+        if (range->op == WIPE_DISCARD) {
+            return 0;
+        }
+    } else if (range->op == WIPE_DISCARD) {
+        if (ioctl(fd, BLKDISCARD, span) == 0) {
+            wipe->discarded += range->end - range->start;
+        }
+
+        return 0;
+    } else if (ioctl(fd, BLKZEROOUT, span) == 0) {
+        wipe->zeroed += range->end - range->start;
+        return 0;
+    }
+
+    if (wipe_write_zeros(fd, range->start, range->end) == -1) {
+        return -1;
+    }
+
+    wipe->zeroed += range->end - range->start;
+    return 0;
+}
+
+/* Run every range, a device at a time.  Called without the GIL. */
+static void wipe_run(_ped_Wipe *wipe)
+{
+    Py_ssize_t i = 0, j;
+
+    while (i < wipe->count) {
+        PedDevice *dev = wipe->ranges[i].dev;
+        int fd, file = dev->type == PED_DEVICE_FILE;
+
+        for (j = i; j < wipe->count && wipe->ranges[j].dev == dev; j++);
+
+        _ped_Lock_write_nogil(_ped_Device_lock(dev));
+        fd = open(dev->path, O_WRONLY | O_CLOEXEC);
+
+        if (fd == -1 && wipe->error == 0) {
+            wipe->error = errno;
+            wipe->error_path = dev->path;
+        }
+
+        for (; fd != -1 && i < j; i++) {
+            if (wipe_range(wipe, fd, file, &wipe->ranges[i]) == -1 && wipe->error == 0) {
+                wipe->error = errno;
+                wipe->error_path = dev->path;
+            }
+        }
+
+        if (fd != -1 && fsync(fd) == -1 && wipe->error == 0) {
+            wipe->error = errno;
+            wipe->error_path = dev->path;
+        }
+
+        if (fd != -1) {
+            close(fd);
+        }
+
+        /* written around libparted, whatever it cached is stale */
+        _ped_SectorCache_invalidate(dev);
+        _ped_Lock_release(_ped_Device_lock(dev));
+        i = j;
+    }
+}
+
+/*
+ * Collect the partitions of a Disk, and its free space if discard and
+ * free_space are both set.  The free space is what the Disk describes, and
+ * before a commit that can be a partition still in use on the device, so
+ * it is only discarded when asked for on its own.
+ */
+static int wipe_add_disk(_ped_Wipe *wipe, PyObject *in_disk, int discard, int free_space)
+{
+    PedDisk *disk = _ped_Disk2PedDisk(in_disk);
+    PedPartition *part = NULL;
+    int ret = 0;
+
+    if (disk == NULL || _ped_Disk_check_writable(in_disk) == -1) {
+        return -1;
+    }
+
+    _ped_Lock_read(&((_ped_Disk *) in_disk)->lock);
+
+    for (part = ped_disk_next_partition(disk, NULL); part && ret == 0; part = ped_disk_next_partition(disk, part)) {
+        if (part->type & PED_PARTITION_FREESPACE) {
+            if (discard && free_space) {
+                ret = wipe_add(wipe, part->geom.dev, WIPE_DISCARD, part->geom.start * part->geom.dev->sector_size,
+                               (part->geom.end + 1) * part->geom.dev->sector_size);
+            }
+        } else if (ped_partition_is_active(part) && !(part->type & PED_PARTITION_EXTENDED)) {
+            if (ped_partition_is_busy(part)) {
+                PyErr_Format(PartitionException, "Partition %d on %s is busy.", part->num, disk->dev->path);
+                ret = -1;
+            } else {
+                ret = wipe_add_geometry(wipe, &part->geom, discard);
+            }
+        }
+    }
+
+    _ped_Lock_release(&((_ped_Disk *) in_disk)->lock);
+    return ret;
+}
+
+static int wipe_add_geometries(_ped_Wipe *wipe, PyObject *in_geoms, int discard)
+{
+    PyObject *seq = PySequence_Fast(in_geoms, "expected a _ped.Disk or a sequence of _ped.Geometry");
+    Py_ssize_t i;
+    int ret = 0;
+
+    if (seq == NULL) {
+        return -1;
+    }
+
+    for (i = 0; i < PySequence_Fast_GET_SIZE(seq) && ret == 0; i++) {
+        PyObject *item = PySequence_Fast_GET_ITEM(seq, i);
+        PedGeometry *geom = NULL;
+
+        if (!PyObject_TypeCheck(item, &_ped_Geometry_Type_obj)) {
+            PyErr_SetString(PyExc_TypeError, "expected a _ped.Disk or a sequence of _ped.Geometry");
+            ret = -1;
+        } else if ((geom = _ped_Geometry2PedGeometry(item)) == NULL) {
+            ret = -1;
+        } else if (ped_device_is_busy(geom->dev)) {
+            /* a bare region could be anywhere, so any use of the device counts */
+            PyErr_Format(DeviceException, "Device %s is busy.", geom->dev->path);
+            ret = -1;
+        } else if (geom->dev->read_only || _ped_DevOps_is_read_only(geom->dev)) {
+            PyErr_Format(DeviceException, "Device %s is read-only.", geom->dev->path);
+            ret = -1;
+        } else {
+            ret = wipe_add_geometry(wipe, geom, discard);
+        }
+    }
+
+    Py_DECREF(seq);
+    return ret;
+}
+
+PyObject *py_ped_wipe_signatures(PyObject *s, PyObject *args)
+{
+    PyObject *in_targets = NULL, *ret = NULL;
+    _ped_Wipe wipe;
+    struct timespec start, end;
+    int discard = 0, free_space = 0, rc;
+
+    if (!PyArg_ParseTuple(args, "O|pp", &in_targets, &discard, &free_space)) {
+        return NULL;
+    }
+
+    memset(&wipe, 0, sizeof(wipe));
+
+    if (PyObject_TypeCheck(in_targets, &_ped_Disk_Type_obj)) {
+        rc = wipe_add_disk(&wipe, in_targets, discard, free_space);
+    } else {
+        rc = wipe_add_geometries(&wipe, in_targets, discard);
+    }
+
+    if (rc == -1) {
+        goto out;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    Py_BEGIN_ALLOW_THREADS
+    wipe_coalesce(&wipe);
+    wipe_run(&wipe);
+    Py_END_ALLOW_THREADS
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if (wipe.error != 0) {
+        PyErr_Format(IOException, "Could not wipe %s: %s", wipe.error_path, strerror(wipe.error));
+        goto out;
+    }
+
+    ret = Py_BuildValue("{s:L,s:L,s:d}",
+                        "bytes_zeroed", wipe.zeroed,
+                        "bytes_discarded", wipe.discarded,
+                        "elapsed", (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+
+out:
+    PyMem_Free(wipe.ranges);
+    return ret;
+}
@@ -4,6 +4,7 @@
 #
 
 import _ped
+import gc
 import unittest
 from tests.baseclass import RequiresDevice, RequiresDeviceAlignment
 
@@ -20,6 +21,26 @@ class AlignmentNewTestCase(unittest.TestCase):
         self.assertIsInstance(_ped.Alignment(offset=0, grain_size=100), _ped.Alignment)
 
 
+class AlignmentUntrackedTestCase(unittest.TestCase):
+    def runTest(self):
+        # _ped.Alignment holds no Python references, so the cyclic
+        # garbage collector has no business looking at it.
+        a = _ped.Alignment(0, 100)
+        self.assertFalse(gc.is_tracked(a))
+        self.assertFalse(gc.is_tracked(a.duplicate()))
+
+        # Subclasses get a __dict__ and may hold references again.
+        class SubAlignment(_ped.Alignment):
+            pass
+
+        sub = SubAlignment(0, 100)
+        sub.cycle = sub
+        self.assertTrue(gc.is_tracked(sub))
+        self.assertEqual(sub.grain_size, 100)
+        del sub
+        gc.collect()
+
+
 class AlignmentGetSetTestCase(unittest.TestCase):
     def setUp(self):
         super().setUp()
@@ -202,6 +202,49 @@ class ConstraintIsSolutionTestCase(RequiresDevice):
         self.assertTrue(self.c1.is_solution(self.g1))
 
 
+class ConstraintCompiledTestCase(RequiresDevice):
+    def setUp(self):
+        super().setUp()
+        self.align = _ped.Alignment(0, 1)
+        self.start_range = _ped.Geometry(self._device, 0, 100)
+        self.end_range = _ped.Geometry(self._device, 0, 200)
+        self.c1 = _ped.Constraint(
+            self.align,
+            _ped.Alignment(0, 1),
+            self.start_range,
+            self.end_range,
+            min_size=1,
+            max_size=200,
+        )
+        self.g1 = _ped.Geometry(self._device, 10, 20)
+
+    def runTest(self):
+        # Repeated use hits the compiled constraint.
+        for _ in range(10):
+            self.assertTrue(self.c1.is_solution(self.g1))
+
+        # Changing the constraint itself invalidates it...
+        self.c1.min_size = 50
+        self.assertFalse(self.c1.is_solution(self.g1))
+        self.c1.min_size = 1
+        self.assertTrue(self.c1.is_solution(self.g1))
+
+        # ...and so does changing one of its members in place.
+        self.start_range.set_start(50)
+        self.assertFalse(self.c1.is_solution(self.g1))
+        self.start_range.set_start(0)
+
+        self.align.grain_size = 4
+        self.assertFalse(self.c1.is_solution(self.g1))
+        self.align.grain_size = 1
+
+        # Replacing a member works as well.
+        self.c1.end_range = _ped.Geometry(self._device, 0, 25)
+        self.assertFalse(self.c1.is_solution(self.g1))
+        self.c1.end_range = self.end_range
+        self.assertTrue(self.c1.is_solution(self.g1))
+
+
 class ConstraintStrTestCase(RequiresDevice):
     def setUp(self):
         super().setUp()
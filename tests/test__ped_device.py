@@ -4,6 +4,8 @@
 #
 
 import _ped
+import gc
+import os
 import unittest
 
 from tests.baseclass import RequiresDevice
@@ -99,6 +101,77 @@ class DeviceCloseTestCase(RequiresDevice):
         self.assertRaises(_ped.IOException, self._device.close)
 
 
+class DevicePoolTestCase(RequiresDevice):
+    def runTest(self):
+        self.addCleanup(_ped.device_pool_disable)
+        self.assertIsNone(_ped.device_pool_info())
+        _ped.device_pool_enable(2)
+
+        # closing leaves the device idle in the pool, but closed to callers
+        self._device.open()
+        self.assertTrue(self._device.close())
+        self.assertEqual(self._device.open_count, 0)
+        self.assertEqual(_ped.device_pool_info()["idle"], 1)
+        self.assertRaises(_ped.IOException, self._device.read, 0, 1)
+        self.assertRaises(_ped.IOException, self._device.close)
+
+        self.assertTrue(self._device.open())
+        self.assertEqual(self._device.open_count, 1)
+        self._device.read(0, 1)
+        self._device.close()
+
+        info = _ped.device_pool_info()
+        self.assertEqual((info["hits"], info["misses"]), (1, 1))
+
+        # only two devices are kept idle
+        devs = [_ped.device_new_memory(64) for i in range(2)]
+
+        for dev in devs:
+            dev.open()
+            dev.close()
+
+        info = _ped.device_pool_info()
+        self.assertEqual((info["size"], info["idle"], info["evictions"]), (2, 2, 1))
+
+        for dev in devs:
+            dev.destroy()
+
+        self.assertEqual(_ped.device_pool_info()["idle"], 0)
+        self.assertTrue(_ped.device_pool_disable())
+        self.assertIsNone(_ped.device_pool_info())
+        self.assertRaises(ValueError, _ped.device_pool_enable, 0)
+
+
+class DevicePoolFlushTestCase(RequiresDevice):
+    def runTest(self):
+        self.addCleanup(_ped.device_pool_disable)
+        label = _ped.disk_new_fresh(self._device, _ped.disk_type_get("msdos"))
+        label.commit_to_dev()
+        _ped.device_pool_enable(2)
+
+        # writes made while the device sat idle are read back once it is taken
+        self._device.open()
+        self.assertEqual(self._device.read(100, 1), "")
+        self._device.close()
+
+        with open(self.path, "r+b") as f:
+            f.seek(100 * self._device.sector_size)
+            f.write(b"fresh")
+
+        self._device.open()
+        self.assertEqual(self._device.read(100, 1), "fresh")
+        self._device.close()
+        self.assertEqual(_ped.device_pool_info()["idle"], 1)
+
+        # a read-only Disk does not make do with the idle read-write open
+        disk = _ped.disk_new(self._device, True)
+        self.assertEqual(_ped.device_pool_info()["idle"], 0)
+        self.assertTrue(_ped.device_get(self.path).read_only)
+
+        del disk
+        self.assertFalse(_ped.device_get(self.path).read_only)
+
+
 @unittest.skip("Unimplemented test case.")
 class DeviceDestroyTestCase(RequiresDevice):
     def runTest(self):
@@ -585,3 +658,150 @@ class DeviceStrTestCase(RequiresDevice):
             )
         )
         self.assertEqual(str(self._device), expected)
+
+
+class DeviceNewMemoryTestCase(unittest.TestCase):
+    def runTest(self):
+        minimum = _ped.Alignment(0, 1)
+        optimum = _ped.Alignment(0, 256)
+        dev = _ped.device_new_memory(8192, 4096, 4096, minimum, optimum)
+        path = dev.path
+
+        try:
+            self.assertEqual(dev.length, 8192)
+            self.assertEqual(dev.sector_size, 4096)
+            self.assertEqual(dev.phys_sector_size, 4096)
+            self.assertEqual(dev.get_optimum_alignment(), optimum)
+            self.assertEqual(dev.get_minimum_alignment(), minimum)
+            self.assertEqual(dev.get_optimal_aligned_constraint().start_align, optimum)
+
+            # a label written to the device can be read back from it
+            disk = _ped.disk_new_fresh(dev, _ped.disk_type_get("gpt"))
+            part = _ped.Partition(disk, _ped.PARTITION_NORMAL, 256, 1279)
+            disk.add_partition(part, dev.get_optimal_aligned_constraint())
+            self.assertTrue(disk.commit_to_dev())
+
+            disk = _ped.disk_new(dev)
+            self.assertEqual(disk.type.name, "gpt")
+            self.assertEqual(disk.get_partition(1).geom.start, 256)
+            self.assertEqual(disk.get_partition(1).geom.end, 1279)
+        finally:
+            dev.destroy()
+
+        # the next memory device does not pick up the old contents
+        dev = _ped.device_new_memory(8192, 4096)
+
+        try:
+            self.assertRaises(_ped.DiskLabelException, _ped.disk_new, dev)
+        finally:
+            dev.destroy()
+
+        self.assertRaises(ValueError, _ped.device_new_memory, 0)
+        self.assertRaises(ValueError, _ped.device_new_memory, 100, 1000)
+        self.assertRaises(ValueError, _ped.device_new_memory, 100, 4096, 512)
+        self.assertRaises(TypeError, _ped.device_new_memory, 100, 512, 512, "align")
+
+
+class DeviceNewMemoryLifetimeTestCase(RequiresDevice):
+    def runTest(self):
+        # a memory device nobody refers to any more goes away with its memfd
+        dev = _ped.device_new_memory(64)
+        path = dev.path
+        geom = _ped.Geometry(dev, 0, 8)
+        del dev
+        gc.collect()
+        self.assertTrue(os.path.exists(path))
+        del geom
+        gc.collect()
+        self.assertFalse(os.path.exists(path))
+
+        # a cached device on a recycled descriptor path is left alone
+        fd = os.open(self.path, os.O_RDONLY)
+        cached = _ped.device_get("/proc/self/fd/%d" % fd)
+        os.close(fd)
+
+        try:
+            dev = _ped.device_new_memory(64)
+
+            try:
+                self.assertNotEqual(dev.path, cached.path)
+                self.assertEqual(dev.length, 64)
+                self.assertEqual(_ped.device_get(cached.path).length, cached.length)
+            finally:
+                dev.destroy()
+        finally:
+            cached.destroy()
+
+
+class DeviceTraceTestCase(RequiresDevice):
+    def runTest(self):
+        self.assertRaises(RuntimeError, self._device.trace_stop)
+
+        self._device.trace_start()
+        self._device.open()
+        self._device.read(0, 2)
+        self._device.read(1, 2)
+        self.assertEqual(self._device.check(0, 4), 4)
+        self._device.sync()
+        self._device.close()
+        trace = self._device.trace_stop()
+
+        ops = [(op, start, count) for (op, start, count, when) in trace["events"]]
+        self.assertEqual(
+            ops, [("read", 0, 2), ("read", 1, 2), ("read", 0, 4), ("sync", 0, 0)]
+        )
+        self.assertEqual((trace["reads"], trace["writes"], trace["syncs"]), (3, 0, 1))
+        self.assertEqual(trace["sectors_read"], 8)
+        self.assertEqual(trace["unique_sectors_read"], 4)
+        self.assertEqual(trace["read_amplification"], 2.0)
+        self.assertEqual(trace["write_amplification"], 1.0)
+        self.assertEqual(trace["dropped"], 0)
+
+        # nothing is recorded once tracing stopped
+        self._device.open()
+        self._device.read(0, 1)
+        self._device.close()
+        self.assertRaises(RuntimeError, self._device.trace_stop)
+
+
+class DeviceSectorCacheTestCase(RequiresDevice):
+    def runTest(self):
+        self.assertIsNone(self._device.sector_cache_info())
+        self.assertRaises(ValueError, self._device.sector_cache_enable, 65536, 1000)
+        self.assertRaises(ValueError, self._device.sector_cache_enable, 1024, 4096)
+
+        self._device.sector_cache_enable(8192, 4096)
+        self.addCleanup(self._device.sector_cache_disable)
+        self._device.open()
+        self.addCleanup(self._device.close)
+
+        def info():
+            info = self._device.sector_cache_info()
+            return (info["hits"], info["misses"], info["device_reads"], info["evictions"])
+
+        # blocks are 8 sectors, and two of them fit
+        self._device.read(0, 2)
+        self.assertEqual(info(), (0, 1, 1, 0))
+        self._device.read(1, 2)
+        self.assertEqual(info(), (1, 1, 1, 0))
+        self._device.read(6, 4)
+        self.assertEqual(info(), (2, 2, 2, 0))
+
+        # a run of missing blocks is one device read, evicting the oldest
+        self._device.read(16, 16)
+        self.assertEqual(info(), (2, 4, 3, 2))
+        self.assertEqual(self._device.sector_cache_info()["blocks"], 2)
+
+        # writes drop what they overwrite
+        self._device.read(24, 1)
+        geom = _ped.Geometry(self._device, 24, 8)
+        geom.write("A" * 100 + "\0" * (self._device.sector_size - 100), 0, 1)
+        self.assertEqual(self._device.read(24, 1), "A" * 100)
+
+        self._device.sync()
+        self.assertEqual(self._device.sector_cache_info()["blocks"], 0)
+
+        self.assertTrue(self._device.sector_cache_disable())
+        self.assertFalse(self._device.sector_cache_disable())
+        self.assertIsNone(self._device.sector_cache_info())
+        self.assertEqual(self._device.read(24, 1), "A" * 100)
@@ -4,6 +4,8 @@
 #
 
 import _ped
+import struct
+import threading
 import unittest
 
 from tests.baseclass import RequiresDevice, RequiresLabeledDevice, RequiresDisk
@@ -23,6 +25,60 @@ class DiskNewLabeledTestCase(RequiresLabeledDevice):
         self.assertEqual(result.type.name, "msdos")
 
 
+class DiskNewReadOnlyTestCase(RequiresLabeledDevice):
+    def runTest(self):
+        disk = _ped.Disk(self._device, True)
+        self.assertTrue(disk.read_only)
+        self.assertEqual(disk.type.name, "msdos")
+        self.assertTrue(disk.duplicate().read_only)
+        self.assertEqual(disk.get_primary_partition_count(), 0)
+
+        self.assertRaises(_ped.DiskException, disk.commit)
+        self.assertRaises(_ped.DiskException, disk.commit_to_dev)
+        self.assertRaises(_ped.DiskException, disk.delete_all)
+        self.assertRaises(
+            _ped.DiskException, disk.set_flag, _ped.DISK_CYLINDER_ALIGNMENT, 1
+        )
+        self.assertRaises(_ped.DiskException, disk.restore, disk.snapshot())
+
+        self.assertTrue(_ped.disk_new(self._device, True).read_only)
+
+        # nothing could be written to the device while the Disk holds it
+        self.assertRaises(_ped.IOException, _ped.disk_new, self._device)
+        self.assertRaises(_ped.IOException, _ped.Disk, self._device)
+        self.assertRaises(
+            _ped.IOException, _ped.disk_new_fresh, self._device, disk.type
+        )
+        self.assertRaises(_ped.IOException, self._device.open)
+
+        # the device stays open read-only for as long as the Disk lives
+        device = _ped.device_get(self.path)
+        self.assertTrue(device.read_only)
+        self.assertGreater(device.open_count, 0)
+
+        del disk
+        device = _ped.device_get(self.path)
+        self.assertFalse(device.read_only)
+        self.assertEqual(device.open_count, 0)
+
+        # partitions of a read-only Disk refuse changes too
+        writable = _ped.disk_new(self._device)
+        writable.add_partition(
+            _ped.Partition(writable, _ped.PARTITION_NORMAL, 10, 49)
+        )
+        writable.commit_to_dev()
+
+        part = _ped.disk_new(self._device, True).get_partition(1)
+        self.assertRaises(_ped.DiskException, part.reset_num)
+        self.assertRaises(_ped.DiskException, part.destroy)
+
+        with self.assertRaises(_ped.DiskException):
+            part.type = _ped.PARTITION_LOGICAL
+
+        self.assertEqual(part.num, 1)
+        self.assertEqual(part.type, _ped.PARTITION_NORMAL)
+
+
 @unittest.skip("Unimplemented test case.")
 class DiskGetSetTestCase(unittest.TestCase):
     # TODO
@@ -162,6 +218,319 @@ class DiskAddPartitionTestCase(unittest.TestCase):
         self.fail("Unimplemented test case.")
 
 
+class DiskAddPartitionsTestCase(RequiresDisk):
+    def runTest(self):
+        entries = [
+            (_ped.PARTITION_NORMAL, "ext2", 10, 49, [_ped.PARTITION_BOOT]),
+            (_ped.PARTITION_NORMAL, None, 40, 59),
+            (_ped.PARTITION_NORMAL, None, 60, 99, None, None),
+            (_ped.PARTITION_NORMAL, None, 100, 119, [-1]),
+            "not a tuple",
+        ]
+        results = self._disk.add_partitions(entries)
+
+        self.assertEqual(len(results), len(entries))
+        self.assertIsInstance(results[0], _ped.Partition)
+        self.assertEqual(results[0].geom.start, 10)
+        self.assertEqual(results[0].fs_type.name, "ext2")
+        self.assertTrue(results[0].get_flag(_ped.PARTITION_BOOT))
+        self.assertIsInstance(results[1], _ped.PartitionException)
+        self.assertIsInstance(results[2], _ped.Partition)
+        self.assertIsInstance(results[3], ValueError)
+        self.assertIsInstance(results[4], TypeError)
+
+        # failed entries must not leave anything behind on the disk
+        self.assertEqual(self._disk.get_last_partition_num(), 2)
+
+        self.assertRaises(TypeError, self._disk.add_partitions, entries, "constraint")
+
+
+class DiskSnapshotTestCase(RequiresDisk):
+    def layout(self):
+        parts = []
+        part = self._disk.next_partition()
+
+        while part:
+            if part.is_active():
+                boot = part.get_flag(_ped.PARTITION_BOOT)
+                parts.append((part.num, part.type, part.geom.start, part.geom.end, boot))
+
+            part = self._disk.next_partition(part)
+
+        return parts
+
+    def runTest(self):
+        kept = _ped.Partition(self._disk, _ped.PARTITION_NORMAL, 10, 49)
+        self._disk.add_partition(kept)
+        moved = _ped.Partition(self._disk, _ped.PARTITION_NORMAL, 50, 89)
+        self._disk.add_partition(moved)
+        moved.set_flag(_ped.PARTITION_BOOT, 1)
+
+        before = self.layout()
+        snap = self._disk.snapshot()
+
+        self._disk.delete_partition(moved)
+        self._disk.add_partition(
+            _ped.Partition(self._disk, _ped.PARTITION_NORMAL, 100, 139)
+        )
+        self._disk.add_partition(
+            _ped.Partition(self._disk, _ped.PARTITION_EXTENDED, 150, 249)
+        )
+        kept.set_flag(_ped.PARTITION_BOOT, 1)
+        self.assertNotEqual(self.layout(), before)
+
+        self._disk.restore(snap)
+        self.assertEqual(self.layout(), before)
+
+        # restoring again is a no-op and the snapshot can be reused
+        self._disk.restore(snap)
+        self.assertEqual(self.layout(), before)
+        self.assertEqual(kept.num, 1)
+
+        other = self._disk.duplicate()
+        self.assertRaises(_ped.DiskException, other.restore, snap)
+        self.assertRaises(TypeError, self._disk.restore, "snapshot")
+
+        # a disk that may reuse the freed one's memory is still another disk
+        self._disk.commit_to_dev()
+        del self.disk, other
+        self._disk = None
+        self.reopen()
+        self.assertRaises(_ped.DiskException, self._disk.restore, snap)
+
+
+class DiskSnapshotRestoreManyTestCase(RequiresDisk):
+    def runTest(self):
+        self._disk.add_partition(
+            _ped.Partition(self._disk, _ped.PARTITION_NORMAL, 10, 49)
+        )
+        snap = self._disk.snapshot()
+
+        # a partition taken off by restore() stays usable while referenced
+        held = _ped.Partition(self._disk, _ped.PARTITION_NORMAL, 50, 89)
+        self._disk.add_partition(held)
+        self._disk.restore(snap)
+
+        # the ones nothing refers to are freed on the way
+        for i in range(200):
+            self._disk.add_partition(
+                _ped.Partition(self._disk, _ped.PARTITION_NORMAL, 100, 139)
+            )
+            self._disk.restore(snap)
+
+        self.assertTrue(held.is_active())
+        self.assertEqual(held.geom.start, 50)
+        self.assertEqual(self._disk.get_last_partition_num(), 1)
+
+
+class DiskDiffTestCase(RequiresDisk):
+    def runTest(self):
+        first = _ped.Partition(self._disk, _ped.PARTITION_NORMAL, 10, 49)
+        self._disk.add_partition(first)
+        second = _ped.Partition(self._disk, _ped.PARTITION_NORMAL, 50, 89)
+        self._disk.add_partition(second)
+
+        base = self._disk.duplicate()
+        snap = self._disk.snapshot()
+        unchanged = {
+            "added": [],
+            "removed": [],
+            "resized": [],
+            "renamed": [],
+            "modified": [],
+            "disk": False,
+        }
+        self.assertEqual(self._disk.diff(base), unchanged)
+        self.assertEqual(self._disk.diff(snap), unchanged)
+
+        self._disk.delete_partition(second)
+        self._disk.add_partition(
+            _ped.Partition(self._disk, _ped.PARTITION_NORMAL, 100, 139)
+        )
+        self._disk.add_partition(
+            _ped.Partition(self._disk, _ped.PARTITION_NORMAL, 150, 189)
+        )
+        self._disk.set_partition_geom(first, self._device.get_constraint(), 10, 39)
+        first.set_flag(_ped.PARTITION_BOOT, 1)
+
+        # the new partitions take numbers 2 and 3
+        diff = self._disk.diff(base)
+        self.assertEqual(diff["added"], [3])
+        self.assertEqual(diff["removed"], [])
+        self.assertEqual(diff["resized"], [1, 2])
+        self.assertEqual(diff["renamed"], [])
+        self.assertEqual(diff["modified"], [1])
+        self.assertFalse(diff["disk"])
+        self.assertEqual(diff, self._disk.diff(snap))
+
+        # and the other way around
+        self.assertEqual(base.diff(self._disk)["removed"], [3])
+        self.assertRaises(TypeError, self._disk.diff, None)
+
+
+class DiskCommitChangesTestCase(RequiresDisk):
+    def runTest(self):
+        self.assertTrue(self._disk.commit_to_dev())
+        snap = self._disk.snapshot()
+
+        # nothing changed, so nothing is written
+        self.assertFalse(self._disk.commit_changes(snap))
+
+        self._disk.add_partition(
+            _ped.Partition(self._disk, _ped.PARTITION_NORMAL, 10, 49)
+        )
+        self.assertTrue(self._disk.commit_changes(snap))
+        self.reopen()
+        self.assertEqual(self._disk.get_partition(1).geom.start, 10)
+
+
+class DiskLabelTemplateTestCase(unittest.TestCase):
+    def setUp(self):
+        self.devices = [_ped.device_new_memory(4096) for i in range(3)]
+        self.devices.append(_ped.device_new_memory(8192))
+        self.devices.append(_ped.device_new_memory(4096, 512, 4096))
+        self.devices.append(
+            _ped.device_new_memory(4096, 512, 512, None, _ped.Alignment(0, 64))
+        )
+
+    def tearDown(self):
+        for dev in self.devices:
+            dev.destroy()
+
+    def runTest(self):
+        for label in ["gpt", "msdos"]:
+            (template_dev, same, other, bigger, phys, aligned) = self.devices
+            disk = _ped.disk_new_fresh(template_dev, _ped.disk_type_get(label))
+            disk.add_partition(
+                _ped.Partition(disk, _ped.PARTITION_NORMAL, 2048, 2559)
+            )
+            disk.add_partition(
+                _ped.Partition(disk, _ped.PARTITION_NORMAL, 2560, 4000)
+            )
+            template = disk.label_template()
+
+            # rendering writes nothing to the template's own device
+            self.assertRaises(_ped.DiskLabelException, _ped.disk_new, template_dev)
+
+            self.assertTrue(_ped.label_stamp(template, same))
+            self.assertTrue(_ped.label_stamp(template, other))
+            self.assertFalse(_ped.label_stamp(template, bigger))
+
+            # same length, but laid out for other sectors or alignment
+            self.assertFalse(_ped.label_stamp(template, phys))
+            self.assertFalse(_ped.label_stamp(template, aligned))
+
+            # stamped copies do not share their identifiers
+            pairs = zip(self.identifiers(label, same), self.identifiers(label, other))
+
+            for ours, theirs in pairs:
+                self.assertNotEqual(ours, theirs)
+
+            # every copy reads back, checksums included
+            for dev in [same, other, bigger, phys, aligned]:
+                stamped = _ped.disk_new(dev)
+                self.assertEqual(stamped.type.name, label)
+                self.assertEqual(stamped.get_partition(1).geom.start, 2048)
+                self.assertEqual(stamped.get_partition(2).geom.end, 4000)
+                dev.clobber()
+
+        self.assertRaises(TypeError, _ped.label_stamp, None, self.devices[0])
+
+    def identifiers(self, label, dev):
+        with open(dev.path, "rb") as f:
+            data = f.read(3 * dev.sector_size)
+
+        if label == "msdos":
+            # the disk signature in the MBR
+            return [data[440:444]]
+
+        # the disk GUID in the header, then the unique GUID of each partition
+        header = dev.sector_size
+        entries = 2 * dev.sector_size
+        return [data[header + 56 : header + 72]] + [
+            data[entries + i * 128 + 16 : entries + i * 128 + 32] for i in range(2)
+        ]
+
+
+class DiskExportLayoutTestCase(RequiresDisk):
+    def runTest(self):
+        self._disk.add_partition(
+            _ped.Partition(self._disk, _ped.PARTITION_NORMAL, 10, 49)
+        )
+        part = _ped.Partition(self._disk, _ped.PARTITION_NORMAL, 50, 89)
+        self._disk.add_partition(part)
+        part.set_flag(_ped.PARTITION_BOOT, 1)
+
+        data = self._disk.export_layout()
+        self.assertIsInstance(data, bytes)
+
+        header = _ped.layout_header(data)
+        self.assertEqual(header[1], "msdos")
+        self.assertEqual(header[2], self._device.sector_size)
+        self.assertEqual(header[3], self._device.length)
+        self.assertEqual(header[5], 2)
+        self.assertEqual(header[6], len(data))
+
+        # loading it on the same device gives back the same table
+        disk = _ped.disk_new_from_layout(self._device, data)
+        self.assertEqual(disk.type.name, "msdos")
+        self.assertEqual(disk.get_partition(2).geom.start, 50)
+        self.assertTrue(disk.get_partition(2).get_flag(_ped.PARTITION_BOOT))
+        self.assertEqual(disk.export_layout(), data)
+        self.assertFalse(any(_ped.layout_diff(data, disk.export_layout()).values()))
+
+        self._disk.delete_partition(part)
+        diff = _ped.layout_diff(data, self._disk.export_layout())
+        self.assertEqual(diff["removed"], [2])
+
+        self.assertRaises(ValueError, _ped.disk_new_from_layout, self._device, b"")
+        self.assertRaises(ValueError, _ped.layout_header, data[:10])
+        self.assertRaises(ValueError, _ped.layout_diff, data, data[:-1])
+
+        # entries and headers that do not describe a usable table
+        def patched(offset, fmt, value):
+            end = offset + struct.calcsize(fmt)
+            return data[:offset] + struct.pack(fmt, value) + data[end:]
+
+        for bad in (
+            patched(76, "<i", 0),
+            patched(76, "<i", 1 << 30),
+            patched(80, "<I", _ped.PARTITION_FREESPACE),
+            patched(80, "<I", _ped.PARTITION_LOGICAL | _ped.PARTITION_EXTENDED),
+            patched(84, "<q", 60),
+            patched(92, "<q", self._device.length),
+        ):
+            self.assertRaises(ValueError, _ped.disk_new_from_layout, self._device, bad)
+
+        small = _ped.device_new_memory(self._device.length - 1)
+        self.addCleanup(small.destroy)
+        self.assertRaises(_ped.DiskException, _ped.disk_new_from_layout, small, data)
+
+
+class DiskProbeFileSystemsTestCase(RequiresDisk):
+    def runTest(self):
+        for start in (10, 50, 100):
+            self._disk.add_partition(
+                _ped.Partition(self._disk, _ped.PARTITION_NORMAL, start, start + 29)
+            )
+
+        # no file systems anywhere, but every partition gets an answer
+        self.assertEqual(self._disk.probe_file_systems(4), {1: None, 2: None, 3: None})
+        self.assertEqual(self._disk.probe_file_systems(), {1: None, 2: None, 3: None})
+        self.assertRaises(ValueError, self._disk.probe_file_systems, 0)
+
+        other = _ped.device_new_memory(1024)
+        self.addCleanup(other.destroy)
+        geoms = [
+            _ped.Geometry(self._device, 10, 30),
+            _ped.Geometry(other, 0, 100),
+            _ped.Geometry(self._device, 50, 30),
+        ]
+        self.assertEqual(_ped.file_system_probe_many(geoms, 2), [None, None, None])
+        self.assertEqual(_ped.file_system_probe_many([]), [])
+        self.assertRaises(TypeError, _ped.file_system_probe_many, [None])
+
+
 @unittest.skip("Unimplemented test case.")
 class DiskRemovePartitionTestCase(unittest.TestCase):
     # TODO
@@ -244,3 +613,89 @@ class DiskStrTestCase(RequiresDisk):
             repr(self._disk.type),
         )
         self.assertEqual(expected, str(self._disk))
+
+
+class DiskConcurrentAccessTestCase(RequiresDisk):
+    def runTest(self):
+        # Hammer one disk from several threads.  Calls on the same disk are
+        # serialized by its lock, so every one of them must succeed.
+        errors = []
+
+        def worker():
+            try:
+                for _i in range(50):
+                    self._disk.get_last_partition_num()
+                    self._disk.get_flag(_ped.DISK_CYLINDER_ALIGNMENT)
+                    self._disk.commit_to_dev()
+            except Exception as e:  # pylint: disable=broad-except
+                errors.append(e)
+
+        threads = [threading.Thread(target=worker) for _i in range(4)]
+
+        for t in threads:
+            t.start()
+
+        for t in threads:
+            t.join()
+
+        self.assertEqual(errors, [])
+        self.assertTrue(self._disk.check())
+
+
+class DiskConcurrentDisksTestCase(unittest.TestCase):
+    def runTest(self):
+        # Work on two disks from two threads at once.  Their locks may share
+        # a stripe, which only costs parallelism, so both must get through.
+        devs = [_ped.device_new_memory(4096) for _i in range(2)]
+        errors = []
+
+        for dev in devs:
+            self.addCleanup(dev.destroy)
+
+        def worker(dev):
+            try:
+                disk = _ped.disk_new_fresh(dev, _ped.disk_type_get("msdos"))
+
+                for i in range(4):
+                    part = _ped.Partition(
+                        disk, _ped.PARTITION_NORMAL, 64 + i * 512, 511 + i * 512
+                    )
+                    disk.add_partition(part)
+                    disk.commit_to_dev()
+
+                self.assertEqual(_ped.disk_new(dev).get_last_partition_num(), 4)
+            except Exception as e:  # pylint: disable=broad-except
+                errors.append(e)
+
+        threads = [threading.Thread(target=worker, args=(dev,)) for dev in devs]
+
+        for t in threads:
+            t.start()
+
+        for t in threads:
+            t.join()
+
+        self.assertEqual(errors, [])
+
+
+class DiskExceptionHandlerTestCase(RequiresDisk):
+    def runTest(self):
+        # The handler runs in the middle of add_partition() on this disk,
+        # which still holds the disk's lock, so it only looks at what it got.
+        seen = []
+
+        def handler(exn_type, _options, _message):
+            seen.append(exn_type)
+            return _ped.EXCEPTION_RESOLVE_CANCEL
+
+        _ped.register_exn_handler(handler)
+        self.addCleanup(_ped.clear_exn_handler)
+
+        self._disk.add_partition(
+            _ped.Partition(self._disk, _ped.PARTITION_NORMAL, 10, 49)
+        )
+        overlapping = _ped.Partition(self._disk, _ped.PARTITION_NORMAL, 40, 59)
+        self.assertRaises(
+            _ped.PartitionException, self._disk.add_partition, overlapping
+        )
+        self.assertEqual(len(seen), 1)
@@ -4,6 +4,10 @@
 #
 
 import _ped
+import gc
+import os
+import tempfile
+import unittest
 from tests.baseclass import RequiresDevice
 
 # One class per method, multiple tests per class.  For these simple methods,
@@ -71,6 +75,32 @@ class GeometryDuplicateTestCase(RequiresDevice):
         self.assertEqual(self.g.end, self.dup.end)
 
 
+class GeometryRecycleTestCase(RequiresDevice):
+    def runTest(self):
+        # Released geometries are recycled, make sure a recycled object
+        # comes back as a fresh one.
+        for i in range(1, 1000):
+            g = _ped.Geometry(self._device, start=i, length=i)
+            self.assertEqual(g.start, i)
+            self.assertEqual(g.length, i)
+            self.assertEqual(g.end, 2 * i - 1)
+            self.assertTrue(gc.is_tracked(g))
+            del g
+
+        # Subclasses are never taken from the free list.
+        class SubGeometry(_ped.Geometry):
+            pass
+
+        sub = SubGeometry(self._device, start=5, length=10)
+        self.assertIsInstance(sub, SubGeometry)
+        self.assertEqual(sub.end, 14)
+        del sub
+
+        dup = _ped.Geometry(self._device, start=0, length=100).duplicate()
+        self.assertIs(type(dup), _ped.Geometry)
+        self.assertEqual(dup.length, 100)
+
+
 class GeometryIntersectTestCase(RequiresDevice):
     def setUp(self):
         super().setUp()
@@ -332,6 +362,125 @@ class GeometryWriteTestCase(RequiresDevice):
         self._device.close()
 
 
+class GeometryCopyToTestCase(RequiresDevice):
+    def setUp(self):
+        super().setUp()
+        self.src = _ped.Geometry(self._device, start=10, length=50)
+        self.dst = _ped.Geometry(self._device, start=100, length=60)
+
+    def runTest(self):
+        # Both devices have to be open.
+        self.assertRaises(_ped.IOException, self.src.copy_to, self.dst)
+
+        self._device.open()
+        self.src.write("first", 0, 1)
+        self.src.write("last", 49, 1)
+        self.assertEqual(self.src.copy_to(self.dst), 50)
+        self.assertEqual(self.dst.read(0, 1), "first")
+        self.assertEqual(self.dst.read(49, 1), "last")
+
+        # The destination has to be big enough.
+        self.assertRaises(ValueError, self.dst.copy_to, self.src)
+        self.assertRaises(TypeError, self.src.copy_to, None)
+        self._device.close()
+
+
+class GeometryCopyToOverlapTestCase(RequiresDevice):
+    def runTest(self):
+        self._device.open()
+
+        # Move a region forward and back over itself.
+        g = _ped.Geometry(self._device, start=10, length=50)
+        moved = _ped.Geometry(self._device, start=30, length=50)
+
+        for i in range(50):
+            g.write(str(i), i, 1)
+
+        self.assertEqual(g.copy_to(moved), 50)
+
+        for i in range(50):
+            self.assertEqual(moved.read(i, 1), str(i))
+
+        self.assertEqual(moved.copy_to(g), 50)
+
+        for i in range(50):
+            self.assertEqual(g.read(i, 1), str(i))
+
+        self._device.close()
+
+
+class GeometryCopyToChunksTestCase(unittest.TestCase):
+    def setUp(self):
+        # Big enough that a copy takes several 4MiB chunks.
+        self._device = _ped.device_new_memory(20480)
+        self.addCleanup(self._device.destroy)
+
+    def runTest(self):
+        self._device.open()
+
+        # These overlap, so the copy goes through the chunked pipeline,
+        # backward when moving up and forward when moving back down.
+        g = _ped.Geometry(self._device, start=0, length=18000)
+        moved = _ped.Geometry(self._device, start=1000, length=18000)
+        marks = [0, 1, 8191, 8192, 9000, 16383, 16384, 17999]
+
+        for i in marks:
+            g.write(str(i), i, 1)
+
+        self.assertEqual(g.copy_to(moved), 18000)
+
+        for i in marks:
+            self.assertEqual(moved.read(i, 1), str(i))
+
+        self.assertEqual(moved.copy_to(g), 18000)
+
+        for i in marks:
+            self.assertEqual(g.read(i, 1), str(i))
+
+        self._device.close()
+
+
+class GeometryCopyToSparseTestCase(RequiresDevice):
+    def setUp(self):
+        super().setUp()
+        (fd, self.dst_path) = tempfile.mkstemp(prefix=self.temp_prefix)
+        os.ftruncate(fd, os.fstat(self.fd).st_size)
+        os.close(fd)
+        self.addCleanup(os.unlink, self.dst_path)
+        self._dst_device = _ped.device_get(self.dst_path)
+
+    def runTest(self):
+        src = _ped.Geometry(self._device, start=0, length=200)
+        dst = _ped.Geometry(self._dst_device, start=0, length=200)
+
+        self._device.open()
+        self._dst_device.open()
+        src.write("head", 0, 1)
+        src.write("data", 150, 1)
+        src.write("tail", 199, 1)
+
+        # Fill the destination so there is something to punch out.
+        dst.write("stale", 10, 1)
+        self.assertEqual(src.copy_to(dst), 200)
+        self.assertEqual(dst.read(150, 1), "data")
+        self.assertEqual(dst.read(10, 1), "")
+
+        # Only the blocks holding data were allocated, not all 200 sectors.
+        self.assertLess(os.stat(self.dst_path).st_blocks, 100)
+
+        self._dst_device.close()
+        self._device.close()
+
+        # Byte for byte, the copy is the source.
+        size = 200 * self._device.sector_size
+
+        with open(self.path, "rb") as f:
+            expected = f.read(size)
+
+        with open(self.dst_path, "rb") as f:
+            self.assertEqual(f.read(size), expected)
+
+
 class GeometryCheckTestCase(RequiresDevice):
     def setUp(self):
         super().setUp()
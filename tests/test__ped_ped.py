@@ -10,7 +10,13 @@ import os
 import _ped
 import unittest
 
-from tests.baseclass import BuildList, RequiresDevice, RequiresFileSystem
+from tests.baseclass import (
+    BuildList,
+    RequiresDevice,
+    RequiresDisk,
+    RequiresFileSystem,
+    RequiresLabeledDevice,
+)
 
 # Mapping of flags to names
 disk_flags = ["DISK_CYLINDER_ALIGNMENT", "DISK_GPT_PMBR_BOOT"]
@@ -382,6 +388,18 @@ class FileSystemProbeTestCase(RequiresFileSystem):
                 self.assertNotEqual(ty.name, name)
 
 
+class FileSystemProbeManyTestCase(RequiresFileSystem):
+    def runTest(self):
+        # several workers on one device all find the file system
+        geoms = [self._geometry] * 6
+        found = _ped.file_system_probe_many(geoms, 4)
+        self.assertEqual([ty.name for ty in found], ["ext2"] * 6)
+        self.assertEqual(found, _ped.file_system_probe_many(geoms, 1))
+
+        # the device is left as it was found
+        self.assertEqual(self._device.open_count, 0)
+
+
 class FileSystemProbeSpecificTestCase(RequiresFileSystem):
     def runTest(self):
         for (
@@ -407,6 +425,140 @@ class FileSystemProbeSpecificTestCase(RequiresFileSystem):
                 self.assertEqual(result, None)
 
 
+class FileSystemSniffTestCase(RequiresFileSystem):
+    def runTest(self):
+        candidates = _ped.file_system_sniff(self._geometry)
+        self.assertIn("ext2", candidates)
+
+        # these all have magic numbers mke2fs does not write
+        for name in ["xfs", "btrfs", "ntfs", "jfs", "reiserfs"]:
+            self.assertNotIn(name, candidates)
+
+        # the probe only looks at candidates, so the result must not change
+        self.assertEqual(_ped.file_system_probe(self._geometry).name, "ext2")
+        self.assertRaises(TypeError, _ped.file_system_sniff, None)
+
+
+class TryDiskProbeTestCase(RequiresDevice):
+    def runTest(self):
+        self.assertEqual(
+            _ped.try_disk_probe(self._device), (None, _ped.TRY_UNRECOGNIZED)
+        )
+        self.assertRaises(TypeError, _ped.try_disk_probe, None)
+
+
+class TryDiskProbeLabeledTestCase(RequiresLabeledDevice):
+    def runTest(self):
+        (ty, status) = _ped.try_disk_probe(self._device)
+        self.assertEqual(status, _ped.TRY_FOUND)
+        self.assertEqual(ty.name, "msdos")
+
+
+class TryDiskNewTestCase(RequiresDevice):
+    def runTest(self):
+        self.assertEqual(
+            _ped.try_disk_new(self._device), (None, _ped.TRY_UNRECOGNIZED)
+        )
+        self.assertRaises(TypeError, _ped.try_disk_new, None)
+
+
+class TryDiskNewLabeledTestCase(RequiresLabeledDevice):
+    def runTest(self):
+        (disk, status) = _ped.try_disk_new(self._device)
+        self.assertEqual(status, _ped.TRY_FOUND)
+        self.assertIsInstance(disk, _ped.Disk)
+        self.assertEqual(disk.type.name, "msdos")
+
+
+class TryFileSystemProbeTestCase(RequiresFileSystem):
+    def runTest(self):
+        (ty, status) = _ped.try_file_system_probe(self._geometry)
+        self.assertEqual(status, _ped.TRY_FOUND)
+        self.assertEqual(ty.name, "ext2")
+        self.assertRaises(TypeError, _ped.try_file_system_probe, None)
+
+
+class TryFileSystemProbeReadErrorTestCase(unittest.TestCase):
+    def runTest(self):
+        dev = _ped.device_new_memory(1024)
+        self.addCleanup(dev.destroy)
+        geom = _ped.Geometry(dev, 512, 256)
+
+        # a region that cannot be read is a failure, not an empty region
+        os.truncate(dev.path, 0)
+        self.assertEqual(_ped.try_file_system_probe(geom), (None, _ped.TRY_FAILED))
+        self.assertRaises(_ped.IOException, _ped.file_system_probe, geom)
+
+
+class TryFileSystemProbeBlankTestCase(RequiresDevice):
+    def runTest(self):
+        geom = _ped.Geometry(self._device, 0, self._device.length - 1)
+        self.assertEqual(
+            _ped.try_file_system_probe(geom), (None, _ped.TRY_UNRECOGNIZED)
+        )
+
+
+class WipeSignaturesTestCase(RequiresFileSystem):
+    def runTest(self):
+        result = _ped.wipe_signatures([self._geometry])
+        self.assertEqual(set(result), {"bytes_zeroed", "bytes_discarded", "elapsed"})
+        self.assertGreater(result["bytes_zeroed"], 0)
+        self.assertEqual(
+            _ped.try_file_system_probe(self._geometry),
+            (None, _ped.TRY_UNRECOGNIZED),
+        )
+
+        result = _ped.wipe_signatures([self._geometry], True)
+        self.assertGreater(result["bytes_discarded"], 0)
+        self.assertRaises(TypeError, _ped.wipe_signatures, [None])
+        self.assertRaises(TypeError, _ped.wipe_signatures, None)
+
+
+class WipeSignaturesReadOnlyTestCase(RequiresLabeledDevice):
+    def runTest(self):
+        # a read-only Disk holds the device, so nothing may be wiped on it
+        disk = _ped.disk_new(self._device, True)
+        geom = _ped.Geometry(self._device, 0, 100)
+        self.assertRaises(_ped.DeviceException, _ped.wipe_signatures, [geom])
+
+        del disk
+        self.assertGreater(_ped.wipe_signatures([geom])["bytes_zeroed"], 0)
+
+
+class LabelScanTestCase(RequiresDevice):
+    def runTest(self):
+        self.assertEqual(_ped.label_scan([self.path]), [(self.path, None, 0)])
+
+        disk = _ped.disk_new_fresh(self._device, _ped.disk_type_get("gpt"))
+        disk.commit_to_dev()
+        self.assertEqual(
+            _ped.label_scan([self.path, self._device], 2),
+            [(self.path, "gpt", 0), (self._device.path, "gpt", 0)],
+        )
+
+        # damage the primary header, the backup still says it is a GPT
+        with open(self.path, "r+b") as f:
+            f.seek(self._device.sector_size + 24)
+            f.write(b"\xff")
+
+        (_, label, problems) = _ped.label_scan([self.path])[0]
+        self.assertEqual(label, "gpt")
+        self.assertTrue(problems & _ped.SCAN_PRIMARY_HEADER_INVALID)
+        self.assertFalse(problems & _ped.SCAN_BACKUP_HEADER_INVALID)
+
+        self.assertEqual(
+            _ped.label_scan(["/nonexistent"]),
+            [("/nonexistent", None, _ped.SCAN_READ_ERROR)],
+        )
+        self.assertRaises(TypeError, _ped.label_scan, [None])
+        self.assertRaises(ValueError, _ped.label_scan, [], 0)
+
+
+class LabelScanMsdosTestCase(RequiresLabeledDevice):
+    def runTest(self):
+        self.assertEqual(_ped.label_scan([self.path]), [(self.path, "msdos", 0)])
+
+
 class FileSystemTypeGetTestCase(unittest.TestCase):
     def runTest(self):
         for f in [
@@ -571,3 +723,105 @@ class UnitGetByNameTestCase(unittest.TestCase):
         self.assertEqual(_ped.unit_get_by_name("TB"), _ped.UNIT_TERABYTE)
 
         self.assertRaises(_ped.UnknownTypeException, _ped.unit_get_by_name, "blargle")
+
+
+class PlanLayoutTestCase(RequiresDevice):
+    def runTest(self):
+        align = _ped.Alignment(0, 8)
+        limit = self._device.length - self._device.length % 8
+
+        layout = _ped.plan_layout(self._device, [16, "4KiB", "25%", "rest"], align)
+        percent = (limit * 25 // 100) // 8 * 8
+        self.assertEqual(
+            layout,
+            [(0, 15), (16, 23), (24, 23 + percent), (24 + percent, limit - 1)],
+        )
+
+        # rest entries split what is left evenly
+        layout = _ped.plan_layout(self._device, ["rest", "rest"], align)
+        self.assertEqual(layout[0][0], 0)
+        self.assertEqual(layout[1][1], limit - 1)
+        self.assertEqual(layout[1][0], layout[0][1] + 1)
+        self.assertEqual(layout[1][0] % 8, 0)
+
+        # fixed sizes round up to whole grains
+        self.assertEqual(_ped.plan_layout(self._device, ["1s"], align), [(0, 7)])
+
+        geom = _ped.Geometry(self._device, 10, 50)
+        self.assertEqual(_ped.plan_layout(geom, ["rest"], align), [(16, 55)])
+
+        for layout in ([limit + 1], [limit, "rest"]):
+            self.assertRaises(
+                _ped.ConstraintException, _ped.plan_layout, self._device, layout, align
+            )
+
+        for layout in (["10QB"], ["-1MiB"], ["101%"], ["0%"]):
+            self.assertRaises(ValueError, _ped.plan_layout, self._device, layout, align)
+
+        self.assertRaises(TypeError, _ped.plan_layout, self._device, [1.5], align)
+        self.assertRaises(TypeError, _ped.plan_layout, "/dev/sda", ["rest"])
+
+
+class PlanLayoutDiskTestCase(RequiresDisk):
+    def runTest(self):
+        align = _ped.Alignment(0, 8)
+        self._disk.set_flag(_ped.DISK_CYLINDER_ALIGNMENT, 0)
+
+        layout = _ped.plan_layout(self._disk, ["1s", "1s", "1s", "rest"], align)
+        self.assertEqual(len(layout), 4)
+
+        for start, end in layout:
+            self.assertEqual(start % 8, 0)
+            self.assertEqual((end + 1) % 8, 0)
+
+        # an msdos label only has room for four primary partitions
+        self.assertRaises(
+            _ped.ConstraintException,
+            _ped.plan_layout,
+            self._disk,
+            ["1s", "1s", "1s", "1s", "rest"],
+            align,
+        )
+
+        part = _ped.Partition(
+            self._disk, _ped.PARTITION_NORMAL, layout[0][0], layout[0][1]
+        )
+        self._disk.add_partition(part)
+        self.assertRaises(
+            _ped.ConstraintException,
+            _ped.plan_layout,
+            self._disk,
+            ["1s", "1s", "1s", "rest"],
+            align,
+        )
+
+
+class StatsTestCase(RequiresDevice):
+    def runTest(self):
+        _ped.stats(True)
+        self.assertFalse(_ped.stats()["enabled"])
+
+        # nothing is counted until stats are enabled
+        _ped.disk_type_get("msdos")
+        self.assertEqual(_ped.stats()["calls"], {})
+
+        _ped.stats_enable()
+        self.addCleanup(_ped.stats_enable, False)
+
+        _ped.disk_type_get("msdos")
+        self.assertRaises(_ped.UnknownTypeException, _ped.disk_type_get, "cheese")
+        self._device.open()
+        self._device.read(0, 2)
+        self._device.close()
+
+        stats = _ped.stats(True)
+        self.assertTrue(stats["enabled"])
+        (calls, errors, total, longest) = stats["calls"]["disk_type_get"]
+        self.assertEqual((calls, errors), (2, 1))
+        self.assertGreaterEqual(total, longest)
+        self.assertEqual(stats["calls"]["Device.read"][:2], (1, 0))
+        self.assertEqual(stats["bytes_read"], 2 * self._device.sector_size)
+        self.assertEqual(stats["bytes_written"], 0)
+
+        # reset clears the counters
+        self.assertNotIn("disk_type_get", _ped.stats()["calls"])
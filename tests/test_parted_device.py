@@ -149,6 +149,55 @@ class DeviceGetConstraintTestCase(unittest.TestCase):
         self.fail("Unimplemented test case.")
 
 
+class DevicePlanLayoutTestCase(RequiresDevice):
+    def runTest(self):
+        alignment = parted.Alignment(offset=0, grainSize=8)
+        geoms = self.device.planLayout(["4KiB", "rest"], alignment)
+
+        self.assertEqual(len(geoms), 2)
+        self.assertIsInstance(geoms[0], parted.Geometry)
+        self.assertEqual((geoms[0].start, geoms[0].end), (0, 7))
+        self.assertEqual(geoms[1].start, 8)
+        self.assertTrue(alignment.isAligned(geoms[1], geoms[1].start))
+
+
+class DeviceTraceIOTestCase(RequiresDevice):
+    def runTest(self):
+        parted.freshDisk(self.device, "msdos").commit()
+
+        with self.device.traceIO() as trace:
+            parted.newDisk(self.device)
+
+        self.assertGreater(trace["reads"], 0)
+        self.assertGreaterEqual(trace["sectors_read"], trace["unique_sectors_read"])
+        self.assertGreaterEqual(trace["read_amplification"], 1.0)
+        self.assertTrue(all(op == "read" for (op, _s, _c, _t) in trace["events"]))
+
+        # the block's exception is not replaced by a failed trace_stop()
+        with self.assertRaises(ZeroDivisionError):
+            with self.device.traceIO():
+                self.device.getPedDevice().trace_stop()
+                1 / 0
+
+
+class DeviceSectorCacheTestCase(RequiresDevice):
+    def runTest(self):
+        parted.freshDisk(self.device, "msdos").commit()
+        self.assertIsNone(self.device.sectorCacheInfo)
+
+        self.device.enableSectorCache()
+        self.addCleanup(self.device.disableSectorCache)
+
+        parted.newDisk(self.device)
+        reads = self.device.sectorCacheInfo["device_reads"]
+
+        # the label is read from memory the second time round
+        disk = parted.newDisk(self.device)
+        self.assertEqual(disk.type, "msdos")
+        self.assertEqual(self.device.sectorCacheInfo["device_reads"], reads)
+        self.assertGreater(self.device.sectorCacheInfo["hits"], 0)
+
+
 @unittest.skip("Unimplemented test case.")
 class DeviceGetPedDeviceTestCase(unittest.TestCase):
     def runTest(self):
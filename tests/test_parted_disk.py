@@ -5,6 +5,7 @@
 # SPDX-License-Identifier: GPL-2.0-or-later
 #
 
+import _ped
 import parted
 import unittest
 
@@ -99,6 +100,144 @@ class DiskAddPartitionTestCase(RequiresDisk):
         self.assertTrue(self.disk.addPartition(part, constraint))
 
 
+class DiskAddPartitionsTestCase(RequiresDisk):
+    """
+    addPartitions should add every valid entry, report the failed ones and
+    keep the partitions list in sync with the disk
+    """
+
+    def runTest(self):
+        self.assertEqual(len(self.disk.partitions), 0)
+
+        results = self.disk.addPartitions(
+            [
+                (parted.PARTITION_NORMAL, None, 60, 99),
+                (parted.PARTITION_NORMAL, None, 70, 79),
+                (parted.PARTITION_NORMAL, "ext2", 10, 49, [parted.PARTITION_BOOT]),
+            ],
+            parted.Constraint(device=self.device),
+        )
+
+        self.assertIsInstance(results[0], parted.Partition)
+        self.assertIsInstance(results[1], parted.PartitionException)
+        self.assertIsInstance(results[2], parted.Partition)
+        self.assertTrue(results[2].getFlag(parted.PARTITION_BOOT))
+
+        starts = [p.geometry.start for p in self.disk.partitions]
+        self.assertEqual(starts, [10, 60])
+        self.disk.partitions.invalidate()
+        self.assertEqual([p.geometry.start for p in self.disk.partitions], starts)
+
+
+class DiskProbeFileSystemsTestCase(RequiresDisk):
+    """
+    probeFileSystems should answer for every partition, by number
+    """
+
+    def runTest(self):
+        self.disk.addPartitions(
+            [
+                (parted.PARTITION_NORMAL, None, 10, 49),
+                (parted.PARTITION_NORMAL, None, 60, 99),
+            ],
+            parted.Constraint(device=self.device),
+        )
+
+        self.assertEqual(self.disk.probeFileSystems(workers=2), {1: None, 2: None})
+
+        geoms = [part.geometry for part in self.disk.partitions]
+        self.assertEqual(parted.probeFileSystems(geoms), [None, None])
+
+
+class DiskWipeSignaturesTestCase(RequiresDisk):
+    """
+    wipeSignatures should zero both ends of each partition and nothing else
+    """
+
+    def runTest(self):
+        self.disk.addPartitions(
+            [(parted.PARTITION_NORMAL, None, 10, 49)],
+            parted.Constraint(device=self.device),
+        )
+        geom = self.disk.partitions[0].geometry
+        outside = parted.Geometry(self.device, start=60, length=1)
+
+        self.device.open()
+        geom.write("signature", 0, 1)
+        outside.write("keep", 0, 1)
+
+        result = self.disk.wipeSignatures()
+        self.assertEqual(result["bytes_zeroed"], 40 * self.device.sectorSize)
+        self.assertEqual(result["bytes_discarded"], 0)
+        self.assertGreaterEqual(result["elapsed"], 0)
+        self.assertEqual(geom.read(0, 1), "")
+        self.assertEqual(outside.read(0, 1), "keep")
+
+        parted.wipeSignatures([outside])
+        self.assertEqual(outside.read(0, 1), "")
+
+        # The free space is only discarded when asked for on its own.
+        outside.write("keep", 0, 1)
+        result = self.disk.wipeSignatures(discard=True)
+        self.assertEqual(result["bytes_discarded"], 40 * self.device.sectorSize)
+        self.assertEqual(outside.read(0, 1), "keep")
+
+        result = self.disk.wipeSignatures(discard=True, freeSpace=True)
+        self.assertGreater(result["bytes_discarded"], 40 * self.device.sectorSize)
+        self.assertEqual(outside.read(0, 1), "")
+        self.device.close()
+
+
+class DiskLabelTemplateTestCase(RequiresDisk):
+    """
+    stampLabel should give another device the same partition table
+    """
+
+    def runTest(self):
+        self.disk.addPartitions(
+            [(parted.PARTITION_NORMAL, None, 10, 49)],
+            parted.Constraint(device=self.device),
+        )
+        template = self.disk.labelTemplate()
+        devs = [
+            parted.Device(PedDevice=_ped.device_new_memory(self.device.length))
+            for i in range(2)
+        ]
+        signatures = []
+
+        try:
+            for dev in devs:
+                parted.stampLabel(template, dev)
+                disk = parted.newDisk(dev)
+                self.assertEqual(disk.type, "msdos")
+                self.assertEqual(disk.partitions[0].geometry.start, 10)
+                self.assertEqual(disk.partitions[0].geometry.end, 49)
+
+                with open(dev.path, "rb") as f:
+                    signatures.append(f.read(444)[440:])
+
+            # each stamped disk gets its own MBR disk signature
+            self.assertNotEqual(signatures[0], signatures[1])
+        finally:
+            for dev in devs:
+                dev.getPedDevice().destroy()
+
+
+class DiskSnapshotTestCase(RequiresDisk):
+    """
+    restore should bring back the partitions recorded by snapshot and keep
+    the partitions list in sync
+    """
+
+    def runTest(self):
+        snap = self.disk.snapshot()
+        self.disk.addPartitions([(parted.PARTITION_NORMAL, None, 10, 49)])
+        self.assertEqual(len(self.disk.partitions), 1)
+
+        self.disk.restore(snap)
+        self.assertEqual(len(self.disk.partitions), 0)
+
+
 @unittest.skip("Unimplemented test case.")
 class DiskRemovePartitionTestCase(unittest.TestCase):
     def runTest(self):
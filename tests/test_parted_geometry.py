@@ -7,6 +7,7 @@
 
 import parted
 import unittest
+import weakref
 
 from tests.baseclass import RequiresDevice
 
@@ -55,6 +56,17 @@ class GeometryEqualTestCase(unittest.TestCase):
         self.fail("Unimplemented test case.")
 
 
+class GeometryCopyToTestCase(RequiresDevice):
+    def runTest(self):
+        src = parted.Geometry(self.device, start=10, length=20)
+        dst = parted.Geometry(self.device, start=40, length=20)
+        self._device.open()
+        src.write("copied", 5, 1)
+        self.assertEqual(src.copyTo(dst), 20)
+        self.assertEqual(dst.read(5, 1), "copied")
+        self._device.close()
+
+
 @unittest.skip("Unimplemented test case.")
 class GeometryGetSizeTestCase(unittest.TestCase):
     def runTest(self):
@@ -71,6 +83,21 @@ class GeometryGetLengthTestCase(RequiresDevice):
         self.assertEqual(geom.getLength(), length)
 
 
+class GeometryWeakrefTestCase(RequiresDevice):
+    def runTest(self):
+        # the slimmed down wrappers still take weak references, but have no
+        # per instance dict to hold new attributes
+        geom = parted.Geometry(self.device, start=100, length=137)
+        ref = weakref.ref(geom)
+        self.assertIs(ref(), geom)
+
+        for obj in (geom, self.device, geom.device):
+            self.assertIs(weakref.ref(obj)(), obj)
+
+            with self.assertRaises(AttributeError):
+                obj.note = "kept"
+
+
 @unittest.skip("Unimplemented test case.")
 class GeometryIntersectTestCase(unittest.TestCase):
     def runTest(self):
@@ -8,6 +8,7 @@
 from __future__ import division
 
 import _ped
+import io
 import parted
 import unittest
 from tests.baseclass import RequiresDevice, RequiresDeviceNode
@@ -72,6 +73,22 @@ class GetDeviceTestCase(RequiresDeviceNode):
         self.assertEqual(parted.getDevice(self.path).path, self.path)
 
 
+class NewMemoryDeviceTestCase(unittest.TestCase):
+    def runTest(self):
+        optimum = parted.Alignment(offset=0, grainSize=2048)
+        device = parted.newMemoryDevice(65536, optimumAlignment=optimum)
+        self.addCleanup(device.destroy)
+
+        self.assertIsInstance(device, parted.Device)
+        self.assertEqual(device.length, 65536)
+        self.assertEqual(device.sectorSize, 512)
+        self.assertEqual(device.optimumAlignment, optimum)
+
+        disk = parted.freshDisk(device, "msdos")
+        self.assertTrue(disk.commit())
+        self.assertEqual(parted.newDisk(device).type, "msdos")
+
+
 class GetAllDevicesTestCase(unittest.TestCase):
     def setUp(self):
         self.devices = parted.getAllDevices()
@@ -124,6 +141,31 @@ class FreshDiskTestCase(RequiresDevice):
             self.assertEqual(parted.diskType[disk.type], value)
 
 
+class LayoutsTestCase(RequiresDevice):
+    def runTest(self):
+        disk = parted.freshDisk(self.device, "msdos")
+        empty = disk.exportLayout()
+
+        geom = parted.Geometry(device=self.device, start=10, length=40)
+        constraint = parted.Constraint(exactGeom=geom)
+        disk.addPartition(
+            parted.Partition(disk=disk, type=parted.PARTITION_NORMAL, geometry=geom),
+            constraint,
+        )
+        full = disk.exportLayout()
+
+        records = list(parted.readLayouts(io.BytesIO(empty + full)))
+        self.assertEqual(records, [empty, full])
+        self.assertEqual(parted.diffLayouts(records[0], records[1])["added"], [1])
+
+        copy = parted.newDiskFromLayout(self.device, records[1])
+        self.assertIsInstance(copy, parted.Disk)
+        self.assertEqual(copy.partitions[0].geometry, geom)
+
+        truncated = io.BytesIO(full[:-1])
+        self.assertRaises(ValueError, list, parted.readLayouts(truncated))
+
+
 @unittest.skip("Unimplemented test case.")
 class IsAlignToCylindersTestCase(unittest.TestCase):
     def runTest(self):
@@ -8,6 +8,7 @@
 import parted
 import unittest
 import uuid
+import weakref
 
 from tests.baseclass import RequiresDisk
 from tests.baseclass import RequiresGPTDisk
@@ -51,6 +52,14 @@ class PartitionNewTestCase(RequiresDisk):
         self.assertIsInstance(part_nofs, parted.Partition)
 
 
+class PartitionWeakrefTestCase(PartitionNewTestCase):
+    def runTest(self):
+        self.assertIs(weakref.ref(self.part)(), self.part)
+
+        with self.assertRaises(AttributeError):
+            self.part.note = "kept"
+
+
 class PartitionGPTNewTestCase(RequiresGPTDisk):
     """
     Like PartitionNewTestCase but with a GPT-labeled disk image.